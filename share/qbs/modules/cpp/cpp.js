@@ -28,6 +28,10 @@
 **
 ****************************************************************************/
 
+var File = require("qbs.File");
+var TextFile = require("qbs.TextFile");
+var Utilities = require("qbs.Utilities");
+
 function languageVersion(versionArray, knownValues, lang) {
     if (!versionArray)
         return undefined;
@@ -44,3 +48,145 @@ function languageVersion(versionArray, knownValues, lang) {
                   + "' from list of unknown " + lang + " version strings (" + versions + ")");
     return version;
 }
+
+// The module properties that affect how a source file gets compiled. Files that differ in any
+// of them cannot be combined into the same file.
+var combinedSourcesProperties = [
+    "defines", "includePaths", "systemIncludePaths", "frameworkPaths", "systemFrameworkPaths",
+    "prefixHeaders", "commonCompilerFlags", "cFlags", "cxxFlags", "objcFlags", "objcxxFlags",
+    "driverFlags", "cLanguageVersion", "cxxLanguageVersion", "optimization", "debugInformation",
+    "warningLevel", "treatWarningsAsErrors", "enableExceptions", "enableRtti",
+    "exceptionHandlingModel", "positionIndependentCode", "visibility"
+];
+
+function combinedSourcesKey(artifactOrProduct) {
+    var values = {};
+    for (var i = 0; i < combinedSourcesProperties.length; ++i) {
+        var name = combinedSourcesProperties[i];
+        values[name] = artifactOrProduct.cpp[name];
+    }
+    return JSON.stringify(values);
+}
+
+// Distributes the inputs of a combining rule among the files to generate. Sources compiled with
+// the product's settings go into one of cpp.combinedSourcesBatchCount files, chosen by the hash
+// of their path, so that adding, removing or editing a source affects only one of them.
+// Sources with different settings due to Group-level properties get separate files.
+function combinedSourcesBatches(product, inputs, suffix) {
+    var productKey = combinedSourcesKey(product);
+    var batchCount = product.cpp.combinedSourcesBatchCount;
+    var baseName = "amalgamated_" + product.targetName;
+    var sortedInputs = inputs.slice().sort(function(a, b) {
+        return a.filePath < b.filePath ? -1 : a.filePath > b.filePath ? 1 : 0;
+    });
+    var batches = {};
+    for (var i = 0; i < sortedInputs.length; ++i) {
+        var input = sortedInputs[i];
+        var key = combinedSourcesKey(input);
+        var fileName = baseName;
+        if (key !== productKey) {
+            fileName += "_" + Utilities.getHash(key).slice(0, 8);
+        } else if (batchCount > 1) {
+            fileName += "_" + parseInt(Utilities.getHash(input.filePath).slice(0, 8), 16)
+                    % batchCount;
+        }
+        fileName += suffix;
+        var batch = batches[fileName];
+        if (!batch) {
+            batch = batches[fileName] = {
+                inputs: [],
+                propertiesSource: key !== productKey ? input : undefined
+            };
+        }
+        batch.inputs.push(input);
+    }
+    return batches;
+}
+
+function combinedSourcesOutputArtifacts(product, inputs, fileTag, suffix) {
+    var batches = combinedSourcesBatches(product, inputs, suffix);
+    var artifacts = [];
+    for (var fileName in batches) {
+        var artifact = {
+            filePath: fileName,
+            fileTags: [fileTag],
+            alwaysUpdated: false // Unchanged files are not rewritten, see writeCombinedSources().
+        };
+        var propertiesSource = batches[fileName].propertiesSource;
+        if (propertiesSource) {
+            artifact.cpp = {};
+            for (var i = 0; i < combinedSourcesProperties.length; ++i) {
+                var name = combinedSourcesProperties[i];
+                artifact.cpp[name] = propertiesSource.cpp[name];
+            }
+        }
+        artifacts.push(artifact);
+    }
+    return artifacts;
+}
+
+function combinedSourcesCommands(product, inputs, outputs, suffix) {
+    var batches = combinedSourcesBatches(product, inputs, suffix);
+    var commands = [];
+    for (var i = 0; i < outputs.length; ++i) {
+        var cmd = new JavaScriptCommand();
+        cmd.description = "creating " + outputs[i].fileName;
+        cmd.highlight = "codegen";
+        cmd.inputFilePaths = batches[outputs[i].fileName].inputs.map(function(input) {
+            return input.filePath;
+        });
+        cmd.outputFilePath = outputs[i].filePath;
+        cmd.sourceCode = function() {
+            writeCombinedSources(inputFilePaths, outputFilePath);
+        };
+        commands.push(cmd);
+    }
+    return commands;
+}
+
+// Leaves the file untouched if its content does not change, so that only the combined files
+// whose list of sources changed get recompiled.
+function writeCombinedSources(inputFilePaths, outputFilePath) {
+    var content = "";
+    for (var i = 0; i < inputFilePaths.length; ++i)
+        content += "#include " + Utilities.cStringQuote(inputFilePaths[i]) + "\n";
+    if (File.exists(outputFilePath)) {
+        var oldFile = new TextFile(outputFilePath, TextFile.ReadOnly);
+        try {
+            if (oldFile.readAll() === content)
+                return;
+        } finally {
+            oldFile.close();
+        }
+    }
+    var f = new TextFile(outputFilePath, TextFile.WriteOnly);
+    try {
+        f.write(content);
+    } finally {
+        f.close();
+    }
+}
+
+// Returns the name of the module declared by a C++ module interface or partition unit,
+// e.g. "a.b" or "a.b:part", or undefined if the file does not declare one.
+// This has to be known in outputArtifacts, before the dependency scanner has run.
+function declaredModuleName(filePath) {
+    var f = new TextFile(filePath, TextFile.ReadOnly);
+    var content;
+    try {
+        content = f.readAll();
+    } finally {
+        f.close();
+    }
+    content = content.replace(/\/\*[\s\S]*?\*\//g, " ").replace(/\/\/.*$/gm, "");
+    var match = /^\s*(export\s+)?module\s+([A-Za-z_][\w.]*)\s*(:\s*([A-Za-z_][\w.]*))?\s*;/m
+            .exec(content);
+    if (!match || (!match[1] && !match[4]))
+        return undefined;
+    return match[4] ? match[2] + ":" + match[4] : match[2];
+}
+
+// GCC and clang both name the file of a partition "a.b-part".
+function compiledModuleFilePath(directory, moduleName, suffix) {
+    return directory + "/" + moduleName.replace(":", "-") + suffix;
+}
@@ -522,6 +522,21 @@ function linkerFlags(project, product, inputs, outputs, primaryOutput, linkerPat
                                        }));
     }
 
+    if (product.cpp.imageFormat === "elf") {
+        var linkerVariant = product.cpp._effectiveLinkerVariant;
+        var linkerThreadCount = product.cpp.linkerThreadCount;
+        if (linkerThreadCount !== undefined) {
+            if (linkerVariant === "gold")
+                escapableLinkerFlags.push("--threads", "--thread-count=" + linkerThreadCount);
+            else if (linkerVariant === "lld")
+                escapableLinkerFlags.push("--threads=" + linkerThreadCount);
+            else if (linkerVariant === "mold")
+                escapableLinkerFlags.push("--thread-count=" + linkerThreadCount);
+        }
+        if (product.cpp.generateGdbIndex && ["gold", "lld", "mold"].contains(linkerVariant))
+            escapableLinkerFlags.push("--gdb-index");
+    }
+
     var importLibs = outputs.dynamiclibrary_import;
     if (importLibs)
         escapableLinkerFlags.push("--out-implib", importLibs[0].filePath);
@@ -751,7 +766,67 @@ function standardFallbackValueOrDefault(toolchain, compilerVersion, languageVers
     return languageVersion;
 }
 
-function compilerFlags(project, product, input, output, explicitlyDependsOn) {
+function compilerFlags(project, product, input, output, explicitlyDependsOn, outputs) {
+    // Determine which C-language we're compiling
+    var tag = ModUtils.fileTagForTargetLanguage(input.fileTags.concat(output.fileTags));
+    if (!["c", "cpp", "objc", "objcpp", "asm_cpp"].contains(tag))
+        throw ("unsupported source language: " + tag);
+
+    // The bulk of the flags depends only on the input's properties, which are usually
+    // shared by all sources of a product, so we compute it once per set of properties.
+    // The cached value is shared, so it must not be modified.
+    var commonFlags = input.cachedValue("gcc.commonCompilerFlags." + tag, function() {
+        return commonCompilerFlags(product, input, tag);
+    });
+
+    var compilerInfo = effectiveCompilerInfo(product.qbs.toolchain,
+                                             input, output);
+
+    var args = commonFlags.beforeRandomSeed.slice();
+    if (input.cpp.enableReproducibleBuilds && !product.qbs.toolchain.contains("clang")) {
+        var hashString = FileInfo.relativePath(project.sourceDirectory, input.filePath);
+        var hash = Utilities.getHash(hashString);
+        args.push("-frandom-seed=0x" + hash.substring(0, 8));
+    }
+    Array.prototype.push.apply(args, commonFlags.beforeLanguage);
+
+    var compiledModules = outputs && outputs["cpp_bmi"];
+    if (compiledModules && product.qbs.toolchain.contains("clang"))
+        // clang only produces a module interface for inputs of this language.
+        args.push("-x", "c++-module");
+    else if (compilerInfo.language)
+        // Only push language arguments if we have to.
+        Array.prototype.push.apply(args, compilerInfo.language);
+
+    Array.prototype.push.apply(args, commonFlags.beforePch);
+
+    var pchTag = compilerInfo.tag + "_pch";
+    var pchOutput = output.fileTags.contains(pchTag);
+    var pchInputs = explicitlyDependsOn[pchTag];
+    if (!pchOutput && pchInputs && pchInputs.length === 1
+            && ModUtils.moduleProperty(input, 'usePrecompiledHeader', tag)) {
+        var pchInput = pchInputs[0];
+        var pchFilePath = FileInfo.joinPaths(FileInfo.path(pchInput.filePath),
+                                             pchInput.completeBaseName);
+        args.push('-include', pchFilePath);
+    }
+
+    Array.prototype.push.apply(args, commonFlags.afterPch);
+
+    if (tag === "cpp" && input.cpp.enableCxxModules) {
+        args = args.concat(cxxModuleFlags(product, input, output, compiledModules,
+                                          explicitlyDependsOn["cpp_bmi"]));
+    }
+
+    args.push("-o", output.filePath);
+    args.push("-c", input.filePath);
+
+    return args;
+}
+
+// The parts of the compiler command line that do not depend on the input file itself,
+// split at the places where file-specific flags go.
+function commonCompilerFlags(product, input, tag) {
     var i;
 
     var includePaths = input.cpp.includePaths;
@@ -761,14 +836,6 @@ function compilerFlags(project, product, input, output, explicitlyDependsOn) {
     var platformDefines = input.cpp.platformDefines;
     var defines = input.cpp.defines;
 
-    // Determine which C-language we're compiling
-    var tag = ModUtils.fileTagForTargetLanguage(input.fileTags.concat(output.fileTags));
-    if (!["c", "cpp", "objc", "objcpp", "asm_cpp"].contains(tag))
-        throw ("unsupported source language: " + tag);
-
-    var compilerInfo = effectiveCompilerInfo(product.qbs.toolchain,
-                                             input, output);
-
     var args = additionalCompilerAndLinkerFlags(product);
 
     Array.prototype.push.apply(args, product.cpp.sysrootFlags);
@@ -776,6 +843,8 @@ function compilerFlags(project, product, input, output, explicitlyDependsOn) {
 
     if (input.cpp.debugInformation)
         args.push('-g');
+    if (usesSplitDwarf(input))
+        args.push('-gsplit-dwarf');
     var opt = input.cpp.optimization
     if (opt === 'fast')
         args.push('-O2');
@@ -799,14 +868,11 @@ function compilerFlags(project, product, input, output, explicitlyDependsOn) {
     if (!input.qbs.toolchain.contains("qcc"))
         args.push('-pipe');
 
+    var result = { beforeRandomSeed: args };
+    args = [];
+
     if (input.cpp.enableReproducibleBuilds) {
         var toolchain = product.qbs.toolchain;
-        if (!toolchain.contains("clang")) {
-            var hashString = FileInfo.relativePath(project.sourceDirectory, input.filePath);
-            var hash = Utilities.getHash(hashString);
-            args.push("-frandom-seed=0x" + hash.substring(0, 8));
-        }
-
         var major = product.cpp.compilerVersionMajor;
         var minor = product.cpp.compilerVersionMinor;
         if ((toolchain.contains("clang") && (major > 3 || (major === 3 && minor >= 5))) ||
@@ -847,25 +913,14 @@ function compilerFlags(project, product, input, output, explicitlyDependsOn) {
             args.push('-fvisibility=default')
     }
 
-    if (compilerInfo.language)
-        // Only push language arguments if we have to.
-        Array.prototype.push.apply(args, compilerInfo.language);
+    result.beforeLanguage = args;
 
-    args = args.concat(ModUtils.moduleProperty(input, 'platformFlags'),
-                       ModUtils.moduleProperty(input, 'flags'),
-                       ModUtils.moduleProperty(input, 'platformFlags', tag),
-                       ModUtils.moduleProperty(input, 'flags', tag));
+    result.beforePch = [].concat(ModUtils.moduleProperty(input, 'platformFlags'),
+                                 ModUtils.moduleProperty(input, 'flags'),
+                                 ModUtils.moduleProperty(input, 'platformFlags', tag),
+                                 ModUtils.moduleProperty(input, 'flags', tag));
 
-    var pchTag = compilerInfo.tag + "_pch";
-    var pchOutput = output.fileTags.contains(pchTag);
-    var pchInputs = explicitlyDependsOn[pchTag];
-    if (!pchOutput && pchInputs && pchInputs.length === 1
-            && ModUtils.moduleProperty(input, 'usePrecompiledHeader', tag)) {
-        var pchInput = pchInputs[0];
-        var pchFilePath = FileInfo.joinPaths(FileInfo.path(pchInput.filePath),
-                                             pchInput.completeBaseName);
-        args.push('-include', pchFilePath);
-    }
+    args = [];
 
     var prefixHeaders = input.cpp.prefixHeaders;
     for (i in prefixHeaders) {
@@ -940,10 +995,67 @@ function compilerFlags(project, product, input, output, explicitlyDependsOn) {
         }
     }
 
-    args.push("-o", output.filePath);
-    args.push("-c", input.filePath);
+    result.afterPch = args;
+    return result;
+}
 
-    return args;
+// Every product stores its compiled module interfaces in its own cpp.compiledModulesDirectory.
+// The interfaces of modules imported from other products are the "cpp_bmi" artifacts
+// of the product's dependencies.
+function cxxModuleFlags(product, input, output, compiledModules, importedModules) {
+    var directory = input.cpp.compiledModulesDirectory;
+    if (product.qbs.toolchain.contains("clang")) {
+        var directories = [directory];
+        (importedModules || []).forEach(function(module) {
+            var moduleDirectory = FileInfo.path(module.filePath);
+            if (!directories.contains(moduleDirectory))
+                directories.push(moduleDirectory);
+        });
+        var args = directories.map(function(dir) { return "-fprebuilt-module-path=" + dir; });
+        if (compiledModules)
+            args.push("-fmodule-output=" + compiledModules[0].filePath);
+        return args;
+    }
+
+    if (importedModules && importedModules.length > 0)
+        return ["-fmodules-ts", "-fmodule-mapper=" + cxxModuleMapperFilePath(output)];
+
+    // The mapper server that comes with GCC maps a module name "a.b:c" to the file
+    // "a.b-c.gcm" in the given directory, which is what Cpp.compiledModuleFilePath() expects.
+    return ["-fmodules-ts", "-fmodule-mapper=|@g++-mapper-server -r" + directory];
+}
+
+// GCC takes only one module directory, so modules imported from other products
+// are listed in a mapper file that is written before compiling.
+function usesCxxModuleMapperFile(product, input, tag, importedModules) {
+    return tag === "cpp" && input.cpp.enableCxxModules && importedModules
+            && importedModules.length > 0 && !product.qbs.toolchain.contains("clang");
+}
+
+function cxxModuleMapperFilePath(output) {
+    return output.filePath + ".modmap";
+}
+
+function createCxxModuleMapperCommand(input, output, importedModules) {
+    var cmd = new JavaScriptCommand();
+    cmd.silent = true;
+    cmd.mapperFilePath = cxxModuleMapperFilePath(output);
+    cmd.directory = input.cpp.compiledModulesDirectory;
+    cmd.moduleFilePaths = importedModules.map(function(module) { return module.filePath; });
+    cmd.sourceCode = function() {
+        var file = new TextFile(mapperFilePath, TextFile.WriteOnly);
+        try {
+            // Modules that are not listed are the ones of this product.
+            file.writeLine("$root " + directory);
+            moduleFilePaths.forEach(function(filePath) {
+                var moduleName = FileInfo.completeBaseName(filePath).replace("-", ":");
+                file.writeLine(moduleName + " " + filePath);
+            });
+        } finally {
+            file.close();
+        }
+    };
+    return cmd;
 }
 
 function additionalCompilerAndLinkerFlags(product) {
@@ -1060,12 +1172,16 @@ function setResponseFileThreshold(command, product)
 }
 
 function prepareCompiler(project, product, inputs, outputs, input, output, explicitlyDependsOn) {
+    // With split DWARF or a compiled module interface, there is more than one output,
+    // so the rule engine does not provide the object file as "output".
+    if (!output)
+        output = (outputs.obj || outputs.intermediate_obj)[0];
     var compilerInfo = effectiveCompilerInfo(product.qbs.toolchain,
                                              input, output);
     var compilerPath = compilerInfo.path;
     var pchOutput = output.fileTags.contains(compilerInfo.tag + "_pch");
 
-    var args = compilerFlags(project, product, input, output, explicitlyDependsOn);
+    var args = compilerFlags(project, product, input, output, explicitlyDependsOn, outputs);
     var wrapperArgsLength = 0;
     var wrapperArgs = product.cpp.compilerWrapper;
     var extraEnv;
@@ -1105,6 +1221,9 @@ function prepareCompiler(project, product, inputs, outputs, input, output, expli
     cmd.responseFileArgumentIndex = wrapperArgsLength;
     cmd.responseFileUsagePrefix = '@';
     setResponseFileThreshold(cmd, product);
+    var importedModules = explicitlyDependsOn["cpp_bmi"];
+    if (usesCxxModuleMapperFile(product, input, compilerInfo.tag, importedModules))
+        return [createCxxModuleMapperCommand(input, output, importedModules), cmd];
     return cmd;
 }
 
@@ -1553,6 +1672,29 @@ function targetFlags(tool, hasTargetOption, target, targetArch, machineType, tar
     return args;
 }
 
+// Split DWARF is an ELF feature, and the assembler does not create .dwo files.
+function usesSplitDwarf(input) {
+    return input.cpp.debugInformation && input.cpp.splitDwarf
+            && input.cpp.imageFormat === "elf" && !input.fileTags.contains("asm_cpp");
+}
+
+// In order of preference. GCC supports -fuse-ld=lld since version 9
+// and -fuse-ld=mold since version 12.1.
+function fastLinkerNames(toolchain, compilerVersionMajor, compilerVersionMinor) {
+    var names = [];
+    if (toolchain.contains("clang") || compilerVersionMajor > 12
+            || (compilerVersionMajor === 12 && compilerVersionMinor >= 1)) {
+        names.push("ld.mold");
+    }
+    if (toolchain.contains("clang") || compilerVersionMajor >= 9)
+        names.push("ld.lld");
+    return names;
+}
+
+function linkerVariantFromFileName(fileName) {
+    return fileName.startsWith("ld.mold") ? "mold" : "lld";
+}
+
 function toolNames(rawToolNames, toolchainPrefix)
 {
     return toolchainPrefix
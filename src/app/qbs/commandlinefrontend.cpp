@@ -42,6 +42,7 @@
 #include "consoleprogressobserver.h"
 #include "session.h"
 #include "status.h"
+#include "testreport.h"
 #include "parser/commandlineoption.h"
 #include "../shared/logging/consolelogger.h"
 
@@ -53,8 +54,11 @@
 #include <tools/qttools.h>
 #include <tools/shellutils.h>
 
+#include <QtCore/qcryptographichash.h>
 #include <QtCore/qdir.h>
 #include <QtCore/qfile.h>
+#include <QtCore/qjsondocument.h>
+#include <QtCore/qjsonobject.h>
 #include <QtCore/qprocess.h>
 #include <QtCore/qtimer.h>
 
@@ -122,8 +126,10 @@ void CommandLineFrontend::start()
             Q_FALLTHROUGH();
         case StatusCommandType:
         case InstallCommandType:
+        case TestCommandType:
         case DumpNodesTreeCommandType:
         case ListProductsCommandType:
+        case QueryCommandType:
             if (m_parser.buildConfigurations().size() > 1) {
                 QString error = Tr::tr("Invalid use of command '%1': There can be only one "
                                "build configuration.\n").arg(m_parser.commandName());
@@ -154,6 +160,7 @@ void CommandLineFrontend::start()
         params.setWaitLockBuildGraph(m_parser.waitLockBuildGraph());
         params.setFallbackProviderEnabled(!m_parser.disableFallbackProvider());
         params.setLogElapsedTime(m_parser.logTime());
+        params.setCollectProfilingData(!m_parser.profileOutputFilePath().isEmpty());
         params.setSettingsDirectory(m_settings->baseDirectory());
         params.setOverrideBuildGraphData(m_parser.command() == ResolveCommandType);
         params.setPropertyCheckingMode(ErrorHandlingMode::Strict);
@@ -227,10 +234,13 @@ void CommandLineFrontend::handleJobFinished(bool success, AbstractJob *job)
 {
     try {
         job->deleteLater();
+        storeProfilingData(job);
         if (!success) {
             qbsError() << job->error().toString();
             m_resolveJobs.removeOne(job);
-            m_buildJobs.removeOne(job);
+            const bool wasBuildJob = m_buildJobs.removeOne(job);
+            if (wasBuildJob && m_buildJobs.empty() && m_parser.command() == TestCommandType)
+                reportTestResults(false);
             if (m_resolveJobs.empty() && m_buildJobs.empty()) {
                 qApp->exit(EXIT_FAILURE);
                 return;
@@ -256,6 +266,10 @@ void CommandLineFrontend::handleJobFinished(bool success, AbstractJob *job)
                 case InstallCommandType:
                     install();
                     break;
+                case TestCommandType:
+                    reportTestResults(m_cancelStatus == CancelStatusNone);
+                    qApp->exit(m_cancelStatus == CancelStatusNone ? EXIT_SUCCESS : EXIT_FAILURE);
+                    break;
                 case GenerateCommandType:
                     generate();
                     // fall through
@@ -274,6 +288,27 @@ void CommandLineFrontend::handleJobFinished(bool success, AbstractJob *job)
     }
 }
 
+// The file is rewritten after every job, so it is complete no matter how we exit.
+void CommandLineFrontend::storeProfilingData(const AbstractJob *job)
+{
+    const QString filePath = m_parser.profileOutputFilePath();
+    if (filePath.isEmpty())
+        return;
+    const QJsonObject jobData = job->profilingData();
+    if (jobData.isEmpty())
+        return;
+    m_profilingData.append(jobData);
+    QJsonObject data;
+    data.insert(QStringLiteral("qbs-version"), QStringLiteral(QBS_VERSION));
+    data.insert(QStringLiteral("jobs"), m_profilingData);
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        throw ErrorInfo(Tr::tr("Cannot open profile output file '%1' for writing: %2")
+                        .arg(QDir::toNativeSeparators(filePath), file.errorString()));
+    }
+    file.write(QJsonDocument(data).toJson());
+}
+
 void CommandLineFrontend::handleNewTaskStarted(const QString &description, int totalEffort)
 {
     // If the user does not want a progress bar, we just print the current activity.
@@ -316,6 +351,9 @@ void CommandLineFrontend::handleTaskProgress(int value, AbstractJob *job)
 
 void CommandLineFrontend::handleProcessResultReport(const qbs::ProcessResult &result)
 {
+    if (m_testReport)
+        m_testReport->addProcessResult(result);
+
     bool hasOutput = !result.stdOut().empty() || !result.stdErr().empty();
     if (!hasOutput && result.success())
         return;
@@ -402,6 +440,9 @@ void CommandLineFrontend::handleProjectsResolved()
     case BuildCommandType:
         build();
         break;
+    case TestCommandType:
+        runTests();
+        break;
     case InstallCommandType:
     case RunCommandType:
         if (m_parser.buildBeforeInstalling())
@@ -421,6 +462,10 @@ void CommandLineFrontend::handleProjectsResolved()
         listProducts();
         qApp->quit();
         break;
+    case QueryCommandType:
+        query();
+        qApp->quit();
+        break;
     case HelpCommandType:
     case VersionCommandType:
     case SessionCommandType:
@@ -512,7 +557,11 @@ void CommandLineFrontend::build()
                                                              buildOptions(it.key()), this));
     }
     connectBuildJobs();
+    setupBuildProgress();
+}
 
+void CommandLineFrontend::setupBuildProgress()
+{
     /*
      * Progress reporting for the build jobs works as follows: We know that for every job,
      * the newTaskStarted() signal is emitted exactly once (unless there's an error). So we add up
@@ -525,6 +574,78 @@ void CommandLineFrontend::build()
     m_currentBuildEffort = 0;
 }
 
+// The assignment of a test to a shard depends only on the name of the test product,
+// so running all shards runs every test exactly once.
+static QStringList testsInShard(const ProjectData &projectData, int shardIndex, int shardCount)
+{
+    QStringList testNames;
+    for (const ProductData &product : projectData.allProducts()) {
+        if (!product.isEnabled() || !product.type().contains(QLatin1String("autotest"))
+                || testNames.contains(product.name())) {
+            continue;
+        }
+        const QByteArray hash = QCryptographicHash::hash(product.name().toUtf8(),
+                                                         QCryptographicHash::Sha1).toHex();
+        if (hash.left(8).toUInt(nullptr, 16) % uint(shardCount) == uint(shardIndex))
+            testNames.push_back(product.name());
+    }
+    return testNames;
+}
+
+// Tests are run by building the AutotestRunner products, so they are scheduled like all
+// other commands, and the up-to-date check of the build graph takes care of caching results.
+// The shard is not part of the build configuration, so switching shards does not require
+// re-resolving the project.
+void CommandLineFrontend::runTests()
+{
+    Q_ASSERT(m_projects.size() == 1);
+    const Project project = m_projects.front();
+    QList<ProductData> runners;
+    const QList<ProductData> products = productsToUse().value(project);
+    for (const ProductData &product : products) {
+        if (product.isEnabled() && product.type().contains(QLatin1String("autotest-result")))
+            runners.push_back(product);
+    }
+    if (runners.empty()) {
+        throw ErrorInfo(Tr::tr("Cannot execute command '%1': Project has no enabled "
+                               "AutotestRunner product.").arg(m_parser.commandName()));
+    }
+    for (const ProductData &runner : qAsConst(runners))
+        m_testRunnerNames.push_back(runner.fullDisplayName());
+    m_testReport = std::make_unique<TestReport>();
+    BuildOptions options = buildOptions(project);
+    if (m_parser.shardCount() > 1) {
+        const QStringList testNames = testsInShard(project.projectData(), m_parser.shardIndex(),
+                                                   m_parser.shardCount());
+        m_testReport->selectTests(testNames);
+        if (testNames.empty()) {
+            reportTestResults(true);
+            qApp->quit();
+            return;
+        }
+        options.setTestsToRun(testNames);
+    }
+    m_buildJobs.push_back(project.buildSomeProducts(runners, options, this));
+    connectBuildJobs();
+    setupBuildProgress();
+}
+
+void CommandLineFrontend::reportTestResults(bool buildSucceeded)
+{
+    QBS_CHECK(m_testReport);
+    QList<ProductData> runners;
+    for (const ProductData &product : m_projects.front().projectData().allProducts()) {
+        if (m_testRunnerNames.contains(product.fullDisplayName()))
+            runners.push_back(product);
+    }
+    m_testReport->collectResults(runners, buildSucceeded);
+    qbsInfo() << m_testReport->summary();
+    if (!m_parser.jsonReportFilePath().isEmpty())
+        m_testReport->writeJson(m_parser.jsonReportFilePath());
+    if (!m_parser.junitReportFilePath().isEmpty())
+        m_testReport->writeJUnit(m_parser.junitReportFilePath());
+}
+
 void CommandLineFrontend::checkGeneratorName()
 {
     const QString generatorName = m_parser.generateOptions().generatorName();
@@ -607,6 +728,55 @@ void CommandLineFrontend::listProducts()
     qbsInfo() << output.join(QLatin1Char('\n'));
 }
 
+void CommandLineFrontend::query()
+{
+    const QString queryType = m_parser.queryType();
+    if (queryType.isEmpty()) {
+        throw ErrorInfo(Tr::tr("No query given.\nUsage: %1")
+                        .arg(m_parser.commandDescription()));
+    }
+    const Project &project = m_projects.front();
+    const QList<ProductData> products = m_parser.products().empty()
+            ? QList<ProductData>() : productsToUse().value(project);
+    const auto absolutePath = [this] {
+        return QDir::cleanPath(QFileInfo(m_parser.queryArgument()).absoluteFilePath());
+    };
+    ErrorInfo error;
+    QStringList output;
+    if (queryType == QLatin1String("dependents")
+            || queryType == QLatin1String("all-dependents")) {
+        output = project.dependentFiles(absolutePath(),
+                                        queryType == QLatin1String("all-dependents"),
+                                        products, &error);
+    } else if (queryType == QLatin1String("producer")) {
+        const TransformerData transformer = project.producingTransformer(absolutePath(), &error);
+        if (!error.hasError()) {
+            output << Tr::tr("Inputs:");
+            for (const ArtifactData &input : transformer.inputs())
+                output << QLatin1String("  ") + input.filePath();
+            output << Tr::tr("Outputs:");
+            for (const ArtifactData &outputArtifact : transformer.outputs())
+                output << QLatin1String("  ") + outputArtifact.filePath();
+            output << Tr::tr("Commands:");
+            for (const RuleCommand &command : transformer.commands()) {
+                const bool isProcessCommand = command.type() == RuleCommand::ProcessCommandType;
+                output << QLatin1String("  ") + (isProcessCommand
+                        ? shellQuote(command.executable(), command.arguments())
+                        : command.description());
+            }
+        }
+    } else if (queryType == QLatin1String("tagged")) {
+        output = project.filesWithTag(m_parser.queryArgument(), products, &error);
+    } else {
+        QBS_CHECK(queryType == QLatin1String("stale"));
+        output = project.staleFiles(products, &error);
+    }
+    if (error.hasError())
+        throw error;
+    if (!output.empty())
+        qbsInfo() << output.join(QLatin1Char('\n'));
+}
+
 void CommandLineFrontend::connectBuildJobs()
 {
     for (AbstractJob * const job : qAsConst(m_buildJobs))
@@ -44,6 +44,7 @@
 #include <api/projectdata.h>
 
 #include <QtCore/qhash.h>
+#include <QtCore/qjsonarray.h>
 #include <QtCore/qlist.h>
 #include <QtCore/qobject.h>
 
@@ -60,6 +61,7 @@ class ErrorInfo;
 class ProcessResult;
 class ProjectGenerator;
 class Settings;
+class TestReport;
 
 class CommandLineFrontend : public QObject
 {
@@ -80,6 +82,7 @@ private:
     void handleTaskProgress(int value, qbs::AbstractJob *job);
     void handleProcessResultReport(const qbs::ProcessResult &result);
     void checkCancelStatus();
+    void storeProfilingData(const AbstractJob *job);
 
     using ProductMap = QHash<Project, QList<ProductData>>;
     ProductMap productsToUse() const;
@@ -91,12 +94,16 @@ private:
     void makeClean();
     int runShell();
     void build();
+    void setupBuildProgress();
+    void runTests();
+    void reportTestResults(bool buildSucceeded);
     void checkGeneratorName();
     void generate();
     int runTarget();
     void updateTimestamps();
     void dumpNodesTree();
     void listProducts();
+    void query();
     void connectBuildJobs();
     void connectBuildJob(AbstractJob *job);
     void connectJob(AbstractJob *job);
@@ -123,6 +130,9 @@ private:
     int m_currentBuildEffort = 0;
     QHash<AbstractJob *, int> m_buildEfforts;
     std::shared_ptr<ProjectGenerator> m_generator;
+    QJsonArray m_profilingData;
+    std::unique_ptr<TestReport> m_testReport;
+    QStringList m_testRunnerNames;
 };
 
 } // namespace qbs
@@ -210,7 +210,12 @@ QString QuietOption::longRepresentation() const
 
 QString JobsOption::description(CommandType command) const
 {
-    Q_UNUSED(command);
+    if (command == CleanCommandType) {
+        return Tr::tr("%1|%2 <n>\n"
+                "\tUse <n> threads to remove files. <n> must be an integer greater than zero.\n"
+                "\tThe default is the number of cores.\n")
+                .arg(longRepresentation(), shortRepresentation());
+    }
     return Tr::tr("%1|%2 <n>\n"
             "\tUse <n> concurrent build jobs. <n> must be an integer greater than zero.\n"
             "\tThe default is the number of cores.\n")
@@ -447,6 +452,32 @@ QString ForceOutputCheckOption::longRepresentation() const
     return QStringLiteral("--check-outputs");
 }
 
+QString ParallelPrepareScriptsOption::description(CommandType command) const
+{
+    Q_UNUSED(command);
+    return Tr::tr("%1\n\tRun prepare scripts in parallel.\n"
+                  "\tThe commands of independent rule applications are created\n"
+                  "\tconcurrently, using as many threads as jobs.\n").arg(longRepresentation());
+}
+
+QString ParallelPrepareScriptsOption::longRepresentation() const
+{
+    return QStringLiteral("--parallel-prepare-scripts");
+}
+
+QString JobserverOption::description(CommandType command) const
+{
+    Q_UNUSED(command);
+    return Tr::tr("%1\n\tAct as a GNU make jobserver for the commands of the build.\n"
+                  "\tSub-makes and compilers supporting the jobserver protocol then\n"
+                  "\tshare the job limit with qbs.\n").arg(longRepresentation());
+}
+
+QString JobserverOption::longRepresentation() const
+{
+    return QStringLiteral("--jobserver");
+}
+
 QString BuildNonDefaultOption::description(CommandType command) const
 {
     Q_UNUSED(command);
@@ -570,6 +601,131 @@ void SettingsDirOption::doParse(const QString &representation, QStringList &inpu
     m_settingsDir = input.takeFirst();
 }
 
+QString ProfileOutputOption::description(CommandType command) const
+{
+    Q_UNUSED(command);
+    return Tr::tr("%1 <file>\n"
+                  "\tWrite hierarchical profiling data for the operation to the given file\n"
+                  "\tin JSON format.\n")
+            .arg(longRepresentation());
+}
+
+QString ProfileOutputOption::longRepresentation() const
+{
+    return QStringLiteral("--profile-output");
+}
+
+void ProfileOutputOption::doParse(const QString &representation, QStringList &input)
+{
+    m_filePath = getArgument(representation, input);
+}
+
+QString MemoryBudgetOption::description(CommandType command) const
+{
+    Q_UNUSED(command);
+    return Tr::tr("%1 <MiB>\n"
+                  "\tDo not start new jobs if the expected memory usage of all running jobs\n"
+                  "\twould exceed <MiB> mebibytes. The default is no limit.\n")
+            .arg(longRepresentation());
+}
+
+QString MemoryBudgetOption::longRepresentation() const
+{
+    return QStringLiteral("--memory-budget");
+}
+
+void MemoryBudgetOption::doParse(const QString &representation, QStringList &input)
+{
+    const QString budgetString = getArgument(representation, input);
+    bool stringOk;
+    m_memoryBudget = budgetString.toInt(&stringOk);
+    if (!stringOk || m_memoryBudget <= 0)
+        throw ErrorInfo(Tr::tr("Invalid use of option '%1': Illegal memory budget '%2'.\n"
+                               "Usage: %3")
+                        .arg(representation, budgetString, description(command())));
+}
+
+QString RemoteWorkerOption::description(CommandType command) const
+{
+    Q_UNUSED(command);
+    return Tr::tr("%1 <host>:<port>\n"
+                  "\tRun commands that allow it on the given remote worker.\n")
+            .arg(longRepresentation());
+}
+
+QString RemoteWorkerOption::longRepresentation() const
+{
+    return QStringLiteral("--remote-worker");
+}
+
+void RemoteWorkerOption::doParse(const QString &representation, QStringList &input)
+{
+    m_address = getArgument(representation, input);
+}
+
+QString ShardOption::description(CommandType command) const
+{
+    Q_UNUSED(command);
+    return Tr::tr("%1 <index>/<count>\n"
+                  "\tSplit the set of tests into <count> parts and run only the part\n"
+                  "\twith the zero-based index <index>.\n")
+            .arg(longRepresentation());
+}
+
+QString ShardOption::longRepresentation() const
+{
+    return QStringLiteral("--shard");
+}
+
+void ShardOption::doParse(const QString &representation, QStringList &input)
+{
+    const QString shardSpec = getArgument(representation, input);
+    const int sepIndex = shardSpec.indexOf(QLatin1Char('/'));
+    bool indexOk = false;
+    bool countOk = false;
+    if (sepIndex > 0) {
+        m_shardIndex = shardSpec.left(sepIndex).toInt(&indexOk);
+        m_shardCount = shardSpec.mid(sepIndex + 1).toInt(&countOk);
+    }
+    if (!indexOk || !countOk || m_shardCount < 1 || m_shardIndex < 0
+            || m_shardIndex >= m_shardCount) {
+        throw ErrorInfo(Tr::tr("Invalid use of option '%1': Illegal shard specification '%2'.\n"
+                               "Usage: %3")
+                        .arg(representation, shardSpec, description(command())));
+    }
+}
+
+void TestReportOption::doParse(const QString &representation, QStringList &input)
+{
+    m_filePath = getArgument(representation, input);
+}
+
+QString JUnitReportOption::description(CommandType command) const
+{
+    Q_UNUSED(command);
+    return Tr::tr("%1 <file>\n"
+                  "\tWrite the test results to the given file in JUnit XML format.\n")
+            .arg(longRepresentation());
+}
+
+QString JUnitReportOption::longRepresentation() const
+{
+    return QStringLiteral("--junit-report");
+}
+
+QString JsonReportOption::description(CommandType command) const
+{
+    Q_UNUSED(command);
+    return Tr::tr("%1 <file>\n"
+                  "\tWrite the test results to the given file in JSON format.\n")
+            .arg(longRepresentation());
+}
+
+QString JsonReportOption::longRepresentation() const
+{
+    return QStringLiteral("--json-report");
+}
+
 QString JobLimitsOption::description(CommandType command) const
 {
     Q_UNUSED(command);
@@ -686,6 +842,18 @@ QString DisableFallbackProviderOption::longRepresentation() const
     return QStringLiteral("--no-fallback-module-provider");
 }
 
+QString RemoveProductDirectoriesOption::description(CommandType command) const
+{
+    Q_UNUSED(command);
+    return Tr::tr("%1\n\tRemove a product's build directory as a whole if it contains "
+                  "only files\n\tgenerated for that product.\n").arg(longRepresentation());
+}
+
+QString RemoveProductDirectoriesOption::longRepresentation() const
+{
+    return QStringLiteral("--remove-product-directories");
+}
+
 QString RunEnvConfigOption::description(CommandType command) const
 {
     Q_UNUSED(command);
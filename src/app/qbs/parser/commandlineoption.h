@@ -76,6 +76,15 @@ public:
         WaitLockOptionType,
         RunEnvConfigOptionType,
         DisableFallbackProviderType,
+        RemoveProductDirectoriesOptionType,
+        ProfileOutputOptionType,
+        ParallelPrepareScriptsOptionType,
+        MemoryBudgetOptionType,
+        RemoteWorkerOptionType,
+        ShardOptionType,
+        JUnitReportOptionType,
+        JsonReportOptionType,
+        JobserverOptionType,
     };
 
     virtual ~CommandLineOption();
@@ -252,6 +261,20 @@ class ForceOutputCheckOption : public OnOffOption
     QString longRepresentation() const override;
 };
 
+class ParallelPrepareScriptsOption : public OnOffOption
+{
+    QString description(CommandType command) const override;
+    QString shortRepresentation() const override { return {}; }
+    QString longRepresentation() const override;
+};
+
+class JobserverOption : public OnOffOption
+{
+    QString description(CommandType command) const override;
+    QString shortRepresentation() const override { return {}; }
+    QString longRepresentation() const override;
+};
+
 class BuildNonDefaultOption : public OnOffOption
 {
     QString description(CommandType command) const override;
@@ -384,6 +407,95 @@ private:
     QString m_settingsDir;
 };
 
+class ProfileOutputOption : public CommandLineOption
+{
+public:
+    QString filePath() const { return m_filePath; }
+
+    QString description(CommandType command) const override;
+    QString shortRepresentation() const override { return {}; }
+    QString longRepresentation() const override;
+
+private:
+    void doParse(const QString &representation, QStringList &input) override;
+
+    QString m_filePath;
+};
+
+class MemoryBudgetOption : public CommandLineOption
+{
+public:
+    int memoryBudget() const { return m_memoryBudget; }
+
+    QString description(CommandType command) const override;
+    QString shortRepresentation() const override { return {}; }
+    QString longRepresentation() const override;
+
+private:
+    void doParse(const QString &representation, QStringList &input) override;
+
+    int m_memoryBudget = 0;
+};
+
+class RemoteWorkerOption : public CommandLineOption
+{
+public:
+    QString address() const { return m_address; }
+
+    QString description(CommandType command) const override;
+    QString shortRepresentation() const override { return {}; }
+    QString longRepresentation() const override;
+
+private:
+    void doParse(const QString &representation, QStringList &input) override;
+
+    QString m_address;
+};
+
+class ShardOption : public CommandLineOption
+{
+public:
+    int shardIndex() const { return m_shardIndex; }
+    int shardCount() const { return m_shardCount; }
+
+    QString description(CommandType command) const override;
+    QString shortRepresentation() const override { return {}; }
+    QString longRepresentation() const override;
+
+private:
+    void doParse(const QString &representation, QStringList &input) override;
+
+    int m_shardIndex = 0;
+    int m_shardCount = 1;
+};
+
+class TestReportOption : public CommandLineOption
+{
+public:
+    QString filePath() const { return m_filePath; }
+
+    QString shortRepresentation() const override { return {}; }
+
+private:
+    void doParse(const QString &representation, QStringList &input) override;
+
+    QString m_filePath;
+};
+
+class JUnitReportOption : public TestReportOption
+{
+public:
+    QString description(CommandType command) const override;
+    QString longRepresentation() const override;
+};
+
+class JsonReportOption : public TestReportOption
+{
+public:
+    QString description(CommandType command) const override;
+    QString longRepresentation() const override;
+};
+
 class JobLimitsOption : public CommandLineOption
 {
 public:
@@ -423,6 +535,14 @@ public:
     QString longRepresentation() const override;
 };
 
+class RemoveProductDirectoriesOption : public OnOffOption
+{
+public:
+    QString description(CommandType command) const override;
+    QString shortRepresentation() const override { return {}; }
+    QString longRepresentation() const override;
+};
+
 } // namespace qbs
 
 #endif // QBS_COMMANDLINEOPTION_H
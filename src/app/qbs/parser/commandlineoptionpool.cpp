@@ -134,6 +134,33 @@ CommandLineOption *CommandLineOptionPool::getOption(CommandLineOption::Type type
         case CommandLineOption::RunEnvConfigOptionType:
             option = new RunEnvConfigOption;
             break;
+        case CommandLineOption::RemoveProductDirectoriesOptionType:
+            option = new RemoveProductDirectoriesOption;
+            break;
+        case CommandLineOption::ProfileOutputOptionType:
+            option = new ProfileOutputOption;
+            break;
+        case CommandLineOption::ParallelPrepareScriptsOptionType:
+            option = new ParallelPrepareScriptsOption;
+            break;
+        case CommandLineOption::MemoryBudgetOptionType:
+            option = new MemoryBudgetOption;
+            break;
+        case CommandLineOption::RemoteWorkerOptionType:
+            option = new RemoteWorkerOption;
+            break;
+        case CommandLineOption::ShardOptionType:
+            option = new ShardOption;
+            break;
+        case CommandLineOption::JUnitReportOptionType:
+            option = new JUnitReportOption;
+            break;
+        case CommandLineOption::JsonReportOptionType:
+            option = new JsonReportOption;
+            break;
+        case CommandLineOption::JobserverOptionType:
+            option = new JobserverOption;
+            break;
         default:
             qFatal("Unknown option type %d", type);
         }
@@ -287,4 +314,55 @@ RunEnvConfigOption *CommandLineOptionPool::runEnvConfigOption() const
     return static_cast<RunEnvConfigOption *>(getOption(CommandLineOption::RunEnvConfigOptionType));
 }
 
+RemoveProductDirectoriesOption *CommandLineOptionPool::removeProductDirectoriesOption() const
+{
+    return static_cast<RemoveProductDirectoriesOption *>(
+                getOption(CommandLineOption::RemoveProductDirectoriesOptionType));
+}
+
+ProfileOutputOption *CommandLineOptionPool::profileOutputOption() const
+{
+    return static_cast<ProfileOutputOption *>(
+                getOption(CommandLineOption::ProfileOutputOptionType));
+}
+
+ParallelPrepareScriptsOption *CommandLineOptionPool::parallelPrepareScriptsOption() const
+{
+    return static_cast<ParallelPrepareScriptsOption *>(
+                getOption(CommandLineOption::ParallelPrepareScriptsOptionType));
+}
+
+MemoryBudgetOption *CommandLineOptionPool::memoryBudgetOption() const
+{
+    return static_cast<MemoryBudgetOption *>(
+                getOption(CommandLineOption::MemoryBudgetOptionType));
+}
+
+RemoteWorkerOption *CommandLineOptionPool::remoteWorkerOption() const
+{
+    return static_cast<RemoteWorkerOption *>(
+                getOption(CommandLineOption::RemoteWorkerOptionType));
+}
+
+ShardOption *CommandLineOptionPool::shardOption() const
+{
+    return static_cast<ShardOption *>(getOption(CommandLineOption::ShardOptionType));
+}
+
+JUnitReportOption *CommandLineOptionPool::junitReportOption() const
+{
+    return static_cast<JUnitReportOption *>(
+                getOption(CommandLineOption::JUnitReportOptionType));
+}
+
+JsonReportOption *CommandLineOptionPool::jsonReportOption() const
+{
+    return static_cast<JsonReportOption *>(getOption(CommandLineOption::JsonReportOptionType));
+}
+
+JobserverOption *CommandLineOptionPool::jobserverOption() const
+{
+    return static_cast<JobserverOption *>(getOption(CommandLineOption::JobserverOptionType));
+}
+
 } // namespace qbs
@@ -79,6 +79,15 @@ public:
     WaitLockOption *waitLockOption() const;
     DisableFallbackProviderOption *disableFallbackProviderOption() const;
     RunEnvConfigOption *runEnvConfigOption() const;
+    RemoveProductDirectoriesOption *removeProductDirectoriesOption() const;
+    ProfileOutputOption *profileOutputOption() const;
+    ParallelPrepareScriptsOption *parallelPrepareScriptsOption() const;
+    MemoryBudgetOption *memoryBudgetOption() const;
+    RemoteWorkerOption *remoteWorkerOption() const;
+    ShardOption *shardOption() const;
+    JUnitReportOption *junitReportOption() const;
+    JsonReportOption *jsonReportOption() const;
+    JobserverOption *jobserverOption() const;
 
 private:
     mutable QHash<CommandLineOption::Type, CommandLineOption *> m_options;
@@ -179,6 +179,9 @@ CleanOptions CommandLineParser::cleanOptions(const QString &profile) const
     options.setDryRun(buildOptions(profile).dryRun());
     options.setKeepGoing(buildOptions(profile).keepGoing());
     options.setLogElapsedTime(logTime());
+    options.setMaxJobCount(buildOptions(profile).maxJobCount());
+    options.setRemoveProductDirectories(
+                d->optionPool.removeProductDirectoriesOption()->enabled());
     return options;
 }
 
@@ -241,6 +244,12 @@ bool CommandLineParser::logTime() const
     return d->logTime;
 }
 
+QString CommandLineParser::profileOutputFilePath() const
+{
+    const QString filePath = d->optionPool.profileOutputOption()->filePath();
+    return filePath.isEmpty() ? filePath : QFileInfo(filePath).absoluteFilePath();
+}
+
 bool CommandLineParser::withNonDefaultProducts() const
 {
     return d->withNonDefaultProducts();
@@ -257,6 +266,40 @@ QStringList CommandLineParser::runArgs() const
     return static_cast<RunCommand *>(d->command)->targetParameters();
 }
 
+QString CommandLineParser::queryType() const
+{
+    Q_ASSERT(d->command->type() == QueryCommandType);
+    return static_cast<QueryCommand *>(d->command)->queryType();
+}
+
+QString CommandLineParser::queryArgument() const
+{
+    Q_ASSERT(d->command->type() == QueryCommandType);
+    return static_cast<QueryCommand *>(d->command)->queryArgument();
+}
+
+int CommandLineParser::shardIndex() const
+{
+    return d->optionPool.shardOption()->shardIndex();
+}
+
+int CommandLineParser::shardCount() const
+{
+    return d->optionPool.shardOption()->shardCount();
+}
+
+QString CommandLineParser::junitReportFilePath() const
+{
+    const QString filePath = d->optionPool.junitReportOption()->filePath();
+    return filePath.isEmpty() ? filePath : QFileInfo(filePath).absoluteFilePath();
+}
+
+QString CommandLineParser::jsonReportFilePath() const
+{
+    const QString filePath = d->optionPool.jsonReportOption()->filePath();
+    return filePath.isEmpty() ? filePath : QFileInfo(filePath).absoluteFilePath();
+}
+
 QStringList CommandLineParser::products() const
 {
     return d->optionPool.productsOption()->arguments();
@@ -385,8 +428,10 @@ QList<Command *> CommandLineParser::CommandLineParserPrivate::allCommands() cons
             commandPool.getCommand(InstallCommandType),
             commandPool.getCommand(DumpNodesTreeCommandType),
             commandPool.getCommand(ListProductsCommandType),
+            commandPool.getCommand(QueryCommandType),
             commandPool.getCommand(VersionCommandType),
             commandPool.getCommand(SessionCommandType),
+            commandPool.getCommand(TestCommandType),
             commandPool.getCommand(HelpCommandType)};
 }
 
@@ -461,9 +506,18 @@ void CommandLineParser::CommandLineParserPrivate::setupBuildOptions()
     buildOptions.setKeepGoing(optionPool.keepGoingOption()->enabled());
     buildOptions.setForceTimestampCheck(optionPool.forceTimestampCheckOption()->enabled());
     buildOptions.setForceOutputCheck(optionPool.forceOutputCheckOption()->enabled());
+    buildOptions.setParallelPrepareScripts(
+                optionPool.parallelPrepareScriptsOption()->enabled());
     const JobsOption * jobsOption = optionPool.jobsOption();
     buildOptions.setMaxJobCount(jobsOption->jobCount());
+    buildOptions.setMemoryBudget(optionPool.memoryBudgetOption()->memoryBudget());
+    buildOptions.setRemoteWorker(optionPool.remoteWorkerOption()->address());
+    buildOptions.setRemoteWorkerToken(
+                QString::fromLocal8Bit(qgetenv("QBS_REMOTE_WORKER_TOKEN")));
+    buildOptions.setProvideJobserver(optionPool.jobserverOption()->enabled());
     buildOptions.setLogElapsedTime(logTime);
+    buildOptions.setCollectProfilingData(
+                !optionPool.profileOutputOption()->filePath().isEmpty());
     buildOptions.setEchoMode(echoMode());
     buildOptions.setInstall(!optionPool.noInstallOption()->enabled());
     buildOptions.setRemoveExistingInstallation(optionPool.removeFirstoption()->enabled());
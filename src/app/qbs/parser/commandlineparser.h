@@ -78,9 +78,16 @@ public:
     bool waitLockBuildGraph() const;
     bool disableFallbackProvider() const;
     bool logTime() const;
+    QString profileOutputFilePath() const;
     bool withNonDefaultProducts() const;
     bool buildBeforeInstalling() const;
     QStringList runArgs() const;
+    QString queryType() const;
+    QString queryArgument() const;
+    int shardIndex() const;
+    int shardCount() const;
+    QString junitReportFilePath() const;
+    QString jsonReportFilePath() const;
     QStringList products() const;
     QStringList runEnvConfig() const;
     QList<QVariantMap> buildConfigurations() const;
@@ -98,6 +98,12 @@ qbs::Command *CommandPool::getCommand(CommandType type) const
         case SessionCommandType:
             command = new SessionCommand(m_optionPool);
             break;
+        case TestCommandType:
+            command = new TestCommand(m_optionPool);
+            break;
+        case QueryCommandType:
+            command = new QueryCommand(m_optionPool);
+            break;
         }
     }
     return command;
@@ -208,7 +208,8 @@ static QList<CommandLineOption::Type> resolveOptions()
             CommandLineOption::DryRunOptionType,
             CommandLineOption::ForceProbesOptionType,
             CommandLineOption::LogTimeOptionType,
-            CommandLineOption::DisableFallbackProviderType};
+            CommandLineOption::DisableFallbackProviderType,
+            CommandLineOption::ProfileOutputOptionType};
 }
 
 QList<CommandLineOption::Type> ResolveCommand::supportedOptions() const
@@ -277,8 +278,12 @@ static QList<CommandLineOption::Type> buildOptions()
             << CommandLineOption::ChangedFilesOptionType
             << CommandLineOption::ForceTimestampCheckOptionType
             << CommandLineOption::ForceOutputCheckOptionType
+            << CommandLineOption::ParallelPrepareScriptsOptionType
             << CommandLineOption::BuildNonDefaultOptionType
             << CommandLineOption::JobsOptionType
+            << CommandLineOption::JobserverOptionType
+            << CommandLineOption::MemoryBudgetOptionType
+            << CommandLineOption::RemoteWorkerOptionType
             << CommandLineOption::CommandEchoModeOptionType
             << CommandLineOption::NoInstallOptionType
             << CommandLineOption::RemoveFirstOptionType
@@ -315,10 +320,12 @@ QList<CommandLineOption::Type> CleanCommand::supportedOptions() const
 {
     return {CommandLineOption::BuildDirectoryOptionType,
             CommandLineOption::DryRunOptionType,
+            CommandLineOption::JobsOptionType,
             CommandLineOption::KeepGoingOptionType,
             CommandLineOption::LogTimeOptionType,
             CommandLineOption::ProductsOptionType,
             CommandLineOption::QuietOptionType,
+            CommandLineOption::RemoveProductDirectoriesOptionType,
             CommandLineOption::SettingsDirOptionType,
             CommandLineOption::ShowProgressOptionType,
             CommandLineOption::VerboseOptionType};
@@ -401,6 +408,38 @@ void RunCommand::parseNext(QStringList &input)
     input.clear();
 }
 
+QString TestCommand::shortDescription() const
+{
+    return Tr::tr("Run the autotests of a project.");
+}
+
+QString TestCommand::longDescription() const
+{
+    QString description = Tr::tr(
+                "qbs %1 [options] [config:<configuration-name>] [<property>:<value>] ...\n")
+            .arg(representation());
+    description += Tr::tr("Builds all AutotestRunner products of the project, which runs "
+                          "the test executables.\n"
+                          "Results of tests whose executables and run-time dependencies "
+                          "have not changed are taken from the previous run.\n");
+    description += Tr::tr("Use the '%1' option to select the AutotestRunner products.\n")
+            .arg(optionPool().productsOption()->longRepresentation());
+    return description += supportedOptionsDescription();
+}
+
+QString TestCommand::representation() const
+{
+    return QStringLiteral("test");
+}
+
+QList<CommandLineOption::Type> TestCommand::supportedOptions() const
+{
+    return QList<CommandLineOption::Type>() << buildOptions()
+                                            << CommandLineOption::ShardOptionType
+                                            << CommandLineOption::JUnitReportOptionType
+                                            << CommandLineOption::JsonReportOptionType;
+}
+
 QString ShellCommand::shortDescription() const
 {
     return Tr::tr("Open a shell with a product's environment.");
@@ -532,6 +571,71 @@ QList<CommandLineOption::Type> ListProductsCommand::supportedOptions() const
             CommandLineOption::BuildDirectoryOptionType};
 }
 
+QString QueryCommand::shortDescription() const
+{
+    return Tr::tr("Answers questions about the build graph.");
+}
+
+QString QueryCommand::longDescription() const
+{
+    QString description = Tr::tr("qbs %1 [options] [config:<configuration-name>] <query>\n")
+            .arg(representation());
+    description += Tr::tr("Prints the result of a query on an existing build graph, "
+                          "one file per line.\n");
+    description += Tr::tr("The following queries are supported:\n");
+    description += Tr::tr("  dependents <file>     the files that directly depend on <file>\n");
+    description += Tr::tr("  all-dependents <file> the files that directly or indirectly "
+                          "depend on <file>\n");
+    description += Tr::tr("  producer <file>       the inputs, outputs and commands of the "
+                          "rule that generates <file>\n");
+    description += Tr::tr("  tagged <tag>          the files tagged <tag>\n");
+    description += Tr::tr("  stale                 the generated files that the next build "
+                          "would update\n");
+    description += Tr::tr("Use the '%1' option to restrict the query to some products.\n")
+            .arg(optionPool().productsOption()->longRepresentation());
+    return description += supportedOptionsDescription();
+}
+
+QString QueryCommand::representation() const
+{
+    return QStringLiteral("query");
+}
+
+QList<CommandLineOption::Type> QueryCommand::supportedOptions() const
+{
+    return {CommandLineOption::BuildDirectoryOptionType,
+            CommandLineOption::LogLevelOptionType,
+            CommandLineOption::VerboseOptionType,
+            CommandLineOption::QuietOptionType,
+            CommandLineOption::ProductsOptionType};
+}
+
+void QueryCommand::parseNext(QStringList &input)
+{
+    QBS_CHECK(!input.empty());
+    const QString &arg = input.front();
+    if (arg.startsWith(QLatin1Char('-')) || arg.contains(QLatin1Char(':'))) {
+        Command::parseNext(input);
+        return;
+    }
+    if (!m_queryType.isEmpty())
+        throwError(Tr::tr("Only one query can be given."));
+    m_queryType = input.takeFirst();
+    if (m_queryType == QLatin1String("stale"))
+        return;
+    if (m_queryType != QLatin1String("dependents")
+            && m_queryType != QLatin1String("all-dependents")
+            && m_queryType != QLatin1String("producer")
+            && m_queryType != QLatin1String("tagged")) {
+        throwError(Tr::tr("Unknown query '%1'.").arg(m_queryType));
+    }
+
+    // The argument is taken verbatim, as file paths can contain colons.
+    if (input.empty())
+        throwError(Tr::tr("The query '%1' requires an argument.").arg(m_queryType));
+    m_queryArgument = input.takeFirst();
+}
+
 QString HelpCommand::shortDescription() const
 {
     return Tr::tr("Show general or command-specific help.");
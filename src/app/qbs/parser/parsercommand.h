@@ -164,6 +164,19 @@ private:
     QStringList m_targetParameters;
 };
 
+class TestCommand : public Command
+{
+public:
+    TestCommand(CommandLineOptionPool &optionPool) : Command(optionPool) {}
+
+private:
+    CommandType type() const override { return TestCommandType; }
+    QString shortDescription() const override;
+    QString longDescription() const override;
+    QString representation() const override;
+    QList<CommandLineOption::Type> supportedOptions() const override;
+};
+
 class ShellCommand : public Command
 {
 public:
@@ -230,6 +243,25 @@ private:
     QList<CommandLineOption::Type> supportedOptions() const override;
 };
 
+class QueryCommand : public Command
+{
+public:
+    QueryCommand(CommandLineOptionPool &optionPool) : Command(optionPool) {}
+    QString queryType() const { return m_queryType; }
+    QString queryArgument() const { return m_queryArgument; }
+
+private:
+    CommandType type() const override { return QueryCommandType; }
+    QString shortDescription() const override;
+    QString longDescription() const override;
+    QString representation() const override;
+    QList<CommandLineOption::Type> supportedOptions() const override;
+    void parseNext(QStringList &input) override;
+
+    QString m_queryType;
+    QString m_queryArgument;
+};
+
 class HelpCommand : public Command
 {
 public:
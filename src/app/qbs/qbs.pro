@@ -13,7 +13,8 @@ SOURCES += main.cpp \
     status.cpp \
     consoleprogressobserver.cpp \
     commandlinefrontend.cpp \
-    qbstool.cpp
+    qbstool.cpp \
+    testreport.cpp
 
 HEADERS += \
     ctrlchandler.h \
@@ -25,7 +26,8 @@ HEADERS += \
     status.h \
     consoleprogressobserver.h \
     commandlinefrontend.h \
-    qbstool.h
+    qbstool.h \
+    testreport.h
 
 include(../../library_dirname.pri)
 isEmpty(QBS_RELATIVE_LIBEXEC_PATH) {
@@ -135,6 +135,7 @@ private:
     void removeFiles(const QJsonObject &request);
     void getRunEnvironment(const QJsonObject &request);
     void getGeneratedFilesForSources(const QJsonObject &request);
+    void queryBuildGraph(const QJsonObject &request);
     void releaseProject();
     void cancelCurrentJob();
     void quitSession();
@@ -219,6 +220,8 @@ Session::Session()
             getRunEnvironment(packet);
         else if (type == QLatin1String("get-generated-files-for-sources"))
             getGeneratedFilesForSources(packet);
+        else if (type == QLatin1String("query-build-graph"))
+            queryBuildGraph(packet);
         else if (type == QLatin1String("release-project"))
             releaseProject();
         else if (type == QLatin1String("quit"))
@@ -592,6 +595,67 @@ void Session::getGeneratedFilesForSources(const QJsonObject &request)
     sendPacket(reply);
 }
 
+void Session::queryBuildGraph(const QJsonObject &request)
+{
+    const char * const replyType = "build-graph-query-result";
+    if (!checkNormalRequestPrerequisites(replyType))
+        return;
+    const QString query = request.value(QLatin1String("query")).toString();
+    const QString filePath = request.value(QLatin1String("file-path")).toString();
+    const QStringList productNames
+            = fromJson<QStringList>(request.value(StringConstants::productsKey()));
+    const QList<ProductData> products = getProductsByName(productNames);
+    if (products.size() != productNames.size()) {
+        sendErrorReply(replyType, tr("Invalid product list."));
+        return;
+    }
+    QJsonObject reply;
+    reply.insert(StringConstants::type(), QLatin1String(replyType));
+    ErrorInfo error;
+    if (query == QLatin1String("dependents") || query == QLatin1String("all-dependents")) {
+        const QStringList files = m_project.dependentFiles(
+                    filePath, query == QLatin1String("all-dependents"), products, &error);
+        reply.insert(QLatin1String("files"), QJsonArray::fromStringList(files));
+    } else if (query == QLatin1String("producer")) {
+        const TransformerData transformer = m_project.producingTransformer(filePath, &error);
+        QJsonArray inputs;
+        for (const ArtifactData &input : transformer.inputs())
+            inputs << input.filePath();
+        QJsonArray outputs;
+        for (const ArtifactData &output : transformer.outputs())
+            outputs << output.filePath();
+        QJsonArray commands;
+        for (const RuleCommand &command : transformer.commands()) {
+            QJsonObject commandObject;
+            commandObject.insert(QLatin1String("description"), command.description());
+            if (command.type() == RuleCommand::ProcessCommandType) {
+                commandObject.insert(QLatin1String("executable"), command.executable());
+                commandObject.insert(QLatin1String("arguments"),
+                                     QJsonArray::fromStringList(command.arguments()));
+            }
+            commands << commandObject;
+        }
+        reply.insert(QLatin1String("inputs"), inputs);
+        reply.insert(QLatin1String("outputs"), outputs);
+        reply.insert(QLatin1String("commands"), commands);
+    } else if (query == QLatin1String("tagged")) {
+        const QStringList files = m_project.filesWithTag(
+                    request.value(QLatin1String("file-tag")).toString(), products, &error);
+        reply.insert(QLatin1String("files"), QJsonArray::fromStringList(files));
+    } else if (query == QLatin1String("stale")) {
+        reply.insert(QLatin1String("files"),
+                     QJsonArray::fromStringList(m_project.staleFiles(products, &error)));
+    } else {
+        sendErrorReply(replyType, tr("Unknown query '%1'.").arg(query));
+        return;
+    }
+    if (error.hasError()) {
+        sendErrorReply(replyType, error);
+        return;
+    }
+    sendPacket(reply);
+}
+
 void Session::releaseProject()
 {
     const char * const replyType = "project-released";
@@ -0,0 +1,295 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#include "testreport.h"
+
+#include <api/projectdata.h>
+#include <logging/translator.h>
+#include <tools/error.h>
+
+#include <QtCore/qdatetime.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qjsonarray.h>
+#include <QtCore/qjsondocument.h>
+#include <QtCore/qjsonobject.h>
+#include <QtCore/qxmlstream.h>
+
+#include <algorithm>
+
+namespace qbs {
+using namespace Internal;
+
+static QString resultFileTag() { return QStringLiteral("autotest-result"); }
+
+void TestReport::addProcessResult(const ProcessResult &result)
+{
+    m_processResults.emplace_back(result, QDateTime::currentMSecsSinceEpoch());
+}
+
+void TestReport::selectTests(const QStringList &testNames)
+{
+    m_selectedTests = testNames;
+    m_hasTestSelection = true;
+}
+
+void TestReport::collectResults(const QList<ProductData> &runners, bool buildSucceeded)
+{
+    m_results.clear();
+    for (const ProductData &runner : runners) {
+        for (const ArtifactData &artifact : runner.generatedArtifacts()) {
+            if (!artifact.fileTags().contains(resultFileTag()))
+                continue;
+            TestResult result = collectResult(artifact.filePath(), runner.name(), buildSucceeded);
+            if (!m_hasTestSelection || m_selectedTests.contains(result.name))
+                m_results.push_back(std::move(result));
+        }
+    }
+    std::sort(m_results.begin(), m_results.end(), [](const TestResult &r1, const TestResult &r2) {
+        return std::make_pair(r1.runner, r1.name) < std::make_pair(r2.runner, r2.name);
+    });
+}
+
+TestReport::TestResult TestReport::collectResult(const QString &resultFilePath,
+                                                 const QString &runnerName,
+                                                 bool buildSucceeded) const
+{
+    TestResult result;
+    result.runner = runnerName;
+
+    // The file name is "<test product name>.<hash>.json".
+    const QString baseName = QFileInfo(resultFilePath).completeBaseName();
+    result.name = baseName.left(baseName.lastIndexOf(QLatin1Char('.')));
+
+    QFile resultFile(resultFilePath);
+    if (!resultFile.open(QIODevice::ReadOnly))
+        return result;
+    const QJsonObject record = QJsonDocument::fromJson(resultFile.readAll()).object();
+    result.name = record.value(QStringLiteral("test")).toString(result.name);
+    result.executable = record.value(QStringLiteral("executable")).toString();
+    const QString program = record.value(QStringLiteral("program")).toString();
+    const QJsonArray arguments = record.value(QStringLiteral("arguments")).toArray();
+    for (const QJsonValue &argument : arguments)
+        result.arguments.push_back(argument.toString());
+    const qint64 startTime = qint64(record.value(QStringLiteral("startTime")).toDouble());
+
+    // Tests that were run in this build.
+    if (const auto processResult = findProcessResult(program, result.arguments)) {
+        result.status = processResult->first.success() ? Status::Passed : Status::Failed;
+        result.crashed = processResult->first.error() != QProcess::UnknownError;
+        result.hasExitCode = !result.crashed;
+        result.exitCode = processResult->first.exitCode();
+        if (startTime > 0)
+            result.durationMs = processResult->second - startTime;
+        result.stdOut = processResult->first.stdOut();
+        result.stdErr = processResult->first.stdErr();
+        return result;
+    }
+
+    // Tests whose result from an earlier build is still valid. If the build failed, we cannot
+    // tell whether the test was skipped because it was up to date, so we additionally check
+    // that the executable has not changed since the test passed.
+    if (record.value(QStringLiteral("status")).toString() != QLatin1String("passed"))
+        return result;
+    const qint64 finishTime = qint64(record.value(QStringLiteral("finishTime")).toDouble());
+    if (!buildSucceeded && QFileInfo(result.executable).lastModified()
+            .toMSecsSinceEpoch() > finishTime) {
+        return result;
+    }
+    result.status = Status::Passed;
+    result.cached = true;
+    if (startTime > 0)
+        result.durationMs = finishTime - startTime;
+    return result;
+}
+
+const std::pair<ProcessResult, qint64> *TestReport::findProcessResult(
+        const QString &program, const QStringList &arguments) const
+{
+    if (program.isEmpty())
+        return nullptr;
+    const QString programFileName = QFileInfo(program).fileName();
+
+    // The last result wins, as a test can only be run once per build.
+    for (auto it = m_processResults.crbegin(); it != m_processResults.crend(); ++it) {
+        const ProcessResult &result = it->first;
+        if (result.arguments() != arguments)
+            continue;
+        if (result.executableFilePath() == program
+                || QFileInfo(result.executableFilePath()).fileName() == programFileName) {
+            return &*it;
+        }
+    }
+    return nullptr;
+}
+
+int TestReport::count(Status status) const
+{
+    return int(std::count_if(m_results.cbegin(), m_results.cend(),
+                             [status](const TestResult &r) { return r.status == status; }));
+}
+
+QString TestReport::statusString(Status status)
+{
+    switch (status) {
+    case Status::Passed:
+        return QStringLiteral("passed");
+    case Status::Failed:
+        return QStringLiteral("failed");
+    case Status::NotRun:
+        break;
+    }
+    return QStringLiteral("not-run");
+}
+
+QString TestReport::summary() const
+{
+    const int cachedCount = int(std::count_if(m_results.cbegin(), m_results.cend(),
+                                              [](const TestResult &r) { return r.cached; }));
+    return Tr::tr("Tests: %1 passed (%2 cached), %3 failed, %4 not run.")
+            .arg(count(Status::Passed)).arg(cachedCount).arg(count(Status::Failed))
+            .arg(count(Status::NotRun));
+}
+
+static void openReportFile(QFile &file)
+{
+    if (!file.open(QIODevice::WriteOnly)) {
+        throw ErrorInfo(Tr::tr("Cannot open test report file '%1' for writing: %2")
+                        .arg(QDir::toNativeSeparators(file.fileName()), file.errorString()));
+    }
+}
+
+void TestReport::writeJson(const QString &filePath) const
+{
+    QJsonArray tests;
+    for (const TestResult &result : m_results) {
+        QJsonObject test;
+        test.insert(QStringLiteral("name"), result.name);
+        test.insert(QStringLiteral("runner"), result.runner);
+        test.insert(QStringLiteral("executable"), result.executable);
+        test.insert(QStringLiteral("arguments"), QJsonArray::fromStringList(result.arguments));
+        test.insert(QStringLiteral("status"), statusString(result.status));
+        test.insert(QStringLiteral("cached"), result.cached);
+        if (result.hasExitCode)
+            test.insert(QStringLiteral("exit-code"), result.exitCode);
+        if (result.durationMs >= 0)
+            test.insert(QStringLiteral("duration-ms"), result.durationMs);
+        if (!result.stdOut.empty())
+            test.insert(QStringLiteral("stdout"), QJsonArray::fromStringList(result.stdOut));
+        if (!result.stdErr.empty())
+            test.insert(QStringLiteral("stderr"), QJsonArray::fromStringList(result.stdErr));
+        tests.append(test);
+    }
+    QJsonObject report;
+    report.insert(QStringLiteral("tests"), tests);
+    report.insert(QStringLiteral("passed"), count(Status::Passed));
+    report.insert(QStringLiteral("failed"), count(Status::Failed));
+    report.insert(QStringLiteral("not-run"), count(Status::NotRun));
+
+    QFile file(filePath);
+    openReportFile(file);
+    file.write(QJsonDocument(report).toJson());
+}
+
+void TestReport::writeJUnit(const QString &filePath) const
+{
+    QFile file(filePath);
+    openReportFile(file);
+    QXmlStreamWriter xml(&file);
+    xml.setAutoFormatting(true);
+    xml.writeStartDocument();
+    xml.writeStartElement(QStringLiteral("testsuites"));
+    for (auto suiteBegin = m_results.cbegin(); suiteBegin != m_results.cend();) {
+        const auto suiteEnd = std::find_if(suiteBegin, m_results.cend(),
+                [suiteBegin](const TestResult &r) { return r.runner != suiteBegin->runner; });
+        qint64 suiteDurationMs = 0;
+        int failures = 0;
+        int skipped = 0;
+        for (auto it = suiteBegin; it != suiteEnd; ++it) {
+            suiteDurationMs += std::max<qint64>(it->durationMs, 0);
+            if (it->status == Status::Failed)
+                ++failures;
+            else if (it->status == Status::NotRun)
+                ++skipped;
+        }
+        xml.writeStartElement(QStringLiteral("testsuite"));
+        xml.writeAttribute(QStringLiteral("name"), suiteBegin->runner);
+        xml.writeAttribute(QStringLiteral("tests"), QString::number(suiteEnd - suiteBegin));
+        xml.writeAttribute(QStringLiteral("failures"), QString::number(failures));
+        xml.writeAttribute(QStringLiteral("errors"), QStringLiteral("0"));
+        xml.writeAttribute(QStringLiteral("skipped"), QString::number(skipped));
+        xml.writeAttribute(QStringLiteral("time"), QString::number(suiteDurationMs / 1000.0));
+        for (auto it = suiteBegin; it != suiteEnd; ++it) {
+            xml.writeStartElement(QStringLiteral("testcase"));
+            xml.writeAttribute(QStringLiteral("name"), it->name);
+            xml.writeAttribute(QStringLiteral("classname"), it->runner);
+            xml.writeAttribute(QStringLiteral("time"),
+                               QString::number(std::max<qint64>(it->durationMs, 0) / 1000.0));
+            switch (it->status) {
+            case Status::Passed:
+                break;
+            case Status::Failed:
+                xml.writeStartElement(QStringLiteral("failure"));
+                xml.writeAttribute(QStringLiteral("message"), it->crashed
+                                   ? Tr::tr("The test crashed or was terminated.")
+                                   : Tr::tr("The test exited with code %1.").arg(it->exitCode));
+                xml.writeEndElement();
+                break;
+            case Status::NotRun:
+                xml.writeEmptyElement(QStringLiteral("skipped"));
+                break;
+            }
+            if (!it->stdOut.empty()) {
+                xml.writeTextElement(QStringLiteral("system-out"),
+                                     it->stdOut.join(QLatin1Char('\n')));
+            }
+            if (!it->stdErr.empty()) {
+                xml.writeTextElement(QStringLiteral("system-err"),
+                                     it->stdErr.join(QLatin1Char('\n')));
+            }
+            xml.writeEndElement();
+        }
+        xml.writeEndElement();
+        suiteBegin = suiteEnd;
+    }
+    xml.writeEndElement();
+    xml.writeEndDocument();
+}
+
+} // namespace qbs
@@ -0,0 +1,103 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#ifndef QBS_TESTREPORT_H
+#define QBS_TESTREPORT_H
+
+#include <tools/processresult.h>
+
+#include <QtCore/qlist.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
+
+#include <utility>
+#include <vector>
+
+namespace qbs {
+class ProductData;
+
+// Assembles the outcome of a "qbs test" run from the result files written by the
+// AutotestRunner rule and the results of the test processes that were run in this build.
+class TestReport
+{
+public:
+    void addProcessResult(const ProcessResult &result);
+
+    // If called, only the results of the given tests are reported, e.g. those of one shard.
+    void selectTests(const QStringList &testNames);
+    void collectResults(const QList<ProductData> &runners, bool buildSucceeded);
+
+    QString summary() const;
+    void writeJson(const QString &filePath) const;
+    void writeJUnit(const QString &filePath) const;
+
+private:
+    enum class Status { Passed, Failed, NotRun };
+
+    struct TestResult
+    {
+        QString name;
+        QString runner;
+        QString executable;
+        QStringList arguments;
+        Status status = Status::NotRun;
+        bool cached = false;
+        bool hasExitCode = false;
+        int exitCode = 0;
+        bool crashed = false;
+        qint64 durationMs = -1;
+        QStringList stdOut;
+        QStringList stdErr;
+    };
+
+    TestResult collectResult(const QString &resultFilePath, const QString &runnerName,
+                             bool buildSucceeded) const;
+    const std::pair<ProcessResult, qint64> *findProcessResult(
+            const QString &program, const QStringList &arguments) const;
+    int count(Status status) const;
+    static QString statusString(Status status);
+
+    std::vector<std::pair<ProcessResult, qint64>> m_processResults;
+    std::vector<TestResult> m_results;
+    QStringList m_selectedTests;
+    bool m_hasTestSelection = false;
+};
+
+} // namespace qbs
+
+#endif // QBS_TESTREPORT_H
@@ -153,11 +153,22 @@ void InternalJob::shareObserverWith(InternalJob *otherJob)
     m_observer = otherJob->m_observer;
 }
 
+void InternalJob::setCollectProfilingData(bool collect, const QString &activity)
+{
+    if (!collect) {
+        m_profiler.reset();
+        return;
+    }
+    m_profiler = std::make_unique<Profiler>();
+    m_profiler->setAttribute(QStringLiteral("activity"), activity);
+}
+
 void InternalJob::storeBuildGraph(const TopLevelProjectPtr &project)
 {
     try {
         doSanityChecks(project, logger());
         TimedActivityLogger storeTimer(m_logger, Tr::tr("Storing build graph"), timed());
+        ProfilingScope storeScope("build-graph-storing");
         project->store(logger());
     } catch (const ErrorInfo &error) {
         ErrorInfo fullError = this->error();
@@ -232,6 +243,7 @@ void InternalSetupProjectJob::init(const TopLevelProjectPtr &existingProject,
     m_existingProject = existingProject;
     m_parameters = parameters;
     setTimed(parameters.logElapsedTime());
+    setCollectProfilingData(parameters.collectProfilingData(), QStringLiteral("resolve"));
 }
 
 void InternalSetupProjectJob::reportError(const ErrorInfo &error)
@@ -247,6 +259,7 @@ TopLevelProjectPtr InternalSetupProjectJob::project() const
 
 void InternalSetupProjectJob::start()
 {
+    const Profiler::Activation profilerActivation(profiler());
     BuildGraphLocker *bgLocker = m_existingProject ? m_existingProject->bgLocker : nullptr;
     bool deleteLocker = false;
     try {
@@ -255,16 +268,25 @@ void InternalSetupProjectJob::start()
             throw err;
         const QString projectId = TopLevelProject::deriveId(
                     m_parameters.finalBuildConfigurationTree());
+        if (profiler())
+            profiler()->setAttribute(QStringLiteral("configuration"), projectId);
         const QString buildDir
                 = TopLevelProject::deriveBuildDirectory(m_parameters.buildRoot(), projectId);
         if (m_existingProject && m_existingProject->buildDirectory != buildDir)
             m_existingProject.reset();
         if (!m_existingProject) {
+            // Unless we know that the build graph will be written, we start out as a reader,
+            // so that we do not have to wait for a build running in another process.
+            const bool mustWrite = m_parameters.waitLockBuildGraph()
+                    || m_parameters.restoreBehavior() == SetupProjectParameters::ResolveOnly;
             bgLocker = new BuildGraphLocker(ProjectBuildData::deriveBuildGraphFilePath(buildDir,
                                                                                        projectId),
-                                           logger(), m_parameters.waitLockBuildGraph(), observer());
+                                           logger(), m_parameters.waitLockBuildGraph(), observer(),
+                                           mustWrite ? BuildGraphLocker::LockMode::Write
+                                                     : BuildGraphLocker::LockMode::Read);
             deleteLocker = true;
         }
+        m_bgLocker = bgLocker;
         execute();
         if (m_existingProject) {
             if (m_existingProject != m_newProject)
@@ -272,9 +294,11 @@ void InternalSetupProjectJob::start()
             m_existingProject->bgLocker = nullptr;
         }
         m_newProject->bgLocker = bgLocker;
+        m_bgLocker = nullptr;
         deleteLocker = false;
     } catch (const ErrorInfo &error) {
         m_newProject.reset();
+        m_bgLocker = nullptr;
         setError(error);
 
         // Delete the build graph locker if and only if we allocated it here.
@@ -303,6 +327,8 @@ void InternalSetupProjectJob::execute()
         if (!m_newProject)
             m_newProject = loadResult.loadedProject;
         if (!m_newProject) {
+            if (m_bgLocker)
+                m_bgLocker->lockForWriting();
             resolveProjectFromScratch(evalContext->engine());
             resolveBuildDataFromScratch(evalContext);
         } else {
@@ -321,6 +347,7 @@ void InternalSetupProjectJob::execute()
 
 void InternalSetupProjectJob::resolveProjectFromScratch(ScriptEngine *engine)
 {
+    ProfilingScope resolveScope("project-resolving");
     Loader loader(engine, logger());
     loader.setSearchPaths(m_parameters.searchPaths());
     loader.setProgressObserver(observer());
@@ -331,12 +358,15 @@ void InternalSetupProjectJob::resolveProjectFromScratch(ScriptEngine *engine)
 void InternalSetupProjectJob::resolveBuildDataFromScratch(const RulesEvaluationContextPtr &evalContext)
 {
     TimedActivityLogger resolveLogger(logger(), QStringLiteral("Resolving build project"), timed());
+    ProfilingScope resolveScope("build-data-resolving");
     BuildDataResolver(logger()).resolveBuildData(m_newProject, evalContext);
 }
 
 BuildGraphLoadResult InternalSetupProjectJob::restoreProject(const RulesEvaluationContextPtr &evalContext)
 {
+    ProfilingScope restoreScope("project-restoring");
     BuildGraphLoader bgLoader(logger());
+    bgLoader.setBuildGraphLocker(m_bgLocker);
     const BuildGraphLoadResult loadResult
             = bgLoader.load(m_existingProject, m_parameters, evalContext);
     return loadResult;
@@ -373,12 +403,16 @@ void InternalBuildJob::build(const TopLevelProjectPtr &project,
 {
     setup(project, products, buildOptions.dryRun());
     setTimed(buildOptions.logElapsedTime());
+    setCollectProfilingData(buildOptions.collectProfilingData(), QStringLiteral("build"));
+    if (profiler())
+        profiler()->setAttribute(QStringLiteral("configuration"), project->id());
 
     m_executor = new Executor(logger());
     m_executor->setProject(project);
     m_executor->setProducts(products);
     m_executor->setBuildOptions(buildOptions);
     m_executor->setProgressObserver(observer());
+    m_executor->setProfiler(profiler());
 
     const auto executorThread = new QThread(this);
     m_executor->moveToThread(executorThread);
@@ -396,6 +430,7 @@ void InternalBuildJob::build(const TopLevelProjectPtr &project,
 
 void InternalBuildJob::handleFinished()
 {
+    const Profiler::Activation profilerActivation(profiler());
     setError(m_executor->error());
     project()->buildData->evaluationContext.reset();
     storeBuildGraph();
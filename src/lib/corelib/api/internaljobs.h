@@ -52,6 +52,8 @@
 #include <QtCore/qobject.h>
 #include <QtCore/qthread.h>
 
+#include <memory>
+
 namespace qbs {
 class ProcessResult;
 class Settings;
@@ -61,6 +63,7 @@ class BuildGraphLoadResult;
 class BuildGraphLocker;
 class Executor;
 class JobObserver;
+class Profiler;
 class ScriptEngine;
 
 class InternalJob : public QObject
@@ -77,6 +80,7 @@ public:
 
     Logger logger() const { return m_logger; }
     bool timed() const { return m_timed; }
+    Profiler *profiler() const { return m_profiler.get(); }
     void shareObserverWith(InternalJob *otherJob);
 
 protected:
@@ -84,6 +88,7 @@ protected:
 
     JobObserver *observer() const { return m_observer; }
     void setTimed(bool timed) { m_timed = timed; }
+    void setCollectProfilingData(bool collect, const QString &activity);
     void storeBuildGraph(const TopLevelProjectPtr &project);
 
 signals:
@@ -98,6 +103,7 @@ private:
     bool m_ownsObserver;
     Logger m_logger;
     bool m_timed;
+    std::unique_ptr<Profiler> m_profiler;
 };
 
 
@@ -144,6 +150,7 @@ private:
     TopLevelProjectPtr m_existingProject;
     TopLevelProjectPtr m_newProject;
     SetupProjectParameters m_parameters;
+    BuildGraphLocker *m_bgLocker = nullptr;
 };
 
 
@@ -41,7 +41,9 @@
 #include "internaljobs.h"
 #include "project_p.h"
 #include <language/language.h>
+#include <tools/buildgraphlocker.h>
 #include <tools/launcherinterface.h>
+#include <tools/profiling.h>
 #include <tools/qbsassert.h>
 
 #include <QtCore/qloggingcategory.h>
@@ -127,7 +129,7 @@ AbstractJob::AbstractJob(InternalJob *internalJob, QObject *parent)
     m_state = StateRunning;
 }
 
-bool AbstractJob::lockProject(const TopLevelProjectPtr &project)
+bool AbstractJob::lockProject(const TopLevelProjectPtr &project, bool forWriting)
 {
     // The API is not thread-safe, so we don't need a mutex here, as the API requests come in
     // synchronously.
@@ -136,7 +138,17 @@ bool AbstractJob::lockProject(const TopLevelProjectPtr &project)
         QTimer::singleShot(0, this, [this] { emit finished(false, this); });
         return false;
     }
+    if (forWriting && project->bgLocker) {
+        try {
+            project->bgLocker->lockForWriting();
+        } catch (const ErrorInfo &error) {
+            internalJob()->setError(error);
+            QTimer::singleShot(0, this, [this] { emit finished(false, this); });
+            return false;
+        }
+    }
     project->locked = true;
+    ++project->lockGeneration;
     m_project = project;
     return true;
 }
@@ -147,6 +159,7 @@ void AbstractJob::unlockProject()
         return;
     QBS_ASSERT(m_project->locked, return);
     m_project->locked = false;
+    ++m_project->lockGeneration;
 }
 
 /*!
@@ -168,6 +181,23 @@ ErrorInfo AbstractJob::error() const
     return internalJob()->error();
 }
 
+/*!
+ * \brief Returns the hierarchical profiling data collected by this job.
+ * The data is only available if collecting it was requested via
+ * \c SetupProjectParameters::setCollectProfilingData() or
+ * \c BuildOptions::setCollectProfilingData() and the job has finished. Otherwise, an
+ * empty object is returned.
+ */
+QJsonObject AbstractJob::profilingData() const
+{
+    const InternalJob *job = internalJob();
+    if (const auto wrapper = qobject_cast<const InternalJobThreadWrapper *>(job))
+        job = wrapper->synchronousJob();
+    if (m_state != StateFinished || !job->profiler())
+        return {};
+    return job->profiler()->toJson();
+}
+
 /*!
  * \brief Cancels this job.
  * Note that the job might not finish immediately. If you need to make sure it has actually
@@ -312,7 +342,7 @@ BuildJob::BuildJob(const Logger &logger, QObject *parent)
 void BuildJob::build(const TopLevelProjectPtr &project, const QVector<ResolvedProductPtr> &products,
                      const BuildOptions &options)
 {
-    if (!lockProject(project))
+    if (!lockProject(project, !options.dryRun()))
         return;
     LauncherInterface::startLauncher();
     qobject_cast<InternalBuildJob *>(internalJob())->build(project, products, options);
@@ -343,7 +373,7 @@ CleanJob::CleanJob(const Logger &logger, QObject *parent)
 void CleanJob::clean(const TopLevelProjectPtr &project, const QVector<ResolvedProductPtr> &products,
                      const qbs::CleanOptions &options)
 {
-    if (!lockProject(project))
+    if (!lockProject(project, !options.dryRun()))
         return;
     auto wrapper = qobject_cast<InternalJobThreadWrapper *>(internalJob());
     qobject_cast<InternalCleanJob *>(wrapper->synchronousJob())->init(project, products, options);
@@ -364,7 +394,7 @@ void InstallJob::install(const TopLevelProjectPtr &project,
                          const QVector<ResolvedProductPtr> &products,
                          const InstallOptions &options)
 {
-    if (!lockProject(project))
+    if (!lockProject(project, !options.dryRun()))
         return;
     auto wrapper = qobject_cast<InternalJobThreadWrapper *>(internalJob());
     auto installJob = qobject_cast<InternalInstallJob *>(wrapper->synchronousJob());
@@ -44,6 +44,7 @@
 #include "../tools/error.h"
 #include "../tools/qbs_export.h"
 
+#include <QtCore/qjsonobject.h>
 #include <QtCore/qobject.h>
 #include <QtCore/qprocess.h>
 #include <QtCore/qvariant.h>
@@ -72,6 +73,7 @@ public:
     State state() const { return m_state; }
 
     ErrorInfo error() const;
+    QJsonObject profilingData() const;
 
 public slots:
     void cancel();
@@ -80,7 +82,7 @@ protected:
     AbstractJob(Internal::InternalJob *internalJob, QObject *parent);
     Internal::InternalJob *internalJob() const { return m_internalJob; }
 
-    bool lockProject(const Internal::TopLevelProjectPtr &project);
+    bool lockProject(const Internal::TopLevelProjectPtr &project, bool forWriting = false);
     void setError(const ErrorInfo &error) { m_error = error; }
 
 signals:
@@ -53,6 +53,7 @@
 #include <buildgraph/artifact.h>
 #include <buildgraph/buildgraph.h>
 #include <buildgraph/buildgraphloader.h>
+#include <buildgraph/buildgraphquery.h>
 #include <buildgraph/emptydirectoriesremover.h>
 #include <buildgraph/nodetreedumper.h>
 #include <buildgraph/productbuilddata.h>
@@ -125,9 +126,17 @@ static void loadPlugins(const QStringList &_pluginPaths, const Logger &logger)
 
 ProjectData ProjectPrivate::projectData()
 {
-    m_projectData = ProjectData();
-    retrieveProjectData(m_projectData, internalProject);
-    m_projectData.d->buildDir = internalProject->buildDirectory;
+    // Clients such as the session compare consecutive results, which is free
+    // if we return the same object when no job has run in the meantime.
+    // Data retrieved while a job is running is never reused.
+    if (!m_projectData.isValid() || internalProject->locked
+            || m_projectDataGeneration != internalProject->lockGeneration) {
+        m_projectData = ProjectData();
+        retrieveProjectData(m_projectData, internalProject,
+                            effectiveInstallRoot(InstallOptions(), internalProject.get()));
+        m_projectData.d->buildDir = internalProject->buildDirectory;
+        m_projectDataGeneration = internalProject->lockGeneration;
+    }
     return m_projectData;
 }
 
@@ -263,8 +272,8 @@ GroupData ProjectPrivate::findGroupData(const ProductData &product, const QStrin
     return {};
 }
 
-GroupData ProjectPrivate::createGroupDataFromGroup(const GroupPtr &resolvedGroup,
-                                                   const ResolvedProductConstPtr &product)
+GroupData ProjectPrivate::createGroupDataFromGroup(const GroupConstPtr &resolvedGroup,
+                                                   const ProductDataPrivate &product)
 {
     GroupData group;
     group.d->name = resolvedGroup->name;
@@ -304,22 +313,33 @@ ArtifactData ProjectPrivate::createApiSourceArtifact(const SourceArtifactConstPt
     return saApi;
 }
 
-ArtifactData ProjectPrivate::createArtifactData(const Artifact *artifact,
-        const ResolvedProductConstPtr &product, const ArtifactSet &targetArtifacts)
+ArtifactSnapshot ProjectPrivate::createArtifactSnapshot(const Artifact *artifact,
+                                                        const ArtifactSet &targetArtifacts)
+{
+    ArtifactSnapshot snapshot;
+    snapshot.filePath = artifact->filePath();
+    snapshot.fileTags = artifact->fileTags();
+    snapshot.properties = artifact->properties;
+    snapshot.isGenerated = artifact->artifactType == Artifact::Generated;
+    snapshot.isTargetArtifact = targetArtifacts.contains(const_cast<Artifact *>(artifact));
+    return snapshot;
+}
+
+ArtifactData ProjectPrivate::createArtifactData(const ArtifactSnapshot &artifact,
+                                                const ProductDataPrivate &product)
 {
     ArtifactData ta;
-    ta.d->filePath = artifact->filePath();
-    ta.d->fileTags = artifact->fileTags().toStringList();
-    ta.d->properties.d->m_map = artifact->properties;
-    ta.d->isGenerated = artifact->artifactType == Artifact::Generated;
-    ta.d->isTargetArtifact = targetArtifacts.contains(const_cast<Artifact *>(artifact));
+    ta.d->filePath = artifact.filePath;
+    ta.d->fileTags = artifact.fileTags.toStringList();
+    ta.d->properties.d->m_map = artifact.properties;
+    ta.d->isGenerated = artifact.isGenerated;
+    ta.d->isTargetArtifact = artifact.isTargetArtifact;
     ta.d->isValid = true;
     setupInstallData(ta, product);
     return ta;
 }
 
-void ProjectPrivate::setupInstallData(ArtifactData &artifact,
-                                      const ResolvedProductConstPtr &product)
+void ProjectPrivate::setupInstallData(ArtifactData &artifact, const ProductDataPrivate &product)
 {
     artifact.d->installData.d->isValid = true;
     artifact.d->installData.d->isInstallable = artifact.properties().getModuleProperty(
@@ -329,17 +349,17 @@ void ProjectPrivate::setupInstallData(ArtifactData &artifact,
     const QString installRoot = artifact.properties().getModuleProperty(
                 StringConstants::qbsModule(), StringConstants::installRootProperty()).toString();
     InstallOptions options;
-    options.setInstallRoot(installRoot);
+    options.setInstallRoot(installRoot.isEmpty() ? product.projectInstallRoot : installRoot);
     artifact.d->installData.d->installRoot = installRoot;
     try {
-        QString installFilePath = ProductInstaller::targetFilePath(product->topLevelProject(),
-                product->sourceDirectory, artifact.filePath(), artifact.properties().d->m_map,
+        QString installFilePath = ProductInstaller::targetFilePath(nullptr,
+                product.sourceDirectory, artifact.filePath(), artifact.properties().d->m_map,
                 options);
         if (!installRoot.isEmpty())
             installFilePath.remove(0, installRoot.size());
         artifact.d->installData.d->installFilePath = installFilePath;
     } catch (const ErrorInfo &e) {
-        logger.printWarning(e);
+        Logger(product.logger).printWarning(e);
     }
 }
 
@@ -526,8 +546,7 @@ void ProjectPrivate::prepareChangeToProject()
 {
     if (internalProject->locked)
         throw ErrorInfo(Tr::tr("A job is currently in progress."));
-    if (!m_projectData.isValid())
-        retrieveProjectData(m_projectData, internalProject);
+    projectData();
 }
 
 RuleCommandList ProjectPrivate::ruleCommandListForTransformer(const Transformer *transformer)
@@ -588,12 +607,36 @@ RuleCommandList ProjectPrivate::ruleCommands(const ProductData &product,
                            "from input file '%2'.").arg(outputFileTag, inputFilePath));
 }
 
+TransformerData ProjectPrivate::createTransformerData(const Transformer *transformer,
+                                                     const ResolvedProductConstPtr &product,
+                                                     const ProductData &productData,
+                                                     const ArtifactSet &targetArtifacts)
+{
+    TransformerData tData;
+    Set<const Artifact *> allInputs;
+    const auto createData = [&productData, &targetArtifacts](const Artifact *a) {
+        return createArtifactData(createArtifactSnapshot(a, targetArtifacts), *productData.d);
+    };
+    for (Artifact * const a : transformer->outputs) {
+        tData.d->outputs << createData(a);
+        for (const Artifact * const child : filterByType<Artifact>(a->children))
+            allInputs << child;
+        for (Artifact * const a
+             : RulesApplicator::collectAuxiliaryInputs(transformer->rule.get(), product.get())) {
+            if (a->artifactType == Artifact::Generated)
+                tData.d->inputs << createData(a);
+        }
+    }
+    for (const Artifact * const input : allInputs)
+        tData.d->inputs << createData(input);
+    tData.d->commands = ruleCommandListForTransformer(transformer);
+    return tData;
+}
+
 ProjectTransformerData ProjectPrivate::transformerData()
 {
-    if (!m_projectData.isValid())
-        retrieveProjectData(m_projectData, internalProject);
     ProjectTransformerData projectTransformerData;
-    for (const ProductData &productData : m_projectData.allProducts()) {
+    for (const ProductData &productData : projectData().allProducts()) {
         if (!productData.isEnabled())
             continue;
         const ResolvedProductConstPtr product = internalProduct(productData);
@@ -608,29 +651,73 @@ ProjectTransformerData ProjectPrivate::transformerData()
         if (allTransformers.empty())
             continue;
         ProductTransformerData productTransformerData;
-        for (const Transformer * const t : allTransformers) {
-            TransformerData tData;
-            Set<const Artifact *> allInputs;
-            for (Artifact * const a : t->outputs) {
-                tData.d->outputs << createArtifactData(a, product, targetArtifacts);
-                for (const Artifact * const child : filterByType<Artifact>(a->children))
-                    allInputs << child;
-                for (Artifact * const a
-                     : RulesApplicator::collectAuxiliaryInputs(t->rule.get(), product.get())) {
-                    if (a->artifactType == Artifact::Generated)
-                        tData.d->inputs << createArtifactData(a, product, targetArtifacts);
-                }
-            }
-            for (const Artifact * const input : allInputs)
-                tData.d->inputs << createArtifactData(input, product, targetArtifacts);
-            tData.d->commands = ruleCommandListForTransformer(t);
-            productTransformerData << tData;
-        }
+        for (const Transformer * const t : allTransformers)
+            productTransformerData << createTransformerData(t, product, productData,
+                                                            targetArtifacts);
         projectTransformerData << qMakePair(productData, productTransformerData);
     }
     return projectTransformerData;
 }
 
+BuildGraphQuery &ProjectPrivate::buildGraphQuery()
+{
+    if (internalProject->locked)
+        throw ErrorInfo(Tr::tr("A job is currently in progress."));
+    if (!m_buildGraphQuery || m_buildGraphQueryGeneration != internalProject->lockGeneration) {
+        m_buildGraphQuery = std::make_shared<BuildGraphQuery>(internalProject);
+        m_buildGraphQueryGeneration = internalProject->lockGeneration;
+    }
+    return *m_buildGraphQuery;
+}
+
+static QStringList filePaths(const std::vector<const Artifact *> &artifacts)
+{
+    QStringList paths;
+    for (const Artifact * const artifact : artifacts)
+        paths << artifact->filePath();
+    paths.sort();
+    paths.removeDuplicates();
+    return paths;
+}
+
+QStringList ProjectPrivate::dependentFiles(const QString &filePath, bool recursive,
+                                           const QList<ProductData> &products)
+{
+    BuildGraphQuery &query = buildGraphQuery();
+    return filePaths(query.dependents(QDir::cleanPath(filePath), recursive,
+                                      internalProducts(products)));
+}
+
+TransformerData ProjectPrivate::producingTransformer(const QString &filePath)
+{
+    const Artifact * const artifact
+            = buildGraphQuery().generatedArtifact(QDir::cleanPath(filePath));
+    if (!artifact || !artifact->transformer)
+        throw ErrorInfo(Tr::tr("File '%1' is not generated by any rule.").arg(filePath));
+    const ResolvedProductConstPtr product = artifact->product.lock();
+    for (const ProductData &productData : projectData().allProducts()) {
+        if (internalProduct(productData) == product) {
+            return createTransformerData(artifact->transformer.get(), product, productData,
+                                         product->targetArtifacts());
+        }
+    }
+    QBS_CHECK(false);
+    return {};
+}
+
+QStringList ProjectPrivate::filesWithTag(const QString &tag, const QList<ProductData> &products)
+{
+    BuildGraphQuery &query = buildGraphQuery();
+    return filePaths(query.artifactsWithFileTag(FileTag(tag.toLocal8Bit()),
+                                                internalProducts(products)));
+}
+
+QStringList ProjectPrivate::staleFiles(const QList<ProductData> &products)
+{
+    BuildGraphQuery &query = buildGraphQuery();
+    return filePaths(query.staleArtifacts(internalProducts(products)));
+}
+
 static bool productIsRunnable(const ResolvedProductConstPtr &product)
 {
     const bool isBundle = product->moduleProperties->moduleProperty(
@@ -647,7 +734,8 @@ static bool productIsMultiplexed(const ResolvedProductConstPtr &product)
 }
 
 void ProjectPrivate::retrieveProjectData(ProjectData &projectData,
-                                         const ResolvedProjectConstPtr &internalProject)
+                                         const ResolvedProjectConstPtr &internalProject,
+                                         const QString &installRoot)
 {
     projectData.d->name = internalProject->name;
     projectData.d->location = internalProject->location;
@@ -667,41 +755,41 @@ void ProjectPrivate::retrieveProjectData(ProjectData &projectData,
         product.d->isMultiplexed = productIsMultiplexed(resolvedProduct);
         product.d->properties = resolvedProduct->productProperties;
         product.d->moduleProperties.d->m_map = resolvedProduct->moduleProperties;
+        product.d->sourceDirectory = resolvedProduct->sourceDirectory;
+        product.d->projectInstallRoot = installRoot;
+        product.d->logger = logger;
         for (const GroupPtr &resolvedGroup : resolvedProduct->groups) {
             if (resolvedGroup->targetOfModule.isEmpty())
-                product.d->groups << createGroupDataFromGroup(resolvedGroup, resolvedProduct);
+                product.d->resolvedGroups.push_back(resolvedGroup);
         }
         if (resolvedProduct->enabled) {
             QBS_CHECK(resolvedProduct->buildData);
+            std::vector<ArtifactSnapshot> &snapshots = product.d->generatedArtifactSnapshots;
             const ArtifactSet targetArtifacts = resolvedProduct->targetArtifacts();
             for (Artifact * const a
                  : filterByType<Artifact>(resolvedProduct->buildData->allNodes())) {
-                if (a->artifactType != Artifact::Generated)
-                    continue;
-                product.d->generatedArtifacts << createArtifactData(a, resolvedProduct,
-                                                                    targetArtifacts);
+                if (a->artifactType == Artifact::Generated)
+                    snapshots.push_back(createArtifactSnapshot(a, targetArtifacts));
             }
             const AllRescuableArtifactData &rad
                     = resolvedProduct->buildData->rescuableArtifactData();
             for (auto it = rad.begin(); it != rad.end(); ++it) {
-                ArtifactData ta;
-                ta.d->filePath = it.key();
-                ta.d->fileTags = it.value().fileTags.toStringList();
-                ta.d->properties.d->m_map = it.value().properties;
-                ta.d->isGenerated = true;
-                ta.d->isTargetArtifact = resolvedProduct->fileTags.intersects(it.value().fileTags);
-                ta.d->isValid = true;
-                setupInstallData(ta, resolvedProduct);
-                product.d->generatedArtifacts << ta;
+                ArtifactSnapshot snapshot;
+                snapshot.filePath = it.key();
+                snapshot.fileTags = it.value().fileTags;
+                snapshot.properties = it.value().properties;
+                snapshot.isGenerated = true;
+                snapshot.isTargetArtifact = resolvedProduct->fileTags.intersects(
+                            it.value().fileTags);
+                snapshots.push_back(snapshot);
             }
+            std::sort(snapshots.begin(), snapshots.end());
         }
         for (const ResolvedProductPtr &resolvedDependentProduct
              : qAsConst(resolvedProduct->dependencies)) {
             product.d->dependencies << resolvedDependentProduct->fullDisplayName();
         }
         std::sort(product.d->type.begin(), product.d->type.end());
-        std::sort(product.d->groups.begin(), product.d->groups.end());
-        std::sort(product.d->generatedArtifacts.begin(), product.d->generatedArtifacts.end());
         product.d->isValid = true;
         projectData.d->products << product;
     }
@@ -709,7 +797,7 @@ void ProjectPrivate::retrieveProjectData(ProjectData &projectData,
         if (!internalSubProject->enabled)
             continue;
         ProjectData subProject;
-        retrieveProjectData(subProject, internalSubProject);
+        retrieveProjectData(subProject, internalSubProject, installRoot);
         projectData.d->subProjects << subProject;
     }
     projectData.d->isValid = true;
@@ -794,6 +882,10 @@ Project::Project() = default;
  * \brief Retrieves information for this project.
  * Call this function if you need insight into the project structure, e.g. because you want to know
  * which products or files are in it.
+ * The groups and generated artifacts of a product are only set up when they are first accessed,
+ * so this function is cheap even for large projects. The returned data still reflects the state
+ * of the project at the time of the call. If no job has run on the project since the last call,
+ * the same data is returned again, which makes comparing the results very cheap.
  */
 ProjectData Project::projectData() const
 {
@@ -993,6 +1085,75 @@ ProjectTransformerData Project::transformerData(ErrorInfo *error) const
     }
 }
 
+/*!
+ * \brief Returns the files that depend on \a filePath in the build graph.
+ * This includes dependencies found by scanners, e.g. the sources including a header.
+ * If \a recursive is \c true, the dependents are collected transitively.
+ * If \a products is empty, all enabled products are considered.
+ */
+QStringList Project::dependentFiles(const QString &filePath, bool recursive,
+                                    const QList<ProductData> &products, ErrorInfo *error) const
+{
+    QBS_ASSERT(isValid(), return {});
+    try {
+        return d->dependentFiles(filePath, recursive, products);
+    } catch (const ErrorInfo &e) {
+        if (error)
+            *error = e;
+        return {};
+    }
+}
+
+/*!
+ * \brief Returns the transformer that generates \a filePath.
+ */
+TransformerData Project::producingTransformer(const QString &filePath, ErrorInfo *error) const
+{
+    QBS_ASSERT(isValid(), return {});
+    try {
+        return d->producingTransformer(filePath);
+    } catch (const ErrorInfo &e) {
+        if (error)
+            *error = e;
+        return {};
+    }
+}
+
+/*!
+ * \brief Returns the files in \a products that are tagged \a tag.
+ * If \a products is empty, all enabled products are considered.
+ */
+QStringList Project::filesWithTag(const QString &tag, const QList<ProductData> &products,
+                                  ErrorInfo *error) const
+{
+    QBS_ASSERT(isValid(), return {});
+    try {
+        return d->filesWithTag(tag, products);
+    } catch (const ErrorInfo &e) {
+        if (error)
+            *error = e;
+        return {};
+    }
+}
+
+/*!
+ * \brief Returns the generated files in \a products that a build would update.
+ * The check is based on file timestamps only; changes to properties or rules that
+ * require re-resolving the project are not taken into account.
+ * If \a products is empty, all enabled products are considered.
+ */
+QStringList Project::staleFiles(const QList<ProductData> &products, ErrorInfo *error) const
+{
+    QBS_ASSERT(isValid(), return {});
+    try {
+        return d->staleFiles(products);
+    } catch (const ErrorInfo &e) {
+        if (error)
+            *error = e;
+        return {};
+    }
+}
+
 ErrorInfo Project::dumpNodesTree(QIODevice &outDevice, const QList<ProductData> &products)
 {
     try {
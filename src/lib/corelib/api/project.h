@@ -140,6 +140,15 @@ public:
                                  const QString &outputFileTag, ErrorInfo *error = nullptr) const;
     ProjectTransformerData transformerData(ErrorInfo *error = nullptr) const;
 
+    QStringList dependentFiles(const QString &filePath, bool recursive,
+                               const QList<ProductData> &products,
+                               ErrorInfo *error = nullptr) const;
+    TransformerData producingTransformer(const QString &filePath,
+                                         ErrorInfo *error = nullptr) const;
+    QStringList filesWithTag(const QString &tag, const QList<ProductData> &products,
+                             ErrorInfo *error = nullptr) const;
+    QStringList staleFiles(const QList<ProductData> &products, ErrorInfo *error = nullptr) const;
+
     ErrorInfo dumpNodesTree(QIODevice &outDevice, const QList<ProductData> &products);
 
 
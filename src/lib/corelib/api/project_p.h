@@ -40,6 +40,7 @@
 #define QBS_PROJECT_P_H
 
 #include "projectdata.h"
+#include "projectdata_p.h"
 #include "rulecommand.h"
 #include "transformerdata.h"
 
@@ -49,6 +50,8 @@
 #include <QtCore/qobject.h>
 #include <QtCore/qstringlist.h>
 
+#include <memory>
+
 namespace qbs {
 class BuildJob;
 class BuildOptions;
@@ -58,6 +61,7 @@ class InstallJob;
 class InstallOptions;
 
 namespace Internal {
+class BuildGraphQuery;
 
 class ProjectPrivate : public QSharedData
 {
@@ -83,13 +87,14 @@ public:
     QList<ProductData> findProductsByName(const QString &name) const;
     GroupData findGroupData(const ProductData &product, const QString &groupName) const;
 
-    GroupData createGroupDataFromGroup(const GroupPtr &resolvedGroup,
-                                       const ResolvedProductConstPtr &product);
-    ArtifactData createApiSourceArtifact(const SourceArtifactConstPtr &sa);
-    ArtifactData createArtifactData(const Artifact *artifact,
-                                    const ResolvedProductConstPtr &product,
-                                    const ArtifactSet &targetArtifacts);
-    void setupInstallData(ArtifactData &artifact, const ResolvedProductConstPtr &product);
+    static GroupData createGroupDataFromGroup(const GroupConstPtr &resolvedGroup,
+                                              const ProductDataPrivate &product);
+    static ArtifactData createApiSourceArtifact(const SourceArtifactConstPtr &sa);
+    static ArtifactSnapshot createArtifactSnapshot(const Artifact *artifact,
+                                                   const ArtifactSet &targetArtifacts);
+    static ArtifactData createArtifactData(const ArtifactSnapshot &artifact,
+                                           const ProductDataPrivate &product);
+    static void setupInstallData(ArtifactData &artifact, const ProductDataPrivate &product);
 
     struct GroupUpdateContext {
         QVector<ResolvedProductPtr> resolvedProducts;
@@ -122,14 +127,34 @@ public:
             const QString &inputFilePath, const QString &outputFileTag);
     ProjectTransformerData transformerData();
 
+    QStringList dependentFiles(const QString &filePath, bool recursive,
+                               const QList<ProductData> &products);
+    TransformerData producingTransformer(const QString &filePath);
+    QStringList filesWithTag(const QString &tag, const QList<ProductData> &products);
+    QStringList staleFiles(const QList<ProductData> &products);
+
     TopLevelProjectPtr internalProject;
     Logger logger;
 
 private:
     void retrieveProjectData(ProjectData &projectData,
-                             const ResolvedProjectConstPtr &internalProject);
+                             const ResolvedProjectConstPtr &internalProject,
+                             const QString &installRoot);
+
+    BuildGraphQuery &buildGraphQuery();
+    TransformerData createTransformerData(const Transformer *transformer,
+                                          const ResolvedProductConstPtr &product,
+                                          const ProductData &productData,
+                                          const ArtifactSet &targetArtifacts);
 
     ProjectData m_projectData;
+
+    // The value of TopLevelProject::lockGeneration when m_projectData was retrieved.
+    unsigned int m_projectDataGeneration = 0;
+
+    // Indexes are set up on demand and discarded whenever a job has run.
+    std::shared_ptr<BuildGraphQuery> m_buildGraphQuery;
+    unsigned int m_buildGraphQueryGeneration = 0;
 };
 
 } // namespace Internal
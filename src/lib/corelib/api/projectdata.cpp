@@ -38,6 +38,7 @@
 ****************************************************************************/
 #include "projectdata.h"
 
+#include "project_p.h"
 #include "projectdata_p.h"
 #include "propertymap_p.h"
 #include <language/language.h>
@@ -615,7 +616,7 @@ const QString &ProductData::buildDirectory() const
  */
 const QList<ArtifactData> &ProductData::generatedArtifacts() const
 {
-    return d->generatedArtifacts;
+    return d->generatedArtifacts();
 }
 
 /*!
@@ -625,7 +626,8 @@ const QList<ArtifactData> &ProductData::generatedArtifacts() const
 const QList<ArtifactData> ProductData::targetArtifacts() const
 {
     QList<ArtifactData> list;
-    std::copy_if(d->generatedArtifacts.cbegin(), d->generatedArtifacts.cend(),
+    const QList<ArtifactData> &generatedArtifacts = d->generatedArtifacts();
+    std::copy_if(generatedArtifacts.cbegin(), generatedArtifacts.cend(),
                  std::back_inserter(list),
                  [](const ArtifactData &a) { return a.isTargetArtifact(); });
     return list;
@@ -637,14 +639,14 @@ const QList<ArtifactData> ProductData::targetArtifacts() const
 const QList<ArtifactData> ProductData::installableArtifacts() const
 {
     QList<ArtifactData> artifacts;
-    for (const GroupData &g : qAsConst(d->groups)) {
+    for (const GroupData &g : d->groups()) {
         const auto sourceArtifacts = g.allSourceArtifacts();
         for (const ArtifactData &a : sourceArtifacts) {
             if (a.installData().isInstallable())
                 artifacts << a;
         }
     }
-    for (const ArtifactData &a : qAsConst(d->generatedArtifacts)) {
+    for (const ArtifactData &a : d->generatedArtifacts()) {
         if (a.installData().isInstallable())
             artifacts << a;
     }
@@ -685,7 +687,7 @@ QString ProductData::targetExecutable() const
  */
 const QList<GroupData> &ProductData::groups() const
 {
-    return d->groups;
+    return d->groups();
 }
 
 /*!
@@ -730,7 +732,7 @@ bool ProductData::isMultiplexed() const
 
 bool operator==(const ProductData &lhs, const ProductData &rhs)
 {
-    if (!lhs.isValid() && !rhs.isValid())
+    if (lhs.d == rhs.d || (!lhs.isValid() && !rhs.isValid()))
         return true;
 
     return lhs.isValid() == rhs.isValid()
@@ -742,8 +744,8 @@ bool operator==(const ProductData &lhs, const ProductData &rhs)
             && lhs.profile() == rhs.profile()
             && lhs.multiplexConfigurationId() == rhs.multiplexConfigurationId()
             && lhs.location() == rhs.location()
-            && lhs.groups() == rhs.groups()
-            && lhs.generatedArtifacts() == rhs.generatedArtifacts()
+            && lhs.d->hasSameGroups(*rhs.d)
+            && lhs.d->hasSameGeneratedArtifacts(*rhs.d)
             && lhs.properties() == rhs.properties()
             && lhs.moduleProperties() == rhs.moduleProperties()
             && lhs.isEnabled() == rhs.isEnabled()
@@ -766,6 +768,59 @@ bool operator<(const ProductData &lhs, const ProductData &rhs)
             && lhs.multiplexConfigurationId() < rhs.multiplexConfigurationId();
 }
 
+namespace Internal {
+
+bool operator==(const ArtifactSnapshot &lhs, const ArtifactSnapshot &rhs)
+{
+    return lhs.filePath == rhs.filePath
+            && lhs.fileTags == rhs.fileTags
+            && (lhs.properties == rhs.properties || *lhs.properties == *rhs.properties)
+            && lhs.isGenerated == rhs.isGenerated
+            && lhs.isTargetArtifact == rhs.isTargetArtifact;
+}
+
+const QList<GroupData> &ProductDataPrivate::groups() const
+{
+    std::call_once(m_groupsRetrieved, [this] {
+        for (const GroupConstPtr &group : resolvedGroups)
+            m_groups << ProjectPrivate::createGroupDataFromGroup(group, *this);
+        std::sort(m_groups.begin(), m_groups.end());
+    });
+    return m_groups;
+}
+
+const QList<ArtifactData> &ProductDataPrivate::generatedArtifacts() const
+{
+    std::call_once(m_generatedArtifactsRetrieved, [this] {
+        for (const ArtifactSnapshot &artifact : generatedArtifactSnapshots)
+            m_generatedArtifacts << ProjectPrivate::createArtifactData(artifact, *this);
+    });
+    return m_generatedArtifacts;
+}
+
+// The install data is derived from the product's source directory and the install root.
+static bool hasSameInstallContext(const ProductDataPrivate &lhs, const ProductDataPrivate &rhs)
+{
+    return lhs.sourceDirectory == rhs.sourceDirectory
+            && lhs.projectInstallRoot == rhs.projectInstallRoot;
+}
+
+bool ProductDataPrivate::hasSameGroups(const ProductDataPrivate &other) const
+{
+    if (resolvedGroups == other.resolvedGroups && hasSameInstallContext(*this, other))
+        return true;
+    return groups() == other.groups();
+}
+
+bool ProductDataPrivate::hasSameGeneratedArtifacts(const ProductDataPrivate &other) const
+{
+    if (hasSameInstallContext(*this, other))
+        return generatedArtifactSnapshots == other.generatedArtifactSnapshots;
+    return generatedArtifacts() == other.generatedArtifacts();
+}
+
+} // namespace Internal
+
 /*!
  * \class ProjectData
  * \brief The \c ProjectData class corresponds to the \c Project item in a qbs source file.
@@ -888,7 +943,7 @@ const QList<ArtifactData> ProjectData::installableArtifacts() const
 
 bool operator==(const ProjectData &lhs, const ProjectData &rhs)
 {
-    if (!lhs.isValid() && !rhs.isValid())
+    if (lhs.d == rhs.d || (!lhs.isValid() && !rhs.isValid()))
         return true;
 
     return lhs.isValid() == rhs.isValid()
@@ -1011,12 +1066,12 @@ QString PropertyMap::toString() const
 
 bool operator==(const PropertyMap &pm1, const PropertyMap &pm2)
 {
-    return *pm1.d->m_map == *pm2.d->m_map;
+    return pm1.d->m_map == pm2.d->m_map || *pm1.d->m_map == *pm2.d->m_map;
 }
 
 bool operator!=(const PropertyMap &pm1, const PropertyMap &pm2)
 {
-    return !(*pm1.d->m_map == *pm2.d->m_map);
+    return !(pm1 == pm2);
 }
 
 } // namespace qbs
@@ -187,6 +187,7 @@ QBS_EXPORT bool operator<(const GroupData &lhs, const GroupData &rhs);
 class QBS_EXPORT ProductData
 {
     friend class Internal::ProjectPrivate;
+    friend QBS_EXPORT bool operator==(const ProductData &lhs, const ProductData &rhs);
 public:
     ProductData();
     ProductData(const ProductData &other);
@@ -230,6 +231,7 @@ QBS_EXPORT bool operator<(const ProductData &lhs, const ProductData &rhs);
 class QBS_EXPORT ProjectData
 {
     friend class Internal::ProjectPrivate;
+    friend QBS_EXPORT bool operator==(const ProjectData &lhs, const ProjectData &rhs);
 public:
     ProjectData();
     ProjectData(const ProjectData &other);
@@ -41,9 +41,14 @@
 
 #include "projectdata.h"
 #include <language/filetags.h>
+#include <language/forward_decls.h>
+#include <logging/logger.h>
 
 #include <QtCore/qshareddata.h>
 
+#include <mutex>
+#include <vector>
+
 namespace qbs {
 namespace Internal {
 
@@ -90,9 +95,36 @@ public:
     bool isValid = false;
 };
 
+// The part of a build graph artifact that goes into its ArtifactData. Unlike the artifact
+// itself, it does not change when the product is built again.
+class ArtifactSnapshot
+{
+public:
+    QString filePath;
+    FileTags fileTags;
+    PropertyMapPtr properties;
+    bool isGenerated = false;
+    bool isTargetArtifact = false;
+};
+
+bool operator==(const ArtifactSnapshot &lhs, const ArtifactSnapshot &rhs);
+inline bool operator<(const ArtifactSnapshot &lhs, const ArtifactSnapshot &rhs)
+{
+    return lhs.filePath < rhs.filePath;
+}
+
 class ProductDataPrivate : public QSharedData
 {
 public:
+    // Creating the groups and the generated artifacts is expensive, so it happens on first
+    // access, from the resolved groups and a snapshot of the product's build graph.
+    // None of these refer to the resolved project, which may be gone by then.
+    // Product data can be shared between threads, so the lists are filled exactly once.
+    const QList<GroupData> &groups() const;
+    const QList<ArtifactData> &generatedArtifacts() const;
+    bool hasSameGroups(const ProductDataPrivate &other) const;
+    bool hasSameGeneratedArtifacts(const ProductDataPrivate &other) const;
+
     QStringList type;
     QStringList dependencies;
     QString name;
@@ -101,14 +133,23 @@ public:
     QString multiplexConfigurationId;
     CodeLocation location;
     QString buildDirectory;
-    QList<GroupData> groups;
     QVariantMap properties;
     PropertyMap moduleProperties;
-    QList<ArtifactData> generatedArtifacts;
+    std::vector<GroupConstPtr> resolvedGroups;
+    std::vector<ArtifactSnapshot> generatedArtifactSnapshots;
+    QString sourceDirectory;
+    QString projectInstallRoot;
+    Logger logger;
     bool isEnabled = false;
     bool isRunnable = false;
     bool isMultiplexed = false;
     bool isValid = false;
+
+private:
+    mutable QList<GroupData> m_groups;
+    mutable QList<ArtifactData> m_generatedArtifacts;
+    mutable std::once_flag m_groupsRetrieved;
+    mutable std::once_flag m_generatedArtifactsRetrieved;
 };
 
 class ProjectDataPrivate : public QSharedData
@@ -59,7 +59,20 @@
 #include <QtCore/qdir.h>
 #include <QtCore/qdiriterator.h>
 #include <QtCore/qfileinfo.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qrunnable.h>
 #include <QtCore/qstring.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qthreadpool.h>
+
+#include <atomic>
+#include <vector>
+
+#if defined(Q_OS_UNIX)
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 namespace qbs {
 namespace Internal {
@@ -97,15 +110,170 @@ static void removeArtifactFromDisk(Artifact *artifact, bool dryRun, const Logger
         throw ErrorInfo(errorMessage);
 }
 
+// Files in the same directory are removed together, so that on Unix, a worker thread
+// needs to open the directory only once and can then use cheap relative unlinkat() calls.
+struct RemovalBatch
+{
+    QString dirPath;
+    QStringList fileNames;
+    QStringList removedFilePaths;
+    QStringList errorMessages;
+};
+
+static void removeFilesInBatch(RemovalBatch &batch, bool keepGoing, std::atomic_bool &abort)
+{
+    const auto addError = [&](const QString &message) {
+        batch.errorMessages << message;
+        if (!keepGoing)
+            abort = true;
+    };
+#if defined(Q_OS_UNIX)
+    const int dirFd = ::open(QFile::encodeName(batch.dirPath).constData(),
+                             O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd == -1 && errno == ENOENT)
+        return;
+#endif
+    for (const QString &fileName : qAsConst(batch.fileNames)) {
+        if (abort)
+            break;
+        const QString filePath = batch.dirPath + QLatin1Char('/') + fileName;
+#if defined(Q_OS_UNIX)
+        if (dirFd != -1) {
+            if (::unlinkat(dirFd, QFile::encodeName(fileName).constData(), 0) == 0) {
+                batch.removedFilePaths << filePath;
+                continue;
+            }
+            const int error = errno;
+            if (error == ENOENT)
+                continue;
+
+            // Directories need to be removed recursively, which we leave to the generic code.
+            if (error != EISDIR && error != EPERM) {
+                addError(Tr::tr("The file %1 could not be deleted: %2")
+                         .arg(QDir::toNativeSeparators(filePath), qt_error_string(error)));
+                continue;
+            }
+        }
+#endif
+        const QFileInfo fileInfo(filePath);
+        if (!FileInfo::fileExists(fileInfo))
+            continue;
+        QString errorMessage;
+        if (removeFileRecursion(fileInfo, &errorMessage))
+            batch.removedFilePaths << filePath;
+        else
+            addError(errorMessage);
+    }
+#if defined(Q_OS_UNIX)
+    if (dirFd != -1)
+        ::close(dirFd);
+#endif
+}
+
+class FileRemovalTask : public QRunnable
+{
+public:
+    FileRemovalTask(RemovalBatch &batch, bool keepGoing, std::atomic_bool &abort)
+        : m_batch(batch), m_keepGoing(keepGoing), m_abort(abort)
+    {
+    }
+
+private:
+    void run() override { removeFilesInBatch(m_batch, m_keepGoing, m_abort); }
+
+    RemovalBatch &m_batch;
+    const bool m_keepGoing;
+    std::atomic_bool &m_abort;
+};
+
+// Collects the files to remove and then removes them on a number of worker threads.
+class ParallelFileRemover
+{
+public:
+    void addFile(const QString &filePath)
+    {
+        const int slashIndex = filePath.lastIndexOf(QLatin1Char('/'));
+        QBS_CHECK(slashIndex != -1);
+        m_filesPerDirectory[filePath.left(slashIndex)] << filePath.mid(slashIndex + 1);
+    }
+
+    // Returns the error messages. If keepGoing is false, removal stops at the first error.
+    QStringList removeFiles(int maxThreadCount, bool keepGoing,
+                            const ProgressObserver *observer, const Logger &logger)
+    {
+        static const int maxBatchSize = 256;
+        std::vector<RemovalBatch> batches;
+        for (auto it = m_filesPerDirectory.cbegin(); it != m_filesPerDirectory.cend(); ++it) {
+            for (int i = 0; i < it.value().size(); i += maxBatchSize) {
+                RemovalBatch batch;
+                batch.dirPath = it.key();
+                batch.fileNames = it.value().mid(i, maxBatchSize);
+                batches.push_back(std::move(batch));
+            }
+        }
+        m_filesPerDirectory.clear();
+
+        std::atomic_bool abort(false);
+        QThreadPool threadPool;
+        threadPool.setMaxThreadCount(maxThreadCount > 0
+                                     ? maxThreadCount : QThread::idealThreadCount());
+        for (RemovalBatch &batch : batches)
+            threadPool.start(new FileRemovalTask(batch, keepGoing, abort));
+        while (!threadPool.waitForDone(100)) {
+            if (observer->canceled())
+                abort = true;
+        }
+        if (observer->canceled())
+            throw ErrorInfo(Tr::tr("Cleaning up was canceled."));
+
+        QStringList errorMessages;
+        for (const RemovalBatch &batch : batches) {
+            for (const QString &filePath : batch.removedFilePaths)
+                printRemovalMessage(filePath, false, logger);
+            errorMessages << batch.errorMessages;
+            if (!keepGoing && !errorMessages.empty())
+                break;
+        }
+        return errorMessages;
+    }
+
+private:
+    QHash<QString, QStringList> m_filesPerDirectory;
+};
+
+// Returns true if dirPath contains only the given files (and directories containing
+// only such files), in which case these are appended to filePaths.
+static bool containsOnlyGeneratedFiles(const QString &dirPath, const Set<QString> &generatedFiles,
+                                       QStringList &filePaths, Set<QString> &directories)
+{
+    directories << dirPath;
+    QDirIterator it(dirPath, QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden
+                    | QDir::System);
+    while (it.hasNext()) {
+        const QString filePath = it.next();
+        if (generatedFiles.contains(filePath)) {
+            filePaths << filePath;
+            continue;
+        }
+        const QFileInfo &fileInfo = it.fileInfo();
+        if (fileInfo.isSymLink() || !fileInfo.isDir())
+            return false;
+        if (!containsOnlyGeneratedFiles(filePath, generatedFiles, filePaths, directories))
+            return false;
+    }
+    return true;
+}
+
 class CleanupVisitor : public ArtifactVisitor
 {
 public:
     CleanupVisitor(CleanOptions options, const ProgressObserver *observer,
-                   Logger logger)
+                   Logger logger, ParallelFileRemover *remover)
         : ArtifactVisitor(Artifact::Generated)
         , m_options(std::move(options))
         , m_observer(observer)
         , m_logger(std::move(logger))
+        , m_remover(remover)
         , m_hasError(false)
     {
     }
@@ -113,15 +281,22 @@ public:
     void visitProduct(const ResolvedProductPtr &product)
     {
         m_product = product;
+        if (m_remover && m_options.removeProductDirectories())
+            collectProductDirectoryContents();
         ArtifactVisitor::visitProduct(product);
         const AllRescuableArtifactData rescuableArtifactData
                 = product->buildData->rescuableArtifactData();
         for (auto it = rescuableArtifactData.begin(); it != rescuableArtifactData.end(); ++it) {
-            Artifact tmp;
-            tmp.product = product;
-            tmp.setFilePath(it.key());
-            tmp.setTimestamp(it.value().timeStamp);
-            removeArtifactFromDisk(&tmp, m_options.dryRun(), m_logger);
+            if (m_remover) {
+                if (!isInRemovedProductDirectory(it.key()))
+                    m_remover->addFile(it.key());
+            } else {
+                Artifact tmp;
+                tmp.product = product;
+                tmp.setFilePath(it.key());
+                tmp.setTimestamp(it.value().timeStamp);
+                removeArtifactFromDisk(&tmp, m_options.dryRun(), m_logger);
+            }
             product->buildData->removeFromRescuableArtifactData(it.key());
         }
     }
@@ -137,22 +312,66 @@ private:
 
         if (artifact->product != m_product)
             return;
-        try {
-            removeArtifactFromDisk(artifact, m_options.dryRun(), m_logger);
-        } catch (const ErrorInfo &error) {
-            if (!m_options.keepGoing())
-                throw;
-            m_logger.printWarning(error);
-            m_hasError = true;
+        if (m_remover) {
+            invalidateArtifactTimestamp(artifact);
+            if (!isInRemovedProductDirectory(artifact->filePath()))
+                m_remover->addFile(artifact->filePath());
+        } else {
+            try {
+                removeArtifactFromDisk(artifact, m_options.dryRun(), m_logger);
+            } catch (const ErrorInfo &error) {
+                if (!m_options.keepGoing())
+                    throw;
+                m_logger.printWarning(error);
+                m_hasError = true;
+            }
         }
         m_directories << artifact->dirPath();
     }
 
+    // If the product's build directory contains nothing but the product's generated files,
+    // we hand its contents to the remover as a whole, without looking at artifacts.
+    void collectProductDirectoryContents()
+    {
+        const QString productDir = m_product->buildDirectory();
+        if (!FileInfo(productDir).exists())
+            return;
+        Set<QString> generatedFiles;
+        for (const Artifact * const artifact
+             : filterByType<Artifact>(m_product->buildData->allNodes())) {
+            if (artifact->artifactType == Artifact::Generated)
+                generatedFiles << artifact->filePath();
+        }
+        const AllRescuableArtifactData rescuableArtifactData
+                = m_product->buildData->rescuableArtifactData();
+        for (auto it = rescuableArtifactData.cbegin(); it != rescuableArtifactData.cend(); ++it)
+            generatedFiles << it.key();
+        QStringList filePaths;
+        Set<QString> directories;
+        if (!containsOnlyGeneratedFiles(productDir, generatedFiles, filePaths, directories)) {
+            m_logger.qbsDebug() << "Product build directory '" << productDir
+                                << "' contains foreign files, removing artifacts one by one.";
+            return;
+        }
+        for (const QString &filePath : qAsConst(filePaths))
+            m_remover->addFile(filePath);
+        m_directories.unite(directories);
+        m_removedProductDirPrefix = productDir + QLatin1Char('/');
+    }
+
+    bool isInRemovedProductDirectory(const QString &filePath) const
+    {
+        return !m_removedProductDirPrefix.isEmpty()
+                && filePath.startsWith(m_removedProductDirPrefix);
+    }
+
     const CleanOptions m_options;
     const ProgressObserver * const m_observer;
     Logger m_logger;
+    ParallelFileRemover * const m_remover;
     bool m_hasError;
     ResolvedProductConstPtr m_product;
+    QString m_removedProductDirPrefix;
     Set<QString> m_directories;
 };
 
@@ -169,15 +388,30 @@ void ArtifactCleaner::cleanup(const TopLevelProjectPtr &project,
     const QString configString = Tr::tr(" for configuration %1").arg(project->id());
     m_observer->initialize(Tr::tr("Cleaning up%1").arg(configString), products.size() + 1);
 
+    // In dry-run mode, artifacts are inspected one by one, so we can report exactly
+    // what would be removed.
+    ParallelFileRemover remover;
+    ParallelFileRemover * const removerToUse = options.dryRun() ? nullptr : &remover;
     Set<QString> directories;
     for (const ResolvedProductPtr &product : products) {
-        CleanupVisitor visitor(options, m_observer, m_logger);
+        CleanupVisitor visitor(options, m_observer, m_logger, removerToUse);
         visitor.visitProduct(product);
         directories.unite(visitor.directories());
         if (visitor.hasError())
             m_hasError = true;
         m_observer->incrementProgressValue();
     }
+    if (removerToUse) {
+        const QStringList errorMessages = removerToUse->removeFiles(options.maxJobCount(),
+                options.keepGoing(), m_observer, m_logger);
+        if (!errorMessages.empty()) {
+            if (!options.keepGoing())
+                throw ErrorInfo(errorMessages.first());
+            for (const QString &message : errorMessages)
+                m_logger.printWarning(ErrorInfo(message));
+            m_hasError = true;
+        }
+    }
 
     // Directories created during the build are not artifacts (TODO: should they be?),
     // so we have to clean them up manually.
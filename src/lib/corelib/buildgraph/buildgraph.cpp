@@ -568,11 +568,10 @@ QString relativeArtifactFileName(const Artifact *artifact)
     return str;
 }
 
-Artifact *lookupArtifact(const ResolvedProductConstPtr &product,
-        const ProjectBuildData *projectBuildData, const QString &dirPath, const QString &fileName,
-        bool compareByName)
+static Artifact *findArtifactOfProduct(const std::vector<FileResourceBase *> &files,
+                                       const ResolvedProductConstPtr &product, bool compareByName)
 {
-    for (const auto &fileResource : projectBuildData->lookupFiles(dirPath, fileName)) {
+    for (const auto &fileResource : files) {
         if (fileResource->fileType() != FileResourceBase::FileTypeArtifact)
             continue;
         const auto artifact = static_cast<Artifact *>(fileResource);
@@ -585,6 +584,14 @@ Artifact *lookupArtifact(const ResolvedProductConstPtr &product,
     return nullptr;
 }
 
+Artifact *lookupArtifact(const ResolvedProductConstPtr &product,
+        const ProjectBuildData *projectBuildData, const QString &dirPath, const QString &fileName,
+        bool compareByName)
+{
+    return findArtifactOfProduct(projectBuildData->lookupFiles(dirPath, fileName), product,
+                                 compareByName);
+}
+
 Artifact *lookupArtifact(const ResolvedProductConstPtr &product, const QString &dirPath,
                          const QString &fileName, bool compareByName)
 {
@@ -611,7 +618,8 @@ Artifact *lookupArtifact(const ResolvedProductConstPtr &product, const ProjectBu
 Artifact *lookupArtifact(const ResolvedProductConstPtr &product, const Artifact *artifact,
                          bool compareByName)
 {
-    return lookupArtifact(product, artifact->dirPath(), artifact->fileName(), compareByName);
+    return findArtifactOfProduct(product->topLevelProject()->buildData->lookupFiles(artifact),
+                                 product, compareByName);
 }
 
 Artifact *createArtifact(const ResolvedProductPtr &product,
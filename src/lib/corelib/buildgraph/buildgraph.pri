@@ -8,6 +8,7 @@ SOURCES += \
     $$PWD/artifactvisitor.cpp \
     $$PWD/buildgraph.cpp \
     $$PWD/buildgraphloader.cpp \
+    $$PWD/buildgraphquery.cpp \
     $$PWD/buildgraphnode.cpp \
     $$PWD/cycledetector.cpp \
     $$PWD/dependencyparametersscriptvalue.cpp \
@@ -18,16 +19,20 @@ SOURCES += \
     $$PWD/executorjob.cpp \
     $$PWD/filedependency.cpp \
     $$PWD/inputartifactscanner.cpp \
+    $$PWD/jobtokenbroker.cpp \
     $$PWD/jscommandexecutor.cpp \
     $$PWD/nodeset.cpp \
     $$PWD/nodetreedumper.cpp \
+    $$PWD/preparescriptworkerpool.cpp \
     $$PWD/processcommandexecutor.cpp \
+    $$PWD/processoutputworker.cpp \
     $$PWD/productbuilddata.cpp \
     $$PWD/productinstaller.cpp \
     $$PWD/projectbuilddata.cpp \
     $$PWD/qtmocscanner.cpp \
     $$PWD/rawscanneddependency.cpp \
     $$PWD/rawscanresults.cpp \
+    $$PWD/remotecommandexecutor.cpp \
     $$PWD/requestedartifacts.cpp \
     $$PWD/requesteddependencies.cpp \
     $$PWD/rulecommands.cpp \
@@ -47,6 +52,7 @@ HEADERS += \
     $$PWD/artifactvisitor.h \
     $$PWD/buildgraph.h \
     $$PWD/buildgraphloader.h \
+    $$PWD/buildgraphquery.h \
     $$PWD/buildgraphnode.h \
     $$PWD/buildgraphvisitor.h \
     $$PWD/cycledetector.h \
@@ -59,16 +65,20 @@ HEADERS += \
     $$PWD/filedependency.h \
     $$PWD/forward_decls.h \
     $$PWD/inputartifactscanner.h \
+    $$PWD/jobtokenbroker.h \
     $$PWD/jscommandexecutor.h \
     $$PWD/nodeset.h \
     $$PWD/nodetreedumper.h \
+    $$PWD/preparescriptworkerpool.h \
     $$PWD/processcommandexecutor.h \
+    $$PWD/processoutputworker.h \
     $$PWD/productbuilddata.h \
     $$PWD/productinstaller.h \
     $$PWD/projectbuilddata.h \
     $$PWD/qtmocscanner.h \
     $$PWD/rawscanneddependency.h \
     $$PWD/rawscanresults.h \
+    $$PWD/remotecommandexecutor.h \
     $$PWD/requestedartifacts.h \
     $$PWD/requesteddependencies.h \
     $$PWD/rescuableartifactdata.h \
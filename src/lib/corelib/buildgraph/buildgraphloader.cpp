@@ -155,7 +155,8 @@ TopLevelProjectConstPtr BuildGraphLoader::loadProject(const QString &bgFilePath)
         void doPrintMessage(LoggerLevel, const QString &, const QString &) override { }
     } dummySink;
     Logger dummyLogger(&dummySink);
-    BuildGraphLocker bgLocker(bgFilePath, dummyLogger, false, nullptr);
+    BuildGraphLocker bgLocker(bgFilePath, dummyLogger, false, nullptr,
+                              BuildGraphLocker::LockMode::Read);
     PersistentPool pool(dummyLogger);
     pool.load(bgFilePath);
     const TopLevelProjectPtr project = TopLevelProject::create();
@@ -166,6 +167,7 @@ TopLevelProjectConstPtr BuildGraphLoader::loadProject(const QString &bgFilePath)
 
 void BuildGraphLoader::loadBuildGraphFromDisk()
 {
+    ProfilingScope loadScope("build-graph-loading");
     const QString projectId = TopLevelProject::deriveId(m_parameters.finalBuildConfigurationTree());
     const QString buildDir
             = TopLevelProject::deriveBuildDirectory(m_parameters.buildRoot(), projectId);
@@ -301,15 +303,27 @@ void BuildGraphLoader::trackProjectChanges()
 {
     TimedActivityLogger trackingTimer(m_logger, Tr::tr("Change tracking"),
                                       m_parameters.logElapsedTime());
+    ProfilingScope trackingScope("change-tracking");
     const TopLevelProjectPtr &restoredProject = m_result.loadedProject;
     Set<QString> buildSystemFiles = restoredProject->buildSystemFiles;
     std::vector<ResolvedProductPtr> allRestoredProducts = restoredProject->allProducts();
     std::vector<ResolvedProductPtr> changedProducts;
+    Set<QString> changedBuildSystemFiles;
     bool reResolvingNecessary = false;
-    if (!checkConfigCompatibility())
+
+    // Products can only be taken over from the stored build graph if nothing but
+    // the build system files changed and the build configuration stayed the same.
+    bool productReuseAllowed = true;
+    if (!checkConfigCompatibility()) {
         reResolvingNecessary = true;
+        productReuseAllowed = false;
+    }
     if (hasProductFileChanged(allRestoredProducts, restoredProject->lastStartResolveTime,
-                              buildSystemFiles, changedProducts)) {
+                              buildSystemFiles, changedProducts, changedBuildSystemFiles)) {
+        reResolvingNecessary = true;
+    }
+    if (hasBuildSystemFileChanged(buildSystemFiles, restoredProject.get(),
+                                  changedBuildSystemFiles)) {
         reResolvingNecessary = true;
     }
 
@@ -318,13 +332,13 @@ void BuildGraphLoader::trackProjectChanges()
     // having been touched. In such a case, the build data for that product will have to be set up
     // anew.
     if (probeExecutionForced(restoredProject, allRestoredProducts)
-            || hasBuildSystemFileChanged(buildSystemFiles, restoredProject.get())
             || hasEnvironmentChanged(restoredProject)
             || hasCanonicalFilePathResultChanged(restoredProject)
             || hasFileExistsResultChanged(restoredProject)
             || hasDirectoryEntriesResultChanged(restoredProject)
             || hasFileLastModifiedResultChanged(restoredProject)) {
         reResolvingNecessary = true;
+        productReuseAllowed = false;
     }
 
     if (!reResolvingNecessary) {
@@ -333,8 +347,18 @@ void BuildGraphLoader::trackProjectChanges()
         return;
     }
 
+    // From here on, we might remove files from the build directory.
+    if (m_bgLocker)
+        m_bgLocker->lockForWriting();
+
+    QHash<QString, ResolvedProductPtr> reusableProducts;
+    if (productReuseAllowed) {
+        reusableProducts = productsUnaffectedByChanges(allRestoredProducts, changedProducts,
+                                                       changedBuildSystemFiles);
+    }
+
     restoredProject->buildData->setDirty();
-    markTransformersForChangeTracking(allRestoredProducts);
+    markTransformersForChangeTracking(allRestoredProducts, reusableProducts);
     if (!m_parameters.overrideBuildGraphData())
         m_parameters.setEnvironment(restoredProject->environment);
     Loader ldr(m_evalContext->engine(), m_logger);
@@ -350,7 +374,10 @@ void BuildGraphLoader::trackProjectChanges()
     ldr.setOldProductProbes(restoredProbes);
     if (!m_parameters.overrideBuildGraphData())
         ldr.setStoredProfiles(restoredProject->profileConfigs);
+    ldr.setReusableProducts(reusableProducts);
     m_result.newlyResolvedProject = ldr.loadProject(m_parameters);
+    if (!reusableProducts.empty())
+        takeOverStateOfReusedProducts(restoredProject, reusableProducts);
 
     std::vector<ResolvedProductPtr> allNewlyResolvedProducts
             = m_result.newlyResolvedProject->allProducts();
@@ -412,9 +439,9 @@ void BuildGraphLoader::trackProjectChanges()
             ++it;
         } else {
             const ResolvedProductPtr &restoredProduct = *k;
-            if (newlyResolvedProduct->enabled)
+            if (newlyResolvedProduct->enabled && newlyResolvedProduct != restoredProduct)
                 newlyResolvedProduct->buildData.swap(restoredProduct->buildData);
-            if (newlyResolvedProduct->buildData)
+            if (newlyResolvedProduct->buildData && newlyResolvedProduct != restoredProduct)
                 updateProductAndRulePointers(newlyResolvedProduct);
 
             // Keep in list if build data still needs to be resolved.
@@ -569,7 +596,7 @@ bool BuildGraphLoader::hasFileLastModifiedResultChanged(const TopLevelProjectCon
 
 bool BuildGraphLoader::hasProductFileChanged(const std::vector<ResolvedProductPtr> &restoredProducts,
         const FileTime &referenceTime, Set<QString> &remainingBuildSystemFiles,
-        std::vector<ResolvedProductPtr> &changedProducts)
+        std::vector<ResolvedProductPtr> &changedProducts, Set<QString> &changedBuildSystemFiles)
 {
     bool hasChanged = false;
     for (const ResolvedProductPtr &product : restoredProducts) {
@@ -579,9 +606,11 @@ bool BuildGraphLoader::hasProductFileChanged(const std::vector<ResolvedProductPt
         if (!pfi.exists()) {
             qCDebug(lcBuildGraph) << "A product was removed, must re-resolve project";
             hasChanged = true;
+            changedBuildSystemFiles.insert(filePath);
         } else if (referenceTime < pfi.lastModified()) {
             qCDebug(lcBuildGraph) << "A product was changed, must re-resolve project";
             hasChanged = true;
+            changedBuildSystemFiles.insert(filePath);
         } else if (!contains(changedProducts, product)) {
             bool foundMissingSourceFile = false;
             for (const QString &file : qAsConst(product->missingSourceFiles)) {
@@ -630,14 +659,18 @@ bool BuildGraphLoader::hasProductFileChanged(const std::vector<ResolvedProductPt
 }
 
 bool BuildGraphLoader::hasBuildSystemFileChanged(const Set<QString> &buildSystemFiles,
-                                                 const TopLevelProject *restoredProject)
+                                                 const TopLevelProject *restoredProject,
+                                                 Set<QString> &changedFiles)
 {
+    bool hasChanged = false;
     for (const QString &file : buildSystemFiles) {
         const FileInfo fi(file);
         if (!fi.exists()) {
             qCDebug(lcBuildGraph) << "Project file" << file
                                   << "no longer exists, must re-resolve project.";
-            return true;
+            changedFiles.insert(file);
+            hasChanged = true;
+            continue;
         }
         const auto generatedChecker = [&file, restoredProject](const ModuleProviderInfo &mpi) {
             return file.startsWith(mpi.outputDirPath(restoredProject->buildDirectory));
@@ -648,17 +681,101 @@ bool BuildGraphLoader::hasBuildSystemFileChanged(const Set<QString> &buildSystem
                 ? restoredProject->lastEndResolveTime : restoredProject->lastStartResolveTime;
         if (referenceTime < fi.lastModified()) {
             qCDebug(lcBuildGraph) << "Project file" << file << "changed, must re-resolve project.";
-            return true;
+            changedFiles.insert(file);
+            hasChanged = true;
         }
     }
-    return false;
+    return hasChanged;
+}
+
+// Returns the restored products that are affected neither directly nor via one of their
+// dependencies by the changed build system files. If some file cannot be attributed
+// to any product, e.g. because it is only imported by another JavaScript file, nothing
+// can be reused.
+QHash<QString, ResolvedProductPtr> BuildGraphLoader::productsUnaffectedByChanges(
+        const std::vector<ResolvedProductPtr> &restoredProducts,
+        const std::vector<ResolvedProductPtr> &changedProducts,
+        const Set<QString> &changedBuildSystemFiles) const
+{
+    Set<const ResolvedProduct *> affectedProducts;
+    for (const ResolvedProductPtr &product : changedProducts)
+        affectedProducts.insert(product.get());
+    for (const QString &file : changedBuildSystemFiles) {
+        bool fileIsKnown = false;
+        for (const ResolvedProductPtr &product : restoredProducts) {
+            if (product->buildSystemFiles.contains(file)) {
+                affectedProducts.insert(product.get());
+                fileIsKnown = true;
+            }
+        }
+        if (!fileIsKnown) {
+            qCDebug(lcBuildGraph) << "Build system file" << file << "is not associated with "
+                                     "any product, must re-resolve all products.";
+            return {};
+        }
+    }
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (const ResolvedProductPtr &product : restoredProducts) {
+            if (affectedProducts.contains(product.get()))
+                continue;
+            for (const ResolvedProductPtr &dep : product->dependencies) {
+                if (affectedProducts.contains(dep.get())) {
+                    affectedProducts.insert(product.get());
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    QHash<QString, ResolvedProductPtr> unaffectedProducts;
+    for (const ResolvedProductPtr &product : restoredProducts) {
+        if (product->enabled && product->buildData && !product->buildSystemFiles.empty()
+                && !affectedProducts.contains(product.get())) {
+            unaffectedProducts.insert(product->uniqueName(), product);
+        }
+    }
+    qCDebug(lcBuildGraph) << unaffectedProducts.size() << "of" << restoredProducts.size()
+                          << "products are not affected by changes to build system files.";
+    return unaffectedProducts;
+}
+
+// Products taken over from the stored build graph did not get evaluated, so the
+// project-wide bookkeeping of the resolver lacks the data they contributed.
+void BuildGraphLoader::takeOverStateOfReusedProducts(
+        const TopLevelProjectConstPtr &restoredProject,
+        const QHash<QString, ResolvedProductPtr> &reusableProducts)
+{
+    const TopLevelProjectPtr &newProject = m_result.newlyResolvedProject;
+    bool productsWereReused = false;
+    for (const ResolvedProductPtr &product : newProject->allProducts()) {
+        if (reusableProducts.value(product->uniqueName()) != product)
+            continue;
+        newProject->buildSystemFiles.unite(product->buildSystemFiles);
+        productsWereReused = true;
+    }
+    if (!productsWereReused)
+        return;
+
+    const auto takeOver = [](auto &newResults, const auto &restoredResults) {
+        for (auto it = restoredResults.cbegin(); it != restoredResults.cend(); ++it) {
+            if (!newResults.contains(it.key()))
+                newResults.insert(it.key(), it.value());
+        }
+    };
+    takeOver(newProject->canonicalFilePathResults, restoredProject->canonicalFilePathResults);
+    takeOver(newProject->fileExistsResults, restoredProject->fileExistsResults);
+    takeOver(newProject->directoryEntriesResults, restoredProject->directoryEntriesResults);
+    takeOver(newProject->fileLastModifiedResults, restoredProject->fileLastModifiedResults);
 }
 
 void BuildGraphLoader::markTransformersForChangeTracking(
-        const std::vector<ResolvedProductPtr> &restoredProducts)
+        const std::vector<ResolvedProductPtr> &restoredProducts,
+        const QHash<QString, ResolvedProductPtr> &reusableProducts)
 {
     for (const ResolvedProductPtr &product : restoredProducts) {
-        if (!product->buildData)
+        if (!product->buildData || reusableProducts.contains(product->uniqueName()))
             continue;
         for (Artifact * const artifact : filterByType<Artifact>(product->buildData->allNodes())) {
             if (artifact->transformer) {
@@ -676,7 +793,7 @@ void BuildGraphLoader::checkAllProductsForChanges(
     for (const ResolvedProductPtr &restoredProduct : restoredProducts) {
         const ResolvedProductPtr newlyResolvedProduct
                 = m_freshProductsByName.value(restoredProduct->uniqueName());
-        if (!newlyResolvedProduct)
+        if (!newlyResolvedProduct || newlyResolvedProduct == restoredProduct)
             continue;
         if (newlyResolvedProduct->enabled != restoredProduct->enabled) {
             qCDebug(lcBuildGraph) << "Condition of product" << restoredProduct->uniqueName()
@@ -56,6 +56,7 @@
 namespace qbs {
 
 namespace Internal {
+class BuildGraphLocker;
 class FileDependency;
 class FileResourceBase;
 class FileTime;
@@ -75,6 +76,9 @@ public:
     BuildGraphLoader(Logger logger);
     ~BuildGraphLoader();
 
+    // If set, the lock is upgraded for writing before the build directory gets modified.
+    void setBuildGraphLocker(BuildGraphLocker *locker) { m_bgLocker = locker; }
+
     BuildGraphLoadResult load(const TopLevelProjectPtr &existingProject,
                               const SetupProjectParameters &parameters,
                               const RulesEvaluationContextPtr &evalContext);
@@ -95,10 +99,19 @@ private:
     bool hasProductFileChanged(const std::vector<ResolvedProductPtr> &restoredProducts,
                                const FileTime &referenceTime,
                                Set<QString> &remainingBuildSystemFiles,
-                               std::vector<ResolvedProductPtr> &productsWithChangedFiles);
+                               std::vector<ResolvedProductPtr> &productsWithChangedFiles,
+                               Set<QString> &changedBuildSystemFiles);
     bool hasBuildSystemFileChanged(const Set<QString> &buildSystemFiles,
-                                   const TopLevelProject *restoredProject);
-    void markTransformersForChangeTracking(const std::vector<ResolvedProductPtr> &restoredProducts);
+                                   const TopLevelProject *restoredProject,
+                                   Set<QString> &changedFiles);
+    QHash<QString, ResolvedProductPtr> productsUnaffectedByChanges(
+            const std::vector<ResolvedProductPtr> &restoredProducts,
+            const std::vector<ResolvedProductPtr> &changedProducts,
+            const Set<QString> &changedBuildSystemFiles) const;
+    void takeOverStateOfReusedProducts(const TopLevelProjectConstPtr &restoredProject,
+                                       const QHash<QString, ResolvedProductPtr> &reusableProducts);
+    void markTransformersForChangeTracking(const std::vector<ResolvedProductPtr> &restoredProducts,
+            const QHash<QString, ResolvedProductPtr> &reusableProducts);
     void checkAllProductsForChanges(const std::vector<ResolvedProductPtr> &restoredProducts,
             std::vector<ResolvedProductPtr> &changedProducts);
     bool checkProductForChanges(const ResolvedProductPtr &restoredProduct,
@@ -138,6 +151,7 @@ private:
     SetupProjectParameters m_parameters;
     BuildGraphLoadResult m_result;
     Logger m_logger;
+    BuildGraphLocker *m_bgLocker = nullptr;
     QStringList m_artifactsRemovedFromDisk;
     std::unordered_map<QString, std::vector<SourceArtifactConstPtr>> m_changedSourcesByProduct;
     Set<QString> m_productsWhoseArtifactsNeedUpdate;
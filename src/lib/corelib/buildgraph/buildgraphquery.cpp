@@ -0,0 +1,220 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#include "buildgraphquery.h"
+
+#include "artifact.h"
+#include "filedependency.h"
+#include "productbuilddata.h"
+#include "projectbuilddata.h"
+
+#include <language/language.h>
+#include <tools/fileinfo.h>
+
+#include <algorithm>
+
+namespace qbs {
+namespace Internal {
+
+BuildGraphQuery::BuildGraphQuery(TopLevelProjectConstPtr project) : m_project(std::move(project))
+{
+}
+
+std::vector<const Artifact *> BuildGraphQuery::dependents(
+        const QString &filePath, bool recursive, const QVector<ResolvedProductPtr> &products)
+{
+    const QVector<ResolvedProductPtr> productsToQuery = productsOrAll(products);
+    Set<const ResolvedProduct *> productSet;
+    for (const ResolvedProductPtr &product : productsToQuery)
+        productSet.insert(product.get());
+    indexFileDependencies(productsToQuery);
+
+    std::vector<const Artifact *> result;
+    Set<const Artifact *> seen;
+    std::vector<const Artifact *> queue;
+    const auto addDependent = [&](const Artifact *dependent) {
+        if (!seen.insert(dependent).second)
+            return;
+        if (productSet.contains(dependent->product.get()))
+            result.push_back(dependent);
+        if (recursive)
+            queue.push_back(dependent);
+    };
+    const auto addDirectDependents = [&](const Artifact *artifact) {
+        for (const Artifact * const parent : artifact->parentArtifacts())
+            addDependent(parent);
+    };
+
+    for (const FileResourceBase * const file : m_project->buildData->lookupFiles(filePath)) {
+        if (file->fileType() == FileResourceBase::FileTypeArtifact) {
+            addDirectDependents(static_cast<const Artifact *>(file));
+            continue;
+        }
+        const auto it = m_dependentsOfFileDependency.find(
+                    static_cast<const FileDependency *>(file));
+        if (it == m_dependentsOfFileDependency.cend())
+            continue;
+        for (const Artifact * const dependent : it->second)
+            addDependent(dependent);
+    }
+    while (!queue.empty()) {
+        const Artifact * const artifact = queue.back();
+        queue.pop_back();
+        addDirectDependents(artifact);
+    }
+    return result;
+}
+
+const Artifact *BuildGraphQuery::generatedArtifact(const QString &filePath) const
+{
+    for (const FileResourceBase * const file : m_project->buildData->lookupFiles(filePath)) {
+        if (file->fileType() != FileResourceBase::FileTypeArtifact)
+            continue;
+        const auto artifact = static_cast<const Artifact *>(file);
+        if (artifact->artifactType == Artifact::Generated)
+            return artifact;
+    }
+    return nullptr;
+}
+
+std::vector<const Artifact *> BuildGraphQuery::artifactsWithFileTag(
+        const FileTag &fileTag, const QVector<ResolvedProductPtr> &products) const
+{
+    std::vector<const Artifact *> result;
+    for (const ResolvedProductPtr &product : productsOrAll(products)) {
+        for (const Artifact * const artifact : product->lookupArtifactsByFileTag(fileTag))
+            result.push_back(artifact);
+    }
+    return result;
+}
+
+std::vector<const Artifact *> BuildGraphQuery::staleArtifacts(
+        const QVector<ResolvedProductPtr> &products)
+{
+    // The file system may have changed since the last query.
+    m_staleness.clear();
+    m_currentTimestamps.clear();
+
+    std::vector<const Artifact *> result;
+    for (const ResolvedProductPtr &product : productsOrAll(products)) {
+        for (const Artifact * const artifact
+             : TypeFilter<Artifact>(product->buildData->allNodes())) {
+            if (artifact->artifactType == Artifact::Generated && isStale(artifact))
+                result.push_back(artifact);
+        }
+    }
+    return result;
+}
+
+QVector<ResolvedProductPtr> BuildGraphQuery::productsOrAll(
+        const QVector<ResolvedProductPtr> &products) const
+{
+    QVector<ResolvedProductPtr> result;
+    if (products.empty()) {
+        for (const ResolvedProductPtr &product : m_project->allProducts())
+            result << product;
+    } else {
+        result = products;
+    }
+    result.erase(std::remove_if(result.begin(), result.end(),
+                                [](const ResolvedProductPtr &product) {
+                     return !product->enabled || !product->buildData;
+                 }), result.end());
+    return result;
+}
+
+// Artifacts know their parents, but file dependencies found by scanners do not know the
+// artifacts that include them, so this direction has to be indexed.
+void BuildGraphQuery::indexFileDependencies(const QVector<ResolvedProductPtr> &products)
+{
+    for (const ResolvedProductPtr &product : products) {
+        if (!m_productsWithIndexedFileDependencies.insert(product.get()).second)
+            continue;
+        for (const Artifact * const artifact
+             : TypeFilter<Artifact>(product->buildData->allNodes())) {
+            for (const FileDependency * const dependency : artifact->fileDependencies)
+                m_dependentsOfFileDependency[dependency].push_back(artifact);
+        }
+    }
+}
+
+bool BuildGraphQuery::isStale(const Artifact *artifact)
+{
+    const auto it = m_staleness.find(artifact);
+    if (it != m_staleness.cend())
+        return it->second;
+
+    // Guard against cycles, which the executor would report as an error.
+    m_staleness[artifact] = false;
+
+    const FileTime &timestamp = artifact->timestamp();
+    bool stale = !timestamp.isValid()
+            || (artifact->alwaysUpdated && !currentTimestamp(artifact->filePath()).isValid());
+    for (const Artifact * const child : artifact->childArtifacts()) {
+        if (stale)
+            break;
+        if (child->artifactType == Artifact::Generated)
+            stale = isStale(child) || timestamp < child->timestamp();
+        else
+            stale = hasChanged(child) || timestamp < child->timestamp();
+    }
+    for (auto depIt = artifact->fileDependencies.cbegin();
+         !stale && depIt != artifact->fileDependencies.cend(); ++depIt) {
+        stale = timestamp < currentTimestamp((*depIt)->filePath());
+    }
+    m_staleness[artifact] = stale;
+    return stale;
+}
+
+bool BuildGraphQuery::hasChanged(const Artifact *sourceArtifact)
+{
+    return currentTimestamp(sourceArtifact->filePath()) != sourceArtifact->timestamp();
+}
+
+FileTime BuildGraphQuery::currentTimestamp(const QString &filePath)
+{
+    const auto it = m_currentTimestamps.constFind(filePath);
+    if (it != m_currentTimestamps.constEnd())
+        return it.value();
+    const FileTime timestamp = FileInfo(filePath).lastModified();
+    m_currentTimestamps.insert(filePath, timestamp);
+    return timestamp;
+}
+
+} // namespace Internal
+} // namespace qbs
@@ -0,0 +1,102 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#ifndef QBS_BUILDGRAPHQUERY_H
+#define QBS_BUILDGRAPHQUERY_H
+
+#include "forward_decls.h"
+#include <language/filetags.h>
+#include <language/forward_decls.h>
+#include <tools/filetime.h>
+#include <tools/set.h>
+
+#include <QtCore/qhash.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qvector.h>
+
+#include <unordered_map>
+#include <vector>
+
+namespace qbs {
+namespace Internal {
+class Artifact;
+class FileDependency;
+
+// Answers questions about the build graph of a project that tools ask frequently.
+// The indexes that are not part of the build graph anyway are set up lazily, for the products
+// that a query is about. A BuildGraphQuery must not be used anymore once the build graph
+// has changed.
+// In all functions, an empty product list means all enabled products.
+class BuildGraphQuery
+{
+public:
+    BuildGraphQuery(TopLevelProjectConstPtr project);
+
+    // The artifacts that have the given file as an input or as a dependency found by a scanner.
+    std::vector<const Artifact *> dependents(const QString &filePath, bool recursive,
+                                             const QVector<ResolvedProductPtr> &products);
+
+    // The generated artifact with the given file path, or null if there is none.
+    const Artifact *generatedArtifact(const QString &filePath) const;
+
+    std::vector<const Artifact *> artifactsWithFileTag(
+            const FileTag &fileTag, const QVector<ResolvedProductPtr> &products) const;
+
+    // The generated artifacts that the next build would likely update. This is based on
+    // timestamps only, so it does not know about changed commands and the like.
+    std::vector<const Artifact *> staleArtifacts(const QVector<ResolvedProductPtr> &products);
+
+private:
+    QVector<ResolvedProductPtr> productsOrAll(const QVector<ResolvedProductPtr> &products) const;
+    void indexFileDependencies(const QVector<ResolvedProductPtr> &products);
+    bool isStale(const Artifact *artifact);
+    bool hasChanged(const Artifact *sourceArtifact);
+    FileTime currentTimestamp(const QString &filePath);
+
+    const TopLevelProjectConstPtr m_project;
+    Set<const ResolvedProduct *> m_productsWithIndexedFileDependencies;
+    std::unordered_map<const FileDependency *, std::vector<const Artifact *>>
+            m_dependentsOfFileDependency;
+    std::unordered_map<const Artifact *, bool> m_staleness;
+    QHash<QString, FileTime> m_currentTimestamps;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_BUILDGRAPHQUERY_H
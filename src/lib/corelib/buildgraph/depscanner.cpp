@@ -58,6 +58,8 @@
 
 #include <QtScript/qscriptcontext.h>
 
+#include <algorithm>
+
 namespace qbs {
 namespace Internal {
 
@@ -68,6 +70,25 @@ QString DependencyScanner::id() const
     return m_id;
 }
 
+// An imported module is provided either by the importing product itself or by one of the
+// products it depends on, each of which keeps its compiled module interfaces in its own directory.
+static QStringList cxxModuleDirectories(const Artifact *artifact, const QString &ownDirectory)
+{
+    QStringList directories{ownDirectory};
+    for (const ResolvedProductPtr &dependency : artifact->product->dependencies) {
+        if (!dependency->moduleProperties->moduleProperty(
+                    StringConstants::cppModule(), QStringLiteral("enableCxxModules")).toBool()) {
+            continue;
+        }
+        const QString directory = dependency->moduleProperties->moduleProperty(
+                    StringConstants::cppModule(),
+                    QStringLiteral("compiledModulesDirectory")).toString();
+        if (!directory.isEmpty() && !directories.contains(directory))
+            directories << directory;
+    }
+    return directories;
+}
+
 static QStringList collectCppIncludePaths(const QVariantMap &modules)
 {
     QStringList result;
@@ -88,6 +109,81 @@ static QStringList collectCppIncludePaths(const QVariantMap &modules)
     return result;
 }
 
+// Predefined macros whose values can be changed by compiler flags, which the compiler probe
+// did not see.
+static bool dependsOnCompilerFlags(const QString &macroName)
+{
+    static const QStringList names{
+        QStringLiteral("__cplusplus"), QStringLiteral("__STDC_VERSION__"),
+        QStringLiteral("_MSVC_LANG"), QStringLiteral("__STRICT_ANSI__"),
+        QStringLiteral("__OPTIMIZE__"), QStringLiteral("__OPTIMIZE_SIZE__"),
+        QStringLiteral("__NO_INLINE__"), QStringLiteral("__PIC__"), QStringLiteral("__pic__"),
+        QStringLiteral("__PIE__"), QStringLiteral("__pie__"), QStringLiteral("_OPENMP"),
+        QStringLiteral("__EXCEPTIONS"), QStringLiteral("__GXX_RTTI"), QStringLiteral("_CPPRTTI"),
+        QStringLiteral("_CPPUNWIND"), QStringLiteral("_DEBUG"), QStringLiteral("_DLL"),
+        QStringLiteral("_MT"), QStringLiteral("_GNU_SOURCE"), QStringLiteral("__FAST_MATH__"),
+        QStringLiteral("__CHAR_UNSIGNED__"), QStringLiteral("_CHAR_UNSIGNED"),
+    };
+    static const QStringList prefixes{
+        QStringLiteral("__cpp_"), QStringLiteral("__SSE"), QStringLiteral("__AVX"),
+        QStringLiteral("__ARM_"), QStringLiteral("__SANITIZE_"), QStringLiteral("__GCC_HAVE_"),
+        QStringLiteral("__GNUC_GNU_INLINE"), QStringLiteral("__GNUC_STDC_INLINE"),
+        QStringLiteral("__FMA"), QStringLiteral("__BMI"), QStringLiteral("__F16C"),
+        QStringLiteral("__POPCNT"), QStringLiteral("__AES"), QStringLiteral("__PCLMUL"),
+        QStringLiteral("__SHA"), QStringLiteral("__XSAVE"), QStringLiteral("__MMX"),
+    };
+    return names.contains(macroName)
+            || std::any_of(prefixes.cbegin(), prefixes.cend(), [&macroName](const QString &p) {
+        return macroName.startsWith(p);
+    });
+}
+
+// Macros that identify the platform and the toolchain. Only compilers define these, so if the
+// compiler probe did not report one of them, it is safe to assume that it is not defined.
+static const QStringList &toolchainIdentificationMacros()
+{
+    static const QStringList names{
+        QStringLiteral("_WIN32"), QStringLiteral("_WIN64"), QStringLiteral("__CYGWIN__"),
+        QStringLiteral("__MINGW32__"), QStringLiteral("__MINGW64__"), QStringLiteral("__APPLE__"),
+        QStringLiteral("__MACH__"), QStringLiteral("__linux__"), QStringLiteral("__linux"),
+        QStringLiteral("__gnu_linux__"), QStringLiteral("__ANDROID__"),
+        QStringLiteral("__FreeBSD__"), QStringLiteral("__NetBSD__"),
+        QStringLiteral("__OpenBSD__"), QStringLiteral("__DragonFly__"), QStringLiteral("__sun"),
+        QStringLiteral("__HAIKU__"), QStringLiteral("__QNX__"), QStringLiteral("__QNXNTO__"),
+        QStringLiteral("__EMSCRIPTEN__"), QStringLiteral("__unix__"), QStringLiteral("__unix"),
+        QStringLiteral("_MSC_VER"), QStringLiteral("__clang__"), QStringLiteral("__GNUC__"),
+        QStringLiteral("__INTEL_COMPILER"), QStringLiteral("__IAR_SYSTEMS_ICC__"),
+        QStringLiteral("__CC_ARM"), QStringLiteral("__ARMCC_VERSION"), QStringLiteral("__SDCC"),
+    };
+    return names;
+}
+
+// The key of the language in cpp.compilerDefinesByLanguage.
+static QString languageForFileTags(const FileTags &fileTags)
+{
+    static const std::pair<FileTag, QString> languages[] = {
+        {"objcpp", QStringLiteral("objcpp")}, {"objcpp_pch_src", QStringLiteral("objcpp")},
+        {"cpp", QStringLiteral("cpp")}, {"cpp_pch_src", QStringLiteral("cpp")},
+        {"objc", QStringLiteral("objc")}, {"objc_pch_src", QStringLiteral("objc")},
+        {"c", QStringLiteral("c")}, {"c_pch_src", QStringLiteral("c")},
+    };
+    for (const auto &language : languages) {
+        if (fileTags.contains(language.first))
+            return language.second;
+    }
+    return {};
+}
+
+static QString macroDefinition(const QString &nameAndParameters, const QString &value)
+{
+    return QStringLiteral("#define ") + nameAndParameters + QLatin1Char(' ') + value;
+}
+
+static QString macroName(const QString &nameAndParameters)
+{
+    return nameAndParameters.left(nameAndParameters.indexOf(QLatin1Char('(')));
+}
+
 PluginDependencyScanner::PluginDependencyScanner(ScannerPlugin *plugin)
     : m_plugin(plugin)
 {
@@ -100,16 +196,26 @@ QStringList PluginDependencyScanner::collectSearchPaths(Artifact *artifact)
     return {};
 }
 
-QStringList PluginDependencyScanner::collectDependencies(Artifact *artifact, FileResourceBase *file,
-                                                         const char *fileTags)
+void PluginDependencyScanner::collectDependencies(Artifact *artifact, FileResourceBase *file,
+                                                  const char *fileTags,
+                                                  RawScanResult *scanResult)
 {
-    Q_UNUSED(artifact);
     Set<QString> result;
+    Set<QString> moduleResult;
     QString baseDirOfInFilePath = file->dirPath();
     const QString &filepath = file->filePath();
-    void *scannerHandle = m_plugin->open(filepath.utf16(), fileTags, ScanForDependenciesFlag);
+    const MacroEnvironment &environment = macroEnvironment(artifact);
+    const CxxModulesSetup modules = cxxModulesSetup(artifact->properties);
+    const QStringList moduleDirectories = modules.isEnabled
+            ? cxxModuleDirectories(artifact, modules.directory) : QStringList();
+    const int openFlags = modules.isEnabled
+            ? ScanForDependenciesFlag | ScanForModulesFlag : ScanForDependenciesFlag;
+    void *scannerHandle = environment.isEnabled
+            ? m_plugin->openConditional(filepath.utf16(), fileTags, openFlags,
+                                        environment.definitions.constData())
+            : m_plugin->open(filepath.utf16(), fileTags, openFlags);
     if (!scannerHandle)
-        return {};
+        return;
     forever {
         int flags = 0;
         int length = 0;
@@ -119,6 +225,15 @@ QStringList PluginDependencyScanner::collectDependencies(Artifact *artifact, Fil
         QString outFilePath = QString::fromLocal8Bit(szOutFilePath, length);
         if (outFilePath.isEmpty())
             continue;
+        if (flags & SC_MODULE_IMPORT_FLAG) {
+            // Partitions are stored like "module-partition", as GCC and clang do by default.
+            // Candidates that do not exist do not get resolved later on.
+            const QString fileName = outFilePath.replace(QLatin1Char(':'), QLatin1Char('-'))
+                    + modules.suffix;
+            for (const QString &directory : moduleDirectories)
+                moduleResult += directory + QLatin1Char('/') + fileName;
+            continue;
+        }
         if (flags & SC_LOCAL_INCLUDE_FLAG) {
             QString localFilePath = FileInfo::resolvePath(baseDirOfInFilePath, outFilePath);
             if (FileInfo::exists(localFilePath))
@@ -126,8 +241,19 @@ QStringList PluginDependencyScanner::collectDependencies(Artifact *artifact, Fil
         }
         result += outFilePath;
     }
+    if (environment.isEnabled) {
+        int count = 0;
+        const char ** const macroNames = m_plugin->conditionMacros(scannerHandle, &count);
+        for (int i = 0; i < count; ++i) {
+            const QString name = QString::fromLatin1(macroNames[i]);
+            scanResult->conditionMacros.emplace_back(name, environment.macros.value(name));
+        }
+    }
     m_plugin->close(scannerHandle);
-    return result.toList();
+    for (const QString &dependency : result)
+        scanResult->deps.emplace_back(dependency);
+    for (const QString &moduleDependency : moduleResult)
+        scanResult->moduleDeps.emplace_back(moduleDependency);
 }
 
 bool PluginDependencyScanner::recursive() const
@@ -148,10 +274,90 @@ QString PluginDependencyScanner::createId() const
 bool PluginDependencyScanner::areModulePropertiesCompatible(const PropertyMapConstPtr &m1,
                                                             const PropertyMapConstPtr &m2) const
 {
-    // This changes when our C++ scanner starts taking defines into account.
-    Q_UNUSED(m1);
-    Q_UNUSED(m2);
-    return true;
+    // Apart from these, only the macros matter, which are checked separately.
+    return evaluatesIncludeConditions(m1) == evaluatesIncludeConditions(m2)
+            && cxxModulesSetup(m1) == cxxModulesSetup(m2);
+}
+
+bool PluginDependencyScanner::areConditionMacrosCompatible(const ConditionMacros &conditionMacros,
+                                                           const Artifact *artifact)
+{
+    if (conditionMacros.empty())
+        return true;
+    const MacroEnvironment &environment = macroEnvironment(artifact);
+    return std::all_of(conditionMacros.cbegin(), conditionMacros.cend(),
+                       [&environment](const std::pair<QString, QString> &macro) {
+        return environment.macros.value(macro.first) == macro.second;
+    });
+}
+
+bool PluginDependencyScanner::evaluatesIncludeConditions(
+        const PropertyMapConstPtr &properties) const
+{
+    return m_plugin->openConditional && m_plugin->conditionMacros
+            && properties->moduleProperty(StringConstants::cppModule(),
+                                          QStringLiteral("evaluateIncludeConditions")).toBool();
+}
+
+PluginDependencyScanner::CxxModulesSetup PluginDependencyScanner::cxxModulesSetup(
+        const PropertyMapConstPtr &properties) const
+{
+    CxxModulesSetup setup;
+    const QVariantMap cpp = properties->value().value(StringConstants::cppModule()).toMap();
+    setup.directory = cpp.value(QStringLiteral("compiledModulesDirectory")).toString();
+    setup.suffix = cpp.value(QStringLiteral("compiledModuleSuffix")).toString();
+    setup.isEnabled = (m_plugin->flags & ScannerUsesCppIncludePaths)
+            && cpp.value(QStringLiteral("enableCxxModules")).toBool()
+            && !setup.directory.isEmpty() && !setup.suffix.isEmpty();
+    return setup;
+}
+
+// The macros that the compiler sees for the given artifact: The ones from cpp.defines and
+// cpp.platformDefines, as well as those predefined by the compiler for the respective language,
+// except for the ones that can be influenced by compiler flags. Other macros might get defined
+// by previously included headers, so they are unknown.
+const PluginDependencyScanner::MacroEnvironment &PluginDependencyScanner::macroEnvironment(
+        const Artifact *artifact)
+{
+    const QString language = languageForFileTags(artifact->fileTags());
+    const std::pair<PropertyMapConstPtr, QString> key(artifact->properties, language);
+    const auto it = m_macroEnvironments.find(key);
+    if (it != m_macroEnvironments.cend())
+        return it->second;
+
+    MacroEnvironment &environment = m_macroEnvironments[key];
+    if (!evaluatesIncludeConditions(artifact->properties))
+        return environment;
+    environment.isEnabled = true;
+
+    const QVariantMap cpp = artifact->properties->value()
+            .value(StringConstants::cppModule()).toMap();
+    const QVariantMap compilerDefines = cpp.value(QStringLiteral("compilerDefinesByLanguage"))
+            .toMap().value(language).toMap();
+    for (auto macro = compilerDefines.cbegin(); macro != compilerDefines.cend(); ++macro) {
+        const QString name = macroName(macro.key());
+        if (!dependsOnCompilerFlags(name))
+            environment.macros.insert(name, macroDefinition(macro.key(), macro.value().toString()));
+    }
+    if (!compilerDefines.empty()) {
+        for (const QString &name : toolchainIdentificationMacros()) {
+            if (!environment.macros.contains(name))
+                environment.macros.insert(name, QStringLiteral("#undef ") + name);
+        }
+    }
+    const QStringList defines = cpp.value(QStringLiteral("platformDefines")).toStringList()
+            + cpp.value(QStringLiteral("defines")).toStringList();
+    for (const QString &define : defines) {
+        const int equalsPos = define.indexOf(QLatin1Char('='));
+        const QString nameAndParameters = define.left(equalsPos);
+        environment.macros.insert(macroName(nameAndParameters),
+                                  macroDefinition(nameAndParameters, equalsPos == -1
+                                                  ? QStringLiteral("1")
+                                                  : define.mid(equalsPos + 1)));
+    }
+    for (const QString &definition : qAsConst(environment.macros))
+        environment.definitions += definition.toLocal8Bit() + '\n';
+    return environment;
 }
 
 UserDependencyScanner::UserDependencyScanner(ResolvedScannerConstPtr scanner,
@@ -171,11 +377,13 @@ QStringList UserDependencyScanner::collectSearchPaths(Artifact *artifact)
     return evaluate(artifact, nullptr, m_scanner->searchPathsScript);
 }
 
-QStringList UserDependencyScanner::collectDependencies(Artifact *artifact, FileResourceBase *file,
-                                                       const char *fileTags)
+void UserDependencyScanner::collectDependencies(Artifact *artifact, FileResourceBase *file,
+                                                const char *fileTags,
+                                                RawScanResult *scanResult)
 {
     Q_UNUSED(fileTags);
-    return evaluate(artifact, file, m_scanner->scanScript);
+    for (const QString &dependency : evaluate(artifact, file, m_scanner->scanScript))
+        scanResult->deps.emplace_back(dependency);
 }
 
 bool UserDependencyScanner::recursive() const
@@ -202,6 +410,14 @@ bool UserDependencyScanner::areModulePropertiesCompatible(const PropertyMapConst
     return m1 == m2 || *m1 == *m2;
 }
 
+bool UserDependencyScanner::areConditionMacrosCompatible(const ConditionMacros &conditionMacros,
+                                                         const Artifact *artifact)
+{
+    Q_UNUSED(conditionMacros);
+    Q_UNUSED(artifact);
+    return true;
+}
+
 class ScriptEngineActiveFlagGuard
 {
     ScriptEngine *m_engine;
@@ -40,14 +40,20 @@
 #ifndef QBS_DEPENDENCY_SCANNER_H
 #define QBS_DEPENDENCY_SCANNER_H
 
+#include "rawscanresults.h"
+
 #include <language/forward_decls.h>
 #include <language/filetags.h>
 #include <language/preparescriptobserver.h>
 
+#include <QtCore/qhash.h>
 #include <QtCore/qstringlist.h>
 
 #include <QtScript/qscriptvalue.h>
 
+#include <map>
+#include <utility>
+
 class ScannerPlugin;
 
 namespace qbs {
@@ -66,12 +72,14 @@ public:
     QString id() const;
 
     virtual QStringList collectSearchPaths(Artifact *artifact) = 0;
-    virtual QStringList collectDependencies(Artifact *artifact, FileResourceBase *file,
-                                            const char *fileTags) = 0;
+    virtual void collectDependencies(Artifact *artifact, FileResourceBase *file,
+                                     const char *fileTags, RawScanResult *scanResult) = 0;
     virtual bool recursive() const = 0;
     virtual const void *key() const = 0;
     virtual bool areModulePropertiesCompatible(const PropertyMapConstPtr &m1,
                                                const PropertyMapConstPtr &m2) const = 0;
+    virtual bool areConditionMacrosCompatible(const ConditionMacros &conditionMacros,
+                                              const Artifact *artifact) = 0;
     virtual bool cacheIsPerFile() const = 0;
 
 private:
@@ -87,16 +95,45 @@ public:
 
 private:
     QStringList collectSearchPaths(Artifact *artifact) override;
-    QStringList collectDependencies(Artifact *artifact, FileResourceBase *file,
-                                    const char *fileTags) override;
+    void collectDependencies(Artifact *artifact, FileResourceBase *file,
+                             const char *fileTags, RawScanResult *scanResult) override;
     bool recursive() const override;
     const void *key() const override;
     QString createId() const override;
     bool areModulePropertiesCompatible(const PropertyMapConstPtr &m1,
                                        const PropertyMapConstPtr &m2) const override;
+    bool areConditionMacrosCompatible(const ConditionMacros &conditionMacros,
+                                      const Artifact *artifact) override;
     bool cacheIsPerFile() const override { return false; }
 
+    // Where the product stores its compiled C++ module interfaces. As the directory differs
+    // between products, scan results with module imports are never shared across products.
+    struct CxxModulesSetup
+    {
+        bool isEnabled = false;
+        QString directory;
+        QString suffix;
+
+        bool operator==(const CxxModulesSetup &other) const
+        {
+            return isEnabled == other.isEnabled && directory == other.directory
+                    && suffix == other.suffix;
+        }
+    };
+    CxxModulesSetup cxxModulesSetup(const PropertyMapConstPtr &properties) const;
+
+    // What the scanner knows about the macros when evaluating preprocessor conditions.
+    struct MacroEnvironment
+    {
+        bool isEnabled = false;
+        QByteArray definitions; // In the format expected by the scanner plugin.
+        QHash<QString, QString> macros;
+    };
+    const MacroEnvironment &macroEnvironment(const Artifact *artifact);
+    bool evaluatesIncludeConditions(const PropertyMapConstPtr &properties) const;
+
     ScannerPlugin* m_plugin;
+    std::map<std::pair<PropertyMapConstPtr, QString>, MacroEnvironment> m_macroEnvironments;
 };
 
 class UserDependencyScanner : public DependencyScanner
@@ -106,13 +143,15 @@ public:
 
 private:
     QStringList collectSearchPaths(Artifact *artifact) override;
-    QStringList collectDependencies(Artifact *artifact, FileResourceBase *file,
-                                    const char *fileTags) override;
+    void collectDependencies(Artifact *artifact, FileResourceBase *file,
+                             const char *fileTags, RawScanResult *scanResult) override;
     bool recursive() const override;
     const void *key() const override;
     QString createId() const override;
     bool areModulePropertiesCompatible(const PropertyMapConstPtr &m1,
                                        const PropertyMapConstPtr &m2) const override;
+    bool areConditionMacrosCompatible(const ConditionMacros &conditionMacros,
+                                      const Artifact *artifact) override;
     bool cacheIsPerFile() const override { return true; }
 
     QStringList evaluate(const Artifact *artifact, const FileResourceBase *fileToScan, const PrivateScriptFunction &script);
@@ -46,6 +46,9 @@
 #include "cycledetector.h"
 #include "executorjob.h"
 #include "inputartifactscanner.h"
+#include "jobtokenbroker.h"
+#include "jscommandexecutor.h"
+#include "processoutputworker.h"
 #include "productinstaller.h"
 #include "rescuableartifactdata.h"
 #include "rulecommands.h"
@@ -66,6 +69,7 @@
 #include <tools/progressobserver.h>
 #include <tools/qbsassert.h>
 #include <tools/qttools.h>
+#include <tools/remoteexecutionclient.h>
 #include <tools/settings.h>
 #include <tools/stringconstants.h>
 
@@ -102,6 +106,8 @@ Executor::Executor(Logger logger, QObject *parent)
 
 Executor::~Executor()
 {
+    detachFromJobTokenBroker();
+
     // jobs must be destroyed before deleting the m_inputArtifactScanContext
     m_allJobs.clear();
     delete m_inputArtifactScanContext;
@@ -148,6 +154,7 @@ void Executor::retrieveSourceFileTimestamp(Artifact *artifact) const
 
 void Executor::build()
 {
+    startProfiling();
     try {
         m_partialBuild = size_t(m_productsToBuild.size()) != m_allProducts.size();
         doBuild();
@@ -230,6 +237,7 @@ void Executor::doBuild()
     m_productsOfFilesToConsider.clear();
     m_artifactsRemovedFromDisk.clear();
     m_jobCountPerPool.clear();
+    m_reservedMemory = 0;
 
     setupJobLimits();
 
@@ -267,6 +275,10 @@ void Executor::doBuild()
 
     m_elapsedTimeRules = m_elapsedTimeScanners = m_elapsedTimeInstalling = 0;
     m_evalContext->engine()->enableProfiling(m_buildOptions.logElapsedTime());
+    if (m_buildOptions.parallelPrepareScripts()) {
+        m_evalContext->setPrepareScriptWorkerCount(
+                    std::min(m_buildOptions.maxJobCount(), BuildOptions::defaultMaxJobCount()));
+    }
 
     InstallOptions installOptions;
     installOptions.setDryRun(m_buildOptions.dryRun());
@@ -278,6 +290,23 @@ void Executor::doBuild()
     if (m_buildOptions.removeExistingInstallation())
         m_productInstaller->removeInstallRoot();
 
+    if (!m_buildOptions.remoteWorker().isEmpty()) {
+        m_remoteExecutionClient = std::make_unique<RemoteExecutionClient>();
+        m_remoteExecutionClient->connectToWorker(m_buildOptions.remoteWorker(),
+                                                 m_buildOptions.remoteWorkerToken());
+    }
+
+    // At most two results per job can be in flight; everything beyond that is handled
+    // synchronously, which naturally throttles the executor if the worker falls behind.
+    m_processOutputWorker = std::make_unique<ProcessOutputWorker>(
+                m_logger, 2 * m_buildOptions.maxJobCount());
+    m_jsCommandCostModel = std::make_unique<JsCommandCostModel>();
+
+    // Executors building other configurations in parallel draw from the same token budget.
+    JobTokenBroker::instance().attach(m_buildOptions.maxJobCount(),
+                                      m_buildOptions.provideJobserver());
+    m_attachedToJobTokenBroker = true;
+
     addExecutorJobs();
     syncFileDependencies();
     prepareAllNodes();
@@ -347,7 +376,8 @@ bool Executor::scheduleJobs()
 {
     QBS_CHECK(m_state == ExecutorRunning);
     std::vector<BuildGraphNode *> delayedLeaves;
-    while (!m_leaves.empty() && !m_availableJobs.empty()) {
+    bool outOfJobTokens = false;
+    while (!outOfJobTokens && !m_leaves.empty() && !m_availableJobs.empty()) {
         BuildGraphNode * const nodeToBuild = m_leaves.top();
         m_leaves.pop();
 
@@ -361,9 +391,15 @@ bool Executor::scheduleJobs()
             //       don't know whether the transformer needs to run at all. Investigate
             //       moving the whole job allocation logic to runTransformer().
             if (schedulingBlockedByJobLimit(nodeToBuild)) {
-                qCDebug(lcExec).noquote() << "node delayed due to occupied job pool:"
+                qCDebug(lcExec).noquote() << "node delayed due to occupied job pool "
+                                             "or exhausted memory budget:"
+                                          << nodeToBuild->toString();
+                delayedLeaves.push_back(nodeToBuild);
+            } else if (!reserveJobToken()) {
+                qCDebug(lcExec).noquote() << "node delayed due to lack of job tokens:"
                                           << nodeToBuild->toString();
                 delayedLeaves.push_back(nodeToBuild);
+                outOfJobTokens = true;
             } else {
                 nodeToBuild->accept(this);
             }
@@ -380,9 +416,77 @@ bool Executor::scheduleJobs()
     }
     for (BuildGraphNode * const delayedLeaf : delayedLeaves)
         m_leaves.push(delayedLeaf);
+
+    // Nodes that turned out to be up to date did not need the token, so give it back for
+    // other configurations to use.
+    if (m_hasReservedJobToken) {
+        m_hasReservedJobToken = false;
+        JobTokenBroker::instance().release();
+    }
     return !m_leaves.empty() || !m_processingJobs.empty();
 }
 
+bool Executor::reserveJobToken()
+{
+    if (m_hasReservedJobToken)
+        return true;
+    JobTokenBroker &broker = JobTokenBroker::instance();
+    if (broker.tryAcquire()) {
+        m_hasReservedJobToken = true;
+        return true;
+    }
+    if (m_waitingForJobToken)
+        return false;
+    m_waitingForJobToken = true;
+    broker.waitForToken(this, [this] { onJobTokenAvailable(); });
+
+    // We do not get notified about tokens that other processes return to the jobserver.
+    if (broker.usesExternalJobserver())
+        QTimer::singleShot(50, this, &Executor::onJobTokenAvailable);
+    return false;
+}
+
+void Executor::onJobTokenAvailable()
+{
+    if (!m_waitingForJobToken)
+        return;
+    if (m_state != ExecutorRunning) {
+        m_waitingForJobToken = false;
+        return;
+    }
+    if (m_evalContext->engine()->isActive()) {
+        QTimer::singleShot(0, this, &Executor::onJobTokenAvailable);
+        return;
+    }
+    m_waitingForJobToken = false;
+    JobTokenBroker::instance().stopWaiting(this);
+    try {
+        if (!scheduleJobs()) {
+            qCDebug(lcExec) << "Nothing left to build; finishing.";
+            finish();
+        }
+    } catch (const ErrorInfo &error) {
+        handleError(error);
+    }
+}
+
+void Executor::detachFromJobTokenBroker()
+{
+    if (!m_attachedToJobTokenBroker)
+        return;
+    JobTokenBroker &broker = JobTokenBroker::instance();
+    broker.stopWaiting(this);
+    m_waitingForJobToken = false;
+    if (m_hasReservedJobToken) {
+        m_hasReservedJobToken = false;
+        broker.release();
+    }
+    for (int i = 0; i < m_processingJobs.size(); ++i) // Only when destroyed during a build.
+        broker.release();
+    broker.detach();
+    m_attachedToJobTokenBroker = false;
+}
+
 bool Executor::schedulingBlockedByJobLimit(const BuildGraphNode *node)
 {
     if (node->type() != BuildGraphNode::ArtifactNodeType)
@@ -392,6 +496,15 @@ bool Executor::schedulingBlockedByJobLimit(const BuildGraphNode *node)
         return false;
 
     const Transformer * const transformer = artifact->transformer.get();
+
+    // A job is always admitted if nothing else is running, so that a single transformer
+    // exceeding the budget on its own cannot stall the build.
+    const int memoryBudget = m_buildOptions.memoryBudget();
+    if (memoryBudget > 0 && m_reservedMemory > 0
+            && m_reservedMemory + transformer->expectedMemoryUsage() > memoryBudget) {
+        return true;
+    }
+
     for (const QString &jobPool : transformer->jobPools()) {
         const int currentJobCount = m_jobCountPerPool[jobPool];
         if (currentJobCount == 0)
@@ -528,6 +641,9 @@ void Executor::buildArtifact(Artifact *artifact)
 void Executor::executeRuleNode(RuleNode *ruleNode)
 {
     AccumulatingTimer rulesTimer(m_buildOptions.logElapsedTime() ? &m_elapsedTimeRules : nullptr);
+    ProfilingScope ruleScope("rule-application", [ruleNode] {
+        return ruleNode->rule()->toString();
+    });
 
     if (!checkNodeProduct(ruleNode))
         return;
@@ -563,7 +679,14 @@ void Executor::finishJob(ExecutorJob *job, bool success)
     const TransformerPtr transformer = it.value();
     m_processingJobs.erase(it);
     m_availableJobs.push_back(job);
+    if (m_attachedToJobTokenBroker)
+        JobTokenBroker::instance().release();
     updateJobCounts(transformer.get(), -1);
+
+    // Must happen after the reservation was released, as it changes the expected usage.
+    if (success && !m_buildOptions.dryRun() && job->peakMemoryUsage() > 0)
+        transformer->measuredMemoryUsage = job->peakMemoryUsage();
+
     if (success) {
         m_project->buildData->setDirty();
         for (Artifact * const artifact : qAsConst(transformer->outputs)) {
@@ -692,6 +815,24 @@ bool Executor::transformerHasMatchingInputFiles(const TransformerConstPtr &trans
     return false;
 }
 
+// The results of the tests that are not selected keep their state, so a later run
+// without a selection runs them if they are out of date.
+bool Executor::transformerRunsSelectedTests(const TransformerConstPtr &transformer) const
+{
+    const QStringList &testsToRun = m_buildOptions.testsToRun();
+    if (testsToRun.empty())
+        return true; // No filtering requested.
+    const bool producesTestResults = std::any_of(
+                transformer->outputs.cbegin(), transformer->outputs.cend(),
+                [](const Artifact *a) { return a->fileTags().contains("autotest-result"); });
+    if (!producesTestResults)
+        return true;
+    return std::any_of(transformer->inputs.cbegin(), transformer->inputs.cend(),
+                       [&testsToRun](const Artifact *input) {
+        return testsToRun.contains(input->product->name);
+    });
+}
+
 void Executor::setupJobLimits()
 {
     Settings settings(m_buildOptions.settingsDirectory());
@@ -714,6 +855,7 @@ void Executor::updateJobCounts(const Transformer *transformer, int diff)
 {
     for (const QString &jobPool : transformer->jobPools())
         m_jobCountPerPool[jobPool] += diff;
+    m_reservedMemory += diff * transformer->expectedMemoryUsage();
 }
 
 void Executor::cancelJobs()
@@ -770,7 +912,11 @@ void Executor::addExecutorJobs()
     for (int i = 1; i <= count; i++) {
         m_allJobs.push_back(std::make_unique<ExecutorJob>(m_logger));
         const auto job = m_allJobs.back().get();
+        if (m_remoteExecutionClient)
+            job->setRemoteExecutionClient(m_remoteExecutionClient.get());
         job->setMainThreadScriptEngine(m_evalContext->engine());
+        job->setProcessOutputWorker(m_processOutputWorker.get());
+        job->setJsCommandCostModel(m_jsCommandCostModel.get());
         job->setObjectName(QStringLiteral("J%1").arg(i));
         job->setDryRun(m_buildOptions.dryRun());
         job->setEchoMode(m_buildOptions.echoMode());
@@ -967,6 +1113,12 @@ void Executor::potentiallyRunTransformer(const TransformerPtr &transformer)
         return;
     }
 
+    if (!transformerRunsSelectedTests(transformer)) {
+        qCDebug(lcExec) << "test not selected. Skipping.";
+        finishTransformer(transformer);
+        return;
+    }
+
     const bool mustExecute = mustExecuteTransformer(transformer);
     if (mustExecute || m_buildOptions.forceTimestampCheck()) {
         for (Artifact * const output : qAsConst(transformer->outputs)) {
@@ -975,7 +1127,9 @@ void Executor::potentiallyRunTransformer(const TransformerPtr &transformer)
             InputArtifactScanner scanner(output, m_inputArtifactScanContext, m_logger);
             AccumulatingTimer scanTimer(m_buildOptions.logElapsedTime()
                                         ? &m_elapsedTimeScanners : nullptr);
+            ProfilingScope scanScope("dependency-scanning");
             scanner.scan();
+            scanScope.stop();
             scanTimer.stop();
             if (scanner.newDependencyAdded() && checkForUnbuiltDependencies(output))
                 return;
@@ -1010,6 +1164,8 @@ void Executor::runTransformer(const TransformerPtr &transformer)
     }
 
     QBS_CHECK(!m_availableJobs.empty());
+    QBS_CHECK(m_hasReservedJobToken);
+    m_hasReservedJobToken = false; // Returned to the broker in finishJob().
     ExecutorJob *job = m_availableJobs.takeFirst();
     for (Artifact * const artifact : qAsConst(transformer->outputs))
         artifact->buildState = BuildGraphNode::Building;
@@ -1039,6 +1195,7 @@ void Executor::possiblyInstallArtifact(const Artifact *artifact)
 {
     AccumulatingTimer installTimer(m_buildOptions.logElapsedTime()
                                    ? &m_elapsedTimeInstalling : nullptr);
+    ProfilingScope installScope("installing");
 
     if (m_buildOptions.install() && !m_buildOptions.executeRulesOnly()
             && (m_activeFileTags.empty() || artifactHasMatchingOutputTags(artifact))
@@ -1143,6 +1300,7 @@ void Executor::finish()
         m_error.append(Tr::tr("%1%2.").arg(message, configString()));
     }
     setState(ExecutorIdle);
+    detachFromJobTokenBroker();
     if (m_progressObserver) {
         m_progressObserver->setFinished();
         m_cancelationTimer->stop();
@@ -1160,9 +1318,26 @@ void Executor::finish()
                                              .arg(elapsedTimeString(m_elapsedTimeInstalling));
     }
 
+    stopProfiling();
     emit finished();
 }
 
+// The executor does its work in many event loop iterations, so the profiler stays active
+// in the executor's thread from the start of the build until it has finished.
+void Executor::startProfiling()
+{
+    if (!m_profiler)
+        return;
+    m_profilerActivation = std::make_unique<Profiler::Activation>(m_profiler);
+    m_buildScope = std::make_unique<ProfilingScope>("executing");
+}
+
+void Executor::stopProfiling()
+{
+    m_buildScope.reset();
+    m_profilerActivation.reset();
+}
+
 void Executor::checkForCancellation()
 {
     QBS_ASSERT(m_progressObserver, return);
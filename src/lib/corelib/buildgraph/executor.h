@@ -48,10 +48,12 @@
 #include <logging/logger.h>
 #include <tools/buildoptions.h>
 #include <tools/error.h>
+#include <tools/profiling.h>
 #include <tools/qttools.h>
 
 #include <QtCore/qobject.h>
 
+#include <memory>
 #include <queue>
 #include <unordered_map>
 
@@ -66,8 +68,11 @@ namespace Internal {
 class ExecutorJob;
 class FileTime;
 class InputArtifactScannerContext;
+class JsCommandCostModel;
+class ProcessOutputWorker;
 class ProductInstaller;
 class ProgressObserver;
+class RemoteExecutionClient;
 class RuleNode;
 
 class Executor : public QObject, private BuildGraphVisitor
@@ -84,6 +89,7 @@ public:
     void setProducts(const QVector<ResolvedProductPtr> &productsToBuild);
     void setBuildOptions(const BuildOptions &buildOptions);
     void setProgressObserver(ProgressObserver *observer) { m_progressObserver = observer; }
+    void setProfiler(Profiler *profiler) { m_profiler = profiler; }
 
     ErrorInfo error() const { return m_error; }
 
@@ -153,10 +159,17 @@ private:
     bool transformerHasMatchingOutputTags(const TransformerConstPtr &transformer) const;
     bool artifactHasMatchingOutputTags(const Artifact *artifact) const;
     bool transformerHasMatchingInputFiles(const TransformerConstPtr &transformer) const;
+    bool transformerRunsSelectedTests(const TransformerConstPtr &transformer) const;
 
     void setupJobLimits();
     void updateJobCounts(const Transformer *transformer, int diff);
     bool schedulingBlockedByJobLimit(const BuildGraphNode *node);
+    bool reserveJobToken();
+    void onJobTokenAvailable();
+    void detachFromJobTokenBroker();
+
+    void startProfiling();
+    void stopProfiling();
 
     using JobMap = QHash<ExecutorJob *, TransformerPtr>;
     JobMap m_processingJobs;
@@ -166,6 +179,9 @@ private:
     BuildOptions m_buildOptions;
     Logger m_logger;
     ProgressObserver *m_progressObserver;
+    std::unique_ptr<RemoteExecutionClient> m_remoteExecutionClient;
+    std::unique_ptr<ProcessOutputWorker> m_processOutputWorker;
+    std::unique_ptr<JsCommandCostModel> m_jsCommandCostModel;
     std::vector<std::unique_ptr<ExecutorJob>> m_allJobs;
     QList<ExecutorJob*> m_availableJobs;
     ExecutorState m_state;
@@ -175,6 +191,10 @@ private:
     std::unordered_map<QString, const ResolvedProduct *> m_productsByName;
     std::unordered_map<QString, const ResolvedProject *> m_projectsByName;
     std::unordered_map<QString, int> m_jobCountPerPool;
+    int m_reservedMemory = 0; // In MiB.
+    bool m_attachedToJobTokenBroker = false;
+    bool m_hasReservedJobToken = false;
+    bool m_waitingForJobToken = false;
     std::unordered_map<const ResolvedProduct *, JobLimits> m_jobLimitsPerProduct;
     std::unordered_map<const Rule *, int> m_pendingTransformersPerRule;
     NodeSet m_roots;
@@ -192,6 +212,9 @@ private:
     qint64 m_elapsedTimeRules = 0;
     qint64 m_elapsedTimeScanners = 0;
     qint64 m_elapsedTimeInstalling = 0;
+    Profiler *m_profiler = nullptr;
+    std::unique_ptr<Profiler::Activation> m_profilerActivation;
+    std::unique_ptr<ProfilingScope> m_buildScope;
 };
 
 } // namespace Internal
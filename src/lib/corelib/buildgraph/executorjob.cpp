@@ -42,6 +42,7 @@
 #include "artifact.h"
 #include "jscommandexecutor.h"
 #include "processcommandexecutor.h"
+#include "remotecommandexecutor.h"
 #include "rulecommands.h"
 #include "transformer.h"
 #include <language/language.h>
@@ -50,11 +51,14 @@
 
 #include <QtCore/qthread.h>
 
+#include <algorithm>
+
 namespace qbs {
 namespace Internal {
 
 ExecutorJob::ExecutorJob(const Logger &logger, QObject *parent)
     : QObject(parent)
+    , m_logger(logger)
     , m_processCommandExecutor(new ProcessCommandExecutor(logger, this))
     , m_jsCommandExecutor(new JsCommandExecutor(logger, this))
 {
@@ -73,22 +77,53 @@ ExecutorJob::ExecutorJob(const Logger &logger, QObject *parent)
 
 ExecutorJob::~ExecutorJob() = default;
 
+// Must be called before the other setters.
+void ExecutorJob::setRemoteExecutionClient(RemoteExecutionClient *client)
+{
+    QBS_ASSERT(!m_remoteCommandExecutor, return);
+    m_remoteCommandExecutor = new RemoteCommandExecutor(m_logger, client, this);
+    connect(m_remoteCommandExecutor, &AbstractCommandExecutor::reportCommandDescription,
+            this, &ExecutorJob::reportCommandDescription);
+    connect(m_remoteCommandExecutor, &ProcessCommandExecutor::reportProcessResult,
+            this, &ExecutorJob::reportProcessResult);
+    connect(m_remoteCommandExecutor, &AbstractCommandExecutor::finished,
+            this, &ExecutorJob::onCommandFinished);
+}
+
 void ExecutorJob::setMainThreadScriptEngine(ScriptEngine *engine)
 {
     m_processCommandExecutor->setMainThreadScriptEngine(engine);
     m_jsCommandExecutor->setMainThreadScriptEngine(engine);
+    if (m_remoteCommandExecutor)
+        m_remoteCommandExecutor->setMainThreadScriptEngine(engine);
+}
+
+void ExecutorJob::setProcessOutputWorker(ProcessOutputWorker *worker)
+{
+    m_processCommandExecutor->setOutputWorker(worker);
+    if (m_remoteCommandExecutor)
+        m_remoteCommandExecutor->setOutputWorker(worker);
+}
+
+void ExecutorJob::setJsCommandCostModel(JsCommandCostModel *costModel)
+{
+    m_jsCommandExecutor->setCostModel(costModel);
 }
 
 void ExecutorJob::setDryRun(bool enabled)
 {
     m_processCommandExecutor->setDryRunEnabled(enabled);
     m_jsCommandExecutor->setDryRunEnabled(enabled);
+    if (m_remoteCommandExecutor)
+        m_remoteCommandExecutor->setDryRunEnabled(enabled);
 }
 
 void ExecutorJob::setEchoMode(CommandEchoMode echoMode)
 {
     m_processCommandExecutor->setEchoMode(echoMode);
     m_jsCommandExecutor->setEchoMode(echoMode);
+    if (m_remoteCommandExecutor)
+        m_remoteCommandExecutor->setEchoMode(echoMode);
 }
 
 void ExecutorJob::run(Transformer *t)
@@ -110,8 +145,13 @@ void ExecutorJob::run(Transformer *t)
     QBS_CHECK(!t->outputs.empty());
     m_processCommandExecutor->setProcessEnvironment(
                 (*t->outputs.cbegin())->product->buildEnvironment);
+    if (m_remoteCommandExecutor) {
+        m_remoteCommandExecutor->setProcessEnvironment(
+                    (*t->outputs.cbegin())->product->buildEnvironment);
+    }
     m_transformer = t;
     m_jobPools = t->jobPools();
+    m_peakMemoryUsage = 0;
     runNextCommand();
 }
 
@@ -135,7 +175,10 @@ void ExecutorJob::runNextCommand()
     const AbstractCommandPtr &command = m_transformer->commands.commandAt(m_currentCommandIdx);
     switch (command->type()) {
     case AbstractCommand::ProcessCommandType:
-        m_currentCommandExecutor = m_processCommandExecutor;
+        if (m_remoteCommandExecutor && RemoteCommandExecutor::canRunRemotely(command.get()))
+            m_currentCommandExecutor = m_remoteCommandExecutor;
+        else
+            m_currentCommandExecutor = m_processCommandExecutor;
         break;
     case AbstractCommand::JavaScriptCommandType:
         m_currentCommandExecutor = m_jsCommandExecutor;
@@ -156,6 +199,11 @@ void ExecutorJob::onCommandFinished(const ErrorInfo &err)
         m_error = err;
         setFinished();
     } else {
+        if (m_currentCommandExecutor == m_processCommandExecutor) {
+            const qint64 mib = 1024 * 1024;
+            const qint64 peak = (m_processCommandExecutor->peakMemoryUsage() + mib - 1) / mib;
+            m_peakMemoryUsage = std::max(m_peakMemoryUsage, int(peak));
+        }
         runNextCommand();
     }
 }
@@ -41,6 +41,7 @@
 #define QBS_EXECUTORJOB_H
 
 #include <language/forward_decls.h>
+#include <logging/logger.h>
 #include <tools/commandechomode.h>
 #include <tools/error.h>
 #include <tools/set.h>
@@ -55,9 +56,12 @@ class ProcessResult;
 namespace Internal {
 class AbstractCommandExecutor;
 class ProductBuildData;
+class JsCommandCostModel;
 class JsCommandExecutor;
-class Logger;
 class ProcessCommandExecutor;
+class ProcessOutputWorker;
+class RemoteCommandExecutor;
+class RemoteExecutionClient;
 class ScriptEngine;
 class Transformer;
 
@@ -68,13 +72,17 @@ public:
     explicit ExecutorJob(const Logger &logger, QObject *parent = nullptr);
     ~ExecutorJob() override;
 
+    void setRemoteExecutionClient(RemoteExecutionClient *client);
     void setMainThreadScriptEngine(ScriptEngine *engine);
+    void setProcessOutputWorker(ProcessOutputWorker *worker);
+    void setJsCommandCostModel(JsCommandCostModel *costModel);
     void setDryRun(bool enabled);
     void setEchoMode(CommandEchoMode echoMode);
     void run(Transformer *t);
     void cancel();
     const Transformer *transformer() const { return m_transformer; }
     Set<QString> jobPools() const { return m_jobPools; }
+    int peakMemoryUsage() const { return m_peakMemoryUsage; } // In MiB, zero if unknown.
 
 signals:
     void reportCommandDescription(const QString &highlight, const QString &message);
@@ -88,12 +96,15 @@ private:
     void setFinished();
     void reset();
 
+    const Logger m_logger;
     AbstractCommandExecutor *m_currentCommandExecutor = nullptr;
     ProcessCommandExecutor *m_processCommandExecutor = nullptr;
+    RemoteCommandExecutor *m_remoteCommandExecutor = nullptr;
     JsCommandExecutor *m_jsCommandExecutor = nullptr;
     Transformer *m_transformer = nullptr;
     Set<QString> m_jobPools;
     int m_currentCommandIdx = 0;
+    int m_peakMemoryUsage = 0;
     ErrorInfo m_error;
 };
 
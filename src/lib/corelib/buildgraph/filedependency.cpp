@@ -61,24 +61,34 @@ const FileTime &FileResourceBase::timestamp() const
 
 void FileResourceBase::setFilePath(const QString &filePath)
 {
-    m_filePath = filePath;
-    FileInfo::splitIntoDirectoryAndFileName(m_filePath, &m_dirPath, &m_fileName);
+    QString dirPath;
+    QString fileName;
+    FileInfo::splitIntoDirectoryAndFileName(filePath, &dirPath, &fileName);
+    m_dirPath = PathAtom::intern(dirPath);
+    m_fileName = PathAtom::intern(fileName);
 }
 
-const QString &FileResourceBase::filePath() const
+QString FileResourceBase::filePath() const
 {
-    return m_filePath;
+    // The directory part is empty for files in the root directory.
+    const QString &dirPath = m_dirPath.toString();
+    const QString &fileName = m_fileName.toString();
+    QString filePath;
+    filePath.reserve(dirPath.size() + 1 + fileName.size());
+    filePath.append(dirPath).append(QLatin1Char('/')).append(fileName);
+    return filePath;
 }
 
 void FileResourceBase::load(PersistentPool &pool)
 {
-    serializationOp<PersistentPool::Load>(pool);
-    FileInfo::splitIntoDirectoryAndFileName(m_filePath, &m_dirPath, &m_fileName);
+    setFilePath(pool.load<QString>());
+    pool.load(m_timestamp);
 }
 
 void FileResourceBase::store(PersistentPool &pool)
 {
-    serializationOp<PersistentPool::Store>(pool);
+    pool.store(filePath());
+    pool.store(m_timestamp);
 }
 
 
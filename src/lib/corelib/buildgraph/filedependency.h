@@ -41,12 +41,14 @@
 #define QBS_FILEDEPENDENCY_H
 
 #include <tools/filetime.h>
+#include <tools/pathatom.h>
 #include <tools/persistence.h>
+#include <tools/slaballocator.h>
 
 namespace qbs {
 namespace Internal {
 
-class FileResourceBase
+class FileResourceBase : public SlabAllocated
 {
 protected:
     FileResourceBase();
@@ -61,24 +63,21 @@ public:
     const FileTime &timestamp() const;
     void clearTimestamp() { m_timestamp.clear(); }
 
+    // File paths are absolute. Only the directory and the file name are stored.
     void setFilePath(const QString &filePath);
-    const QString &filePath() const;
-    QString dirPath() const { return m_dirPath.toString(); }
-    QString fileName() const { return m_fileName.toString(); }
+    QString filePath() const;
+    const QString &dirPath() const { return m_dirPath.toString(); }
+    const QString &fileName() const { return m_fileName.toString(); }
+    const PathAtom &dirPathAtom() const { return m_dirPath; }
+    const PathAtom &fileNameAtom() const { return m_fileName; }
 
     virtual void load(PersistentPool &pool);
     virtual void store(PersistentPool &pool);
 
 private:
-    template<PersistentPool::OpType opType> void serializationOp(PersistentPool &pool)
-    {
-        pool.serializationOp<opType>(m_filePath, m_timestamp);
-    }
-
     FileTime m_timestamp;
-    QString m_filePath;
-    QStringRef m_dirPath;
-    QStringRef m_fileName;
+    PathAtom m_dirPath;
+    PathAtom m_fileName;
 };
 
 class FileDependency : public FileResourceBase
@@ -78,8 +78,12 @@ static void resolveDepencency(const RawScannedDependency &dependency,
     Artifact *dependencyInProduct = nullptr;
     Artifact *dependencyInOtherProduct = nullptr;
     bool productOfDependencyIsDependency = false;
-    const auto files = project->topLevelProject()
-            ->buildData->lookupFiles(absDirPath, dependency.fileName());
+    static const std::vector<FileResourceBase *> noFiles;
+    const std::optional<PathAtom> absDirPathAtom = PathAtom::find(absDirPath);
+    const auto &files = absDirPathAtom
+            ? project->topLevelProject()->buildData->lookupFiles(*absDirPathAtom,
+                                                                 dependency.fileNameAtom())
+            : noFiles;
     for (FileResourceBase *lookupResult : files) {
         switch (lookupResult->fileType()) {
         case FileResourceBase::FileTypeDependency:
@@ -247,7 +251,8 @@ void InputArtifactScanner::scanForScannerFileDependencies(DependencyScanner *sca
 
     const QString &filePathToBeScanned = fileToBeScanned->filePath();
     RawScanResults::ScanData &scanData = m_rawScanResults.findScanData(fileToBeScanned, scanner,
-                                                                       m_artifact->properties);
+                                                                       m_artifact->properties,
+                                                                       inputArtifact);
     if (scanData.lastScanTime < fileToBeScanned->timestamp()) {
         try {
             qCDebug(lcDepScan) << "scanning" << FileInfo::fileName(filePathToBeScanned);
@@ -271,7 +276,7 @@ void InputArtifactScanner::resolveScanResultDependencies(const Artifact *inputAr
     {
         const QString &dependencyFilePath = dependency.filePath();
         InputArtifactScannerContext::ResolvedDependencyCacheItem &cachedResolvedDependencyItem
-                = cache.resolvedDependenciesCache[dependency.dirPath()][dependency.fileName()];
+                = cache.resolvedDependenciesCache[dependency.dirPathAtom()][dependency.fileNameAtom()];
         ResolvedDependency &resolvedDependency = cachedResolvedDependencyItem.resolvedDependency;
         if (cachedResolvedDependencyItem.valid) {
             if (resolvedDependency.filePath.isEmpty())
@@ -297,6 +302,13 @@ void InputArtifactScanner::resolveScanResultDependencies(const Artifact *inputAr
         return nullptr;
     };
 
+    for (const RawScannedDependency &dependency : scanResult.moduleDeps) {
+        if (const auto resolvedDependency = getResolvedDependency(dependency))
+            handleDependency(*resolvedDependency);
+        else
+            qCDebug(lcDepScan) << "unresolved module dependency " << dependency.filePath();
+    }
+
     for (const RawScannedDependency &dependency : scanResult.deps) {
         const auto maybeResolvedDependency = getResolvedDependency(dependency);
         if (!maybeResolvedDependency) {
@@ -389,10 +401,10 @@ void InputArtifactScanner::scanWithScannerPlugin(DependencyScanner *scanner,
                                                  RawScanResult *scanResult)
 {
     scanResult->deps.clear();
-    const QStringList &dependencies = scanner->collectDependencies(
-                inputArtifact, fileToBeScanned, m_fileTagsForScanner.constData());
-    for (const QString &s : dependencies)
-        scanResult->deps.emplace_back(s);
+    scanResult->moduleDeps.clear();
+    scanResult->conditionMacros.clear();
+    scanner->collectDependencies(inputArtifact, fileToBeScanned, m_fileTagsForScanner.constData(),
+                                 scanResult);
 }
 
 InputArtifactScannerContext::DependencyScannerCacheItem::DependencyScannerCacheItem() : valid(false)
@@ -43,6 +43,7 @@
 #include <language/filetags.h>
 #include <language/forward_decls.h>
 #include <logging/logger.h>
+#include <tools/pathatom.h>
 #include <tools/set.h>
 
 #include <QtCore/qhash.h>
@@ -83,7 +84,8 @@ class InputArtifactScannerContext
         ResolvedDependency resolvedDependency;
     };
 
-    using ResolvedDependenciesCache = QHash<QString, QHash<QString, ResolvedDependencyCacheItem>>;
+    using ResolvedDependenciesCache
+            = QHash<PathAtom, QHash<PathAtom, ResolvedDependencyCacheItem>>;
 
     struct ScannerResolvedDependenciesCache
     {
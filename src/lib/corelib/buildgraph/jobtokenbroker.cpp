@@ -0,0 +1,336 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "jobtokenbroker.h"
+
+#include <logging/categories.h>
+#include <tools/qbsassert.h>
+
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qmetaobject.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qstringlist.h>
+
+#if defined(Q_OS_WIN)
+#include <QtCore/qt_windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+
+namespace qbs {
+namespace Internal {
+
+// Newer versions of GNU make use --jobserver-auth, older ones --jobserver-fds.
+// If several are given, the last one wins.
+static QString jobserverAuth(const QString &makeFlags)
+{
+    static const QString prefixes[] = {
+        QStringLiteral("--jobserver-auth="), QStringLiteral("--jobserver-fds=")
+    };
+    QString auth;
+    const QStringList flags = makeFlags.split(QLatin1Char(' '));
+    for (const QString &flag : flags) {
+        for (const QString &prefix : prefixes) {
+            if (flag.startsWith(prefix))
+                auth = flag.mid(prefix.size());
+        }
+    }
+    return auth;
+}
+
+// A connection to a GNU make jobserver, which is either the one qbs was started from or one
+// created by qbs. Reading never blocks, as it happens in the executor threads.
+class JobserverConnection
+{
+public:
+    static std::unique_ptr<JobserverConnection> connect();
+    static std::unique_ptr<JobserverConnection> create(int jobCount);
+    ~JobserverConnection();
+
+    bool tryTakeToken(char *token);
+    void returnToken(char token);
+
+    QString makeFlags() const { return m_makeFlags; }
+
+private:
+    JobserverConnection() = default;
+
+#if defined(Q_OS_WIN)
+    HANDLE m_semaphore = nullptr;
+#else
+    int m_readFd = -1;
+    int m_writeFd = -1;
+    QString m_createdFifo;
+#endif
+    QString m_makeFlags;
+};
+
+std::unique_ptr<JobserverConnection> JobserverConnection::connect()
+{
+    const QString auth = jobserverAuth(QString::fromLocal8Bit(qgetenv("MAKEFLAGS")));
+    if (auth.isEmpty())
+        return {};
+    std::unique_ptr<JobserverConnection> connection(new JobserverConnection);
+#if defined(Q_OS_WIN)
+    connection->m_semaphore = OpenSemaphoreW(SYNCHRONIZE | SEMAPHORE_MODIFY_STATE, FALSE,
+                                             reinterpret_cast<const wchar_t *>(auth.utf16()));
+    if (!connection->m_semaphore) {
+        qCDebug(lcExec) << "Cannot open jobserver semaphore" << auth;
+        return {};
+    }
+#else
+    if (auth.startsWith(QLatin1String("fifo:"))) {
+        const QByteArray path = QFile::encodeName(auth.mid(5));
+        connection->m_readFd = open(path.constData(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+        connection->m_writeFd = connection->m_readFd;
+    } else {
+        const QStringList fds = auth.split(QLatin1Char(','));
+        bool readOk = false;
+        bool writeOk = false;
+        const int readFd = fds.size() == 2 ? fds.first().toInt(&readOk) : -1;
+        const int writeFd = fds.size() == 2 ? fds.last().toInt(&writeOk) : -1;
+
+        // The descriptors are only inherited if make considers us a recursive make.
+        // Setting O_NONBLOCK on them would affect make itself, so we read from a private
+        // open file description instead, which is only possible via procfs.
+        if (readOk && writeOk && fcntl(readFd, F_GETFD) != -1 && fcntl(writeFd, F_GETFD) != -1) {
+            const QByteArray procPath = "/proc/self/fd/" + QByteArray::number(readFd);
+            connection->m_readFd = open(procPath.constData(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+            connection->m_writeFd = connection->m_readFd != -1 ? writeFd : -1;
+        }
+    }
+    if (connection->m_readFd == -1) {
+        qCDebug(lcExec) << "Cannot use jobserver" << auth << "from MAKEFLAGS";
+        return {};
+    }
+#endif
+    qCDebug(lcExec) << "Using jobserver" << auth << "from MAKEFLAGS";
+    return connection;
+}
+
+std::unique_ptr<JobserverConnection> JobserverConnection::create(int jobCount)
+{
+#if defined(Q_OS_WIN)
+    Q_UNUSED(jobCount);
+    qCDebug(lcExec) << "Providing a jobserver is not supported on this platform";
+    return {};
+#else
+    static int fifoCount = 0;
+    const QString fifoPath = QDir::tempPath() + QStringLiteral("/qbs-jobserver-%1-%2")
+            .arg(QCoreApplication::applicationPid()).arg(++fifoCount);
+    const QByteArray encodedPath = QFile::encodeName(fifoPath);
+    if (mkfifo(encodedPath.constData(), 0600) != 0) {
+        qCDebug(lcExec) << "Cannot create jobserver fifo" << fifoPath << ":" << strerror(errno);
+        return {};
+    }
+    std::unique_ptr<JobserverConnection> connection(new JobserverConnection);
+    connection->m_createdFifo = fifoPath;
+    connection->m_readFd = open(encodedPath.constData(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (connection->m_readFd == -1) {
+        qCDebug(lcExec) << "Cannot open jobserver fifo" << fifoPath << ":" << strerror(errno);
+        return {};
+    }
+    connection->m_writeFd = connection->m_readFd;
+
+    // Like make, we keep the implicit token to ourselves.
+    for (int i = 1; i < jobCount; ++i)
+        connection->returnToken('+');
+    connection->m_makeFlags = QStringLiteral(" -j%1 --jobserver-auth=fifo:%2")
+            .arg(jobCount).arg(fifoPath);
+    qCDebug(lcExec) << "Providing jobserver" << fifoPath << "for" << jobCount << "jobs";
+    return connection;
+#endif
+}
+
+JobserverConnection::~JobserverConnection()
+{
+#if defined(Q_OS_WIN)
+    if (m_semaphore)
+        CloseHandle(m_semaphore);
+#else
+    if (m_readFd != -1)
+        close(m_readFd);
+    if (!m_createdFifo.isEmpty())
+        unlink(QFile::encodeName(m_createdFifo).constData());
+#endif
+}
+
+bool JobserverConnection::tryTakeToken(char *token)
+{
+#if defined(Q_OS_WIN)
+    *token = '+';
+    return WaitForSingleObject(m_semaphore, 0) == WAIT_OBJECT_0;
+#else
+    ssize_t bytesRead;
+    do {
+        bytesRead = read(m_readFd, token, 1);
+    } while (bytesRead == -1 && errno == EINTR);
+    return bytesRead == 1;
+#endif
+}
+
+void JobserverConnection::returnToken(char token)
+{
+#if defined(Q_OS_WIN)
+    Q_UNUSED(token);
+    ReleaseSemaphore(m_semaphore, 1, nullptr);
+#else
+    ssize_t bytesWritten;
+    do {
+        bytesWritten = write(m_writeFd, &token, 1);
+    } while (bytesWritten == -1 && errno == EINTR);
+    QBS_ASSERT(bytesWritten == 1, return);
+#endif
+}
+
+
+JobTokenBroker &JobTokenBroker::instance()
+{
+    static JobTokenBroker broker;
+    return broker;
+}
+
+JobTokenBroker::JobTokenBroker() = default;
+JobTokenBroker::~JobTokenBroker() = default;
+
+void JobTokenBroker::attach(int maxJobCount, bool provideJobserver)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_clientCount++ > 0)
+        return;
+    QBS_ASSERT(m_tokensInUse == 0, m_tokensInUse = 0);
+    m_budget = maxJobCount;
+    m_jobserver = JobserverConnection::connect();
+    m_jobserverIsExternal = bool(m_jobserver);
+    if (!m_jobserver && provideJobserver && m_budget > 1)
+        m_jobserver = JobserverConnection::create(m_budget);
+}
+
+void JobTokenBroker::detach()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    QBS_ASSERT(m_clientCount > 0, return);
+    if (--m_clientCount > 0)
+        return;
+    QBS_ASSERT(m_tokensInUse == 0, m_tokensInUse = 0);
+    for (const char token : m_jobserverTokens)
+        m_jobserver->returnToken(token);
+    m_jobserverTokens.clear();
+    m_jobserver.reset();
+    m_jobserverIsExternal = false;
+    m_waiters.clear();
+}
+
+bool JobTokenBroker::tryAcquire()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_tokensInUse >= m_budget)
+        return false;
+
+    // The first token is the implicit one that every jobserver client owns.
+    if (m_jobserver && m_tokensInUse > 0) {
+        char token;
+        if (!m_jobserver->tryTakeToken(&token))
+            return false;
+        m_jobserverTokens.push_back(token);
+    }
+    ++m_tokensInUse;
+    return true;
+}
+
+void JobTokenBroker::release()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        QBS_ASSERT(m_tokensInUse > 0, return);
+        --m_tokensInUse;
+        if (!m_jobserverTokens.empty()) {
+            m_jobserver->returnToken(m_jobserverTokens.back());
+            m_jobserverTokens.pop_back();
+        }
+    }
+    notifyWaiters();
+}
+
+void JobTokenBroker::waitForToken(QObject *waiter, const std::function<void()> &callback)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_waiters.emplace_back(waiter, callback);
+}
+
+void JobTokenBroker::stopWaiting(QObject *waiter)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_waiters.erase(std::remove_if(m_waiters.begin(), m_waiters.end(),
+                                   [waiter](const auto &w) { return w.first == waiter; }),
+                    m_waiters.end());
+}
+
+bool JobTokenBroker::usesExternalJobserver() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_jobserverIsExternal;
+}
+
+QString JobTokenBroker::jobserverMakeFlags() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_jobserver ? m_jobserver->makeFlags() : QString();
+}
+
+// Posting happens under the lock, so a waiter that has called stopWaiting() cannot be
+// notified anymore.
+void JobTokenBroker::notifyWaiters()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto &waiter : m_waiters)
+        QMetaObject::invokeMethod(waiter.first, waiter.second, Qt::QueuedConnection);
+    m_waiters.clear();
+}
+
+} // namespace Internal
+} // namespace qbs
@@ -0,0 +1,109 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_JOBTOKENBROKER_H
+#define QBS_JOBTOKENBROKER_H
+
+#include <QtCore/qstring.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+class QObject;
+QT_END_NAMESPACE
+
+namespace qbs {
+namespace Internal {
+class JobserverConnection;
+
+// Hands out the job tokens of a qbs process. All executors that run at the same time, e.g.
+// when building several configurations at once, share one budget, so the total number of
+// concurrently running commands does not grow with the number of configurations.
+// If qbs is run from a GNU make that provides a jobserver, the tokens beyond the implicit one
+// are taken from that jobserver. Otherwise, qbs can act as a jobserver itself, so that
+// sub-makes and compilers started by rules share the budget with qbs.
+// All functions are thread-safe, as the executors of different configurations live in
+// different threads.
+class JobTokenBroker
+{
+public:
+    static JobTokenBroker &instance();
+
+    // The first client determines the budget. It is reset once the last client has detached.
+    void attach(int maxJobCount, bool provideJobserver);
+    void detach();
+
+    bool tryAcquire();
+    void release();
+
+    // Invokes callback in waiter's thread once a token has been released in this process.
+    // Tokens that are returned to an external jobserver cannot be observed, so clients
+    // should additionally poll if usesExternalJobserver() is true.
+    void waitForToken(QObject *waiter, const std::function<void()> &callback);
+    void stopWaiting(QObject *waiter);
+
+    bool usesExternalJobserver() const;
+
+    // The value of MAKEFLAGS for child processes if qbs is the jobserver, or an empty string.
+    QString jobserverMakeFlags() const;
+
+private:
+    JobTokenBroker();
+    ~JobTokenBroker();
+
+    void notifyWaiters();
+
+    mutable std::mutex m_mutex;
+    int m_clientCount = 0;
+    int m_budget = 0;
+    int m_tokensInUse = 0;
+    std::vector<char> m_jobserverTokens;
+    std::unique_ptr<JobserverConnection> m_jobserver;
+    bool m_jobserverIsExternal = false;
+    std::vector<std::pair<QObject *, std::function<void()>>> m_waiters;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_JOBTOKENBROKER_H
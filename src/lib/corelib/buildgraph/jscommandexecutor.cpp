@@ -55,6 +55,7 @@
 #include <tools/qbsassert.h>
 #include <tools/qttools.h>
 
+#include <QtCore/qelapsedtimer.h>
 #include <QtCore/qeventloop.h>
 #include <QtCore/qpointer.h>
 #include <QtCore/qthread.h>
@@ -68,65 +69,22 @@ struct JavaScriptCommandResult
     bool success = false;
     QString errorMessage;
     CodeLocation errorLocation;
+    qint64 elapsedTime = 0; // In nanoseconds.
 };
 
-class JsCommandExecutorThreadObject : public QObject
+static void runJavaScriptCommand(ScriptEngine *scriptEngine, const JavaScriptCommand *cmd,
+                                 Transformer *transformer, JavaScriptCommandResult &result)
 {
-    Q_OBJECT
-public:
-    JsCommandExecutorThreadObject(Logger logger)
-        : m_logger(std::move(logger))
-        , m_scriptEngine(nullptr)
-    {
-    }
-
-    const JavaScriptCommandResult &result() const
-    {
-        return m_result;
-    }
-
-    void cancel(const qbs::ErrorInfo &reason)
-    {
-        m_result.success = !reason.hasError();
-        m_result.errorMessage = reason.toString();
-        if (m_scriptEngine)
-            m_scriptEngine->abortEvaluation();
-        m_cancelled = true;
-    }
-
-signals:
-    void finished();
-
-public:
-    void start(const JavaScriptCommand *cmd, Transformer *transformer)
-    {
-        if (m_cancelled) {
-            emit finished();
-            return;
-        }
-
-        m_running = true;
-        try {
-            doStart(cmd, transformer);
-        } catch (const qbs::ErrorInfo &error) {
-            setError(error.toString(), cmd->codeLocation());
-        }
-
-        m_running = false;
-        emit finished();
-    }
-
-private:
-    void doStart(const JavaScriptCommand *cmd, Transformer *transformer)
-    {
-        m_result.success = true;
-        m_result.errorMessage.clear();
-        ScriptEngine * const scriptEngine = provideScriptEngine();
+    QElapsedTimer timer;
+    timer.start();
+    result.success = true;
+    result.errorMessage.clear();
+    try {
         QScriptValue scope = scriptEngine->newObject();
         scope.setPrototype(scriptEngine->globalObject());
-        m_scriptEngine->clearRequestedProperties();
+        scriptEngine->clearRequestedProperties();
         setupScriptEngineForFile(scriptEngine,
-                                 transformer->rule->prepareScript.fileContext(), scope,
+                                 transformer->rule->commandsScript().fileContext(), scope,
                                  ObserveMode::Enabled);
 
         QScriptValue importScopeForSourceCode;
@@ -170,17 +128,60 @@ private:
         scriptEngine->clearRequestedProperties();
         if (scriptEngine->hasUncaughtException()) {
             // ### We don't know the line number of the command's sourceCode property assignment.
-            setError(scriptEngine->uncaughtException().toString(), cmd->codeLocation());
+            result.success = false;
+            result.errorMessage = scriptEngine->uncaughtException().toString();
+            result.errorLocation = cmd->codeLocation();
         }
+    } catch (const qbs::ErrorInfo &error) {
+        result.success = false;
+        result.errorMessage = error.toString();
+        result.errorLocation = cmd->codeLocation();
+    }
+    result.elapsedTime = timer.nsecsElapsed();
+}
+
+class JsCommandExecutorThreadObject : public QObject
+{
+    Q_OBJECT
+public:
+    JsCommandExecutorThreadObject(Logger logger)
+        : m_logger(std::move(logger))
+        , m_scriptEngine(nullptr)
+    {
     }
 
-    void setError(const QString &errorMessage, const CodeLocation &codeLocation)
+    const JavaScriptCommandResult &result() const
     {
-        m_result.success = false;
-        m_result.errorMessage = errorMessage;
-        m_result.errorLocation = codeLocation;
+        return m_result;
+    }
+
+    void cancel(const qbs::ErrorInfo &reason)
+    {
+        m_result.success = !reason.hasError();
+        m_result.errorMessage = reason.toString();
+        if (m_scriptEngine)
+            m_scriptEngine->abortEvaluation();
+        m_cancelled = true;
+    }
+
+signals:
+    void finished();
+
+public:
+    void start(const JavaScriptCommand *cmd, Transformer *transformer)
+    {
+        if (m_cancelled) {
+            emit finished();
+            return;
+        }
+
+        m_running = true;
+        runJavaScriptCommand(provideScriptEngine(), cmd, transformer, m_result);
+        m_running = false;
+        emit finished();
     }
 
+private:
     ScriptEngine *provideScriptEngine()
     {
         if (!m_scriptEngine)
@@ -195,6 +196,24 @@ private:
     bool m_cancelled = false;
 };
 
+// Commands that took less than this on average are run directly in the executor thread.
+static const qint64 inlineExecutionThreshold = 1000 * 1000; // In nanoseconds.
+
+void JsCommandCostModel::addSample(const QString &sourceCode, qint64 elapsedTime)
+{
+    const auto it = m_averageCosts.find(sourceCode);
+    if (it == m_averageCosts.end())
+        m_averageCosts.insert(sourceCode, elapsedTime);
+    else
+        *it = (*it * 3 + elapsedTime) / 4;
+}
+
+bool JsCommandCostModel::isCheap(const QString &sourceCode) const
+{
+    const auto it = m_averageCosts.constFind(sourceCode);
+    return it != m_averageCosts.constEnd() && *it < inlineExecutionThreshold;
+}
+
 
 JsCommandExecutor::JsCommandExecutor(const Logger &logger, QObject *parent)
     : AbstractCommandExecutor(logger, parent)
@@ -247,12 +266,32 @@ bool JsCommandExecutor::doStart()
         return false;
     }
 
+    if (canRunInline()) {
+        EvalContextSwitcher contextSwitcher(scriptEngine(), EvalContext::JsCommand);
+        JavaScriptCommandResult result;
+        runJavaScriptCommand(scriptEngine(), jsCommand(), transformer(), result);
+
+        // Reporting synchronously would make the executor start the next command
+        // from within this function.
+        QTimer::singleShot(0, this, [this, result] { finishCommand(result); });
+        return false;
+    }
+
     m_thread->start();
     m_running = true;
     emit startRequested(jsCommand(), transformer());
     return true;
 }
 
+// Skipping the hand-off to the command thread pays off for the many tiny commands that copy
+// or generate small files. We only do it for commands we have seen being fast, as the
+// executor thread is blocked while the command runs and the command cannot be canceled.
+bool JsCommandExecutor::canRunInline() const
+{
+    return m_costModel && command()->timeout() <= 0 && !scriptEngine()->isActive()
+            && m_costModel->isCheap(jsCommand()->sourceCode());
+}
+
 void JsCommandExecutor::cancel(const qbs::ErrorInfo &reason)
 {
     if (m_running && (!dryRun() || command()->ignoreDryRun()))
@@ -265,7 +304,13 @@ void JsCommandExecutor::cancel(const qbs::ErrorInfo &reason)
 void JsCommandExecutor::onJavaScriptCommandFinished()
 {
     m_running = false;
-    const JavaScriptCommandResult &result = m_objectInThread->result();
+    finishCommand(m_objectInThread->result());
+}
+
+void JsCommandExecutor::finishCommand(const JavaScriptCommandResult &result)
+{
+    if (m_costModel)
+        m_costModel->addSample(jsCommand()->sourceCode(), result.elapsedTime);
     ErrorInfo err;
     if (!result.success) {
         logger().qbsDebug() << "JS context:\n" << jsCommand()->properties();
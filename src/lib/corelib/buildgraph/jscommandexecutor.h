@@ -43,6 +43,7 @@
 
 #include "abstractcommandexecutor.h"
 
+#include <QtCore/qhash.h>
 #include <QtCore/qstring.h>
 
 namespace qbs {
@@ -51,6 +52,19 @@ class CodeLocation;
 namespace Internal {
 class JavaScriptCommand;
 class JsCommandExecutorThreadObject;
+struct JavaScriptCommandResult;
+
+// Remembers how long JavaScript commands took to run, keyed by their source code.
+// Only accessed from the executor thread.
+class JsCommandCostModel
+{
+public:
+    void addSample(const QString &sourceCode, qint64 elapsedTime);
+    bool isCheap(const QString &sourceCode) const;
+
+private:
+    QHash<QString, qint64> m_averageCosts; // In nanoseconds.
+};
 
 class JsCommandExecutor : public AbstractCommandExecutor
 {
@@ -59,11 +73,15 @@ public:
     explicit JsCommandExecutor(const Logger &logger, QObject *parent = nullptr);
     ~JsCommandExecutor() override;
 
+    void setCostModel(JsCommandCostModel *costModel) { m_costModel = costModel; }
+
 signals:
     void startRequested(const JavaScriptCommand *cmd, Transformer *transformer);
 
 private:
     void onJavaScriptCommandFinished();
+    void finishCommand(const JavaScriptCommandResult &result);
+    bool canRunInline() const;
 
     void doReportCommandDescription(const QString &productName) override;
     bool doStart() override;
@@ -75,6 +93,7 @@ private:
 
     QThread *m_thread;
     JsCommandExecutorThreadObject *m_objectInThread;
+    JsCommandCostModel *m_costModel = nullptr;
     bool m_running;
 };
 
@@ -0,0 +1,217 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#include "preparescriptworkerpool.h"
+
+#include "buildgraph.h"
+#include "rulecommands.h"
+#include "transformer.h"
+
+#include <language/language.h>
+#include <language/resolvedfilecontext.h>
+#include <language/scriptengine.h>
+#include <logging/translator.h>
+#include <tools/progressobserver.h>
+#include <tools/qbsassert.h>
+#include <tools/stringconstants.h>
+
+#include <QtCore/qthread.h>
+
+#include <chrono>
+#include <unordered_map>
+
+namespace qbs {
+namespace Internal {
+
+class PrepareScriptWorker : public QThread
+{
+public:
+    PrepareScriptWorker(PrepareScriptWorkerPool &pool) : m_pool(pool) {}
+
+private:
+    void run() override
+    {
+        // Script engines must only be used in the thread they were created in.
+        m_engine = ScriptEngine::create(m_pool.m_logger, EvalContext::RuleExecution);
+        m_prepareScriptScope = m_engine->newObject();
+        m_prepareScriptScope.setPrototype(m_engine->globalObject());
+        ProcessCommand::setupForJavaScript(m_prepareScriptScope);
+        JavaScriptCommand::setupForJavaScript(m_prepareScriptScope);
+
+        unsigned int currentBatchId = 0;
+        unsigned int batchId = 0;
+        while (PrepareScriptTask * const task = m_pool.takeTask(batchId)) {
+            if (batchId != currentBatchId) {
+                // Every batch comes from a separate rule application, for which the
+                // executor thread also sets up a fresh scope.
+                currentBatchId = batchId;
+                m_scope = m_engine->newObject();
+                m_scope.setPrototype(m_prepareScriptScope);
+                m_engine->setGlobalObject(m_scope);
+            }
+            runTask(*task);
+            m_pool.taskFinished();
+        }
+
+        m_prepareFunctions.clear();
+        m_scope = QScriptValue();
+        m_prepareScriptScope = QScriptValue();
+        delete m_engine;
+    }
+
+    void runTask(PrepareScriptTask &task)
+    {
+        m_engine->clearRequestedProperties();
+        m_engine->clearUsesIo();
+        Transformer * const transformer = task.transformer.get();
+        const Rule * const rule = transformer->rule.get();
+        try {
+            setupScriptEngineForFile(m_engine, rule->prepareScript.fileContext(), m_scope,
+                                     ObserveMode::Enabled);
+            QScriptValue prepareScriptContext = m_engine->newObject();
+            prepareScriptContext.setPrototype(m_scope);
+            setupScriptEngineForProduct(m_engine, task.product, rule->module.get(),
+                                        prepareScriptContext, true);
+            transformer->setupInputs(prepareScriptContext);
+            transformer->setupExplicitlyDependsOn(prepareScriptContext);
+            transformer->setupOutputs(prepareScriptContext);
+            for (const QString &name : {StringConstants::inputsVar(), StringConstants::inputVar(),
+                                        StringConstants::explicitlyDependsOnVar(),
+                                        StringConstants::productVar(),
+                                        StringConstants::projectVar()}) {
+                m_scope.setProperty(name, prepareScriptContext.property(name));
+            }
+            transformer->createCommands(m_engine, prepareFunction(rule),
+                                        rule->prepareScript.location(),
+                                        ScriptEngine::argumentList(Rule::argumentNamesForPrepare(),
+                                                                   prepareScriptContext));
+        } catch (const ErrorInfo &error) {
+            task.error = error;
+        }
+        task.usesIo = m_engine->usesIo();
+    }
+
+    // Rule::prepareScript caches the function for the executor thread's engine only.
+    const QScriptValue &prepareFunction(const Rule *rule)
+    {
+        QScriptValue &function = m_prepareFunctions[rule];
+        if (!function.isValid()) {
+            const PrivateScriptFunction &script = rule->prepareScript;
+            function = m_engine->evaluate(script.sourceCode(), script.location().filePath(),
+                                          script.location().line());
+            if (Q_UNLIKELY(!function.isFunction())) {
+                function = QScriptValue();
+                throw ErrorInfo(Tr::tr("Invalid prepare script."), script.location());
+            }
+        }
+        return function;
+    }
+
+    PrepareScriptWorkerPool &m_pool;
+    ScriptEngine *m_engine = nullptr;
+    QScriptValue m_prepareScriptScope;
+    QScriptValue m_scope;
+    std::unordered_map<const Rule *, QScriptValue> m_prepareFunctions;
+};
+
+PrepareScriptWorkerPool::PrepareScriptWorkerPool(Logger logger, int workerCount)
+    : m_logger(std::move(logger))
+{
+    QBS_CHECK(workerCount > 0);
+    for (int i = 0; i < workerCount; ++i) {
+        m_workers.push_back(std::make_unique<PrepareScriptWorker>(*this));
+        m_workers.back()->start();
+    }
+}
+
+PrepareScriptWorkerPool::~PrepareScriptWorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shuttingDown = true;
+    }
+    m_tasksAvailable.notify_all();
+    for (const auto &worker : m_workers)
+        worker->wait();
+}
+
+void PrepareScriptWorkerPool::run(std::vector<PrepareScriptTask> &tasks,
+                                  ProgressObserver *observer)
+{
+    if (tasks.empty())
+        return;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    QBS_CHECK(!m_tasks);
+    m_tasks = &tasks;
+    m_nextTask = 0;
+    m_finishedTasks = 0;
+    m_canceled = false;
+    if (++m_batchId == 0)
+        ++m_batchId;
+    m_tasksAvailable.notify_all();
+    while (m_finishedTasks != (m_canceled ? m_nextTask : tasks.size())) {
+        m_batchFinished.wait_for(lock, std::chrono::milliseconds(100));
+        if (!m_canceled && observer && observer->canceled())
+            m_canceled = true;
+    }
+    m_tasks = nullptr;
+}
+
+PrepareScriptTask *PrepareScriptWorkerPool::takeTask(unsigned int &batchId)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_tasksAvailable.wait(lock, [this] {
+        return m_shuttingDown || (m_tasks && !m_canceled && m_nextTask < m_tasks->size());
+    });
+    if (m_shuttingDown)
+        return nullptr;
+    batchId = m_batchId;
+    return &(*m_tasks)[m_nextTask++];
+}
+
+void PrepareScriptWorkerPool::taskFinished()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_finishedTasks;
+    }
+    m_batchFinished.notify_one();
+}
+
+} // namespace Internal
+} // namespace qbs
@@ -0,0 +1,128 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_PREPARESCRIPTWORKERPOOL_H
+#define QBS_PREPARESCRIPTWORKERPOOL_H
+
+#include "forward_decls.h"
+#include "requestedartifacts.h"
+
+#include <language/forward_decls.h>
+#include <language/property.h>
+#include <logging/logger.h>
+#include <tools/error.h>
+#include <tools/set.h>
+
+#include <QtCore/qhash.h>
+#include <QtCore/qstring.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace qbs {
+namespace Internal {
+class PrepareScriptWorker;
+class ProgressObserver;
+
+// The properties, imports etc that the executor thread's engine recorded while creating the
+// outputs of a rule application. They have to be merged into the transformer's change tracking
+// data, which the worker engine fills in only with what the prepare script itself requested.
+struct ScriptRequests
+{
+    PropertySet properties;
+    QHash<QString, PropertySet> propertiesFromArtifact;
+    std::vector<QString> importedFiles;
+    Set<const ResolvedProduct *> productsWithRequestedDependencies;
+    RequestedArtifacts artifacts;
+    Set<const ResolvedProduct *> exports;
+};
+
+struct PrepareScriptTask
+{
+    // Fully set up, except for the commands. Only the worker running the task touches it.
+    TransformerPtr transformer;
+    ResolvedProduct *product = nullptr;
+
+    // Filled in by the worker.
+    ErrorInfo error;
+    bool usesIo = false;
+};
+
+// Runs the prepare scripts of independent rule applications on a number of threads, each of
+// which has its own script engine. The build graph must not be modified while a batch of tasks
+// is running, so the caller blocks in run() and merges the results afterwards.
+class PrepareScriptWorkerPool
+{
+public:
+    PrepareScriptWorkerPool(Logger logger, int workerCount);
+    ~PrepareScriptWorkerPool();
+
+    int workerCount() const { return int(m_workers.size()); }
+
+    // Returns after all tasks have been run or, if the observer reports cancelation,
+    // after the running ones have finished.
+    void run(std::vector<PrepareScriptTask> &tasks, ProgressObserver *observer);
+
+private:
+    friend class PrepareScriptWorker;
+
+    // Returns the next task of the current batch, or null if the pool is shutting down.
+    PrepareScriptTask *takeTask(unsigned int &batchId);
+    void taskFinished();
+
+    Logger m_logger;
+    std::vector<std::unique_ptr<PrepareScriptWorker>> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_tasksAvailable;
+    std::condition_variable m_batchFinished;
+    std::vector<PrepareScriptTask> *m_tasks = nullptr;
+    std::size_t m_nextTask = 0;
+    std::size_t m_finishedTasks = 0;
+    unsigned int m_batchId = 0;
+    bool m_canceled = false;
+    bool m_shuttingDown = false;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_PREPARESCRIPTWORKERPOOL_H
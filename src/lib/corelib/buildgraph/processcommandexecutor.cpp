@@ -41,6 +41,8 @@
 #include "processcommandexecutor.h"
 
 #include "artifact.h"
+#include "jobtokenbroker.h"
+#include "processoutputworker.h"
 #include "rulecommands.h"
 #include "transformer.h"
 
@@ -57,7 +59,6 @@
 #include <tools/processresult.h>
 #include <tools/processresult_p.h>
 #include <tools/qbsassert.h>
-#include <tools/scripttools.h>
 #include <tools/shellutils.h>
 #include <tools/stringconstants.h>
 
@@ -65,8 +66,6 @@
 #include <QtCore/qtemporaryfile.h>
 #include <QtCore/qtimer.h>
 
-#include <QtScript/qscriptvalue.h>
-
 namespace qbs {
 namespace Internal {
 
@@ -115,6 +114,11 @@ void ProcessCommandExecutor::doSetup()
         cmd->addRelevantEnvValue(key, transformer()->product()->buildEnvironment.value(key));
 
     m_commandEnvironment = mergeEnvironments(m_buildEnvironment, cmd->environment());
+
+    // Lets sub-makes and e.g. gcc -flto=jobserver take part in our job budget.
+    const QString makeFlags = JobTokenBroker::instance().jobserverMakeFlags();
+    if (!makeFlags.isEmpty() && !m_commandEnvironment.contains(QStringLiteral("MAKEFLAGS")))
+        m_commandEnvironment.insert(QStringLiteral("MAKEFLAGS"), makeFlags);
     m_program = program;
     m_arguments = cmd->arguments();
     m_shellInvocation = shellQuote(QDir::toNativeSeparators(m_program), m_arguments);
@@ -126,8 +130,6 @@ bool ProcessCommandExecutor::doStart()
 
     const ProcessCommand * const cmd = processCommand();
 
-    m_process.setProcessEnvironment(m_commandEnvironment);
-
     QStringList arguments = m_arguments;
 
     if (dryRun() && !cmd->ignoreDryRun()) {
@@ -194,9 +196,16 @@ bool ProcessCommandExecutor::doStart()
     qCDebug(lcExec) << "Running external process; full command line is:" << m_shellInvocation;
     const QProcessEnvironment &additionalVariables = cmd->environment();
     qCDebug(lcExec) << "Additional environment:" << additionalVariables.toStringList();
+    startProcess(workingDir, arguments);
+    return true;
+}
+
+void ProcessCommandExecutor::startProcess(const QString &workingDir,
+                                          const QStringList &arguments)
+{
+    m_process.setProcessEnvironment(m_commandEnvironment);
     m_process.setWorkingDirectory(workingDir);
     m_process.start(m_program, arguments);
-    return true;
 }
 
 void ProcessCommandExecutor::cancel(const qbs::ErrorInfo &reason)
@@ -205,108 +214,50 @@ void ProcessCommandExecutor::cancel(const qbs::ErrorInfo &reason)
     disconnect(this, &ProcessCommandExecutor::reportProcessResult, nullptr, nullptr);
 
     m_cancelReason = reason;
-    m_process.cancel();
-}
-
-QString ProcessCommandExecutor::filterProcessOutput(const QByteArray &_output,
-        const QString &filterFunctionSource)
-{
-    const QString output = QString::fromLocal8Bit(_output);
-    if (filterFunctionSource.isEmpty())
-        return output;
-
-    QScriptValue scope = scriptEngine()->newObject();
-    scope.setPrototype(scriptEngine()->globalObject());
-    for (QVariantMap::const_iterator it = command()->properties().constBegin();
-            it != command()->properties().constEnd(); ++it) {
-        scope.setProperty(it.key(), scriptEngine()->toScriptValue(it.value()));
-    }
-
-    TemporaryGlobalObjectSetter tgos(scope);
-    QScriptValue filterFunction = scriptEngine()->evaluate(QLatin1String("var f = ")
-                                                           + filterFunctionSource
-                                                           + QLatin1String("; f"));
-    if (!filterFunction.isFunction()) {
-        logger().printWarning(ErrorInfo(Tr::tr("Error in filter function: %1.\n%2")
-                         .arg(filterFunctionSource, filterFunction.toString())));
-        return output;
-    }
-
-    QScriptValue outputArg = scriptEngine()->newArray(1);
-    outputArg.setProperty(0, scriptEngine()->toScriptValue(output));
-    QScriptValue filteredOutput = filterFunction.call(scriptEngine()->undefinedValue(), outputArg);
-    if (scriptEngine()->hasErrorOrException(filteredOutput)) {
-        logger().printWarning(ErrorInfo(Tr::tr("Error when calling output filter function: %1")
-                         .arg(scriptEngine()->lastErrorString(filteredOutput)),
-                                        scriptEngine()->lastErrorLocation(filteredOutput)));
-        return output;
-    }
-
-    return filteredOutput.toString();
+    cancelProcess();
 }
 
-static QProcess::ProcessError saveToFile(const QString &filePath, const QByteArray &content)
+void ProcessCommandExecutor::cancelProcess()
 {
-    QBS_ASSERT(!filePath.isEmpty(), return QProcess::WriteError);
-
-    QFile f(filePath);
-    if (!f.open(QIODevice::WriteOnly))
-        return QProcess::WriteError;
-
-    if (f.write(content) != content.size())
-        return QProcess::WriteError;
-    f.close();
-    return f.error() == QFileDevice::NoError ? QProcess::UnknownError : QProcess::WriteError;
+    m_process.cancel();
 }
 
-void ProcessCommandExecutor::getProcessOutput(bool stdOut, ProcessResult &result)
+void ProcessCommandExecutor::finishProcess(const ProcessOutcome &outcome)
 {
-    QByteArray content;
-    QString filterFunction;
-    QString redirectPath;
-    QStringList *target;
-    if (stdOut) {
-        content = m_process.readAllStandardOutput();
-        filterFunction = processCommand()->stdoutFilterFunction();
-        redirectPath = processCommand()->stdoutFilePath();
-        target = &result.d->stdOut;
-    } else {
-        content = m_process.readAllStandardError();
-        filterFunction = processCommand()->stderrFilterFunction();
-        redirectPath = processCommand()->stderrFilePath();
-        target = &result.d->stdErr;
-    }
-    QString contentString = filterProcessOutput(content, filterFunction);
-    if (!redirectPath.isEmpty()) {
-        const QByteArray dataToWrite = filterFunction.isEmpty() ? content
-                                                                : contentString.toLocal8Bit();
-        const QProcess::ProcessError error = saveToFile(redirectPath, dataToWrite);
-        if (result.error() == QProcess::UnknownError && error != QProcess::UnknownError)
-            result.d->error = error;
-    } else {
-        if (!contentString.isEmpty() && contentString.endsWith(QLatin1Char('\n')))
-            contentString.chop(1);
-        *target = contentString.split(QLatin1Char('\n'), QBS_SKIP_EMPTY_PARTS);
-    }
+    const ProcessCommand * const cmd = processCommand();
+    ProcessOutputRequest request;
+    request.program = m_program;
+    request.arguments = m_arguments;
+    request.workingDirectory = outcome.workingDirectory;
+    request.stdOut = outcome.stdOut;
+    request.stdErr = outcome.stdErr;
+    request.error = outcome.error;
+    request.exitCode = outcome.exitCode;
+    request.stdoutFilterFunction = cmd->stdoutFilterFunction();
+    request.stderrFilterFunction = cmd->stderrFilterFunction();
+    request.stdoutFilePath = cmd->stdoutFilePath();
+    request.stderrFilePath = cmd->stderrFilePath();
+    if (!request.stdoutFilterFunction.isEmpty() || !request.stderrFilterFunction.isEmpty())
+        request.commandProperties = cmd->properties();
+
+    const QString errorString = outcome.errorString;
+    const auto handleOutput = [this, errorString](const ProcessOutputResult &output) {
+        onProcessOutputHandled(output, errorString);
+    };
+    if (m_outputWorker && m_outputWorker->post(request, this, handleOutput))
+        return;
+    handleOutput(ProcessOutputWorker::processOutput(request, scriptEngine()));
 }
 
-void ProcessCommandExecutor::sendProcessOutput()
+void ProcessCommandExecutor::onProcessOutputHandled(const ProcessOutputResult &output,
+                                                    const QString &errorString)
 {
-    ProcessResult result;
-    result.d->executableFilePath = m_program;
-    result.d->arguments = m_arguments;
-    result.d->workingDirectory = m_process.workingDirectory();
-    if (result.workingDirectory().isEmpty())
-        result.d->workingDirectory = QDir::currentPath();
-    result.d->exitCode = m_process.exitCode();
-    result.d->error = m_process.error();
-    QString errorString = m_process.errorString();
-
-    getProcessOutput(true, result);
-    getProcessOutput(false, result);
+    for (const ErrorInfo &warning : output.warnings)
+        logger().printWarning(warning);
 
+    ProcessResult result = output.result;
     const bool processError = result.error() != QProcess::UnknownError;
-    const bool failureExit = quint32(m_process.exitCode())
+    const bool failureExit = quint32(result.exitCode())
             > quint32(processCommand()->maxExitCode());
     const bool cancelledWithError = m_cancelReason.hasError();
     result.d->success = !processError && !failureExit && !cancelledWithError;
@@ -318,7 +269,7 @@ void ProcessCommandExecutor::sendProcessOutput()
         emit finished(ErrorInfo(errorString));
     } else if (Q_UNLIKELY(failureExit)) {
         emit finished(ErrorInfo(Tr::tr("Process failed with exit code %1.")
-                                .arg(m_process.exitCode())));
+                                .arg(result.exitCode())));
     } else {
         emit finished();
     }
@@ -369,7 +320,14 @@ void ProcessCommandExecutor::onProcessFinished()
         return;
     }
     removeResponseFile();
-    sendProcessOutput();
+    ProcessOutcome outcome;
+    outcome.workingDirectory = m_process.workingDirectory();
+    outcome.stdOut = m_process.readAllStandardOutput();
+    outcome.stdErr = m_process.readAllStandardError();
+    outcome.errorString = m_process.errorString();
+    outcome.error = m_process.error();
+    outcome.exitCode = m_process.exitCode();
+    finishProcess(outcome);
 }
 
 static QString environmentVariableString(const QString &key, const QString &value)
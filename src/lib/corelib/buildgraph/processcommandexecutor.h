@@ -52,6 +52,8 @@ class ProcessResult;
 
 namespace Internal {
 class ProcessCommand;
+class ProcessOutputResult;
+class ProcessOutputWorker;
 
 class ProcessCommandExecutor : public AbstractCommandExecutor
 {
@@ -63,9 +65,38 @@ public:
         m_buildEnvironment = processEnvironment;
     }
 
+    // If set, the output of finished processes is handled there instead of in the calling thread.
+    void setOutputWorker(ProcessOutputWorker *worker) { m_outputWorker = worker; }
+
+    // In bytes, zero if unknown.
+    qint64 peakMemoryUsage() const { return m_process.peakMemoryUsage(); }
+
 signals:
     void reportProcessResult(const qbs::ProcessResult &result);
 
+protected:
+    class ProcessOutcome
+    {
+    public:
+        QString workingDirectory;
+        QByteArray stdOut;
+        QByteArray stdErr;
+        QString errorString;
+        QProcess::ProcessError error = QProcess::UnknownError;
+        int exitCode = 0;
+    };
+
+    ProcessCommand *processCommand() const;
+    const QString &program() const { return m_program; }
+    const QProcessEnvironment &commandEnvironment() const { return m_commandEnvironment; }
+    bool usesResponseFile() const { return !m_responseFileName.isEmpty(); }
+
+    // Called with the final arguments once all checks have passed. The default implementation
+    // runs the process locally. Implementations must eventually call finishProcess().
+    virtual void startProcess(const QString &workingDir, const QStringList &arguments);
+    virtual void cancelProcess();
+    void finishProcess(const ProcessOutcome &outcome);
+
 private:
     void onProcessError();
     void onProcessFinished();
@@ -76,12 +107,9 @@ private:
     void cancel(const qbs::ErrorInfo &reason) override;
 
     void startProcessCommand();
-    QString filterProcessOutput(const QByteArray &output, const QString &filterFunctionSource);
-    void getProcessOutput(bool stdOut, ProcessResult &result);
+    void onProcessOutputHandled(const ProcessOutputResult &output, const QString &errorString);
 
-    void sendProcessOutput();
     void removeResponseFile();
-    ProcessCommand *processCommand() const;
 
 private:
     QString m_program;
@@ -93,6 +121,7 @@ private:
     QProcessEnvironment m_commandEnvironment;
     QString m_responseFileName;
     qbs::ErrorInfo m_cancelReason;
+    ProcessOutputWorker *m_outputWorker = nullptr;
 };
 
 } // namespace Internal
@@ -0,0 +1,217 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "processoutputworker.h"
+
+#include <language/scriptengine.h>
+#include <logging/translator.h>
+#include <tools/processresult_p.h>
+#include <tools/qbsassert.h>
+#include <tools/qttools.h>
+#include <tools/scripttools.h>
+
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qtimer.h>
+
+#include <QtScript/qscriptvalue.h>
+
+namespace qbs {
+namespace Internal {
+
+class ProcessOutputWorkerThreadObject : public QObject
+{
+public:
+    ProcessOutputWorkerThreadObject(Logger logger) : m_logger(std::move(logger)) { }
+
+    ProcessOutputResult process(const ProcessOutputRequest &request)
+    {
+        if (!m_scriptEngine && (!request.stdoutFilterFunction.isEmpty()
+                                || !request.stderrFilterFunction.isEmpty())) {
+            m_scriptEngine = ScriptEngine::create(m_logger, EvalContext::JsCommand, this);
+        }
+        return ProcessOutputWorker::processOutput(request, m_scriptEngine);
+    }
+
+private:
+    Logger m_logger;
+    ScriptEngine *m_scriptEngine = nullptr;
+};
+
+ProcessOutputWorker::ProcessOutputWorker(const Logger &logger, int capacity, QObject *parent)
+    : QObject(parent)
+    , m_thread(new QThread(this))
+    , m_objectInThread(new ProcessOutputWorkerThreadObject(logger))
+    , m_capacity(capacity)
+{
+    m_objectInThread->moveToThread(m_thread);
+}
+
+ProcessOutputWorker::~ProcessOutputWorker()
+{
+    m_thread->quit();
+    m_thread->wait();
+    delete m_objectInThread;
+}
+
+bool ProcessOutputWorker::post(const ProcessOutputRequest &request, QObject *context,
+                               Callback callback)
+{
+    if (m_pendingCount.fetch_add(1) >= m_capacity) {
+        m_pendingCount.fetch_sub(1);
+        return false;
+    }
+    if (!m_thread->isRunning())
+        m_thread->start();
+
+    const quint64 id = m_nextId++;
+    m_callbacks.insert(id, PendingCallback{context, std::move(callback)});
+    QTimer::singleShot(0, m_objectInThread, [this, id, request] {
+        const ProcessOutputResult result = m_objectInThread->process(request);
+        m_pendingCount.fetch_sub(1);
+        QTimer::singleShot(0, this, [this, id, result] { deliver(id, result); });
+    });
+    return true;
+}
+
+void ProcessOutputWorker::deliver(quint64 id, const ProcessOutputResult &result)
+{
+    const PendingCallback pending = m_callbacks.take(id);
+    if (pending.context)
+        pending.callback(result);
+}
+
+static QString filterProcessOutput(const QByteArray &_output, const QString &filterFunctionSource,
+                                   const QVariantMap &commandProperties, ScriptEngine *engine,
+                                   QList<ErrorInfo> &warnings)
+{
+    const QString output = QString::fromLocal8Bit(_output);
+    if (filterFunctionSource.isEmpty())
+        return output;
+
+    QBS_ASSERT(engine, return output);
+    QScriptValue scope = engine->newObject();
+    scope.setPrototype(engine->globalObject());
+    for (QVariantMap::const_iterator it = commandProperties.constBegin();
+            it != commandProperties.constEnd(); ++it) {
+        scope.setProperty(it.key(), engine->toScriptValue(it.value()));
+    }
+
+    TemporaryGlobalObjectSetter tgos(scope);
+    QScriptValue filterFunction = engine->evaluate(QLatin1String("var f = ")
+                                                   + filterFunctionSource
+                                                   + QLatin1String("; f"));
+    if (!filterFunction.isFunction()) {
+        warnings << ErrorInfo(Tr::tr("Error in filter function: %1.\n%2")
+                              .arg(filterFunctionSource, filterFunction.toString()));
+        return output;
+    }
+
+    QScriptValue outputArg = engine->newArray(1);
+    outputArg.setProperty(0, engine->toScriptValue(output));
+    QScriptValue filteredOutput = filterFunction.call(engine->undefinedValue(), outputArg);
+    if (engine->hasErrorOrException(filteredOutput)) {
+        warnings << ErrorInfo(Tr::tr("Error when calling output filter function: %1")
+                              .arg(engine->lastErrorString(filteredOutput)),
+                              engine->lastErrorLocation(filteredOutput));
+        return output;
+    }
+
+    return filteredOutput.toString();
+}
+
+static QProcess::ProcessError saveToFile(const QString &filePath, const QByteArray &content)
+{
+    QBS_ASSERT(!filePath.isEmpty(), return QProcess::WriteError);
+
+    QFile f(filePath);
+    if (!f.open(QIODevice::WriteOnly))
+        return QProcess::WriteError;
+
+    if (f.write(content) != content.size())
+        return QProcess::WriteError;
+    f.close();
+    return f.error() == QFileDevice::NoError ? QProcess::UnknownError : QProcess::WriteError;
+}
+
+static void getProcessOutput(const QByteArray &content, const QString &filterFunction,
+                             const QString &redirectPath, const QVariantMap &commandProperties,
+                             ScriptEngine *engine, QStringList &target,
+                             QProcess::ProcessError &processError, QList<ErrorInfo> &warnings)
+{
+    QString contentString = filterProcessOutput(content, filterFunction, commandProperties,
+                                                 engine, warnings);
+    if (!redirectPath.isEmpty()) {
+        const QByteArray dataToWrite = filterFunction.isEmpty() ? content
+                                                                : contentString.toLocal8Bit();
+        const QProcess::ProcessError error = saveToFile(redirectPath, dataToWrite);
+        if (processError == QProcess::UnknownError && error != QProcess::UnknownError)
+            processError = error;
+    } else {
+        if (!contentString.isEmpty() && contentString.endsWith(QLatin1Char('\n')))
+            contentString.chop(1);
+        target = contentString.split(QLatin1Char('\n'), QBS_SKIP_EMPTY_PARTS);
+    }
+}
+
+ProcessOutputResult ProcessOutputWorker::processOutput(const ProcessOutputRequest &request,
+                                                       ScriptEngine *engine)
+{
+    ProcessOutputResult output;
+    ProcessResult &result = output.result;
+    result.d->executableFilePath = request.program;
+    result.d->arguments = request.arguments;
+    result.d->workingDirectory = request.workingDirectory;
+    if (result.workingDirectory().isEmpty())
+        result.d->workingDirectory = QDir::currentPath();
+    result.d->exitCode = request.exitCode;
+    result.d->error = request.error;
+
+    getProcessOutput(request.stdOut, request.stdoutFilterFunction, request.stdoutFilePath,
+                     request.commandProperties, engine, result.d->stdOut, result.d->error,
+                     output.warnings);
+    getProcessOutput(request.stdErr, request.stderrFilterFunction, request.stderrFilePath,
+                     request.commandProperties, engine, result.d->stdErr, result.d->error,
+                     output.warnings);
+    return output;
+}
+
+} // namespace Internal
+} // namespace qbs
@@ -0,0 +1,134 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_PROCESSOUTPUTWORKER_H
+#define QBS_PROCESSOUTPUTWORKER_H
+
+#include <logging/logger.h>
+#include <tools/error.h>
+#include <tools/processresult.h>
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qpointer.h>
+#include <QtCore/qprocess.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qvariant.h>
+
+#include <atomic>
+#include <functional>
+
+QT_BEGIN_NAMESPACE
+class QThread;
+QT_END_NAMESPACE
+
+namespace qbs {
+namespace Internal {
+class ProcessOutputWorkerThreadObject;
+class ScriptEngine;
+
+// Everything needed to turn the raw output of a finished process into a ProcessResult.
+// It is self-contained, so it can be handed to another thread.
+class ProcessOutputRequest
+{
+public:
+    QString program;
+    QStringList arguments;
+    QString workingDirectory;
+    QByteArray stdOut;
+    QByteArray stdErr;
+    QProcess::ProcessError error = QProcess::UnknownError;
+    int exitCode = 0;
+    QString stdoutFilterFunction;
+    QString stderrFilterFunction;
+    QString stdoutFilePath;
+    QString stderrFilePath;
+    QVariantMap commandProperties;
+};
+
+class ProcessOutputResult
+{
+public:
+    ProcessResult result; // Everything but the success flag is set.
+    QList<ErrorInfo> warnings; // Must be printed by the receiver.
+};
+
+// Applies output filters, writes redirected output to files and creates the process results
+// on a dedicated thread, so the executor thread can go on scheduling jobs in the meantime.
+// The hand-off is bounded: If too many requests are pending, post() refuses the request
+// and the caller is expected to handle it itself via processOutput().
+class ProcessOutputWorker : public QObject
+{
+    Q_OBJECT
+public:
+    using Callback = std::function<void(const ProcessOutputResult &)>;
+
+    ProcessOutputWorker(const Logger &logger, int capacity, QObject *parent = nullptr);
+    ~ProcessOutputWorker() override;
+
+    // The callback is invoked in the thread the worker lives in, unless the context object
+    // has been destroyed in the meantime.
+    bool post(const ProcessOutputRequest &request, QObject *context, Callback callback);
+
+    static ProcessOutputResult processOutput(const ProcessOutputRequest &request,
+                                             ScriptEngine *engine);
+
+private:
+    struct PendingCallback
+    {
+        QPointer<QObject> context;
+        Callback callback;
+    };
+
+    void deliver(quint64 id, const ProcessOutputResult &result);
+
+    QThread * const m_thread;
+    ProcessOutputWorkerThreadObject * const m_objectInThread;
+    QHash<quint64, PendingCallback> m_callbacks;
+    quint64 m_nextId = 0;
+    const int m_capacity;
+    std::atomic<int> m_pendingCount{0};
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_PROCESSOUTPUTWORKER_H
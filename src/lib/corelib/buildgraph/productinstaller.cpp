@@ -165,7 +165,7 @@ QString ProductInstaller::targetFilePath(const TopLevelProject *project,
 void ProductInstaller::initInstallRoot(const TopLevelProject *project,
                                        InstallOptions &options)
 {
-    if (!options.installRoot().isEmpty())
+    if (!options.installRoot().isEmpty() || !project)
         return;
 
     options.setInstallRoot(effectiveInstallRoot(options, project));
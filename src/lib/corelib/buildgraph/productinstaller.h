@@ -60,6 +60,7 @@ public:
             InstallOptions options, ProgressObserver *observer, Logger logger);
     void install();
 
+    // The project is only needed if the options do not specify the install root.
     static QString targetFilePath(const TopLevelProject *project, const QString &productSourceDir,
             const QString &sourceFilePath, const PropertyMapConstPtr &properties,
             InstallOptions &options);
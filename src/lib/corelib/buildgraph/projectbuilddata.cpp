@@ -98,7 +98,7 @@ QString ProjectBuildData::deriveBuildGraphFilePath(const QString &buildDir, cons
 
 void ProjectBuildData::insertIntoLookupTable(FileResourceBase *fileres)
 {
-    auto &lst = m_artifactLookupTable[{fileres->fileName(), fileres->dirPath()}];
+    auto &lst = m_artifactLookupTable[{fileres->fileNameAtom(), fileres->dirPathAtom()}];
     const auto * const artifact = fileres->fileType() == FileResourceBase::FileTypeArtifact
             ? static_cast<Artifact *>(fileres) : nullptr;
     if (artifact && artifact->artifactType == Artifact::Generated) {
@@ -125,7 +125,7 @@ void ProjectBuildData::insertIntoLookupTable(FileResourceBase *fileres)
 
 void ProjectBuildData::removeFromLookupTable(FileResourceBase *fileres)
 {
-    removeOne(m_artifactLookupTable[{fileres->fileName(), fileres->dirPath()}], fileres);
+    removeOne(m_artifactLookupTable[{fileres->fileNameAtom(), fileres->dirPathAtom()}], fileres);
 }
 
 const std::vector<FileResourceBase *> &ProjectBuildData::lookupFiles(const QString &filePath) const
@@ -135,17 +135,36 @@ const std::vector<FileResourceBase *> &ProjectBuildData::lookupFiles(const QStri
     return lookupFiles(dirPath, fileName);
 }
 
+static const std::vector<FileResourceBase *> &emptyLookupResult()
+{
+    static const std::vector<FileResourceBase *> emptyResult;
+    return emptyResult;
+}
+
 const std::vector<FileResourceBase *> &ProjectBuildData::lookupFiles(const QString &dirPath,
         const QString &fileName) const
 {
-    static const std::vector<FileResourceBase *> emptyResult;
+    // Strings that were never interned cannot be part of any key.
+    const std::optional<PathAtom> dirPathAtom = PathAtom::find(dirPath);
+    if (!dirPathAtom)
+        return emptyLookupResult();
+    const std::optional<PathAtom> fileNameAtom = PathAtom::find(fileName);
+    if (!fileNameAtom)
+        return emptyLookupResult();
+    return lookupFiles(*dirPathAtom, *fileNameAtom);
+}
+
+const std::vector<FileResourceBase *> &ProjectBuildData::lookupFiles(
+        const PathAtom &dirPath, const PathAtom &fileName) const
+{
     const auto it = m_artifactLookupTable.find({fileName, dirPath});
-    return it != m_artifactLookupTable.end() ? it->second : emptyResult;
+    return it != m_artifactLookupTable.end() ? it->second : emptyLookupResult();
 }
 
-const std::vector<FileResourceBase *> &ProjectBuildData::lookupFiles(const Artifact *artifact) const
+const std::vector<FileResourceBase *> &ProjectBuildData::lookupFiles(
+        const FileResourceBase *file) const
 {
-    return lookupFiles(artifact->dirPath(), artifact->fileName());
+    return lookupFiles(file->dirPathAtom(), file->fileNameAtom());
 }
 
 void ProjectBuildData::insertFileDependency(FileDependency *dependency)
@@ -340,7 +359,7 @@ private:
             QString pathstr;
             for (const Rule *r : qAsConst(m_rulePath)) {
                 pathstr += QLatin1Char('\n') + r->toString() + QLatin1Char('\t')
-                        + r->prepareScript.location().toString();
+                        + r->commandsScript().location().toString();
             }
             throw ErrorInfo(Tr::tr("Cycle detected in rule dependencies: %1").arg(pathstr));
         }
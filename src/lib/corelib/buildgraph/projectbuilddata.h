@@ -43,6 +43,7 @@
 #include "rawscanresults.h"
 #include <language/forward_decls.h>
 #include <logging/logger.h>
+#include <tools/pathatom.h>
 #include <tools/persistence.h>
 #include <tools/set.h>
 #include <tools/qttools.h>
@@ -74,7 +75,9 @@ public:
 
     const std::vector<FileResourceBase *> &lookupFiles(const QString &filePath) const;
     const std::vector<FileResourceBase *> &lookupFiles(const QString &dirPath, const QString &fileName) const;
-    const std::vector<FileResourceBase *> &lookupFiles(const Artifact *artifact) const;
+    const std::vector<FileResourceBase *> &lookupFiles(const PathAtom &dirPath,
+                                                       const PathAtom &fileName) const;
+    const std::vector<FileResourceBase *> &lookupFiles(const FileResourceBase *file) const;
     void insertFileDependency(FileDependency *dependency);
     void removeArtifactAndExclusiveDependents(Artifact *artifact, const Logger &logger,
             bool removeFromProduct = true, ArtifactSet *removedArtifacts = nullptr);
@@ -101,7 +104,7 @@ private:
         pool.serializationOp<opType>(fileDependencies, rawScanResults);
     }
 
-    using ArtifactKey = std::pair<QString /*fileName*/, QString /*dirName*/>;
+    using ArtifactKey = std::pair<PathAtom /*fileName*/, PathAtom /*dirName*/>;
     using ArtifactLookupTable = std::unordered_map<ArtifactKey, std::vector<FileResourceBase *>>;
     ArtifactLookupTable m_artifactLookupTable;
 
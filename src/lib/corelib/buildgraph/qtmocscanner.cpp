@@ -83,9 +83,9 @@ public:
 
 private:
     QStringList collectSearchPaths(Artifact *) override { return {}; }
-    QStringList collectDependencies(Artifact *, FileResourceBase *, const char *) override
+    void collectDependencies(Artifact *, FileResourceBase *, const char *,
+                             RawScanResult *) override
     {
-        return {};
     }
     bool recursive() const override { return false; }
     const void *key() const override { return nullptr; }
@@ -95,6 +95,10 @@ private:
     {
         return true;
     }
+    bool areConditionMacrosCompatible(const ConditionMacros &, const Artifact *) override
+    {
+        return true;
+    }
     bool cacheIsPerFile() const override { return false; }
 
     const QString m_id;
@@ -126,7 +130,8 @@ static RawScanResult runScanner(ScannerPlugin *scanner, const Artifact *artifact
     RawScanResults &rawScanResults
             = artifact->product->topLevelProject()->buildData->rawScanResults;
     RawScanResults::ScanData &scanData = rawScanResults.findScanData(artifact, &depScanner,
-                                                                     artifact->properties);
+                                                                     artifact->properties,
+                                                                     artifact);
     if (scanData.lastScanTime < artifact->timestamp()) {
         FileTags tags = artifact->fileTags();
         if (tags.contains(commonFileTags->cppCombine)) {
@@ -48,18 +48,23 @@ RawScannedDependency::RawScannedDependency() : m_isClean(true) {}
 
 RawScannedDependency::RawScannedDependency(const QString &filePath)
 {
-    FileInfo::splitIntoDirectoryAndFileName(filePath, &m_dirPath, &m_fileName);
+    QString dirPath;
+    QString fileName;
+    FileInfo::splitIntoDirectoryAndFileName(filePath, &dirPath, &fileName);
+    m_dirPath = PathAtom::intern(dirPath);
+    m_fileName = PathAtom::intern(fileName);
     setClean();
 }
 
 QString RawScannedDependency::filePath() const
 {
-    return m_dirPath.isEmpty() ? m_fileName : m_dirPath + QLatin1Char('/') + m_fileName;
+    return m_dirPath.isNull() ? fileName() : dirPath() + QLatin1Char('/') + fileName();
 }
 
 void RawScannedDependency::setClean()
 {
-    m_isClean = !m_dirPath.contains(QLatin1Char('.')) && !m_dirPath.contains(QStringLiteral("//"));
+    const QString &dirPath = m_dirPath.toString();
+    m_isClean = !dirPath.contains(QLatin1Char('.')) && !dirPath.contains(QStringLiteral("//"));
 }
 
 void RawScannedDependency::load(PersistentPool &pool)
@@ -75,7 +80,7 @@ void RawScannedDependency::store(PersistentPool &pool)
 
 bool operator==(const RawScannedDependency &d1, const RawScannedDependency &d2)
 {
-    return d1.dirPath() == d2.dirPath() && d1.fileName() == d2.fileName();
+    return d1.dirPathAtom() == d2.dirPathAtom() && d1.fileNameAtom() == d2.fileNameAtom();
 }
 
 
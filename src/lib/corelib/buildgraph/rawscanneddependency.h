@@ -40,6 +40,7 @@
 #ifndef QBS_RAWSCANNEDDEPENDENCY_H
 #define QBS_RAWSCANNEDDEPENDENCY_H
 
+#include <tools/pathatom.h>
 #include <tools/persistence.h>
 
 #include <QtCore/qstring.h>
@@ -55,10 +56,12 @@ public:
     RawScannedDependency(const QString &filePath);
 
     QString filePath() const;
-    const QString &dirPath() const { return m_dirPath; }
-    const QString &fileName() const { return m_fileName; }
+    const QString &dirPath() const { return m_dirPath.toString(); }
+    const QString &fileName() const { return m_fileName.toString(); }
+    const PathAtom &dirPathAtom() const { return m_dirPath; }
+    const PathAtom &fileNameAtom() const { return m_fileName; }
     bool isClean() const { return m_isClean; }
-    bool isValid() const { return !m_fileName.isEmpty(); }
+    bool isValid() const { return !m_fileName.isNull(); }
 
     void load(PersistentPool &pool);
     void store(PersistentPool &pool);
@@ -70,8 +73,8 @@ private:
         pool.serializationOp<opType>(m_dirPath, m_fileName);
     }
 
-    QString m_dirPath;
-    QString m_fileName;
+    PathAtom m_dirPath;
+    PathAtom m_fileName;
     bool m_isClean = 0;
 };
 
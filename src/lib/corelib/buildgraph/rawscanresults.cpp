@@ -49,16 +49,22 @@ namespace Internal {
 
 RawScanResults::ScanData &RawScanResults::findScanData(
         const FileResourceBase *file,
-        const DependencyScanner *scanner,
-        const PropertyMapConstPtr &moduleProperties)
+        DependencyScanner *scanner,
+        const PropertyMapConstPtr &moduleProperties,
+        const Artifact *inputArtifact)
 {
-    std::vector<ScanData> &scanDataForFile = m_rawScanData[file->filePath()];
+    std::vector<ScanData> &scanDataForFile
+            = m_rawScanData[{file->dirPathAtom(), file->fileNameAtom()}];
     const QString &scannerId = scanner->id();
     for (auto &scanData : scanDataForFile) {
         if (scannerId != scanData.scannerId)
             continue;
         if (!scanner->areModulePropertiesCompatible(moduleProperties, scanData.moduleProperties))
             continue;
+        if (!scanner->areConditionMacrosCompatible(scanData.rawScanResult.conditionMacros,
+                                                   inputArtifact)) {
+            continue;
+        }
         return scanData;
     }
     ScanData newScanData;
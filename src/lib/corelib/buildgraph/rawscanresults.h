@@ -46,27 +46,40 @@
 #include <language/forward_decls.h>
 #include <language/propertymapinternal.h>
 #include <tools/filetime.h>
+#include <tools/pathatom.h>
 #include <tools/persistence.h>
+#include <tools/qttools.h>
 
-#include <QtCore/qhash.h>
 #include <QtCore/qstring.h>
 
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace qbs {
 namespace Internal {
+class Artifact;
 class DependencyScanner;
 class FileResourceBase;
 
+// The macros a scanner looked up while evaluating preprocessor conditions, each together with
+// the definition it was given ("#define NAME value", "#undef NAME" or empty if unknown).
+using ConditionMacros = std::vector<std::pair<QString, QString>>;
+
 class RawScanResult
 {
 public:
     std::vector<RawScannedDependency> deps;
+
+    // The compiled interfaces of imported C++ modules. They are not scanned themselves.
+    std::vector<RawScannedDependency> moduleDeps;
+
     FileTags additionalFileTags;
+    ConditionMacros conditionMacros;
 
     template<PersistentPool::OpType opType> void completeSerializationOp(PersistentPool &pool)
     {
-        pool.serializationOp<opType>(deps, additionalFileTags);
+        pool.serializationOp<opType>(deps, moduleDeps, additionalFileTags, conditionMacros);
     }
 };
 
@@ -88,8 +101,9 @@ public:
 
     ScanData &findScanData(
             const FileResourceBase *file,
-            const DependencyScanner *scanner,
-            const PropertyMapConstPtr &moduleProperties);
+            DependencyScanner *scanner,
+            const PropertyMapConstPtr &moduleProperties,
+            const Artifact *inputArtifact);
 
     template<PersistentPool::OpType opType> void completeSerializationOp(PersistentPool &pool)
     {
@@ -97,7 +111,8 @@ public:
     }
 
 private:
-    QHash<QString, std::vector<ScanData>> m_rawScanData;
+    using FileKey = std::pair<PathAtom /*dirPath*/, PathAtom /*fileName*/>;
+    std::unordered_map<FileKey, std::vector<ScanData>> m_rawScanData;
 };
 
 } // namespace Internal
@@ -0,0 +1,158 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "remotecommandexecutor.h"
+
+#include "artifact.h"
+#include "filedependency.h"
+#include "rulecommands.h"
+#include "transformer.h"
+
+#include <language/scriptengine.h>
+#include <logging/categories.h>
+#include <logging/translator.h>
+#include <tools/qttools.h>
+#include <tools/remoteexecutionclient.h>
+#include <tools/set.h>
+
+#include <QtCore/qtimer.h>
+
+namespace qbs {
+namespace Internal {
+
+RemoteCommandExecutor::RemoteCommandExecutor(const Logger &logger, RemoteExecutionClient *client,
+                                             QObject *parent)
+    : ProcessCommandExecutor(logger, parent), m_client(client)
+{
+    connect(m_client, &RemoteExecutionClient::finished,
+            this, &RemoteCommandExecutor::onRemoteExecutionFinished);
+}
+
+bool RemoteCommandExecutor::canRunRemotely(const AbstractCommand *command)
+{
+    return command->type() == AbstractCommand::ProcessCommandType
+            && static_cast<const ProcessCommand *>(command)->allowRemoteExecution();
+}
+
+void RemoteCommandExecutor::startProcess(const QString &workingDir,
+                                         const QStringList &arguments)
+{
+    // The response file is a local temporary file that the worker would not know about.
+    if (usesResponseFile()) {
+        ProcessCommandExecutor::startProcess(workingDir, arguments);
+        return;
+    }
+
+    RemoteExecutionClient::Request request;
+    request.program = program();
+    request.arguments = arguments;
+    request.workingDirectory = workingDir;
+    request.environment = commandEnvironment();
+    request.inputFilePaths = inputFilePaths();
+    request.outputFilePaths = outputFilePaths();
+    m_workingDir = workingDir;
+    m_token = m_client->execute(request);
+    qCDebug(lcExec) << "running command remotely, request" << m_token;
+}
+
+void RemoteCommandExecutor::cancelProcess()
+{
+    if (!m_token) {
+        ProcessCommandExecutor::cancelProcess();
+        return;
+    }
+    m_client->cancel(m_token);
+    m_token = 0;
+    m_outcome = ProcessOutcome();
+    m_outcome.workingDirectory = m_workingDir;
+    m_outcome.error = QProcess::Crashed;
+    m_outcome.errorString = Tr::tr("Remote execution canceled.");
+    m_outcome.exitCode = -1;
+    QTimer::singleShot(0, this, &RemoteCommandExecutor::finishRemoteExecution);
+}
+
+void RemoteCommandExecutor::onRemoteExecutionFinished(quintptr token,
+                                                      const RemoteExecutionFinishedPacket &result)
+{
+    if (!m_token || token != m_token)
+        return;
+    m_token = 0;
+    m_outcome = ProcessOutcome();
+    m_outcome.workingDirectory = m_workingDir;
+    m_outcome.stdOut = result.stdOut;
+    m_outcome.stdErr = result.stdErr;
+    m_outcome.errorString = result.errorString;
+    m_outcome.error = result.error;
+    m_outcome.exitCode = result.exitCode;
+    finishRemoteExecution();
+}
+
+void RemoteCommandExecutor::finishRemoteExecution()
+{
+    if (scriptEngine()->isActive()) {
+        qCDebug(lcExec) << "Remote command finished while rule execution is pausing. "
+                           "Delaying slot execution.";
+        QTimer::singleShot(0, this, &RemoteCommandExecutor::finishRemoteExecution);
+        return;
+    }
+    finishProcess(m_outcome);
+}
+
+QStringList RemoteCommandExecutor::inputFilePaths() const
+{
+    Set<QString> filePaths;
+    for (const Artifact * const output : qAsConst(transformer()->outputs)) {
+        for (const Artifact * const child : filterByType<Artifact>(output->children))
+            filePaths.insert(child->filePath());
+        for (const FileDependency * const fileDependency : qAsConst(output->fileDependencies))
+            filePaths.insert(fileDependency->filePath());
+    }
+    return filePaths.toList();
+}
+
+QStringList RemoteCommandExecutor::outputFilePaths() const
+{
+    QStringList filePaths;
+    for (const Artifact * const output : qAsConst(transformer()->outputs))
+        filePaths << output->filePath();
+    return filePaths;
+}
+
+} // namespace Internal
+} // namespace qbs
@@ -0,0 +1,81 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_REMOTECOMMANDEXECUTOR_H
+#define QBS_REMOTECOMMANDEXECUTOR_H
+
+#include "processcommandexecutor.h"
+
+namespace qbs {
+namespace Internal {
+class RemoteExecutionClient;
+class RemoteExecutionFinishedPacket;
+
+// Ships process commands to a remote worker. Commands that do not qualify for remote execution,
+// e.g. because they need a response file, are run locally.
+class RemoteCommandExecutor : public ProcessCommandExecutor
+{
+    Q_OBJECT
+public:
+    RemoteCommandExecutor(const Internal::Logger &logger, RemoteExecutionClient *client,
+                          QObject *parent = nullptr);
+
+    // A command can run remotely if it opted in via allowRemoteExecution, which declares that
+    // it reads no files other than the ones known to the build graph and the tool itself.
+    static bool canRunRemotely(const AbstractCommand *command);
+
+private:
+    void startProcess(const QString &workingDir, const QStringList &arguments) override;
+    void cancelProcess() override;
+    void onRemoteExecutionFinished(quintptr token, const RemoteExecutionFinishedPacket &result);
+    void finishRemoteExecution();
+
+    QStringList inputFilePaths() const;
+    QStringList outputFilePaths() const;
+
+    RemoteExecutionClient * const m_client;
+    quintptr m_token = 0;
+    QString m_workingDir;
+    ProcessOutcome m_outcome;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_REMOTECOMMANDEXECUTOR_H
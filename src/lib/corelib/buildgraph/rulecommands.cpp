@@ -51,9 +51,12 @@
 #include <QtScript/qscriptengine.h>
 #include <QtScript/qscriptvalueiterator.h>
 
+#include <algorithm>
+
 namespace qbs {
 namespace Internal {
 
+static QString allowRemoteExecutionProperty() { return QStringLiteral("allowRemoteExecution"); }
 static QString argumentsProperty() { return QStringLiteral("arguments"); }
 static QString environmentProperty() { return QStringLiteral("environment"); }
 static QString extendedDescriptionProperty() { return QStringLiteral("extendedDescription"); }
@@ -77,6 +80,7 @@ static QString stderrFilterFunctionProperty() { return QStringLiteral("stderrFil
 static QString stdoutFilePathProperty() { return QStringLiteral("stdoutFilePath"); }
 static QString stdoutFilterFunctionProperty() { return QStringLiteral("stdoutFilterFunction"); }
 static QString timeoutProperty() { return QStringLiteral("timeout"); }
+static QString expectedMemoryUsageProperty() { return QStringLiteral("expectedMemoryUsage"); }
 static QString workingDirProperty() { return QStringLiteral("workingDirectory"); }
 
 static QString invokedSourceCode(const QScriptValue &codeOrFunction)
@@ -91,7 +95,8 @@ AbstractCommand::AbstractCommand()
       m_highlight(defaultHighLight()),
       m_ignoreDryRun(defaultIgnoreDryRun()),
       m_silent(defaultIsSilent()),
-      m_timeout(defaultTimeout())
+      m_timeout(defaultTimeout()),
+      m_expectedMemoryUsage(defaultExpectedMemoryUsage())
 {
 }
 
@@ -107,6 +112,7 @@ bool AbstractCommand::equals(const AbstractCommand *other) const
             && m_silent == other->m_silent
             && m_jobPool == other->m_jobPool
             && m_timeout == other->m_timeout
+            && m_expectedMemoryUsage == other->m_expectedMemoryUsage
             && m_properties == other->m_properties;
 }
 
@@ -121,10 +127,13 @@ void AbstractCommand::fillFromScriptValue(const QScriptValue *scriptValue, const
     const auto timeoutScriptValue = scriptValue->property(timeoutProperty());
     if (!timeoutScriptValue.isUndefined() && !timeoutScriptValue.isNull())
         m_timeout = timeoutScriptValue.toInt32();
+    m_expectedMemoryUsage = std::max(0, scriptValue->property(expectedMemoryUsageProperty())
+                                     .toInt32());
     m_codeLocation = codeLocation;
 
     m_predefinedProperties
             << StringConstants::descriptionProperty()
+            << expectedMemoryUsageProperty()
             << extendedDescriptionProperty()
             << highlightProperty()
             << ignoreDryRunProperty()
@@ -182,6 +191,8 @@ static QScriptValue js_CommandBase(QScriptContext *context, QScriptEngine *engin
                     engine->toScriptValue(AbstractCommand::defaultIsSilent()));
     cmd.setProperty(timeoutProperty(),
                     engine->toScriptValue(AbstractCommand::defaultTimeout()));
+    cmd.setProperty(expectedMemoryUsageProperty(),
+                    engine->toScriptValue(AbstractCommand::defaultExpectedMemoryUsage()));
     return cmd;
 }
 
@@ -227,6 +238,8 @@ static QScriptValue js_Command(QScriptContext *context, QScriptEngine *engine)
                     engine->toScriptValue(commandPrototype->environment().toStringList()));
     cmd.setProperty(ignoreDryRunProperty(),
                     engine->toScriptValue(commandPrototype->ignoreDryRun()));
+    cmd.setProperty(allowRemoteExecutionProperty(),
+                    engine->toScriptValue(commandPrototype->allowRemoteExecution()));
     return cmd;
 }
 
@@ -243,6 +256,7 @@ ProcessCommand::ProcessCommand()
     , m_responseFileThreshold(defaultResponseFileThreshold())
     , m_responseFileArgumentIndex(0)
     , m_responseFileSeparator(QStringLiteral("\n"))
+    , m_allowRemoteExecution(false)
 {
 }
 
@@ -323,6 +337,7 @@ void ProcessCommand::fillFromScriptValue(const QScriptValue *scriptValue, const
     getEnvironmentFromList(envList);
     m_stdoutFilePath = scriptValue->property(stdoutFilePathProperty()).toString();
     m_stderrFilePath = scriptValue->property(stderrFilePathProperty()).toString();
+    m_allowRemoteExecution = scriptValue->property(allowRemoteExecutionProperty()).toBool();
 
     m_predefinedProperties
             << programProperty()
@@ -336,7 +351,8 @@ void ProcessCommand::fillFromScriptValue(const QScriptValue *scriptValue, const
             << responseFileUsagePrefixProperty()
             << environmentProperty()
             << stdoutFilePathProperty()
-            << stderrFilePathProperty();
+            << stderrFilePathProperty()
+            << allowRemoteExecutionProperty();
     applyCommandProperties(scriptValue);
 }
 
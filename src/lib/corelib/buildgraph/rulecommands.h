@@ -72,6 +72,7 @@ public:
     static bool defaultIgnoreDryRun() { return false; }
     static bool defaultIsSilent() { return false; }
     static int defaultTimeout() { return -1; }
+    static int defaultExpectedMemoryUsage() { return 0; }
 
     virtual CommandType type() const = 0;
     virtual bool equals(const AbstractCommand *other) const;
@@ -86,6 +87,7 @@ public:
     QString jobPool() const { return m_jobPool; }
     CodeLocation codeLocation() const { return m_codeLocation; }
     int timeout() const { return m_timeout; }
+    int expectedMemoryUsage() const { return m_expectedMemoryUsage; } // In MiB.
 
     const QVariantMap &properties() const { return m_properties; }
 
@@ -103,7 +105,7 @@ private:
     {
         pool.serializationOp<opType>(m_description, m_extendedDescription, m_highlight,
                                      m_ignoreDryRun, m_silent, m_codeLocation, m_jobPool,
-                                     m_timeout, m_properties);
+                                     m_timeout, m_expectedMemoryUsage, m_properties);
     }
 
     QString m_description;
@@ -114,6 +116,7 @@ private:
     CodeLocation m_codeLocation;
     QString m_jobPool;
     int m_timeout;
+    int m_expectedMemoryUsage;
     QVariantMap m_properties;
 };
 
@@ -145,6 +148,9 @@ public:
     QString stdoutFilePath() const { return m_stdoutFilePath; }
     QString stderrFilePath() const { return m_stderrFilePath; }
 
+    // Not part of equals(), as where a command runs does not influence its outputs.
+    bool allowRemoteExecution() const { return m_allowRemoteExecution; }
+
     void load(PersistentPool &pool) override;
     void store(PersistentPool &pool) override;
 
@@ -162,7 +168,8 @@ private:
                                      m_responseFileUsagePrefix, m_responseFileSeparator,
                                      m_maxExitCode, m_responseFileThreshold,
                                      m_responseFileArgumentIndex, m_relevantEnvVars,
-                                     m_relevantEnvValues, m_stdoutFilePath, m_stderrFilePath);
+                                     m_relevantEnvValues, m_stdoutFilePath, m_stderrFilePath,
+                                     m_allowRemoteExecution);
     }
 
     QString m_program;
@@ -180,6 +187,7 @@ private:
     QProcessEnvironment m_relevantEnvValues;
     QString m_stdoutFilePath;
     QString m_stderrFilePath;
+    bool m_allowRemoteExecution;
 };
 
 class JavaScriptCommand : public AbstractCommand
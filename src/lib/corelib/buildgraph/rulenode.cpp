@@ -71,7 +71,7 @@ QString RuleNode::toString() const
 {
     return QLatin1String("RULE ") + m_rule->toString() + QLatin1String(" [")
             + (!product.expired() ? product->name : QLatin1String("<null>")) + QLatin1Char(']')
-            + QLatin1String(" located at ") + m_rule->prepareScript.location().toString();
+            + QLatin1String(" located at ") + m_rule->commandsScript().location().toString();
 }
 
 void RuleNode::apply(const Logger &logger,
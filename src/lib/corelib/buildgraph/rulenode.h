@@ -46,6 +46,7 @@
 #include <language/forward_decls.h>
 #include <tools/dynamictypecheck.h>
 #include <tools/persistence.h>
+#include <tools/slaballocator.h>
 
 #include <unordered_map>
 
@@ -54,7 +55,7 @@ namespace Internal {
 
 class Logger;
 
-class RuleNode : public BuildGraphNode
+class RuleNode : public BuildGraphNode, public SlabAllocated
 {
 public:
     RuleNode();
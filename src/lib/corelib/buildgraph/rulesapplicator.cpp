@@ -96,6 +96,35 @@ RulesApplicator::~RulesApplicator()
     delete m_mocScanner;
 }
 
+static ScriptRequests takeScriptRequests(ScriptEngine *engine)
+{
+    ScriptRequests requests;
+    requests.properties = engine->propertiesRequestedInScript();
+    requests.propertiesFromArtifact = engine->propertiesRequestedFromArtifact();
+    requests.importedFiles = engine->importedFilesUsedInScript();
+    requests.productsWithRequestedDependencies = engine->productsWithRequestedDependencies();
+    requests.artifacts = engine->requestedArtifacts();
+    requests.exports = engine->requestedExports();
+    engine->clearRequestedProperties();
+    return requests;
+}
+
+static void addScriptRequests(Transformer *transformer, const ScriptRequests &requests)
+{
+    transformer->propertiesRequestedInPrepareScript += requests.properties;
+    unite(transformer->propertiesRequestedFromArtifactInPrepareScript,
+          requests.propertiesFromArtifact);
+    transformer->importedFilesUsedInPrepareScript.insert(
+                transformer->importedFilesUsedInPrepareScript.cend(),
+                requests.importedFiles.cbegin(), requests.importedFiles.cend());
+    transformer->depsRequestedInPrepareScript.add(requests.productsWithRequestedDependencies);
+    transformer->artifactsMapRequestedInPrepareScript.unite(requests.artifacts);
+    for (const ResolvedProduct * const p : requests.exports) {
+        transformer->exportedModulesAccessedInPrepareScript.insert(
+                    std::make_pair(p->uniqueName(), p->exportedModule));
+    }
+}
+
 void RulesApplicator::applyRule(RuleNode *ruleNode, const ArtifactSet &inputArtifacts,
                                 const ArtifactSet &explicitlyDependsOn)
 {
@@ -126,16 +155,114 @@ void RulesApplicator::applyRule(RuleNode *ruleNode, const ArtifactSet &inputArti
     if (m_rule->multiplex) { // apply the rule once for a set of inputs
         doApply(inputArtifacts, prepareScriptContext);
     } else { // apply the rule once for each input
+        // A batchPrepare script creates the commands for all inputs in one call.
+        // The moc scanner is bound to the executor thread's scope, so the prepare scripts
+        // of the moc rules cannot be run elsewhere.
+        m_batchPrepareScripts = m_rule->hasBatchPrepareScript();
+        PrepareScriptWorkerPool * const workerPool = !m_batchPrepareScripts
+                && inputArtifacts.size() > 1 && !m_mocScanner
+                ? evalContext()->prepareScriptWorkerPool() : nullptr;
+        m_deferPrepareScripts = workerPool != nullptr;
         for (Artifact * const inputArtifact : inputArtifacts) {
             ArtifactSet lst;
             lst += inputArtifact;
             doApply(lst, prepareScriptContext);
         }
+        if (m_batchPrepareScripts)
+            runBatchPrepareScript(prepareScriptContext);
+        else if (m_deferPrepareScripts)
+            runDeferredPrepareScripts(workerPool);
     }
     if (engine()->usesIo())
         m_ruleUsesIo = true;
 }
 
+void RulesApplicator::runDeferredPrepareScripts(PrepareScriptWorkerPool *workerPool)
+{
+    m_deferPrepareScripts = false;
+    std::vector<PrepareScriptTask> tasks;
+    std::vector<DeferredPrepareScript> deferred;
+    std::swap(tasks, m_prepareScriptTasks);
+    std::swap(deferred, m_deferredPrepareScripts);
+    workerPool->run(tasks, evalContext()->observer());
+    evalContext()->checkForCancelation();
+
+    // Merge in input order, so that the outcome, including which error gets reported,
+    // does not depend on thread scheduling.
+    for (std::size_t i = 0; i < tasks.size(); ++i) {
+        PrepareScriptTask &task = tasks.at(i);
+        if (task.error.hasError())
+            throw task.error;
+        if (task.usesIo)
+            m_ruleUsesIo = true;
+        Transformer * const transformer = task.transformer.get();
+        addScriptRequests(transformer, deferred.at(i).requests);
+        finishTransformer(deferred.at(i).oldTransformer.get(), transformer,
+                          deferred.at(i).outputArtifacts);
+    }
+}
+
+void RulesApplicator::runBatchPrepareScript(QScriptValue &prepareScriptContext)
+{
+    m_batchPrepareScripts = false;
+    std::vector<DeferredPrepareScript> batch;
+    std::swap(batch, m_deferredPrepareScripts);
+    if (batch.empty())
+        return;
+
+    const PrivateScriptFunction &script = m_rule->batchPrepareScript;
+    if (!script.scriptFunction.isValid() || script.scriptFunction.engine() != engine()) {
+        script.scriptFunction = engine()->evaluate(script.sourceCode(),
+                                                   script.location().filePath(),
+                                                   script.location().line());
+        if (Q_UNLIKELY(!script.scriptFunction.isFunction()))
+            throw ErrorInfo(Tr::tr("Invalid batchPrepare script."), script.location());
+    }
+
+    // Every batch entry looks like the context of a regular prepare script,
+    // minus project and product, which are the same for all entries.
+    QScriptValue batchValue = engine()->newArray(quint32(batch.size()));
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        Transformer * const transformer = batch.at(i).transformer.get();
+        QScriptValue entry = engine()->newObject();
+        transformer->setupInputs(entry);
+        transformer->setupOutputs(entry);
+        transformer->setupExplicitlyDependsOn(entry);
+        batchValue.setProperty(quint32(i), entry);
+    }
+    prepareScriptContext.setProperty(StringConstants::batchVar(), batchValue);
+
+    evalContext()->checkForCancelation();
+    const QScriptValue result = script.scriptFunction.call(QScriptValue(),
+            ScriptEngine::argumentList(Rule::argumentNamesForBatchPrepare(),
+                                       prepareScriptContext));
+    engine()->releaseResourcesOfScriptObjects();
+    prepareScriptContext.setProperty(StringConstants::batchVar(), QScriptValue());
+
+    // We cannot tell which entry a property was requested for, so every transformer
+    // depends on all the requests made by the script.
+    const ScriptRequests batchRequests = takeScriptRequests(engine());
+    if (Q_UNLIKELY(engine()->hasErrorOrException(result)))
+        throw engine()->lastError(result, script.location());
+    if (Q_UNLIKELY(!result.isArray() || result.property(StringConstants::lengthProperty())
+                   .toUInt32() != batch.size())) {
+        throw ErrorInfo(Tr::tr("The batchPrepare script must return an array with one "
+                               "list of commands for each of the %1 batch entries.")
+                        .arg(int(batch.size())), script.location());
+    }
+
+    const FileTime executionTime = FileTime::currentTime();
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        Transformer * const transformer = batch.at(i).transformer.get();
+        addScriptRequests(transformer, batch.at(i).requests);
+        addScriptRequests(transformer, batchRequests);
+        transformer->lastPrepareScriptExecutionTime = executionTime;
+        transformer->setCommandsFromScriptValue(result.property(quint32(i)), script.location());
+        finishTransformer(batch.at(i).oldTransformer.get(), transformer,
+                          batch.at(i).outputArtifacts);
+    }
+}
+
 void RulesApplicator::handleRemovedRuleOutputs(const ArtifactSet &inputArtifacts,
         const ArtifactSet &outputArtifactsToRemove, QStringList &removedArtifacts,
         const Logger &logger)
@@ -299,24 +426,47 @@ void RulesApplicator::doApply(const ArtifactSet &inputArtifacts, QScriptValue &p
     if (!ruleArtifactArtifactMap.empty())
         engine()->setGlobalObject(prepareScriptContext.prototype());
 
+    if (m_deferPrepareScripts || m_batchPrepareScripts) {
+        if (m_deferPrepareScripts) {
+            PrepareScriptTask task;
+            task.transformer = m_transformer;
+            task.product = m_product.get();
+            m_prepareScriptTasks.push_back(std::move(task));
+        }
+        DeferredPrepareScript deferred;
+        deferred.transformer = m_transformer;
+        deferred.oldTransformer = m_oldTransformer;
+        deferred.outputArtifacts = outputArtifacts;
+        deferred.requests = takeScriptRequests(engine());
+        m_deferredPrepareScripts.push_back(std::move(deferred));
+        return;
+    }
+
     m_transformer->setupOutputs(prepareScriptContext);
     m_transformer->createCommands(engine(), m_rule->prepareScript,
             ScriptEngine::argumentList(Rule::argumentNamesForPrepare(), prepareScriptContext));
-    if (Q_UNLIKELY(m_transformer->commands.empty()))
+    finishTransformer(m_oldTransformer.get(), m_transformer.get(), outputArtifacts);
+}
+
+void RulesApplicator::finishTransformer(const Transformer *oldTransformer,
+                                        Transformer *transformer,
+                                        const QList<Artifact *> &outputArtifacts)
+{
+    if (Q_UNLIKELY(transformer->commands.empty()))
         throw ErrorInfo(Tr::tr("There is a rule without commands: %1.")
-                        .arg(m_rule->toString()), m_rule->prepareScript.location());
-    if (!m_oldTransformer || m_oldTransformer->outputs != m_transformer->outputs
-            || m_oldTransformer->inputs != m_transformer->inputs
-            || m_oldTransformer->explicitlyDependsOn != m_transformer->explicitlyDependsOn
-            || m_oldTransformer->commands != m_transformer->commands
-            || commandsNeedRerun(m_transformer.get(), m_product.get(), m_productsByName,
+                        .arg(m_rule->toString()), m_rule->commandsScript().location());
+    if (!oldTransformer || oldTransformer->outputs != transformer->outputs
+            || oldTransformer->inputs != transformer->inputs
+            || oldTransformer->explicitlyDependsOn != transformer->explicitlyDependsOn
+            || oldTransformer->commands != transformer->commands
+            || commandsNeedRerun(transformer, m_product.get(), m_productsByName,
                                  m_projectsByName)) {
-        for (Artifact * const output : qAsConst(outputArtifacts)) {
+        for (Artifact * const output : outputArtifacts) {
             output->clearTimestamp();
             m_invalidatedArtifacts += output;
         }
     }
-    m_transformer->commandsNeedChangeTracking = false;
+    transformer->commandsNeedChangeTracking = false;
 }
 
 ArtifactSet RulesApplicator::collectOldOutputArtifacts(const ArtifactSet &inputArtifacts) const
@@ -426,7 +576,7 @@ RulesApplicator::OutputArtifactInfo RulesApplicator::createOutputArtifact(const
             throw ErrorInfo(Tr::tr("Artifact '%1' has undeclared file tags [\"%2\"].")
                             .arg(outputPath, undeclaredTags.toStringList()
                                  .join(QLatin1String("\",\""))),
-                            m_rule->prepareScript.location());
+                            m_rule->commandsScript().location());
         }
     }
 
@@ -447,15 +597,15 @@ RulesApplicator::OutputArtifactInfo RulesApplicator::createOutputArtifact(const
                     .join(QLatin1String(", ")) + QLatin1Char(']');
 
             e += QStringLiteral("  while trying to apply:   %1:%2:%3  %4\n")
-                .arg(m_rule->prepareScript.location().filePath())
-                .arg(m_rule->prepareScript.location().line())
-                .arg(m_rule->prepareScript.location().column())
+                .arg(m_rule->commandsScript().location().filePath())
+                .arg(m_rule->commandsScript().location().line())
+                .arg(m_rule->commandsScript().location().column())
                 .arg(str);
 
             e += QStringLiteral("  was already defined in:  %1:%2:%3  %4\n")
-                .arg(transformer->rule->prepareScript.location().filePath())
-                .arg(transformer->rule->prepareScript.location().line())
-                .arg(transformer->rule->prepareScript.location().column())
+                .arg(transformer->rule->commandsScript().location().filePath())
+                .arg(transformer->rule->commandsScript().location().line())
+                .arg(transformer->rule->commandsScript().location().column())
                 .arg(str);
 
             throw ErrorInfo(e);
@@ -464,7 +614,7 @@ RulesApplicator::OutputArtifactInfo RulesApplicator::createOutputArtifact(const
             QBS_CHECK(inputArtifacts.size() == 1);
             QBS_CHECK(transformer->inputs.size() == 1);
             ErrorInfo error(Tr::tr("Conflicting instances of rule '%1':").arg(m_rule->toString()),
-                            m_rule->prepareScript.location());
+                            m_rule->commandsScript().location());
             error.append(Tr::tr("Output artifact '%1' is to be produced from input "
                                 "artifacts '%2' and '%3', but the rule is not a multiplex rule.")
                          .arg(outputArtifact->filePath(),
@@ -516,24 +666,94 @@ public:
 QList<Artifact *> RulesApplicator::runOutputArtifactsScript(const ArtifactSet &inputArtifacts,
         const QScriptValueList &args)
 {
+    OutputArtifactsScriptResult result = cachedOutputArtifactsScriptResult(inputArtifacts);
+    if (result.isValid()) {
+        qCDebug(lcBuildGraph) << "outputArtifacts script of rule" << m_rule->toString()
+                              << "does not need to run";
+    } else {
+        result = evaluateOutputArtifactsScript(inputArtifacts, args);
+    }
+
     QList<Artifact *> lst;
+    for (std::size_t i = 0; i < result.outputs.size(); ++i) {
+        try {
+            lst.push_back(createOutputArtifactFromScriptResult(result.outputs.at(i),
+                                                               inputArtifacts));
+        } catch (const RuleOutputArtifactsException &roae) {
+            ErrorInfo ei = roae;
+            ei.prepend(Tr::tr("Error in Rule.outputArtifacts[%1]").arg(i),
+                       m_rule->outputArtifactsScript.location());
+            throw ei;
+        }
+    }
+    m_transformer->outputArtifactsScriptResult = std::move(result);
+    return lst;
+}
+
+OutputArtifactsScriptResult RulesApplicator::cachedOutputArtifactsScriptResult(
+        const ArtifactSet &inputArtifacts) const
+{
+    const ArtifactSet oldOutputs = collectOldOutputArtifacts(inputArtifacts);
+    if (oldOutputs.empty())
+        return {};
+    const Transformer * const oldTransformer = (*oldOutputs.cbegin())->transformer.get();
+    const OutputArtifactsScriptResult &result = oldTransformer->outputArtifactsScriptResult;
+    if (!result.isValid() || !result.reusable || oldTransformer->inputs != inputArtifacts
+            || oldTransformer->explicitlyDependsOn != m_explicitlyDependsOn) {
+        return {};
+    }
+    if (!outputArtifactsScriptResultIsUpToDate(oldTransformer, m_product.get(), m_productsByName,
+                                               m_projectsByName)) {
+        return {};
+    }
+    return result;
+}
+
+OutputArtifactsScriptResult RulesApplicator::evaluateOutputArtifactsScript(
+        const ArtifactSet &inputArtifacts, const QScriptValueList &args)
+{
     QScriptValue fun = engine()->evaluate(m_rule->outputArtifactsScript.sourceCode(),
                                           m_rule->outputArtifactsScript.location().filePath(),
                                           m_rule->outputArtifactsScript.location().line());
     if (!fun.isFunction())
         throw ErrorInfo(QStringLiteral("Function expected."),
                         m_rule->outputArtifactsScript.location());
+    const bool usedIoBefore = engine()->usesIo();
+    engine()->clearUsesIo();
+    engine()->clearFileSystemQueried();
     QScriptValue res = fun.call(QScriptValue(), args);
     engine()->releaseResourcesOfScriptObjects();
+
+    OutputArtifactsScriptResult result;
+    result.propertiesRequested = engine()->propertiesRequestedInScript();
+    result.propertiesRequestedFromArtifact = engine()->propertiesRequestedFromArtifact();
+    result.importedFilesUsed = engine()->importedFilesUsedInScript();
+    result.depsRequested = engine()->requestedDependencies();
+    result.artifactsMapRequested = engine()->requestedArtifacts();
+    for (const ResolvedProduct * const p : engine()->requestedExports()) {
+        result.exportedModulesAccessed.insert(std::make_pair(p->uniqueName(),
+                                                             p->exportedModule));
+    }
+
+    result.executionTime = FileTime::currentTime();
+
+    // A script that read files or looked at the file system in any other way can depend on
+    // arbitrary state that we do not track, so its result must not be re-used.
+    result.reusable = !engine()->usesIo() && !engine()->fileSystemQueried();
+    engine()->clearRequestedProperties();
+    if (usedIoBefore)
+        engine()->setUsesIo();
+
     if (engine()->hasErrorOrException(res))
         throw engine()->lastError(res, m_rule->outputArtifactsScript.location());
     if (!res.isArray())
         throw ErrorInfo(Tr::tr("Rule.outputArtifacts must return an array of objects."),
                         m_rule->outputArtifactsScript.location());
     const quint32 c = res.property(StringConstants::lengthProperty()).toUInt32();
+    result.outputs.reserve(c);
     for (quint32 i = 0; i < c; ++i) {
         try {
-            lst.push_back(createOutputArtifactFromScriptValue(res.property(i), inputArtifacts));
+            result.outputs.push_back(outputArtifactFromScriptValue(res.property(i)));
         } catch (const RuleOutputArtifactsException &roae) {
             ErrorInfo ei = roae;
             ei.prepend(Tr::tr("Error in Rule.outputArtifacts[%1]").arg(i),
@@ -541,22 +761,12 @@ QList<Artifact *> RulesApplicator::runOutputArtifactsScript(const ArtifactSet &i
             throw ei;
         }
     }
-    return lst;
+    return result;
 }
 
 class ArtifactBindingsExtractor
 {
-    struct Entry
-    {
-        Entry(QString module, QString name, QVariant value)
-            : module(std::move(module)), name(std::move(name)), value(std::move(value))
-        {}
-
-        QString module;
-        QString name;
-        QVariant value;
-    };
-    std::vector<Entry> m_propertyValues;
+    std::vector<std::pair<QStringList, QVariant>> m_propertyValues;
 
     static Set<QString> getArtifactItemPropertyNames()
     {
@@ -592,64 +802,70 @@ class ArtifactBindingsExtractor
                 newModuleName.append(name);
                 extractPropertyValues(value, newModuleName);
             } else {
-                m_propertyValues.emplace_back(moduleName, name, value.toVariant());
+                m_propertyValues.emplace_back(QStringList{moduleName, name}, value.toVariant());
             }
         }
     }
 public:
-    void apply(Artifact *outputArtifact, const QScriptValue &obj)
+    std::vector<std::pair<QStringList, QVariant>> extract(const QScriptValue &obj)
     {
         extractPropertyValues(obj);
-        if (m_propertyValues.empty())
-            return;
-
-        outputArtifact->properties = outputArtifact->properties->clone();
-        QVariantMap artifactCfg = outputArtifact->properties->value();
-        for (const auto &e : m_propertyValues) {
-            const QStringList key{e.module, e.name};
-            setConfigProperty(artifactCfg, key, e.value);
-            outputArtifact->pureProperties.emplace_back(key, e.value);
-        }
-        outputArtifact->properties->setValue(artifactCfg);
+        return std::move(m_propertyValues);
     }
 };
 
-Artifact *RulesApplicator::createOutputArtifactFromScriptValue(const QScriptValue &obj,
-        const ArtifactSet &inputArtifacts)
+OutputArtifactsScriptResult::Output RulesApplicator::outputArtifactFromScriptValue(
+        const QScriptValue &obj) const
 {
     if (!obj.isObject()) {
         throw ErrorInfo(Tr::tr("Elements of the Rule.outputArtifacts array must be "
                                "of Object type."), m_rule->outputArtifactsScript.location());
     }
-    const QString unresolvedFilePath
-            = obj.property(StringConstants::filePathProperty()).toVariant().toString();
-    if (unresolvedFilePath.isEmpty()) {
+    OutputArtifactsScriptResult::Output output;
+    output.filePath = obj.property(StringConstants::filePathProperty()).toVariant().toString();
+    if (output.filePath.isEmpty()) {
         throw RuleOutputArtifactsException(
                 Tr::tr("Property filePath must be a non-empty string."));
     }
-    const QString filePath = FileInfo::resolvePath(m_product->buildDirectory(), unresolvedFilePath);
-    const FileTags fileTags = FileTags::fromStringList(
+    output.fileTags = FileTags::fromStringList(
                 obj.property(StringConstants::fileTagsProperty()).toVariant().toStringList());
     const QVariant alwaysUpdatedVar
             = obj.property(StringConstants::alwaysUpdatedProperty()).toVariant();
-    const bool alwaysUpdated = alwaysUpdatedVar.isValid() ? alwaysUpdatedVar.toBool() : true;
-    OutputArtifactInfo outputInfo = createOutputArtifact(filePath, fileTags, alwaysUpdated,
-                                                         inputArtifacts);
+    output.alwaysUpdated = alwaysUpdatedVar.isValid() ? alwaysUpdatedVar.toBool() : true;
+    output.explicitlyDependsOn = FileTags::fromStringList(
+                obj.property(StringConstants::explicitlyDependsOnProperty())
+                .toVariant().toStringList());
+    output.properties = ArtifactBindingsExtractor().extract(obj);
+    return output;
+}
+
+Artifact *RulesApplicator::createOutputArtifactFromScriptResult(
+        const OutputArtifactsScriptResult::Output &output, const ArtifactSet &inputArtifacts)
+{
+    const QString filePath = FileInfo::resolvePath(m_product->buildDirectory(), output.filePath);
+    OutputArtifactInfo outputInfo = createOutputArtifact(filePath, output.fileTags,
+                                                         output.alwaysUpdated, inputArtifacts);
     if (outputInfo.artifact->fileTags().empty()) {
         // Check the file tags after file taggers were run.
         throw RuleOutputArtifactsException(
                 Tr::tr("Property fileTags for artifact '%1' must be a non-empty string list. "
                        "Alternatively, a FileTagger can be provided.")
-                    .arg(unresolvedFilePath));
+                    .arg(output.filePath));
     }
-    const FileTags explicitlyDependsOn = FileTags::fromStringList(
-                obj.property(StringConstants::explicitlyDependsOnProperty())
-                .toVariant().toStringList());
-    for (const FileTag &tag : explicitlyDependsOn) {
+    for (const FileTag &tag : output.explicitlyDependsOn) {
         for (Artifact * const dependency : m_product->lookupArtifactsByFileTag(tag))
             connect(outputInfo.artifact, dependency);
     }
-    ArtifactBindingsExtractor().apply(outputInfo.artifact, obj);
+    if (!output.properties.empty()) {
+        Artifact * const outputArtifact = outputInfo.artifact;
+        outputArtifact->properties = outputArtifact->properties->clone();
+        QVariantMap artifactCfg = outputArtifact->properties->value();
+        for (const auto &property : output.properties) {
+            setConfigProperty(artifactCfg, property.first, property.second);
+            outputArtifact->pureProperties.push_back(property);
+        }
+        outputArtifact->properties->setValue(artifactCfg);
+    }
     if (!outputInfo.newlyCreated && (outputInfo.artifact->fileTags() != outputInfo.oldFileTags
             || outputInfo.artifact->properties->value() != outputInfo.oldProperties)) {
         invalidateArtifactAsRuleInputIfNecessary(outputInfo.artifact);
@@ -42,6 +42,8 @@
 #include "artifact.h"
 #include "forward_decls.h"
 #include "nodeset.h"
+#include "preparescriptworkerpool.h"
+#include "transformer.h"
 #include <language/filetags.h>
 #include <language/forward_decls.h>
 #include <logging/logger.h>
@@ -52,6 +54,7 @@
 #include <QtScript/qscriptvalue.h>
 
 #include <unordered_map>
+#include <vector>
 
 namespace qbs {
 namespace Internal {
@@ -86,6 +89,10 @@ public:
 
 private:
     void doApply(const ArtifactSet &inputArtifacts, QScriptValue &prepareScriptContext);
+    void finishTransformer(const Transformer *oldTransformer, Transformer *transformer,
+                           const QList<Artifact *> &outputArtifacts);
+    void runDeferredPrepareScripts(PrepareScriptWorkerPool *workerPool);
+    void runBatchPrepareScript(QScriptValue &prepareScriptContext);
     ArtifactSet collectOldOutputArtifacts(const ArtifactSet &inputArtifacts) const;
 
     struct OutputArtifactInfo {
@@ -101,8 +108,14 @@ private:
             bool alwaysUpdated, const ArtifactSet &inputArtifacts);
     QList<Artifact *> runOutputArtifactsScript(const ArtifactSet &inputArtifacts,
             const QScriptValueList &args);
-    Artifact *createOutputArtifactFromScriptValue(const QScriptValue &obj,
-            const ArtifactSet &inputArtifacts);
+    OutputArtifactsScriptResult cachedOutputArtifactsScriptResult(
+            const ArtifactSet &inputArtifacts) const;
+    OutputArtifactsScriptResult evaluateOutputArtifactsScript(const ArtifactSet &inputArtifacts,
+            const QScriptValueList &args);
+    OutputArtifactsScriptResult::Output outputArtifactFromScriptValue(
+            const QScriptValue &obj) const;
+    Artifact *createOutputArtifactFromScriptResult(
+            const OutputArtifactsScriptResult::Output &output, const ArtifactSet &inputArtifacts);
     QString resolveOutPath(const QString &path) const;
     const RulesEvaluationContextPtr &evalContext() const;
     ScriptEngine *engine() const;
@@ -127,6 +140,20 @@ private:
     QtMocScanner *m_mocScanner;
     Logger m_logger;
     bool m_ruleUsesIo = false;
+
+    // Rule applications whose prepare scripts are still to be run by the worker pool
+    // or by a single call of the rule's batchPrepare script.
+    struct DeferredPrepareScript
+    {
+        TransformerPtr transformer;
+        TransformerConstPtr oldTransformer;
+        QList<Artifact *> outputArtifacts;
+        ScriptRequests requests;
+    };
+    bool m_deferPrepareScripts = false;
+    bool m_batchPrepareScripts = false;
+    std::vector<PrepareScriptTask> m_prepareScriptTasks;
+    std::vector<DeferredPrepareScript> m_deferredPrepareScripts;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(RulesApplicator::InputsSources)
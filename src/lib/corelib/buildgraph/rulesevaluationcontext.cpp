@@ -39,6 +39,7 @@
 #include "rulesevaluationcontext.h"
 
 #include "artifact.h"
+#include "preparescriptworkerpool.h"
 #include "rulecommands.h"
 #include "transformer.h"
 #include <language/language.h>
@@ -88,6 +89,16 @@ void RulesEvaluationContext::checkForCancelation()
         throw ErrorInfo(Tr::tr("Build canceled."));
 }
 
+PrepareScriptWorkerPool *RulesEvaluationContext::prepareScriptWorkerPool()
+{
+    // The worker threads are only started once there actually is a rule to apply.
+    if (!m_prepareScriptWorkerPool && m_prepareScriptWorkerCount > 0) {
+        m_prepareScriptWorkerPool = std::make_unique<PrepareScriptWorkerPool>(
+                    m_logger, m_prepareScriptWorkerCount);
+    }
+    return m_prepareScriptWorkerPool.get();
+}
+
 void RulesEvaluationContext::initScope()
 {
     if (m_initScopeCalls++ > 0)
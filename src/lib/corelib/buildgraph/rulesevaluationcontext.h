@@ -48,8 +48,11 @@
 #include <QtScript/qscriptprogram.h>
 #include <QtScript/qscriptvalue.h>
 
+#include <memory>
+
 namespace qbs {
 namespace Internal {
+class PrepareScriptWorkerPool;
 class ProgressObserver;
 class ScriptEngine;
 
@@ -78,6 +81,11 @@ public:
     void incrementProgressValue();
     void checkForCancelation();
 
+    // A value greater than zero allows the prepare scripts of independent rule applications
+    // to run concurrently on that many threads.
+    void setPrepareScriptWorkerCount(int count) { m_prepareScriptWorkerCount = count; }
+    PrepareScriptWorkerPool *prepareScriptWorkerPool();
+
 private:
     friend class Scope;
 
@@ -90,6 +98,8 @@ private:
     unsigned int m_initScopeCalls;
     QScriptValue m_scope;
     QScriptValue m_prepareScriptScope;
+    int m_prepareScriptWorkerCount = 0;
+    std::unique_ptr<PrepareScriptWorkerPool> m_prepareScriptWorkerPool;
 };
 
 } // namespace Internal
@@ -257,8 +257,13 @@ void Transformer::createCommands(ScriptEngine *engine, const PrivateScriptFuncti
         if (Q_UNLIKELY(!script.scriptFunction.isFunction()))
             throw ErrorInfo(Tr::tr("Invalid prepare script."), script.location());
     }
+    createCommands(engine, script.scriptFunction, script.location(), args);
+}
 
-    QScriptValue scriptValue = script.scriptFunction.call(QScriptValue(), args);
+void Transformer::createCommands(ScriptEngine *engine, const QScriptValue &scriptFunction,
+                                 const CodeLocation &location, const QScriptValueList &args)
+{
+    QScriptValue scriptValue = scriptFunction.call(QScriptValue(), args);
     engine->releaseResourcesOfScriptObjects();
     propertiesRequestedInPrepareScript = engine->propertiesRequestedInScript();
     propertiesRequestedFromArtifactInPrepareScript = engine->propertiesRequestedFromArtifact();
@@ -272,22 +277,26 @@ void Transformer::createCommands(ScriptEngine *engine, const PrivateScriptFuncti
     }
     engine->clearRequestedProperties();
     if (Q_UNLIKELY(engine->hasErrorOrException(scriptValue)))
-        throw engine->lastError(scriptValue, script.location());
+        throw engine->lastError(scriptValue, location);
+    setCommandsFromScriptValue(scriptValue, location);
+}
+
+void Transformer::setCommandsFromScriptValue(const QScriptValue &scriptValue,
+                                             const CodeLocation &location)
+{
     commands.clear();
     if (scriptValue.isArray()) {
         const int count = scriptValue.property(StringConstants::lengthProperty()).toInt32();
         for (qint32 i = 0; i < count; ++i) {
             QScriptValue item = scriptValue.property(i);
             if (item.isValid() && !item.isUndefined()) {
-                const AbstractCommandPtr cmd
-                        = createCommandFromScriptValue(item, script.location());
+                const AbstractCommandPtr cmd = createCommandFromScriptValue(item, location);
                 if (cmd)
                     commands.addCommand(cmd);
             }
         }
     } else {
-        const AbstractCommandPtr cmd = createCommandFromScriptValue(scriptValue,
-                                                                    script.location());
+        const AbstractCommandPtr cmd = createCommandFromScriptValue(scriptValue, location);
         if (cmd)
             commands.addCommand(cmd);
     }
@@ -313,8 +322,10 @@ void Transformer::rescueChangeTrackingData(const TransformerConstPtr &other)
     prepareScriptNeedsChangeTracking = other->prepareScriptNeedsChangeTracking;
     commandsNeedChangeTracking = other->commandsNeedChangeTracking;
     markedForRerun = other->markedForRerun;
+    measuredMemoryUsage = other->measuredMemoryUsage;
     exportedModulesAccessedInPrepareScript = other->exportedModulesAccessedInPrepareScript;
     exportedModulesAccessedInCommands = other->exportedModulesAccessedInCommands;
+    outputArtifactsScriptResult = other->outputArtifactsScriptResult;
 }
 
 Set<QString> Transformer::jobPools() const
@@ -327,5 +338,17 @@ Set<QString> Transformer::jobPools() const
     return pools;
 }
 
+// What was measured is more reliable than what a rule author guessed, but on the first run,
+// the declarations are all we have.
+int Transformer::expectedMemoryUsage() const
+{
+    if (measuredMemoryUsage > 0)
+        return measuredMemoryUsage;
+    int declaredUsage = 0;
+    for (const AbstractCommandPtr &c : commands.commands())
+        declaredUsage = std::max(declaredUsage, c->expectedMemoryUsage());
+    return declaredUsage;
+}
+
 } // namespace Internal
 } // namespace qbs
@@ -51,6 +51,7 @@
 #include <language/scriptengine.h>
 #include <tools/filetime.h>
 #include <tools/persistence.h>
+#include <tools/slaballocator.h>
 
 #include <QtCore/qhash.h>
 
@@ -60,10 +61,54 @@ class Artifact;
 class AbstractCommand;
 class Rule;
 
-class Transformer
+// What a dynamic rule's outputArtifacts script returned for a set of inputs, along with
+// everything the script accessed. As long as none of that changed, the rule can be
+// re-applied to these inputs without running the script again, unless the script
+// looked at the file system.
+class OutputArtifactsScriptResult
 {
 public:
-    static TransformerPtr create() { return TransformerPtr(new Transformer); }
+    struct Output
+    {
+        QString filePath;
+        FileTags fileTags;
+        FileTags explicitlyDependsOn;
+        bool alwaysUpdated = true;
+        std::vector<std::pair<QStringList, QVariant>> properties;
+
+        template<PersistentPool::OpType opType> void completeSerializationOp(PersistentPool &pool)
+        {
+            pool.serializationOp<opType>(filePath, fileTags, explicitlyDependsOn, alwaysUpdated,
+                                         properties);
+        }
+    };
+
+    bool isValid() const { return executionTime.isValid(); }
+    void clear() { *this = OutputArtifactsScriptResult(); }
+
+    std::vector<Output> outputs;
+    PropertySet propertiesRequested;
+    QHash<QString, PropertySet> propertiesRequestedFromArtifact;
+    std::vector<QString> importedFilesUsed;
+    RequestedDependencies depsRequested;
+    RequestedArtifacts artifactsMapRequested;
+    std::unordered_map<QString, ExportedModule> exportedModulesAccessed;
+    FileTime executionTime;
+    bool reusable = false; // The accesses above are tracked regardless.
+
+    template<PersistentPool::OpType opType> void completeSerializationOp(PersistentPool &pool)
+    {
+        pool.serializationOp<opType>(outputs, propertiesRequested,
+                                     propertiesRequestedFromArtifact, importedFilesUsed,
+                                     depsRequested, artifactsMapRequested,
+                                     exportedModulesAccessed, executionTime, reusable);
+    }
+};
+
+class Transformer : public SlabAllocated
+{
+public:
+    static TransformerPtr create() { return makeSlabShared(new Transformer); }
 
     ~Transformer();
 
@@ -86,10 +131,12 @@ public:
     FileTime lastCommandExecutionTime;
     std::unordered_map<QString, ExportedModule> exportedModulesAccessedInPrepareScript;
     std::unordered_map<QString, ExportedModule> exportedModulesAccessedInCommands;
+    OutputArtifactsScriptResult outputArtifactsScriptResult;
     bool alwaysRun;
     bool prepareScriptNeedsChangeTracking = false;
     bool commandsNeedChangeTracking = false;
     bool markedForRerun = false;
+    int measuredMemoryUsage = 0; // Peak in MiB, as observed during the last successful run.
 
     static QScriptValue translateFileConfig(ScriptEngine *scriptEngine,
                                             const Artifact *artifact,
@@ -100,9 +147,14 @@ public:
     void setupExplicitlyDependsOn(QScriptValue targetScriptValue);
     void createCommands(ScriptEngine *engine, const PrivateScriptFunction &script,
                         const QScriptValueList &args);
+    void createCommands(ScriptEngine *engine, const QScriptValue &scriptFunction,
+                        const CodeLocation &location, const QScriptValueList &args);
+    void setCommandsFromScriptValue(const QScriptValue &scriptValue,
+                                    const CodeLocation &location);
     void rescueChangeTrackingData(const TransformerConstPtr &other);
 
     Set<QString> jobPools() const;
+    int expectedMemoryUsage() const;
 
     template<PersistentPool::OpType opType> void completeSerializationOp(PersistentPool &pool)
     {
@@ -118,8 +170,9 @@ public:
                                      lastPrepareScriptExecutionTime, lastCommandExecutionTime,
                                      exportedModulesAccessedInPrepareScript,
                                      exportedModulesAccessedInCommands,
-                                     alwaysRun, prepareScriptNeedsChangeTracking,
-                                     commandsNeedChangeTracking, markedForRerun);
+                                     outputArtifactsScriptResult, alwaysRun,
+                                     prepareScriptNeedsChangeTracking, commandsNeedChangeTracking,
+                                     markedForRerun, measuredMemoryUsage);
     }
 
 private:
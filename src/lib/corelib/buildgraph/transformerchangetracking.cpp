@@ -61,8 +61,17 @@ public:
 
     bool prepareScriptNeedsRerun() const;
     bool commandsNeedRerun() const;
+    bool outputArtifactsScriptResultIsUpToDate() const;
 
 private:
+    bool scriptRequestsChanged(const PropertySet &properties,
+                               const QHash<QString, PropertySet> &propertiesFromArtifact,
+                               const std::vector<QString> &importedFiles,
+                               const FileTime &referenceTime,
+                               const RequestedDependencies &deps,
+                               const RequestedArtifacts &artifactsMap,
+                               const std::unordered_map<QString, ExportedModule> &exportedModules,
+                               const char *context) const;
     QVariantMap propertyMapByKind(const Property &property) const;
     bool checkForPropertyChange(const Property &restoredProperty,
                                 const QVariantMap &newProperties) const;
@@ -258,18 +267,50 @@ const ResolvedProduct *TrafoChangeTracker::getProduct(const QString &name) const
 
 bool TrafoChangeTracker::prepareScriptNeedsRerun() const
 {
-    for (const Property &property : qAsConst(m_transformer->propertiesRequestedInPrepareScript)) {
+    if (scriptRequestsChanged(m_transformer->propertiesRequestedInPrepareScript,
+                              m_transformer->propertiesRequestedFromArtifactInPrepareScript,
+                              m_transformer->importedFilesUsedInPrepareScript,
+                              m_transformer->lastPrepareScriptExecutionTime,
+                              m_transformer->depsRequestedInPrepareScript,
+                              m_transformer->artifactsMapRequestedInPrepareScript,
+                              m_transformer->exportedModulesAccessedInPrepareScript,
+                              "prepare script")) {
+        return true;
+    }
+
+    // The outputArtifacts script of a dynamic rule is part of the rule application as well.
+    return m_transformer->outputArtifactsScriptResult.isValid()
+            && !outputArtifactsScriptResultIsUpToDate();
+}
+
+bool TrafoChangeTracker::outputArtifactsScriptResultIsUpToDate() const
+{
+    const OutputArtifactsScriptResult &result = m_transformer->outputArtifactsScriptResult;
+    return result.isValid()
+            && !scriptRequestsChanged(result.propertiesRequested,
+                                      result.propertiesRequestedFromArtifact,
+                                      result.importedFilesUsed, result.executionTime,
+                                      result.depsRequested, result.artifactsMapRequested,
+                                      result.exportedModulesAccessed, "outputArtifacts script");
+}
+
+bool TrafoChangeTracker::scriptRequestsChanged(
+        const PropertySet &properties, const QHash<QString, PropertySet> &propertiesFromArtifact,
+        const std::vector<QString> &importedFiles, const FileTime &referenceTime,
+        const RequestedDependencies &deps, const RequestedArtifacts &artifactsMap,
+        const std::unordered_map<QString, ExportedModule> &exportedModules,
+        const char *context) const
+{
+    for (const Property &property : properties) {
         if (checkForPropertyChange(property, propertyMapByKind(property)))
             return true;
     }
 
-    if (checkForImportFileChange(m_transformer->importedFilesUsedInPrepareScript,
-                                 m_transformer->lastPrepareScriptExecutionTime, "prepare script")) {
+    if (checkForImportFileChange(importedFiles, referenceTime, context))
         return true;
-    }
 
-    for (auto it = m_transformer->propertiesRequestedFromArtifactInPrepareScript.constBegin();
-         it != m_transformer->propertiesRequestedFromArtifactInPrepareScript.constEnd(); ++it) {
+    for (auto it = propertiesFromArtifact.constBegin(); it != propertiesFromArtifact.constEnd();
+         ++it) {
         for (const Property &property : qAsConst(it.value())) {
             const Artifact * const artifact = getArtifact(it.key(), property.productName);
             if (!artifact)
@@ -284,13 +325,11 @@ bool TrafoChangeTracker::prepareScriptNeedsRerun() const
         }
     }
 
-    if (!m_transformer->depsRequestedInPrepareScript.isUpToDate(m_product->topLevelProject()))
+    if (!deps.isUpToDate(m_product->topLevelProject()))
         return true;
-    if (!m_transformer->artifactsMapRequestedInPrepareScript.isUpToDate(
-                m_product->topLevelProject())) {
+    if (!artifactsMap.isUpToDate(m_product->topLevelProject()))
         return true;
-    }
-    if (!areExportedModulesUpToDate(m_transformer->exportedModulesAccessedInPrepareScript))
+    if (!areExportedModulesUpToDate(exportedModules))
         return true;
 
     return false;
@@ -366,6 +405,15 @@ bool prepareScriptNeedsRerun(
             .prepareScriptNeedsRerun();
 }
 
+bool outputArtifactsScriptResultIsUpToDate(
+        const Transformer *transformer, const ResolvedProduct *product,
+        const std::unordered_map<QString, const ResolvedProduct *> &productsByName,
+        const std::unordered_map<QString, const ResolvedProject *> &projectsByName)
+{
+    return TrafoChangeTracker(transformer, product, productsByName, projectsByName)
+            .outputArtifactsScriptResultIsUpToDate();
+}
+
 bool commandsNeedRerun(Transformer *transformer, const ResolvedProduct *product,
                        const std::unordered_map<QString, const ResolvedProduct *> &productsByName,
                        const std::unordered_map<QString, const ResolvedProject *> &projectsByName)
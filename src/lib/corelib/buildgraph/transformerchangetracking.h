@@ -42,6 +42,12 @@ bool prepareScriptNeedsRerun(
         const std::unordered_map<QString, const ResolvedProduct *> &productsByName,
         const std::unordered_map<QString, const ResolvedProject *> &projectsByName);
 
+bool outputArtifactsScriptResultIsUpToDate(
+        const Transformer *transformer,
+        const ResolvedProduct *product,
+        const std::unordered_map<QString, const ResolvedProduct *> &productsByName,
+        const std::unordered_map<QString, const ResolvedProject *> &projectsByName);
+
 bool commandsNeedRerun(Transformer *transformer,
                        const ResolvedProduct *product,
                        const std::unordered_map<QString, const ResolvedProduct *> &productsByName,
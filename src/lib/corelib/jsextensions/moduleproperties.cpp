@@ -282,6 +282,8 @@ void ModuleProperties::init(QScriptValue objectWithProperties, const void *ptr,
     QScriptEngine * const engine = objectWithProperties.engine();
     objectWithProperties.setProperty(QStringLiteral("moduleProperty"),
                                      engine->newFunction(ModuleProperties::js_moduleProperty, 2));
+    objectWithProperties.setProperty(QStringLiteral("cachedValue"),
+                                     engine->newFunction(ModuleProperties::js_cachedValue, 2));
     objectWithProperties.setProperty(ptrKey(), engine->toScriptValue(quintptr(ptr)));
     objectWithProperties.setProperty(typeKey(), type);
 }
@@ -313,6 +315,15 @@ QScriptValue ModuleProperties::js_moduleProperty(QScriptContext *context, QScrip
     }
 }
 
+QScriptValue ModuleProperties::js_cachedValue(QScriptContext *context, QScriptEngine *engine)
+{
+    try {
+        return cachedValue(context, engine);
+    } catch (const ErrorInfo &e) {
+        return context->throwError(e.toString());
+    }
+}
+
 QScriptValue ModuleProperties::moduleProperty(QScriptContext *context, QScriptEngine *engine)
 {
     if (Q_UNLIKELY(context->argumentCount() < 2)) {
@@ -320,6 +331,47 @@ QScriptValue ModuleProperties::moduleProperty(QScriptContext *context, QScriptEn
                                    Tr::tr("Function moduleProperty() expects 2 arguments"));
     }
 
+    const ResolvedProduct *product = nullptr;
+    const Artifact *artifact = nullptr;
+    const QScriptValue error = getOwner(context, &product, &artifact);
+    if (error.isValid())
+        return error;
+
+    const auto qbsEngine = static_cast<ScriptEngine *>(engine);
+    const QString moduleName = context->argument(0).toString();
+    const QString propertyName = context->argument(1).toString();
+    return getModuleProperty(product, artifact, qbsEngine, moduleName, propertyName);
+}
+
+// Lets modules compute values that depend only on module properties, such as the
+// non-file-specific parts of a command line, once per set of properties rather than once
+// per artifact. The value is shared between all callers and must not be modified.
+QScriptValue ModuleProperties::cachedValue(QScriptContext *context, QScriptEngine *engine)
+{
+    if (Q_UNLIKELY(context->argumentCount() < 2 || !context->argument(1).isFunction())) {
+        return context->throwError(QScriptContext::SyntaxError,
+                                   Tr::tr("Function cachedValue() expects a key and a function"));
+    }
+
+    const ResolvedProduct *product = nullptr;
+    const Artifact *artifact = nullptr;
+    const QScriptValue error = getOwner(context, &product, &artifact);
+    if (error.isValid())
+        return error;
+
+    const auto qbsEngine = static_cast<ScriptEngine *>(engine);
+    const PropertyMapConstPtr &properties = artifact ? artifact->properties
+                                                     : product->moduleProperties;
+    const QScriptValue result = qbsEngine->cachedPropertyMapValue(
+                context->argument(0).toString(), properties, artifact, context->argument(1));
+    if (qbsEngine->hasErrorOrException(result))
+        return context->throwValue(qbsEngine->lastErrorValue(result));
+    return result;
+}
+
+QScriptValue ModuleProperties::getOwner(QScriptContext *context, const ResolvedProduct **product,
+                                        const Artifact **artifact)
+{
     const QScriptValue objectWithProperties = context->thisObject();
     const QScriptValue typeScriptValue = objectWithProperties.property(typeKey());
     if (Q_UNLIKELY(!typeScriptValue.isString())) {
@@ -333,24 +385,18 @@ QScriptValue ModuleProperties::moduleProperty(QScriptContext *context, QScriptEn
     }
 
     const void *ptr = reinterpret_cast<const void *>(qscriptvalue_cast<quintptr>(ptrScriptValue));
-    const ResolvedProduct *product = nullptr;
-    const Artifact *artifact = nullptr;
     if (typeScriptValue.toString() == StringConstants::productValue()) {
-        QBS_ASSERT(ptr, return {});
-        product = static_cast<const ResolvedProduct *>(ptr);
+        QBS_ASSERT(ptr, return context->throwError(QStringLiteral("Internal error: null pointer")));
+        *product = static_cast<const ResolvedProduct *>(ptr);
     } else if (typeScriptValue.toString() == artifactType()) {
-        QBS_ASSERT(ptr, return {});
-        artifact = static_cast<const Artifact *>(ptr);
-        product = artifact->product.get();
+        QBS_ASSERT(ptr, return context->throwError(QStringLiteral("Internal error: null pointer")));
+        *artifact = static_cast<const Artifact *>(ptr);
+        *product = (*artifact)->product.get();
     } else {
         return context->throwError(QScriptContext::TypeError,
                                    QStringLiteral("Internal error: invalid type"));
     }
-
-    const auto qbsEngine = static_cast<ScriptEngine *>(engine);
-    const QString moduleName = context->argument(0).toString();
-    const QString propertyName = context->argument(1).toString();
-    return getModuleProperty(product, artifact, qbsEngine, moduleName, propertyName);
+    return {};
 }
 
 } // namespace Internal
@@ -76,8 +76,12 @@ private:
                              const Artifact *artifact);
 
     static QScriptValue js_moduleProperty(QScriptContext *context, QScriptEngine *engine);
+    static QScriptValue js_cachedValue(QScriptContext *context, QScriptEngine *engine);
 
     static QScriptValue moduleProperty(QScriptContext *context, QScriptEngine *engine);
+    static QScriptValue cachedValue(QScriptContext *context, QScriptEngine *engine);
+    static QScriptValue getOwner(QScriptContext *context, const ResolvedProduct **product,
+                                 const Artifact **artifact);
 };
 
 } // namespace Internal
@@ -519,6 +519,14 @@ void BuiltinDeclarations::addRuleItem()
                 << StringConstants::projectVar() << StringConstants::productVar()
                 << StringConstants::inputsVar() << StringConstants::inputVar());
     item << outputArtifactsDecl;
+    PropertyDeclaration batchPrepareDecl(StringConstants::batchPrepareProperty(),
+                                         PropertyDeclaration::Variant, QString(),
+                                         PropertyDeclaration::PropertyNotAvailableInConfig);
+    batchPrepareDecl.setFunctionArgumentNames(
+                QStringList()
+                << StringConstants::projectVar() << StringConstants::productVar()
+                << StringConstants::batchVar());
+    item << batchPrepareDecl;
     PropertyDeclaration usingsDecl(QStringLiteral("usings"), PropertyDeclaration::StringList);
     usingsDecl.setDeprecationInfo(DeprecationInfo(Version(1, 5),
                                                   Tr::tr("Use 'inputsFromDependencies' instead")));
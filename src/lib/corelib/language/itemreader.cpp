@@ -121,6 +121,7 @@ const QStringList &ItemReader::allSearchPaths() const
 Item *ItemReader::readFile(const QString &filePath)
 {
     AccumulatingTimer readFileTimer(m_elapsedTime != -1 ? &m_elapsedTime : nullptr);
+    ProfilingScope readFileScope("item-reading");
     return m_visitorState->readFile(filePath, allSearchPaths(), m_pool);
 }
 
@@ -260,6 +260,14 @@ QStringList Rule::argumentNamesForPrepare()
     return argNames;
 }
 
+QStringList Rule::argumentNamesForBatchPrepare()
+{
+    static const QStringList argNames = BuiltinDeclarations::instance()
+            .argumentNamesForScriptFunction(ItemType::Rule,
+                                            StringConstants::batchPrepareProperty());
+    return argNames;
+}
+
 QString Rule::toString() const
 {
     QStringList outputTagsSorted = collectedOutputFileTags().toStringList();
@@ -634,12 +642,15 @@ void TopLevelProject::store(Logger logger)
         return;
     }
 
+    if (bgLocker)
+        bgLocker->lockForWriting();
     makeModuleProvidersNonTransient();
 
     const QString fileName = buildGraphFilePath();
     qCDebug(lcBuildGraph) << "storing:" << fileName;
     PersistentPool pool(logger);
     PersistentPool::HeadData headData;
+    headData.generation = PersistentPool::storedGeneration(fileName) + 1;
     headData.projectConfig = buildConfiguration();
     pool.setHeadData(headData);
     pool.setupWriteStream(fileName);
@@ -837,6 +848,8 @@ bool listsAreEqual(const L &l1, const L &l2)
 QString keyFromElem(const SourceArtifactPtr &sa) { return sa->absoluteFilePath; }
 QString keyFromElem(const RulePtr &r) {
     QString key = r->toString() + r->prepareScript.sourceCode();
+    if (r->hasBatchPrepareScript())
+        key += r->batchPrepareScript.sourceCode();
     if (r->outputArtifactsScript.isValid())
         key += r->outputArtifactsScript.sourceCode();
     for (const auto &a : r->artifacts)
@@ -872,6 +885,7 @@ bool operator==(const Rule &r1, const Rule &r2)
 
     return r1.module->name == r2.module->name
             && r1.prepareScript == r2.prepareScript
+            && r1.batchPrepareScript == r2.batchPrepareScript
             && r1.outputArtifactsScript == r2.outputArtifactsScript
             && r1.inputs == r2.inputs
             && r1.outputFileTags == r2.outputFileTags
@@ -53,6 +53,7 @@
 #include <tools/joblimits.h>
 #include <tools/persistence.h>
 #include <tools/set.h>
+#include <tools/slaballocator.h>
 #include <tools/weakpointer.h>
 
 #include <QtCore/qdatastream.h>
@@ -220,10 +221,10 @@ inline bool operator!=(const RuleArtifact::Binding &b1, const RuleArtifact::Bind
 bool operator==(const RuleArtifact &a1, const RuleArtifact &a2);
 inline bool operator!=(const RuleArtifact &a1, const RuleArtifact &a2) { return !(a1 == a2); }
 
-class SourceArtifactInternal
+class SourceArtifactInternal : public SlabAllocated
 {
 public:
-    static SourceArtifactPtr create() { return SourceArtifactPtr(new SourceArtifactInternal); }
+    static SourceArtifactPtr create() { return makeSlabShared(new SourceArtifactInternal); }
 
     bool isTargetOfModule() const { return !targetOfModule.isEmpty(); }
 
@@ -402,6 +403,7 @@ public:
     ResolvedModuleConstPtr module;
     QString name;
     PrivateScriptFunction prepareScript;
+    PrivateScriptFunction batchPrepareScript;   // non-multiplex rules only; replaces prepareScript
     FileTags outputFileTags;                    // unused, if artifacts is non-empty
     PrivateScriptFunction outputArtifactsScript;    // unused, if artifacts is non-empty
     FileTags inputs;
@@ -420,16 +422,23 @@ public:
 
     static QStringList argumentNamesForOutputArtifacts();
     static QStringList argumentNamesForPrepare();
+    static QStringList argumentNamesForBatchPrepare();
 
     QString toString() const;
     FileTags staticOutputFileTags() const;
     FileTags collectedOutputFileTags() const;
     bool isDynamic() const;
     bool declaresInputs() const;
+    bool hasBatchPrepareScript() const { return batchPrepareScript.isValid(); }
+    const PrivateScriptFunction &commandsScript() const
+    {
+        return hasBatchPrepareScript() ? batchPrepareScript : prepareScript;
+    }
 
     template<PersistentPool::OpType opType> void completeSerializationOp(PersistentPool &pool)
     {
-        pool.serializationOp<opType>(name, prepareScript, outputArtifactsScript, module, inputs,
+        pool.serializationOp<opType>(name, prepareScript, batchPrepareScript,
+                                     outputArtifactsScript, module, inputs,
                                      outputFileTags, auxiliaryInputs, excludedInputs,
                                      inputsFromDependencies, explicitlyDependsOn,
                                      explicitlyDependsOnFromDependencies, multiplex,
@@ -547,10 +556,10 @@ inline bool operator!=(const ExportedModule &m1, const ExportedModule &m2) { ret
 class TopLevelProject;
 class ScriptEngine;
 
-class QBS_AUTOTEST_EXPORT ResolvedProduct
+class QBS_AUTOTEST_EXPORT ResolvedProduct : public SlabAllocated
 {
 public:
-    static ResolvedProductPtr create() { return ResolvedProductPtr(new ResolvedProduct); }
+    static ResolvedProductPtr create() { return makeSlabShared(new ResolvedProduct); }
 
     ~ResolvedProduct();
 
@@ -577,6 +586,7 @@ public:
     std::vector<ProbeConstPtr> probes;
     std::vector<ArtifactPropertiesPtr> artifactProperties;
     QStringList missingSourceFiles;
+    Set<QString> buildSystemFiles; // Product, project, module and JS files it was resolved from.
     std::unique_ptr<ProductBuildData> buildData;
 
     ExportedModule exportedModule;
@@ -628,7 +638,7 @@ private:
                                      moduleProperties, rules, dependencies, dependencyParameters,
                                      fileTaggers, modules, moduleParameters, scanners, groups,
                                      artifactProperties, probes, exportedModule, buildData,
-                                     jobLimits);
+                                     jobLimits, buildSystemFiles);
     }
 
     QHash<QString, QString> m_executablePathCache;
@@ -695,8 +705,9 @@ public:
     QHash<std::pair<QString, quint32>, QStringList> directoryEntriesResults; // Results of calls to "File.directoryEntries()".
     QHash<QString, FileTime> fileLastModifiedResults; // Results of calls to "File.lastModified()".
     std::unique_ptr<ProjectBuildData> buildData;
-    BuildGraphLocker *bgLocker; // This holds the system-wide build graph file lock.
+    BuildGraphLocker *bgLocker; // Holds the system-wide build graph file lock, if any.
     bool locked; // This is the API-level lock for the project instance.
+    unsigned int lockGeneration = 0; // Incremented whenever the lock is taken or released.
 
     Set<QString> buildSystemFiles;
     FileTime lastStartResolveTime;
@@ -109,6 +109,11 @@ void Loader::setStoredModuleProviderInfo(const ModuleProviderInfoList &providerI
     m_storedModuleProviderInfo = providerInfo;
 }
 
+void Loader::setReusableProducts(const QHash<QString, ResolvedProductPtr> &products)
+{
+    m_reusableProducts = products;
+}
+
 TopLevelProjectPtr Loader::loadProject(const SetupProjectParameters &_parameters)
 {
     SetupProjectParameters parameters = _parameters;
@@ -169,6 +174,7 @@ TopLevelProjectPtr Loader::loadProject(const SetupProjectParameters &_parameters
     const ModuleLoaderResult loadResult = moduleLoader.load(parameters);
     ProjectResolver resolver(&evaluator, loadResult, std::move(parameters), m_logger);
     resolver.setProgressObserver(m_progressObserver);
+    resolver.setReusableProducts(m_reusableProducts);
     const TopLevelProjectPtr project = resolver.resolve();
     project->lastStartResolveTime = resolveTime;
     project->lastEndResolveTime = FileTime::currentTime();
@@ -66,6 +66,7 @@ public:
     void setLastResolveTime(const FileTime &time) { m_lastResolveTime = time; }
     void setStoredProfiles(const QVariantMap &profiles);
     void setStoredModuleProviderInfo(const ModuleProviderInfoList &providerInfo);
+    void setReusableProducts(const QHash<QString, ResolvedProductPtr> &products);
     TopLevelProjectPtr loadProject(const SetupProjectParameters &parameters);
 
     static void setupProjectFilePath(SetupProjectParameters &parameters);
@@ -80,6 +81,7 @@ private:
     ModuleProviderInfoList m_storedModuleProviderInfo;
     QVariantMap m_storedProfiles;
     FileTime m_lastResolveTime;
+    QHash<QString, ResolvedProductPtr> m_reusableProducts;
 };
 
 } // namespace Internal
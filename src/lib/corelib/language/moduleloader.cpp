@@ -286,6 +286,7 @@ ModuleLoaderResult ModuleLoader::load(const SetupProjectParameters &parameters)
 {
     TimedActivityLogger moduleLoaderTimer(m_logger, Tr::tr("ModuleLoader"),
                                           parameters.logElapsedTime());
+    ProfilingScope moduleLoaderScope("module-loader");
     qCDebug(lcModuleLoader) << "load" << parameters.projectFilePath();
     m_parameters = parameters;
     m_modulePrototypes.clear();
@@ -636,6 +637,7 @@ void ModuleLoader::handleTopLevelProject(ModuleLoaderResult *loadResult, Item *p
     m_reader->clearExtraSearchPathsStack();
     AccumulatingTimer timer(m_parameters.logElapsedTime()
                             ? &m_elapsedTimePropertyChecking : nullptr);
+    ProfilingScope checkScope("property-checking");
     PropertyDeclarationCheck check(m_disabledItems, m_parameters, m_logger);
     check(projectItem);
 }
@@ -1223,6 +1225,7 @@ void ModuleLoader::prepareProduct(ProjectContext *projectContext, Item *productI
 {
     AccumulatingTimer timer(m_parameters.logElapsedTime()
                             ? &m_elapsedTimePrepareProducts : nullptr);
+    ProfilingScope prepareScope("product-preparation");
     checkCancelation();
     qCDebug(lcModuleLoader) << "prepareProduct" << productItem->file()->filePath();
 
@@ -1322,6 +1325,7 @@ void ModuleLoader::setupProductDependencies(ProductContext *productContext,
     }
     AccumulatingTimer timer(m_parameters.logElapsedTime()
                             ? &m_elapsedTimeProductDependencies : nullptr);
+    ProfilingScope dependenciesScope("product-dependencies-setup");
     checkCancelation();
     Item *item = productContext->item;
     qCDebug(lcModuleLoader) << "setupProductDependencies" << productContext->name
@@ -1408,6 +1412,7 @@ ModuleLoader::ModuleDependencies ModuleLoader::setupReverseModuleDependencies(co
 void ModuleLoader::handleProduct(ModuleLoader::ProductContext *productContext)
 {
     AccumulatingTimer timer(m_parameters.logElapsedTime() ? &m_elapsedTimeHandleProducts : nullptr);
+    ProfilingScope handleScope("product-handling");
     if (productContext->info.delayedError.hasError())
         return;
 
@@ -3582,6 +3587,7 @@ void ModuleLoader::resolveProbe(ProductContext *productContext, Item *parent, It
     const QString &probeId = probeGlobalId(probe);
     if (Q_UNLIKELY(probeId.isEmpty()))
         throw ErrorInfo(Tr::tr("Probe.id must be set."), probe->location());
+    ProfilingScope probeScope("probe-execution", probeId);
     const JSSourceValueConstPtr configureScript
             = probe->sourceProperty(StringConstants::configureProperty());
     QBS_CHECK(configureScript);
@@ -4090,6 +4096,7 @@ void ModuleLoader::addTransitiveDependencies(ProductContext *ctx)
 {
     AccumulatingTimer timer(m_parameters.logElapsedTime()
                             ? &m_elapsedTimeTransitiveDependencies : nullptr);
+    ProfilingScope transitiveDependenciesScope("transitive-dependencies-setup");
     qCDebug(lcModuleLoader) << "addTransitiveDependencies";
 
     std::vector<Item::Module> transitiveDeps = allModules(ctx->item);
@@ -85,6 +85,20 @@ static const FileTag unknownFileTag()
     return tag;
 }
 
+static void gatherBuildSystemFiles(const Item *item, Set<QString> &files)
+{
+    for (; item; item = item->prototype()) {
+        const FileContextPtr &file = item->file();
+        if (!file)
+            continue;
+        files.insert(file->filePath());
+        for (const JsImport &jsImport : file->jsImports()) {
+            for (const QString &filePath : jsImport.filePaths)
+                files.insert(filePath);
+        }
+    }
+}
+
 struct ProjectResolver::ProjectContext
 {
     ProjectContext *parentContext = nullptr;
@@ -93,6 +107,7 @@ struct ProjectResolver::ProjectContext
     std::vector<RulePtr> rules;
     JobLimits jobLimits;
     ResolvedModulePtr dummyModule;
+    Set<QString> buildSystemFiles;
 };
 
 struct ProjectResolver::ProductContext
@@ -134,6 +149,14 @@ void ProjectResolver::setProgressObserver(ProgressObserver *observer)
     m_progressObserver = observer;
 }
 
+// Products from a stored build graph that the caller has determined not to be affected by
+// any change to the build system files. They are taken over as they are instead of getting
+// resolved anew, unless the module loader results indicate otherwise.
+void ProjectResolver::setReusableProducts(QHash<QString, ResolvedProductPtr> products)
+{
+    m_reusableProducts = std::move(products);
+}
+
 static void checkForDuplicateProductNames(const TopLevelProjectConstPtr &project)
 {
     const std::vector<ResolvedProductPtr> allProducts = project->allProducts();
@@ -157,6 +180,7 @@ TopLevelProjectPtr ProjectResolver::resolve()
 {
     TimedActivityLogger projectResolverTimer(m_logger, Tr::tr("ProjectResolver"),
                                              m_setupParams.logElapsedTime());
+    ProfilingScope projectResolverScope("project-resolver");
     qCDebug(lcProjectResolver) << "resolving" << m_loadResult.root->file()->filePath();
 
     m_productContext = nullptr;
@@ -167,8 +191,12 @@ TopLevelProjectPtr ProjectResolver::resolve()
         tlp = resolveTopLevelProject();
         printProfilingInfo();
     } catch (const CancelException &) {
+        restoreReusedProducts();
         throw ErrorInfo(Tr::tr("Project resolving canceled for configuration '%1'.")
                     .arg(TopLevelProject::deriveId(m_setupParams.finalBuildConfigurationTree())));
+    } catch (const ErrorInfo &) {
+        restoreReusedProducts();
+        throw;
     }
     return tlp;
 }
@@ -243,6 +271,7 @@ TopLevelProjectPtr ProjectResolver::resolveTopLevelProject()
     ProjectContext projectContext;
     projectContext.project = project;
 
+    determineReusableProducts();
     resolveProject(m_loadResult.root, &projectContext);
     ErrorInfo accumulatedErrors;
     for (const ErrorInfo &e : m_queuedErrors)
@@ -264,7 +293,7 @@ TopLevelProjectPtr ProjectResolver::resolveTopLevelProject()
     checkForDuplicateProductNames(project);
 
     for (const ResolvedProductPtr &product : project->allProducts()) {
-        if (!product->enabled)
+        if (!product->enabled || m_reusedProducts.contains(product.get()))
             continue;
 
         applyFileTaggers(product);
@@ -318,6 +347,7 @@ void ProjectResolver::resolveProjectFully(Item *item, ProjectResolver::ProjectCo
     }
 
     projectContext->dummyModule = ResolvedModule::create();
+    gatherBuildSystemFiles(item, projectContext->buildSystemFiles);
 
     for (Item::PropertyDeclarationMap::const_iterator it
                 = item->propertyDeclarations().constBegin();
@@ -349,8 +379,10 @@ void ProjectResolver::resolveProjectFully(Item *item, ProjectResolver::ProjectCo
         }
     }
 
-    for (const ResolvedProductPtr &product : projectContext->project->products)
-        postProcess(product, projectContext);
+    for (const ResolvedProductPtr &product : projectContext->project->products) {
+        if (!m_reusedProducts.contains(product.get()))
+            postProcess(product, projectContext);
+    }
 }
 
 void ProjectResolver::resolveSubProject(Item *item, ProjectResolver::ProjectContext *projectContext)
@@ -409,6 +441,8 @@ void ProjectResolver::resolveProduct(Item *item, ProjectContext *projectContext)
     product->location = item->location();
     ProductContextSwitcher contextSwitcher(this, &productContext, m_progressObserver);
     try {
+        if (reuseProduct(item, projectContext))
+            return;
         resolveProductFully(item, projectContext);
     } catch (const ErrorInfo &e) {
         QString mainErrorString = !product->name.isEmpty()
@@ -518,6 +552,96 @@ void ProjectResolver::resolveProductFully(Item *item, ProjectContext *projectCon
 
     for (const FileTag &t : qAsConst(product->fileTags))
         m_productsByType[t].push_back(product);
+
+    gatherBuildSystemFiles(item, product->buildSystemFiles);
+    for (const Item * const child : qAsConst(subItems))
+        gatherBuildSystemFiles(child, product->buildSystemFiles);
+    for (const Item::Module &m : item->modules())
+        gatherBuildSystemFiles(m.item, product->buildSystemFiles);
+    for (const ProjectContext *p = projectContext; p; p = p->parentContext)
+        product->buildSystemFiles.unite(p->buildSystemFiles);
+}
+
+// A product can only be taken over from the stored build graph if all the products it
+// depends on are taken over as well. Otherwise, properties pulled in via Export items
+// or the dependency list itself might be outdated.
+void ProjectResolver::determineReusableProducts()
+{
+    if (m_reusableProducts.empty())
+        return;
+    QHash<QString, std::vector<Item *>> productItemsByName;
+    for (auto it = m_loadResult.productInfos.cbegin(); it != m_loadResult.productInfos.cend();
+         ++it) {
+        Item * const item = it.key();
+        try {
+            const QString name = m_evaluator->stringValue(item, StringConstants::nameProperty());
+            productItemsByName[name].push_back(item);
+            if (it.value().delayedError.hasError()
+                    || !m_evaluator->boolValue(item, StringConstants::conditionProperty())) {
+                continue;
+            }
+            const QString uniqueName = ResolvedProduct::uniqueName(name, m_evaluator->stringValue(
+                    item, StringConstants::multiplexConfigurationIdProperty()));
+            const ResolvedProductPtr product = m_reusableProducts.value(uniqueName);
+            if (product && product->enabled)
+                m_reusableProductItems.insert(item, product);
+        } catch (const ErrorInfo &) {
+        }
+    }
+
+    const auto isNotReusable = [this](Item *item) {
+        return !m_reusableProductItems.contains(item);
+    };
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (auto it = m_reusableProductItems.begin(); it != m_reusableProductItems.end();) {
+            const auto &usedProducts
+                    = m_loadResult.productInfos.constFind(it.key()).value().usedProducts;
+            const bool hasNonReusableDependency = any_of(usedProducts,
+                    [&](const ModuleLoaderResult::ProductInfo::Dependency &dep) {
+                return any_of(productItemsByName.value(dep.name), isNotReusable);
+            });
+            if (hasNonReusableDependency) {
+                it = m_reusableProductItems.erase(it);
+                changed = true;
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+bool ProjectResolver::reuseProduct(Item *item, ProjectContext *projectContext)
+{
+    const ResolvedProductPtr product = m_reusableProductItems.value(item);
+    if (!product || !projectContext->project->enabled)
+        return false;
+    qCDebug(lcProjectResolver) << "re-using product" << product->uniqueName();
+    m_reusedProductStates.push_back({product, product->project, product->enabled,
+                                     product->dependencies, product->dependencyParameters,
+                                     product->exportedModule});
+    product->project = projectContext->project;
+    product->dependencies.clear();
+    product->dependencyParameters.clear();
+    m_reusedProducts.insert(product.get());
+    m_productItemMap.insert(product, item);
+    projectContext->project->products.push_back(product);
+    m_productsByName.insert(product->uniqueName(), product);
+    for (const FileTag &t : qAsConst(product->fileTags))
+        m_productsByType[t].push_back(product);
+    return true;
+}
+
+void ProjectResolver::restoreReusedProducts()
+{
+    for (ReusedProductState &state : m_reusedProductStates) {
+        state.product->project = state.project;
+        state.product->enabled = state.enabled;
+        state.product->dependencies = std::move(state.dependencies);
+        state.product->dependencyParameters = std::move(state.dependencyParameters);
+        state.product->exportedModule = std::move(state.exportedModule);
+    }
+    m_reusedProductStates.clear();
 }
 
 void ProjectResolver::resolveModules(const Item *item, ProjectContext *projectContext)
@@ -1210,6 +1334,8 @@ void ProjectResolver::resolveRule(Item *item, ProjectContext *projectContext)
 
     rule->name = m_evaluator->stringValue(item, StringConstants::nameProperty());
     rule->prepareScript.initialize(scriptFunctionValue(item, StringConstants::prepareProperty()));
+    rule->batchPrepareScript.initialize(scriptFunctionValue(
+                                            item, StringConstants::batchPrepareProperty()));
     rule->outputArtifactsScript.initialize(scriptFunctionValue(
                                                item, StringConstants::outputArtifactsProperty()));
     rule->outputFileTags = m_evaluator->fileTagsValue(
@@ -1251,6 +1377,16 @@ void ProjectResolver::resolveRule(Item *item, ProjectContext *projectContext)
         throw ErrorInfo(Tr::tr("Rule has no inputs, but is not a multiplex rule."),
                         item->location());
     }
+    if (rule->hasBatchPrepareScript()) {
+        if (rule->multiplex) {
+            throw ErrorInfo(Tr::tr("The Rule.batchPrepare script is not allowed in "
+                                   "multiplex rules."), item->location());
+        }
+        if (rule->prepareScript.isValid()) {
+            throw ErrorInfo(Tr::tr("A rule cannot have both a prepare and a batchPrepare "
+                                   "script."), item->location());
+        }
+    }
     if (!rule->multiplex && !rule->requiresInputs) {
         throw ErrorInfo(Tr::tr("Rule.requiresInputs is false for non-multiplex rule."),
                         item->location());
@@ -1701,6 +1837,7 @@ QVariantMap ProjectResolver::evaluateModuleValues(Item *item, bool lookupPrototy
         if (!module.item->isPresentModule())
             continue;
         const QString fullName = module.name.toString();
+        ProfilingScope moduleScope("property-evaluation", fullName);
         moduleValues[fullName] = evaluateProperties(module.item, lookupPrototype, true);
     }
 
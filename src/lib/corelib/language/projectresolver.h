@@ -42,6 +42,7 @@
 
 #include "filetags.h"
 #include "itemtype.h"
+#include "language.h"
 #include "moduleloader.h"
 #include "qualifiedid.h"
 
@@ -72,6 +73,7 @@ public:
     ~ProjectResolver();
 
     void setProgressObserver(ProgressObserver *observer);
+    void setReusableProducts(QHash<QString, ResolvedProductPtr> products);
     TopLevelProjectPtr resolve();
 
     static void applyFileTaggers(const SourceArtifactPtr &artifact,
@@ -101,6 +103,9 @@ private:
     void resolveSubProject(Item *item, ProjectContext *projectContext);
     void resolveProduct(Item *item, ProjectContext *projectContext);
     void resolveProductFully(Item *item, ProjectContext *projectContext);
+    void determineReusableProducts();
+    bool reuseProduct(Item *item, ProjectContext *projectContext);
+    void restoreReusedProducts();
     void resolveModules(const Item *item, ProjectContext *projectContext);
     void resolveModule(const QualifiedId &moduleName, Item *item, bool isProduct,
                        const QVariantMap &parameters, JobLimits &jobLimits,
@@ -184,6 +189,22 @@ private:
     QMap<QString, ResolvedProductPtr> m_productsByName;
     QHash<FileTag, QList<ResolvedProductPtr> > m_productsByType;
     QHash<ResolvedProductPtr, Item *> m_productItemMap;
+    QHash<QString, ResolvedProductPtr> m_reusableProducts;
+    QHash<Item *, ResolvedProductPtr> m_reusableProductItems;
+    Set<ResolvedProduct *> m_reusedProducts;
+
+    // The reused products are shared with the stored project, which must stay intact
+    // if resolving fails.
+    struct ReusedProductState
+    {
+        ResolvedProductPtr product;
+        WeakPointer<ResolvedProject> project;
+        bool enabled = false;
+        std::vector<ResolvedProductPtr> dependencies;
+        QHash<ResolvedProductConstPtr, QVariantMap> dependencyParameters;
+        ExportedModule exportedModule;
+    };
+    std::vector<ReusedProductState> m_reusedProductStates;
     mutable QHash<FileContextConstPtr, ResolvedFileContextPtr> m_fileContextMap;
     mutable QHash<CodeLocation, ScriptFunctionPtr> m_scriptFunctionMap;
     mutable QHash<std::pair<QStringRef, QStringList>, QString> m_scriptFunctions;
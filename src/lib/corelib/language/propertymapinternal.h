@@ -43,16 +43,17 @@
 #include "forward_decls.h"
 #include <tools/persistence.h>
 #include <tools/qbs_export.h>
+#include <tools/slaballocator.h>
 #include <QtCore/qvariant.h>
 
 namespace qbs {
 namespace Internal {
 
-class QBS_AUTOTEST_EXPORT PropertyMapInternal
+class QBS_AUTOTEST_EXPORT PropertyMapInternal : public SlabAllocated
 {
 public:
-    static PropertyMapPtr create() { return PropertyMapPtr(new PropertyMapInternal); }
-    PropertyMapPtr clone() const { return PropertyMapPtr(new PropertyMapInternal(*this)); }
+    static PropertyMapPtr create() { return makeSlabShared(new PropertyMapInternal); }
+    PropertyMapPtr clone() const { return makeSlabShared(new PropertyMapInternal(*this)); }
 
     const QVariantMap &value() const { return m_value; }
     QVariant moduleProperty(const QString &moduleName,
@@ -289,6 +289,70 @@ QVariant ScriptEngine::retrieveFromPropertyCache(const QString &moduleName,
     return m_propertyCache.value(PropertyCacheKey(moduleName, propertyName, propertyMap));
 }
 
+// Returns the value of computeFunction for the given property map. The function runs only once
+// per map, but every call records the properties the function requested.
+// If artifact is non-null, the map is its property map.
+// All callers get the same script value, so that a cache hit does not have to convert
+// anything. Scripts must therefore not modify it.
+QScriptValue ScriptEngine::cachedPropertyMapValue(const QString &key,
+        const PropertyMapConstPtr &propertyMap, const Artifact *artifact,
+        const QScriptValue &computeFunction)
+{
+    const auto cacheKey = std::make_pair(propertyMap.get(), key);
+    const auto it = m_propertyMapValues.constFind(cacheKey);
+    if (it != m_propertyMapValues.constEnd()) {
+        const PropertyMapValue &cached = it.value();
+        m_propertiesRequestedInScript += cached.propertiesRequestedInScript;
+        if (artifact) {
+            m_propertiesRequestedFromArtifact[artifact->filePath()]
+                    += cached.propertiesRequestedFromArtifact;
+        }
+        for (auto other = cached.propertiesRequestedFromOtherArtifacts.cbegin();
+             other != cached.propertiesRequestedFromOtherArtifacts.cend(); ++other) {
+            m_propertiesRequestedFromArtifact[other.key()] += other.value();
+        }
+        for (const qint64 importValueId : cached.importsRequestedInScript)
+            addImportRequestedInScript(importValueId);
+        return cached.value;
+    }
+
+    // Let the function start with empty requests, so we see everything it needs.
+    PropertySet propertiesRequestedInScript;
+    QHash<QString, PropertySet> propertiesRequestedFromArtifact;
+    std::vector<qint64> importsRequestedInScript;
+    std::swap(propertiesRequestedInScript, m_propertiesRequestedInScript);
+    std::swap(propertiesRequestedFromArtifact, m_propertiesRequestedFromArtifact);
+    std::swap(importsRequestedInScript, m_importsRequestedInScript);
+    const QScriptValue result = computeFunction.call();
+    std::swap(propertiesRequestedInScript, m_propertiesRequestedInScript);
+    std::swap(propertiesRequestedFromArtifact, m_propertiesRequestedFromArtifact);
+    std::swap(importsRequestedInScript, m_importsRequestedInScript);
+
+    PropertyMapValue computed;
+    computed.propertyMap = propertyMap;
+    computed.propertiesRequestedInScript = propertiesRequestedInScript;
+    computed.propertiesRequestedFromOtherArtifacts = propertiesRequestedFromArtifact;
+    if (artifact) {
+        computed.propertiesRequestedFromArtifact
+                = computed.propertiesRequestedFromOtherArtifacts.take(artifact->filePath());
+    }
+    computed.importsRequestedInScript = importsRequestedInScript;
+
+    m_propertiesRequestedInScript += propertiesRequestedInScript;
+    for (auto it = propertiesRequestedFromArtifact.cbegin();
+         it != propertiesRequestedFromArtifact.cend(); ++it) {
+        m_propertiesRequestedFromArtifact[it.key()] += it.value();
+    }
+    for (const qint64 importValueId : importsRequestedInScript)
+        addImportRequestedInScript(importValueId);
+
+    if (hasErrorOrException(result))
+        return result;
+    computed.value = result;
+    m_propertyMapValues.insert(cacheKey, computed);
+    return result;
+}
+
 void ScriptEngine::defineProperty(QScriptValue &object, const QString &name,
                                   const QScriptValue &descriptor)
 {
@@ -574,12 +638,14 @@ void ScriptEngine::releaseResourcesOfScriptObjects()
 void ScriptEngine::addCanonicalFilePathResult(const QString &filePath,
                                               const QString &resultFilePath)
 {
+    m_fileSystemQueried = true;
     if (gatherFileResults())
         m_canonicalFilePathResult.insert(filePath, resultFilePath);
 }
 
 void ScriptEngine::addFileExistsResult(const QString &filePath, bool exists)
 {
+    m_fileSystemQueried = true;
     if (gatherFileResults())
         m_fileExistsResult.insert(filePath, exists);
 }
@@ -587,6 +653,7 @@ void ScriptEngine::addFileExistsResult(const QString &filePath, bool exists)
 void ScriptEngine::addDirectoryEntriesResult(const QString &path, QDir::Filters filters,
                                              const QStringList &entries)
 {
+    m_fileSystemQueried = true;
     if (gatherFileResults()) {
         m_directoryEntriesResult.insert(
                     std::pair<QString, quint32>(path, static_cast<quint32>(filters)),
@@ -596,6 +663,7 @@ void ScriptEngine::addDirectoryEntriesResult(const QString &path, QDir::Filters
 
 void ScriptEngine::addFileLastModifiedResult(const QString &filePath, const FileTime &fileTime)
 {
+    m_fileSystemQueried = true;
     if (gatherFileResults())
         m_fileLastModifiedResult.insert(filePath, fileTime);
 }
@@ -171,6 +171,10 @@ public:
     void clearUsesIo() { m_usesIo = false; }
     bool usesIo() const { return m_usesIo; }
 
+    // Whether a script has looked at the file system, e.g. via File.exists().
+    void clearFileSystemQueried() { m_fileSystemQueried = false; }
+    bool fileSystemQueried() const { return m_fileSystemQueried; }
+
     void enableProfiling(bool enable);
 
     void setPropertyCacheEnabled(bool enable) { m_propertyCacheEnabled = enable; }
@@ -179,6 +183,9 @@ public:
                             const PropertyMapConstPtr &propertyMap, const QVariant &value);
     QVariant retrieveFromPropertyCache(const QString &moduleName, const QString &propertyName,
                                        const PropertyMapConstPtr &propertyMap);
+    QScriptValue cachedPropertyMapValue(const QString &key, const PropertyMapConstPtr &propertyMap,
+                                        const Artifact *artifact,
+                                        const QScriptValue &computeFunction);
 
     void defineProperty(QScriptValue &object, const QString &name, const QScriptValue &descriptor);
     void setObservedProperty(QScriptValue &object, const QString &name, const QScriptValue &value);
@@ -327,6 +334,19 @@ private:
     bool m_propertyCacheEnabled;
     bool m_active;
     QHash<PropertyCacheKey, QVariant> m_propertyCache;
+
+    // A value that a script computed from one property map, along with what the
+    // computation requested, so that re-using the value can be tracked like computing it.
+    struct PropertyMapValue
+    {
+        PropertyMapConstPtr propertyMap; // Keeps the key alive.
+        QScriptValue value;
+        PropertySet propertiesRequestedInScript;
+        PropertySet propertiesRequestedFromArtifact; // The artifact the value was requested for.
+        QHash<QString, PropertySet> propertiesRequestedFromOtherArtifacts;
+        std::vector<qint64> importsRequestedInScript;
+    };
+    QHash<std::pair<const PropertyMapInternal *, QString>, PropertyMapValue> m_propertyMapValues;
     PropertySet m_propertiesRequestedInScript;
     QHash<QString, PropertySet> m_propertiesRequestedFromArtifact;
     Logger &m_logger;
@@ -347,6 +367,7 @@ private:
     QScriptValue m_cancelationError;
     qint64 m_elapsedTimeImporting = -1;
     bool m_usesIo = false;
+    bool m_fileSystemQueried = false;
     EvalContext m_evalContext;
     std::vector<ResourceAcquiringScriptObject *> m_resourceAcquiringScriptObjects;
     const std::unique_ptr<PrepareScriptObserver> m_observer;
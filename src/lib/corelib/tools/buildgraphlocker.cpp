@@ -41,6 +41,7 @@
 
 #include "error.h"
 #include "hostosinfo.h"
+#include "persistence.h"
 #include "processutils.h"
 #include "progressobserver.h"
 #include "stringconstants.h"
@@ -106,14 +107,50 @@ static bool appNamesAreEqual(const QString &app1, const QString &app2)
 }
 
 BuildGraphLocker::BuildGraphLocker(const QString &buildGraphFilePath, const Logger &logger,
-                                   bool waitIndefinitely, ProgressObserver *observer)
-    : m_lockFile(buildGraphFilePath + QStringLiteral(".lock"))
+                                   bool waitIndefinitely, ProgressObserver *observer,
+                                   LockMode mode)
+    : m_buildGraphFilePath(buildGraphFilePath)
+    , m_lockFile(buildGraphFilePath + QStringLiteral(".lock"))
     , m_logger(logger)
     , m_dirManager(QFileInfo(buildGraphFilePath).absolutePath(), logger)
+    , m_mode(mode)
 {
+    m_lockFile.setStaleLockTime(0);
+    if (m_mode == LockMode::Write) {
+        acquireLockFile(waitIndefinitely, observer);
+        return;
+    }
+
+    // This must happen before the build graph is loaded, so that a build graph stored
+    // in the meantime is detected when switching to write mode.
+    m_snapshotGeneration = PersistentPool::storedGeneration(buildGraphFilePath);
+}
+
+BuildGraphLocker::~BuildGraphLocker()
+{
+    if (m_mode == LockMode::Write)
+        m_lockFile.unlock();
+}
+
+void BuildGraphLocker::lockForWriting()
+{
+    if (m_mode == LockMode::Write)
+        return;
+    acquireLockFile(false, nullptr);
+    if (PersistentPool::storedGeneration(m_buildGraphFilePath) != m_snapshotGeneration) {
+        m_lockFile.unlock();
+        throw ErrorInfo(Tr::tr("Cannot lock build graph file '%1': The build graph was "
+                               "changed by another process. Please re-resolve the project.")
+                        .arg(m_buildGraphFilePath));
+    }
+    m_mode = LockMode::Write;
+}
+
+void BuildGraphLocker::acquireLockFile(bool waitIndefinitely, ProgressObserver *observer)
+{
+    const QString &buildGraphFilePath = m_buildGraphFilePath;
     if (waitIndefinitely)
         m_logger.qbsDebug() << "Waiting to acquire lock file...";
-    m_lockFile.setStaleLockTime(0);
     int attemptsToGetInfo = 0;
     do {
         if (observer && observer->canceled())
@@ -157,10 +194,5 @@ BuildGraphLocker::BuildGraphLocker(const QString &buildGraphFilePath, const Logg
                     .arg(buildGraphFilePath));
 }
 
-BuildGraphLocker::~BuildGraphLocker()
-{
-    m_lockFile.unlock();
-}
-
 } // namespace Internal
 } // namespace qbs
@@ -68,17 +68,32 @@ private:
     Logger m_logger;
 };
 
+// Build graph files are replaced atomically when they are stored, so a process that only
+// reads the build graph always sees the last complete one and does not need to exclude
+// writers. A read locker therefore does not hold the lock file. It has to be turned into
+// a write locker before the build graph or the build directory is modified, which fails if
+// the build graph was stored by someone else after it had been read.
 class BuildGraphLocker
 {
 public:
+    enum class LockMode { Read, Write };
+
     explicit BuildGraphLocker(const QString &buildGraphFilePath, const Logger &logger,
-                              bool waitIndefinitely, ProgressObserver *observer);
+                              bool waitIndefinitely, ProgressObserver *observer,
+                              LockMode mode = LockMode::Write);
     ~BuildGraphLocker();
 
+    void lockForWriting();
+
 private:
+    void acquireLockFile(bool waitIndefinitely, ProgressObserver *observer);
+
+    const QString m_buildGraphFilePath;
     QLockFile m_lockFile;
     Logger m_logger;
     DirectoryManager m_dirManager;
+    LockMode m_mode;
+    quint64 m_snapshotGeneration = 0;
 };
 
 } // namespace Internal
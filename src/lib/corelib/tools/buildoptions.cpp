@@ -61,6 +61,7 @@ public:
     QStringList changedFiles;
     QStringList filesToConsider;
     QStringList activeFileTags;
+    QStringList testsToRun;
     JobLimits jobLimits;
     QString settingsDir;
     int maxJobCount;
@@ -69,11 +70,17 @@ public:
     bool forceTimestampCheck;
     bool forceOutputCheck;
     bool logElapsedTime;
+    bool collectProfilingData = false;
     CommandEchoMode echoMode;
     bool install;
     bool removeExistingInstallation;
     bool onlyExecuteRules;
     bool jobLimitsFromProjectTakePrecedence = false;
+    bool parallelPrepareScripts = false;
+    int memoryBudget = 0;
+    QString remoteWorker;
+    QString remoteWorkerToken;
+    bool provideJobserver = false;
 };
 
 } // namespace Internal
@@ -156,6 +163,25 @@ void BuildOptions::setActiveFileTags(const QStringList &fileTags)
     d->activeFileTags = fileTags;
 }
 
+/*!
+ * \brief The names of the test products whose tests are to be run.
+ * \sa setTestsToRun
+ * By default, this list is empty.
+ */
+QStringList BuildOptions::testsToRun() const
+{
+    return d->testsToRun;
+}
+
+/*!
+ * \brief If the given list is non-empty, AutotestRunner products only run the tests of
+ *        the products with these names. The results of other tests are left untouched.
+ */
+void BuildOptions::setTestsToRun(const QStringList &testProductNames)
+{
+    d->testsToRun = testProductNames;
+}
+
 /*!
  * \brief Returns the default value for \c maxJobCount.
  * This value will be used when \c maxJobCount has not been set explicitly.
@@ -322,6 +348,24 @@ void BuildOptions::setLogElapsedTime(bool log)
     d->logElapsedTime = log;
 }
 
+/*!
+ * \brief Returns true iff hierarchical profiling data will be collected during the build.
+ * The default is \c false.
+ * \sa AbstractJob::profilingData()
+ */
+bool BuildOptions::collectProfilingData() const
+{
+    return d->collectProfilingData;
+}
+
+/*!
+ * \brief Controls whether hierarchical profiling data will be collected during the build.
+ */
+void BuildOptions::setCollectProfilingData(bool collect)
+{
+    d->collectProfilingData = collect;
+}
+
 /*!
  * \brief The kind of output that is displayed when executing commands.
  */
@@ -375,6 +419,107 @@ void BuildOptions::setRemoveExistingInstallation(bool removeExisting)
     d->removeExistingInstallation = removeExisting;
 }
 
+/*!
+ * \brief Returns true iff the prepare scripts of independent rule applications are run
+ * concurrently.
+ * The default is \c false.
+ */
+bool BuildOptions::parallelPrepareScripts() const
+{
+    return d->parallelPrepareScripts;
+}
+
+/*!
+ * \brief Controls whether prepare scripts can be run concurrently.
+ * If \a parallel is \c true, the prepare scripts of a non-multiplex rule are run on up to
+ * \l maxJobCount() threads, each of which has its own JavaScript engine. This speeds up
+ * the start of builds with many source files, at the cost of additional memory.
+ */
+void BuildOptions::setParallelPrepareScripts(bool parallel)
+{
+    d->parallelPrepareScripts = parallel;
+}
+
+/*!
+ * \brief Returns the amount of memory in MiB that concurrently running commands may use.
+ * The default is zero, which means there is no limit.
+ */
+int BuildOptions::memoryBudget() const
+{
+    return d->memoryBudget;
+}
+
+/*!
+ * \brief Limits the memory used by concurrently running commands to \a budget MiB.
+ * A job is only started if the expected memory usage of its commands fits into what is
+ * left of the budget. The expected usage is either declared via the command's
+ * \c expectedMemoryUsage property or learned from earlier builds. A job is always started
+ * if no other job is running. A value of zero disables the limit.
+ */
+void BuildOptions::setMemoryBudget(int budget)
+{
+    d->memoryBudget = budget;
+}
+
+/*!
+ * \brief Returns the address of the remote worker that commands can be run on.
+ * The default is an empty string, which means that all commands are run locally.
+ */
+QString BuildOptions::remoteWorker() const
+{
+    return d->remoteWorker;
+}
+
+/*!
+ * \brief Makes the build ship commands to the remote worker at \a address.
+ * The address has the form \c{<host>:<port>}. Only commands that declare that they can run
+ * remotely are sent to the worker; all others still run locally.
+ */
+void BuildOptions::setRemoteWorker(const QString &address)
+{
+    d->remoteWorker = address;
+}
+
+/*!
+ * \brief Returns the access token that is presented to the remote worker.
+ * The default is an empty string.
+ */
+QString BuildOptions::remoteWorkerToken() const
+{
+    return d->remoteWorkerToken;
+}
+
+/*!
+ * \brief Sets the access token that is presented to the remote worker to \a token.
+ * The worker refuses clients that do not know its token.
+ */
+void BuildOptions::setRemoteWorkerToken(const QString &token)
+{
+    d->remoteWorkerToken = token;
+}
+
+/*!
+ * \brief Returns true iff qbs acts as a GNU make jobserver for the processes it starts.
+ * The default is \c false.
+ */
+bool BuildOptions::provideJobserver() const
+{
+    return d->provideJobserver;
+}
+
+/*!
+ * \brief Controls whether qbs acts as a GNU make jobserver.
+ * If \a provide is \c true and qbs was not itself started by a make that provides a
+ * jobserver, the job tokens are made available to the commands of a build via the
+ * \c MAKEFLAGS environment variable. This way, sub-makes and compilers that support the
+ * jobserver protocol, such as \c{gcc -flto=jobserver}, stay within the \l maxJobCount()
+ * limit. Only supported on Unix.
+ */
+void BuildOptions::setProvideJobserver(bool provide)
+{
+    d->provideJobserver = provide;
+}
+
 /*!
  * \brief Returns true iff instead of a full build, only the rules of the project will be run.
  * The default is false.
@@ -457,6 +602,11 @@ qbs::BuildOptions qbs::BuildOptions::fromJson(const QJsonObject &data)
     setValueFromJson(opt.d->removeExistingInstallation, data, "clean-install-root");
     setValueFromJson(opt.d->onlyExecuteRules, data, "only-execute-rules");
     setValueFromJson(opt.d->jobLimitsFromProjectTakePrecedence, data, "enforce-project-job-limits");
+    setValueFromJson(opt.d->parallelPrepareScripts, data, "parallel-prepare-scripts");
+    setValueFromJson(opt.d->memoryBudget, data, "memory-budget");
+    setValueFromJson(opt.d->remoteWorker, data, "remote-worker");
+    setValueFromJson(opt.d->remoteWorkerToken, data, "remote-worker-token");
+    setValueFromJson(opt.d->provideJobserver, data, "jobserver");
     return opt;
 }
 
@@ -73,6 +73,9 @@ public:
     QStringList activeFileTags() const;
     void setActiveFileTags(const QStringList &fileTags);
 
+    QStringList testsToRun() const;
+    void setTestsToRun(const QStringList &testProductNames);
+
     static int defaultMaxJobCount();
     int maxJobCount() const;
     void setMaxJobCount(int jobCount);
@@ -101,6 +104,9 @@ public:
     bool logElapsedTime() const;
     void setLogElapsedTime(bool log);
 
+    bool collectProfilingData() const;
+    void setCollectProfilingData(bool collect);
+
     CommandEchoMode echoMode() const;
     void setEchoMode(CommandEchoMode echoMode);
 
@@ -113,6 +119,21 @@ public:
     bool executeRulesOnly() const;
     void setExecuteRulesOnly(bool onlyRules);
 
+    bool parallelPrepareScripts() const;
+    void setParallelPrepareScripts(bool parallel);
+
+    int memoryBudget() const;
+    void setMemoryBudget(int budget);
+
+    QString remoteWorker() const;
+    void setRemoteWorker(const QString &address);
+
+    QString remoteWorkerToken() const;
+    void setRemoteWorkerToken(const QString &token);
+
+    bool provideJobserver() const;
+    void setProvideJobserver(bool provide);
+
 private:
     QSharedDataPointer<Internal::BuildOptionsPrivate> d;
 };
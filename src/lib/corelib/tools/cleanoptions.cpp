@@ -49,13 +49,15 @@ class CleanOptionsPrivate : public QSharedData
 {
 public:
     CleanOptionsPrivate()
-        : dryRun(false),
-          keepGoing(false), logElapsedTime(false)
+        : maxJobCount(0), dryRun(false),
+          keepGoing(false), logElapsedTime(false), removeProductDirectories(false)
     { }
 
+    int maxJobCount;
     bool dryRun;
     bool keepGoing;
     bool logElapsedTime;
+    bool removeProductDirectories;
 };
 
 } // namespace Internal
@@ -145,6 +147,46 @@ void CleanOptions::setLogElapsedTime(bool log)
     d->logElapsedTime = log;
 }
 
+/*!
+ * \brief Returns the maximum number of threads that remove files concurrently.
+ * If the value is not valid (i.e. <= 0), the number of available processor cores is used.
+ * The default is 0.
+ */
+int CleanOptions::maxJobCount() const
+{
+    return d->maxJobCount;
+}
+
+/*!
+ * \brief Controls how many threads remove files concurrently.
+ */
+void CleanOptions::setMaxJobCount(int jobCount)
+{
+    d->maxJobCount = jobCount;
+}
+
+/*!
+ * \brief Returns true iff a product's build directory is removed as a whole if it contains
+ * only files generated for that product.
+ * The default is false.
+ */
+bool CleanOptions::removeProductDirectories() const
+{
+    return d->removeProductDirectories;
+}
+
+/*!
+ * \brief Controls whether product build directories can be removed as a whole.
+ * If the argument is true, then qbs will not look up the product's artifacts one by one,
+ * but will instead remove the product's build directory with everything in it, provided
+ * that the directory does not contain any file that is not a generated artifact of the product.
+ * Otherwise, the artifacts are removed individually as usual.
+ */
+void CleanOptions::setRemoveProductDirectories(bool remove)
+{
+    d->removeProductDirectories = remove;
+}
+
 qbs::CleanOptions qbs::CleanOptions::fromJson(const QJsonObject &data)
 {
     CleanOptions opt;
@@ -152,6 +194,8 @@ qbs::CleanOptions qbs::CleanOptions::fromJson(const QJsonObject &data)
     setValueFromJson(opt.d->dryRun, data, "dry-run");
     setValueFromJson(opt.d->keepGoing, data, "keep-going");
     setValueFromJson(opt.d->logElapsedTime, data, "log-time");
+    setValueFromJson(opt.d->maxJobCount, data, "max-job-count");
+    setValueFromJson(opt.d->removeProductDirectories, data, "remove-product-directories");
     return opt;
 }
 
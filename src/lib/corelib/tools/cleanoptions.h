@@ -71,6 +71,12 @@ public:
     bool logElapsedTime() const;
     void setLogElapsedTime(bool log);
 
+    int maxJobCount() const;
+    void setMaxJobCount(int jobCount);
+
+    bool removeProductDirectories() const;
+    void setRemoveProductDirectories(bool remove);
+
 private:
     QSharedDataPointer<Internal::CleanOptionsPrivate> d;
 };
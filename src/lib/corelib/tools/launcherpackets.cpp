@@ -125,7 +125,7 @@ void ProcessFinishedPacket::doSerialize(QDataStream &stream) const
 {
     stream << errorString << stdOut << stdErr
            << static_cast<quint8>(exitStatus) << static_cast<quint8>(error)
-           << exitCode;
+           << exitCode << peakMemoryUsage;
 }
 
 void ProcessFinishedPacket::doDeserialize(QDataStream &stream)
@@ -136,13 +136,120 @@ void ProcessFinishedPacket::doDeserialize(QDataStream &stream)
     exitStatus = static_cast<QProcess::ExitStatus>(val);
     stream >> val;
     error = static_cast<QProcess::ProcessError>(val);
-    stream >> exitCode;
+    stream >> exitCode >> peakMemoryUsage;
 }
 
 ShutdownPacket::ShutdownPacket() : LauncherPacket(LauncherPacketType::Shutdown, 0) { }
 void ShutdownPacket::doSerialize(QDataStream &stream) const { Q_UNUSED(stream); }
 void ShutdownPacket::doDeserialize(QDataStream &stream) { Q_UNUSED(stream); }
 
+
+RemoteHandshakePacket::RemoteHandshakePacket()
+    : LauncherPacket(LauncherPacketType::RemoteHandshake, 0)
+{
+}
+
+void RemoteHandshakePacket::doSerialize(QDataStream &stream) const
+{
+    stream << accessToken;
+}
+
+void RemoteHandshakePacket::doDeserialize(QDataStream &stream)
+{
+    stream >> accessToken;
+}
+
+QDataStream &operator<<(QDataStream &stream, const RemoteInputFile &file)
+{
+    return stream << file.filePath << file.digest << file.executable;
+}
+
+QDataStream &operator>>(QDataStream &stream, RemoteInputFile &file)
+{
+    return stream >> file.filePath >> file.digest >> file.executable;
+}
+
+QDataStream &operator<<(QDataStream &stream, const RemoteOutputFile &file)
+{
+    return stream << file.content << file.executable;
+}
+
+QDataStream &operator>>(QDataStream &stream, RemoteOutputFile &file)
+{
+    return stream >> file.content >> file.executable;
+}
+
+RemoteExecutePacket::RemoteExecutePacket(quintptr token)
+    : LauncherPacket(LauncherPacketType::RemoteExecute, token)
+{
+}
+
+void RemoteExecutePacket::doSerialize(QDataStream &stream) const
+{
+    stream << command << arguments << workingDir << env << inputs << outputs;
+}
+
+void RemoteExecutePacket::doDeserialize(QDataStream &stream)
+{
+    stream >> command >> arguments >> workingDir >> env >> inputs >> outputs;
+}
+
+
+RemoteMissingBlobsPacket::RemoteMissingBlobsPacket(quintptr token)
+    : LauncherPacket(LauncherPacketType::RemoteMissingBlobs, token)
+{
+}
+
+void RemoteMissingBlobsPacket::doSerialize(QDataStream &stream) const
+{
+    stream << digests;
+}
+
+void RemoteMissingBlobsPacket::doDeserialize(QDataStream &stream)
+{
+    stream >> digests;
+}
+
+
+RemoteUploadBlobsPacket::RemoteUploadBlobsPacket(quintptr token)
+    : LauncherPacket(LauncherPacketType::RemoteUploadBlobs, token)
+{
+}
+
+void RemoteUploadBlobsPacket::doSerialize(QDataStream &stream) const
+{
+    stream << blobs;
+}
+
+void RemoteUploadBlobsPacket::doDeserialize(QDataStream &stream)
+{
+    stream >> blobs;
+}
+
+
+RemoteExecutionFinishedPacket::RemoteExecutionFinishedPacket(quintptr token)
+    : LauncherPacket(LauncherPacketType::RemoteExecutionFinished, token)
+{
+}
+
+void RemoteExecutionFinishedPacket::doSerialize(QDataStream &stream) const
+{
+    stream << errorString << stdOut << stdErr
+           << static_cast<quint8>(exitStatus) << static_cast<quint8>(error)
+           << exitCode << outputs;
+}
+
+void RemoteExecutionFinishedPacket::doDeserialize(QDataStream &stream)
+{
+    stream >> errorString >> stdOut >> stdErr;
+    quint8 val;
+    stream >> val;
+    exitStatus = static_cast<QProcess::ExitStatus>(val);
+    stream >> val;
+    error = static_cast<QProcess::ProcessError>(val);
+    stream >> exitCode >> outputs;
+}
+
 void PacketParser::setDevice(QIODevice *device)
 {
     m_stream.setDevice(device);
@@ -41,6 +41,8 @@
 #define QBS_LAUNCHERPACKETS_H
 
 #include <QtCore/qdatastream.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qlist.h>
 #include <QtCore/qprocess.h>
 #include <QtCore/qstringlist.h>
 
@@ -52,7 +54,9 @@ namespace qbs {
 namespace Internal {
 
 enum class LauncherPacketType {
-    Shutdown, StartProcess, StopProcess, ProcessError, ProcessFinished
+    Shutdown, StartProcess, StopProcess, ProcessError, ProcessFinished,
+    RemoteExecute, RemoteMissingBlobs, RemoteUploadBlobs, RemoteExecutionFinished,
+    RemoteHandshake
 };
 
 class PacketParser
@@ -164,6 +168,105 @@ public:
     QProcess::ExitStatus exitStatus = QProcess::ExitStatus::NormalExit;
     QProcess::ProcessError error = QProcess::ProcessError::UnknownError;
     int exitCode = 0;
+    qint64 peakMemoryUsage = 0; // In bytes, zero if unknown.
+
+private:
+    void doSerialize(QDataStream &stream) const override;
+    void doDeserialize(QDataStream &stream) override;
+};
+
+// The following packets make up the protocol between qbs and a remote worker.
+// Inputs are identified by their content digest, so a worker needs to receive only those
+// files it does not have yet. The worker mirrors the client's absolute file paths.
+
+// Must be the first packet a client sends. The worker drops connections that do not
+// present its access token.
+class RemoteHandshakePacket : public LauncherPacket
+{
+public:
+    RemoteHandshakePacket();
+
+    QByteArray accessToken;
+
+private:
+    void doSerialize(QDataStream &stream) const override;
+    void doDeserialize(QDataStream &stream) override;
+};
+
+class RemoteInputFile
+{
+public:
+    QString filePath;
+    QByteArray digest;
+    bool executable = false;
+};
+
+QDataStream &operator<<(QDataStream &stream, const RemoteInputFile &file);
+QDataStream &operator>>(QDataStream &stream, RemoteInputFile &file);
+
+class RemoteOutputFile
+{
+public:
+    QByteArray content;
+    bool executable = false;
+};
+
+QDataStream &operator<<(QDataStream &stream, const RemoteOutputFile &file);
+QDataStream &operator>>(QDataStream &stream, RemoteOutputFile &file);
+
+class RemoteExecutePacket : public LauncherPacket
+{
+public:
+    RemoteExecutePacket(quintptr token);
+
+    QString command;
+    QStringList arguments;
+    QString workingDir;
+    QStringList env;
+    QList<RemoteInputFile> inputs;
+    QStringList outputs;
+
+private:
+    void doSerialize(QDataStream &stream) const override;
+    void doDeserialize(QDataStream &stream) override;
+};
+
+class RemoteMissingBlobsPacket : public LauncherPacket
+{
+public:
+    RemoteMissingBlobsPacket(quintptr token);
+
+    QList<QByteArray> digests;
+
+private:
+    void doSerialize(QDataStream &stream) const override;
+    void doDeserialize(QDataStream &stream) override;
+};
+
+class RemoteUploadBlobsPacket : public LauncherPacket
+{
+public:
+    RemoteUploadBlobsPacket(quintptr token);
+
+    QHash<QByteArray, QByteArray> blobs; // Digest to content.
+
+private:
+    void doSerialize(QDataStream &stream) const override;
+    void doDeserialize(QDataStream &stream) override;
+};
+
+class RemoteExecutionFinishedPacket : public LauncherPacket
+{
+public:
+    RemoteExecutionFinishedPacket(quintptr token);
+
+    QString errorString;
+    QByteArray stdOut;
+    QByteArray stdErr;
+    QProcess::ExitStatus exitStatus = QProcess::ExitStatus::NormalExit;
+    QProcess::ProcessError error = QProcess::ProcessError::UnknownError;
+    int exitCode = 0;
+    QHash<QString, RemoteOutputFile> outputs; // By file path.
 
 private:
     void doSerialize(QDataStream &stream) const override;
@@ -0,0 +1,179 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "pathatom.h"
+
+#include "qttools.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace qbs {
+namespace Internal {
+
+class PathAtom::Entry
+{
+public:
+    explicit Entry(QString string) : string(std::move(string)) {}
+
+    const QString string;
+
+    // Only ever drops to zero with the table's lock held, and the entry is removed from the
+    // table right away. Therefore, entries found in the table always have a positive count.
+    std::atomic_int refCount{1};
+};
+
+namespace {
+class PathAtomTable
+{
+public:
+    static PathAtomTable &instance()
+    {
+        // Deliberately leaked, as atoms might still be in use during static destruction.
+        static PathAtomTable * const table = new PathAtomTable;
+        return *table;
+    }
+
+    PathAtom::Entry *find(const QString &string)
+    {
+        std::shared_lock<std::shared_mutex> locker(m_mutex);
+        return findAndRef(string);
+    }
+
+    PathAtom::Entry *intern(const QString &string)
+    {
+        if (PathAtom::Entry * const existing = find(string))
+            return existing;
+        std::lock_guard<std::shared_mutex> locker(m_mutex);
+        if (PathAtom::Entry * const existing = findAndRef(string))
+            return existing; // Another thread was faster.
+        auto entry = std::make_unique<PathAtom::Entry>(string);
+        PathAtom::Entry * const entryPtr = entry.get();
+        m_entries.emplace(entryPtr->string, std::move(entry));
+        return entryPtr;
+    }
+
+    void release(PathAtom::Entry *entry)
+    {
+        // Fast path: Someone else still holds a reference.
+        int refCount = entry->refCount.load(std::memory_order_relaxed);
+        while (refCount > 1) {
+            if (entry->refCount.compare_exchange_weak(refCount, refCount - 1,
+                                                      std::memory_order_release,
+                                                      std::memory_order_relaxed)) {
+                return;
+            }
+        }
+
+        std::lock_guard<std::shared_mutex> locker(m_mutex);
+        if (entry->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            m_entries.erase(m_entries.find(entry->string));
+    }
+
+private:
+    PathAtom::Entry *findAndRef(const QString &string)
+    {
+        const auto it = m_entries.find(string);
+        if (it == m_entries.cend())
+            return nullptr;
+        it->second->refCount.fetch_add(1, std::memory_order_relaxed);
+        return it->second.get();
+    }
+
+    std::shared_mutex m_mutex;
+
+    // The keys share their data with the strings in the entries. The entries are
+    // heap-allocated, so they stay at the same address no matter what happens to the table.
+    std::unordered_map<QString, std::unique_ptr<PathAtom::Entry>> m_entries;
+};
+} // namespace
+
+PathAtom::PathAtom(const PathAtom &other) : m_entry(other.m_entry)
+{
+    if (m_entry)
+        m_entry->refCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+PathAtom &PathAtom::operator=(const PathAtom &other)
+{
+    PathAtom copy(other);
+    std::swap(m_entry, copy.m_entry);
+    return *this;
+}
+
+PathAtom &PathAtom::operator=(PathAtom &&other) noexcept
+{
+    std::swap(m_entry, other.m_entry);
+    return *this;
+}
+
+PathAtom::~PathAtom()
+{
+    if (m_entry)
+        PathAtomTable::instance().release(m_entry);
+}
+
+PathAtom PathAtom::intern(const QString &string)
+{
+    if (string.isEmpty())
+        return {};
+    return PathAtom(PathAtomTable::instance().intern(string));
+}
+
+std::optional<PathAtom> PathAtom::find(const QString &string)
+{
+    if (string.isEmpty())
+        return PathAtom();
+    if (Entry * const entry = PathAtomTable::instance().find(string))
+        return PathAtom(entry);
+    return {};
+}
+
+const QString &PathAtom::toString() const
+{
+    static const QString emptyString;
+    return m_entry ? m_entry->string : emptyString;
+}
+
+} // namespace Internal
+} // namespace qbs
@@ -0,0 +1,126 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_PATHATOM_H
+#define QBS_PATHATOM_H
+
+#include "persistence.h"
+#include "qbs_export.h"
+
+#include <QtCore/qhashfunctions.h>
+#include <QtCore/qstring.h>
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+
+namespace qbs {
+namespace Internal {
+
+// A directory path or file name from a process-wide interning table. Build graphs contain
+// millions of paths, but only a few thousand distinct directories, so storing and hashing
+// atoms instead of strings saves a lot of memory and time, and two atoms are equal
+// if and only if they point to the same table entry.
+// Entries are reference-counted: An entry is removed from the table as soon as the last atom
+// referring to it goes away, so a long-running process such as an IDE does not accumulate
+// the paths of all the projects it has ever loaded.
+class QBS_AUTOTEST_EXPORT PathAtom
+{
+public:
+    PathAtom() = default;
+    PathAtom(const PathAtom &other);
+    PathAtom(PathAtom &&other) noexcept : m_entry(other.m_entry) { other.m_entry = nullptr; }
+    PathAtom &operator=(const PathAtom &other);
+    PathAtom &operator=(PathAtom &&other) noexcept;
+    ~PathAtom();
+
+    // Returns the atom for the given string, creating it if necessary.
+    static PathAtom intern(const QString &string);
+
+    // Returns the atom for the given string if one exists. Use this for look-ups, so that
+    // the table does not grow with strings that cannot be found anyway.
+    static std::optional<PathAtom> find(const QString &string);
+
+    // The null atom represents the empty string.
+    bool isNull() const { return !m_entry; }
+    const QString &toString() const;
+
+    std::size_t hash() const
+    {
+        return std::size_t((reinterpret_cast<quintptr>(m_entry) >> 4)
+                           * quintptr(0x9E3779B97F4A7C15ULL));
+    }
+
+    class Entry; // Opaque, see pathatom.cpp.
+
+private:
+    explicit PathAtom(Entry *entry) : m_entry(entry) {}
+
+    friend bool operator==(const PathAtom &a1, const PathAtom &a2)
+    {
+        return a1.m_entry == a2.m_entry;
+    }
+
+    Entry *m_entry = nullptr;
+};
+
+inline bool operator!=(const PathAtom &a1, const PathAtom &a2) { return !(a1 == a2); }
+inline uint qHash(const PathAtom &atom, uint seed = 0) { return uint(atom.hash()) ^ seed; }
+
+// Serialized as a plain string, so the on-disk format does not depend on interning.
+template<> struct PPHelper<PathAtom>
+{
+    static void store(const PathAtom &atom, PersistentPool *pool) { pool->store(atom.toString()); }
+    static void load(PathAtom &atom, PersistentPool *pool)
+    {
+        atom = PathAtom::intern(pool->load<QString>());
+    }
+};
+
+} // namespace Internal
+} // namespace qbs
+
+namespace std {
+template<> struct hash<qbs::Internal::PathAtom>
+{
+    std::size_t operator()(const qbs::Internal::PathAtom &atom) const { return atom.hash(); }
+};
+} // namespace std
+
+#endif // QBS_PATHATOM_H
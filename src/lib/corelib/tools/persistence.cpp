@@ -44,11 +44,12 @@
 #include <tools/error.h>
 
 #include <QtCore/qdir.h>
+#include <QtCore/qsavefile.h>
 
 namespace qbs {
 namespace Internal {
 
-static const char QBS_PERSISTENCE_MAGIC[] = "QBSPERSISTENCE-129";
+static const char QBS_PERSISTENCE_MAGIC[] = "QBSPERSISTENCE-141";
 
 NoBuildGraphError::NoBuildGraphError(const QString &filePath)
     : ErrorInfo(Tr::tr("Build graph not found for configuration '%1'. Expected location was '%2'.")
@@ -85,7 +86,7 @@ void PersistentPool::load(const QString &filePath)
                          QString::fromLatin1(magic)));
     }
 
-    m_stream >> m_headData.projectConfig;
+    m_stream >> m_headData.generation >> m_headData.projectConfig;
     m_file = std::move(file);
     m_loadedRaw.clear();
     m_loaded.clear();
@@ -94,6 +95,23 @@ void PersistentPool::load(const QString &filePath)
     m_inverseStringStorage.clear();
 }
 
+// Returns 0 if there is no usable build graph file.
+quint64 PersistentPool::storedGeneration(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QFile::ReadOnly))
+        return 0;
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_8);
+    QByteArray magic;
+    stream >> magic;
+    if (magic != QBS_PERSISTENCE_MAGIC)
+        return 0;
+    quint64 generation;
+    stream >> generation;
+    return stream.status() == QDataStream::Ok ? generation : 0;
+}
+
 void PersistentPool::setupWriteStream(const QString &filePath)
 {
     QString dirPath = FileInfo::path(filePath);
@@ -102,20 +120,18 @@ void PersistentPool::setupWriteStream(const QString &filePath)
                         .arg(dirPath));
     }
 
-    if (QFile::exists(filePath) && !QFile::remove(filePath)) {
-        throw ErrorInfo(Tr::tr("Failure storing build graph: Cannot remove old file '%1'")
-                        .arg(filePath));
-    }
-    QBS_CHECK(!QFile::exists(filePath));
-    std::unique_ptr<QFile> file(new QFile(filePath));
-    if (!file->open(QFile::WriteOnly)) {
+    // The new build graph becomes visible only in finalizeWriteStream(), so processes reading
+    // the build graph concurrently always get a complete one.
+    std::unique_ptr<QSaveFile> file(new QSaveFile(filePath));
+    if (!file->open(QIODevice::WriteOnly)) {
         throw ErrorInfo(Tr::tr("Failure storing build graph: "
                 "Cannot open file '%1' for writing: %2").arg(filePath, file->errorString()));
     }
 
     m_stream.setDevice(file.get());
     m_file = std::move(file);
-    m_stream << QByteArray(qstrlen(QBS_PERSISTENCE_MAGIC), 0) << m_headData.projectConfig;
+    m_stream << QByteArray(qstrlen(QBS_PERSISTENCE_MAGIC), 0) << m_headData.generation
+             << m_headData.projectConfig;
     m_lastStoredObjectId = 0;
     m_lastStoredStringId = 0;
     m_lastStoredEnvId = 0;
@@ -130,12 +146,9 @@ void PersistentPool::finalizeWriteStream()
     m_stream << QByteArray(QBS_PERSISTENCE_MAGIC);
     if (m_stream.status() != QDataStream::Ok)
         throw ErrorInfo(Tr::tr("Failure serializing build graph."));
-    const auto file = static_cast<QFile *>(m_stream.device());
-    if (!file->flush()) {
-        file->close();
-        file->remove();
+    const auto file = static_cast<QSaveFile *>(m_stream.device());
+    if (!file->commit())
         throw ErrorInfo(Tr::tr("Failure serializing build graph: %1").arg(file->errorString()));
-    }
 }
 
 void PersistentPool::storeVariant(const QVariant &variant)
@@ -78,6 +78,7 @@ public:
     class HeadData
     {
     public:
+        quint64 generation = 0; // Incremented every time the build graph is stored.
         QVariantMap projectConfig;
     };
 
@@ -126,6 +127,7 @@ public:
     }
 
     void load(const QString &filePath);
+    static quint64 storedGeneration(const QString &filePath);
     void setupWriteStream(const QString &filePath);
     void finalizeWriteStream();
     void clear();
@@ -54,12 +54,14 @@ QT_END_NAMESPACE
 namespace qbs {
 namespace Internal {
 class ProcessCommandExecutor;
+class ProcessOutputWorker;
 class ProcessResultPrivate;
 }
 
 class QBS_EXPORT ProcessResult
 {
     friend class qbs::Internal::ProcessCommandExecutor;
+    friend class qbs::Internal::ProcessOutputWorker;
 public:
     ProcessResult();
     ProcessResult(const ProcessResult &other);
@@ -39,11 +39,17 @@
 
 #include "profiling.h"
 
+#include "slaballocator.h"
+
 #include <logging/logger.h>
 #include <logging/translator.h>
 
+#include <QtCore/qhash.h>
+#include <QtCore/qjsonarray.h>
 #include <QtCore/qstring.h>
 
+#include <vector>
+
 namespace qbs {
 namespace Internal {
 
@@ -103,6 +109,151 @@ void AccumulatingTimer::stop()
     m_timer.invalidate();
 }
 
+static thread_local Profiler *currentProfiler = nullptr;
+static thread_local Profiler::Node *currentNode = nullptr;
+
+// Only the objects of slab-allocated types such as build graph nodes are counted, but
+// unlike a process-wide heap statistic, this is cheap and attributes the allocations
+// to the thread that made them.
+static qint64 allocatedBytes()
+{
+    return qint64(slabBytesAllocatedInCurrentThread());
+}
+
+class Profiler::Node
+{
+public:
+    Node(QString name, Node *parent) : name(std::move(name)), parent(parent) {}
+
+    QJsonObject toJson() const
+    {
+        QJsonObject json;
+        json.insert(QStringLiteral("name"), name);
+        json.insert(QStringLiteral("count"), count);
+        json.insert(QStringLiteral("wall-time-ms"), double(elapsedNs) / 1000000);
+        json.insert(QStringLiteral("allocated-bytes"), allocatedBytes);
+        if (!children.empty()) {
+            QJsonArray childrenJson;
+            for (const auto &child : children)
+                childrenJson.append(child->toJson());
+            json.insert(QStringLiteral("children"), childrenJson);
+        }
+        return json;
+    }
+
+    const QString name;
+    Node * const parent;
+    qint64 count = 0;
+    qint64 elapsedNs = 0;
+    qint64 allocatedBytes = 0;
+    std::vector<std::unique_ptr<Node>> children;
+    QHash<QString, Node *> childrenByName;
+};
+
+Profiler::Profiler() : m_root(std::make_unique<Node>(QString(), nullptr))
+{
+}
+
+Profiler::~Profiler() = default;
+
+Profiler *Profiler::current()
+{
+    return currentProfiler;
+}
+
+void Profiler::setAttribute(const QString &key, const QJsonValue &value)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_attributes.insert(key, value);
+}
+
+QJsonObject Profiler::toJson() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    QJsonObject json = m_attributes;
+    QJsonArray scopes;
+    for (const auto &child : m_root->children)
+        scopes.append(child->toJson());
+    json.insert(QStringLiteral("scopes"), scopes);
+    return json;
+}
+
+Profiler::Node *Profiler::enterScope(const QString &name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Node * const parent = currentNode ? currentNode : m_root.get();
+    Node *&node = parent->childrenByName[name];
+    if (!node) {
+        parent->children.push_back(std::make_unique<Node>(name, parent));
+        node = parent->children.back().get();
+    }
+    currentNode = node;
+    return node;
+}
+
+void Profiler::leaveScope(Node *node, qint64 elapsedNs, qint64 allocatedBytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++node->count;
+    node->elapsedNs += elapsedNs;
+    node->allocatedBytes += allocatedBytes;
+    currentNode = node->parent;
+}
+
+Profiler::Activation::Activation(Profiler *profiler)
+    : m_previousProfiler(currentProfiler), m_previousNode(currentNode)
+{
+    currentProfiler = profiler;
+    currentNode = nullptr;
+}
+
+Profiler::Activation::~Activation()
+{
+    currentProfiler = m_previousProfiler;
+    currentNode = m_previousNode;
+}
+
+ProfilingScope::ProfilingScope(const char *name) : m_profiler(currentProfiler)
+{
+    if (m_profiler)
+        start(QLatin1String(name));
+}
+
+ProfilingScope::ProfilingScope(const char *category, const QString &detail)
+    : m_profiler(currentProfiler)
+{
+    if (m_profiler)
+        start(QLatin1String(category) + QLatin1Char(':') + detail);
+}
+
+ProfilingScope::ProfilingScope(const char *category, const std::function<QString()> &detail)
+    : m_profiler(currentProfiler)
+{
+    if (m_profiler)
+        start(QLatin1String(category) + QLatin1Char(':') + detail());
+}
+
+ProfilingScope::~ProfilingScope()
+{
+    stop();
+}
+
+void ProfilingScope::start(const QString &name)
+{
+    m_node = m_profiler->enterScope(name);
+    m_allocatedBytesAtStart = allocatedBytes();
+    m_timer.start();
+}
+
+void ProfilingScope::stop()
+{
+    if (!m_node)
+        return;
+    m_profiler->leaveScope(m_node, m_timer.nsecsElapsed(),
+                           allocatedBytes() - m_allocatedBytesAtStart);
+    m_node = nullptr;
+}
+
 QString elapsedTimeString(qint64 elapsedTimeInMs)
 {
     qint64 ms = elapsedTimeInMs;
@@ -40,7 +40,14 @@
 #ifndef QBS_PROFILING_H
 #define QBS_PROFILING_H
 
+#include "qbs_export.h"
+
 #include <QtCore/qelapsedtimer.h>
+#include <QtCore/qjsonobject.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
 
 QT_BEGIN_NAMESPACE
 class QString;
@@ -76,6 +83,67 @@ private:
     qint64 * const m_elapsedTime;
 };
 
+// Collects a tree of named scopes with call counts, wall time and the size of the slab-allocated
+// objects created in them.
+// Scopes with the same name and parent are merged.
+class QBS_AUTOTEST_EXPORT Profiler
+{
+public:
+    class Node;
+
+    Profiler();
+    ~Profiler();
+
+    static Profiler *current();
+
+    void setAttribute(const QString &key, const QJsonValue &value);
+    QJsonObject toJson() const;
+
+    // Makes the profiler receive the scopes entered in the current thread.
+    class QBS_AUTOTEST_EXPORT Activation
+    {
+    public:
+        Activation(Profiler *profiler);
+        ~Activation();
+
+    private:
+        Profiler * const m_previousProfiler;
+        Node * const m_previousNode;
+    };
+
+private:
+    friend class ProfilingScope;
+
+    Node *enterScope(const QString &name);
+    void leaveScope(Node *node, qint64 elapsedNs, qint64 allocatedBytes);
+
+    const std::unique_ptr<Node> m_root;
+    QJsonObject m_attributes;
+    mutable std::mutex m_mutex;
+};
+
+// Records the time spent in its lifetime under the given name, if a profiler is active
+// in the current thread. Otherwise, it does nothing.
+class QBS_AUTOTEST_EXPORT ProfilingScope
+{
+public:
+    explicit ProfilingScope(const char *name);
+    ProfilingScope(const char *category, const QString &detail);
+
+    // For details that are expensive to compute; the function is only called when profiling.
+    ProfilingScope(const char *category, const std::function<QString()> &detail);
+    ~ProfilingScope();
+    void stop();
+
+private:
+    void start(const QString &name);
+
+    Profiler * const m_profiler;
+    Profiler::Node *m_node = nullptr;
+    QElapsedTimer m_timer;
+    qint64 m_allocatedBytesAtStart = 0;
+};
+
 } // namespace Internal
 } // namespace qbs
 
@@ -70,6 +70,7 @@ void QbsProcess::start(const QString &command, const QStringList &arguments)
     }
     m_command = command;
     m_arguments = arguments;
+    m_peakMemoryUsage = 0;
     m_state = QProcess::Starting;
     if (LauncherInterface::socket()->isReady())
         doStart();
@@ -175,6 +176,7 @@ void QbsProcess::handleFinishedPacket(const QByteArray &packetData)
     m_state = QProcess::NotRunning;
     const auto packet = LauncherPacket::extractPacket<ProcessFinishedPacket>(token(), packetData);
     m_exitCode = packet.exitCode;
+    m_peakMemoryUsage = packet.peakMemoryUsage;
     m_stdout = packet.stdOut;
     m_stderr = packet.stdErr;
     m_errorString = packet.errorString;
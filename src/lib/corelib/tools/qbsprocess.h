@@ -65,6 +65,7 @@ public:
     QByteArray readAllStandardOutput();
     QByteArray readAllStandardError();
     int exitCode() const { return m_exitCode; }
+    qint64 peakMemoryUsage() const { return m_peakMemoryUsage; }
     QProcess::ProcessError error() const { return m_error; }
     QString errorString() const { return m_errorString; }
 
@@ -96,6 +97,7 @@ private:
     QProcess::ProcessError m_error = QProcess::UnknownError;
     QProcess::ProcessState m_state = QProcess::NotRunning;
     int m_exitCode = 0;
+    qint64 m_peakMemoryUsage = 0;
     int m_connectionAttempts = 0;
     bool m_socketError = false;
 };
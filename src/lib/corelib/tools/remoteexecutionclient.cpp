@@ -0,0 +1,276 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "remoteexecutionclient.h"
+
+#include "error.h"
+#include "fileinfo.h"
+#include "qbsassert.h"
+#include <logging/categories.h>
+#include <logging/translator.h>
+
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qsavefile.h>
+#include <QtCore/qtimer.h>
+#include <QtNetwork/qtcpsocket.h>
+
+namespace qbs {
+namespace Internal {
+
+RemoteExecutionClient::RemoteExecutionClient(QObject *parent)
+    : QObject(parent), m_socket(new QTcpSocket(this))
+{
+    m_packetParser.setDevice(m_socket);
+}
+
+RemoteExecutionClient::~RemoteExecutionClient()
+{
+    m_socket->disconnect();
+}
+
+void RemoteExecutionClient::connectToWorker(const QString &address, const QString &accessToken)
+{
+    const int separatorPos = address.lastIndexOf(QLatin1Char(':'));
+    bool portOk = false;
+    const quint16 port = separatorPos == -1 ? 0 : address.mid(separatorPos + 1).toUShort(&portOk);
+    if (!portOk || separatorPos == 0) {
+        throw ErrorInfo(Tr::tr("Invalid remote worker address '%1'. "
+                               "The expected format is '<host>:<port>'.").arg(address));
+    }
+    m_address = address;
+    m_socket->connectToHost(address.left(separatorPos), port);
+    if (!m_socket->waitForConnected(10000)) {
+        throw ErrorInfo(Tr::tr("Cannot connect to remote worker at '%1': %2")
+                        .arg(address, m_socket->errorString()));
+    }
+    connect(m_socket, &QTcpSocket::readyRead, this, &RemoteExecutionClient::handleSocketData);
+    connect(m_socket,
+#if (QT_VERSION < QT_VERSION_CHECK(5, 15, 0))
+            static_cast<void(QTcpSocket::*)(QAbstractSocket::SocketError)>(&QTcpSocket::error),
+#else
+            &QTcpSocket::errorOccurred,
+#endif
+            this, &RemoteExecutionClient::handleSocketError);
+    RemoteHandshakePacket handshakePacket;
+    handshakePacket.accessToken = accessToken.toUtf8();
+    sendPacket(handshakePacket);
+}
+
+quintptr RemoteExecutionClient::execute(const Request &request)
+{
+    const quintptr token = m_nextToken++;
+    PendingRequest &pendingRequest = m_pendingRequests[token];
+    RemoteExecutePacket packet(token);
+    packet.command = request.program;
+    packet.arguments = request.arguments;
+    packet.workingDir = request.workingDirectory;
+    packet.env = request.environment.toStringList();
+    packet.outputs = request.outputFilePaths;
+    if (m_socket->state() != QAbstractSocket::ConnectedState) {
+        QTimer::singleShot(0, this, [this] { // Don't call back on the caller.
+            failPendingRequests(Tr::tr("Not connected to remote worker at '%1'.")
+                                .arg(m_address));
+        });
+        return token;
+    }
+    for (const QString &filePath : request.inputFilePaths) {
+        RemoteInputFile inputFile;
+        inputFile.filePath = filePath;
+        inputFile.digest = digest(filePath);
+        if (inputFile.digest.isEmpty())
+            continue; // Not present locally either; let the command itself complain.
+        inputFile.executable = QFileInfo(filePath).isExecutable();
+        pendingRequest.filePathsByDigest.insert(inputFile.digest, filePath);
+        packet.inputs << inputFile;
+    }
+    qCDebug(lcExec) << "sending request" << token << "with" << packet.inputs.size()
+                    << "inputs to remote worker";
+    sendPacket(packet);
+    return token;
+}
+
+void RemoteExecutionClient::cancel(quintptr token)
+{
+    if (m_pendingRequests.remove(token) == 0)
+        return;
+    sendPacket(StopProcessPacket(token));
+}
+
+void RemoteExecutionClient::handleSocketData()
+{
+    try {
+        if (!m_packetParser.parse())
+            return;
+    } catch (const PacketParser::InvalidPacketSizeException &e) {
+        failPendingRequests(Tr::tr("Internal protocol error: invalid packet size %1.")
+                            .arg(e.size));
+        return;
+    }
+    switch (m_packetParser.type()) {
+    case LauncherPacketType::RemoteMissingBlobs:
+        handleMissingBlobs();
+        break;
+    case LauncherPacketType::RemoteExecutionFinished:
+        handleExecutionFinished();
+        break;
+    default:
+        failPendingRequests(Tr::tr("Internal protocol error: invalid packet type %1.")
+                            .arg(static_cast<int>(m_packetParser.type())));
+        return;
+    }
+    handleSocketData();
+}
+
+void RemoteExecutionClient::handleSocketError()
+{
+    failPendingRequests(Tr::tr("Connection to remote worker at '%1' lost: %2")
+                        .arg(m_address, m_socket->errorString()));
+}
+
+void RemoteExecutionClient::handleMissingBlobs()
+{
+    const auto it = m_pendingRequests.constFind(m_packetParser.token());
+    if (it == m_pendingRequests.constEnd())
+        return; // Canceled in the meantime.
+    const auto packet = LauncherPacket::extractPacket<RemoteMissingBlobsPacket>(
+                m_packetParser.token(), m_packetParser.packetData());
+    RemoteUploadBlobsPacket uploadPacket(packet.token);
+    for (const QByteArray &digest : packet.digests) {
+        QFile file(it->filePathsByDigest.value(digest));
+        if (file.open(QIODevice::ReadOnly))
+            uploadPacket.blobs.insert(digest, file.readAll());
+    }
+    qCDebug(lcExec) << "uploading" << uploadPacket.blobs.size() << "files for request"
+                    << packet.token;
+    sendPacket(uploadPacket);
+}
+
+void RemoteExecutionClient::handleExecutionFinished()
+{
+    const quintptr token = m_packetParser.token();
+    if (m_pendingRequests.remove(token) == 0)
+        return; // Canceled in the meantime.
+    auto packet = LauncherPacket::extractPacket<RemoteExecutionFinishedPacket>(
+                token, m_packetParser.packetData());
+    for (auto it = packet.outputs.cbegin(); it != packet.outputs.cend(); ++it) {
+        QString errorString;
+        if (!writeOutputFile(it.key(), it.value(), &errorString)
+                && packet.error == QProcess::UnknownError) {
+            packet.error = QProcess::WriteError;
+            packet.errorString = Tr::tr("Cannot write output file '%1': %2")
+                    .arg(QDir::toNativeSeparators(it.key()), errorString);
+        }
+    }
+    emit finished(token, packet);
+}
+
+// Leaves the file alone if it is already up to date, so its timestamp does not change.
+bool RemoteExecutionClient::writeOutputFile(const QString &filePath,
+                                            const RemoteOutputFile &output, QString *errorString)
+{
+    const QByteArray outputDigest = QCryptographicHash::hash(
+                output.content, QCryptographicHash::Sha256).toHex();
+    if (digest(filePath) != outputDigest) {
+        QDir().mkpath(FileInfo::path(filePath));
+        QSaveFile file(filePath);
+        if (!file.open(QIODevice::WriteOnly) || file.write(output.content) != output.content.size()
+                || !file.commit()) {
+            *errorString = file.errorString();
+            return false;
+        }
+        m_digestCache[filePath] = std::make_pair(FileInfo(filePath).lastModified(), outputDigest);
+    }
+
+    const QFile::Permissions executableFlags = QFile::ExeOwner | QFile::ExeUser
+            | QFile::ExeGroup | QFile::ExeOther;
+    const QFile::Permissions permissions = QFile::permissions(filePath);
+    const QFile::Permissions wantedPermissions = output.executable
+            ? permissions | executableFlags : permissions & ~executableFlags;
+    if (wantedPermissions != permissions && !QFile::setPermissions(filePath, wantedPermissions)) {
+        *errorString = Tr::tr("Cannot set permissions.");
+        return false;
+    }
+    return true;
+}
+
+void RemoteExecutionClient::failPendingRequests(const QString &error)
+{
+    // The connection is unusable from here on, so requests made later fail right away
+    // instead of waiting for a reply that will never come.
+    m_socket->disconnect();
+    m_socket->abort();
+    const auto tokens = m_pendingRequests.keys();
+    m_pendingRequests.clear();
+    for (const quintptr token : tokens) {
+        RemoteExecutionFinishedPacket packet(token);
+        packet.error = QProcess::Crashed;
+        packet.exitStatus = QProcess::CrashExit;
+        packet.exitCode = -1;
+        packet.errorString = error;
+        emit finished(token, packet);
+    }
+}
+
+void RemoteExecutionClient::sendPacket(const LauncherPacket &packet)
+{
+    m_socket->write(packet.serialize());
+}
+
+QByteArray RemoteExecutionClient::digest(const QString &filePath)
+{
+    const FileTime timestamp = FileInfo(filePath).lastModified();
+    if (!timestamp.isValid())
+        return {};
+    auto &cacheEntry = m_digestCache[filePath];
+    if (cacheEntry.first == timestamp && !cacheEntry.second.isEmpty())
+        return cacheEntry.second;
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(&file);
+    cacheEntry = std::make_pair(timestamp, hash.result().toHex());
+    return cacheEntry.second;
+}
+
+} // namespace Internal
+} // namespace qbs
@@ -0,0 +1,122 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_REMOTEEXECUTIONCLIENT_H
+#define QBS_REMOTEEXECUTIONCLIENT_H
+
+#include "filetime.h"
+#include "launcherpackets.h"
+#include "qttools.h"
+
+#include <QtCore/qhash.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qprocess.h>
+#include <QtCore/qstringlist.h>
+
+#include <unordered_map>
+
+QT_BEGIN_NAMESPACE
+class QTcpSocket;
+QT_END_NAMESPACE
+
+namespace qbs {
+namespace Internal {
+
+// Talks to a qbs_remoteworker instance. Requests are multiplexed over a single connection;
+// the client must live in the thread that uses it.
+class RemoteExecutionClient : public QObject
+{
+    Q_OBJECT
+public:
+    class Request
+    {
+    public:
+        QString program;
+        QStringList arguments;
+        QString workingDirectory;
+        QProcessEnvironment environment;
+        QStringList inputFilePaths;
+        QStringList outputFilePaths;
+    };
+
+    explicit RemoteExecutionClient(QObject *parent = nullptr);
+    ~RemoteExecutionClient() override;
+
+    // The address has the form "<host>:<port>". Blocks until the connection is established
+    // and throws an ErrorInfo if that fails. The worker closes the connection if the
+    // access token does not match its own.
+    void connectToWorker(const QString &address, const QString &accessToken);
+
+    // Returns a non-zero token that identifies the request in the finished() signal.
+    quintptr execute(const Request &request);
+    void cancel(quintptr token);
+
+signals:
+    // The output files have already been written when this signal is emitted.
+    void finished(quintptr token, const qbs::Internal::RemoteExecutionFinishedPacket &result);
+
+private:
+    class PendingRequest
+    {
+    public:
+        QHash<QByteArray, QString> filePathsByDigest;
+    };
+
+    void handleSocketData();
+    void handleSocketError();
+    void handleMissingBlobs();
+    void handleExecutionFinished();
+    bool writeOutputFile(const QString &filePath, const RemoteOutputFile &output,
+                         QString *errorString);
+    void failPendingRequests(const QString &error);
+    void sendPacket(const LauncherPacket &packet);
+    QByteArray digest(const QString &filePath);
+
+    QTcpSocket * const m_socket;
+    QString m_address;
+    PacketParser m_packetParser;
+    QHash<quintptr, PendingRequest> m_pendingRequests;
+    std::unordered_map<QString, std::pair<FileTime, QByteArray>> m_digestCache;
+    quintptr m_nextToken = 1;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // Include guard
@@ -92,6 +92,7 @@ public:
     bool overrideBuildGraphData;
     bool dryRun;
     bool logElapsedTime;
+    bool collectProfilingData = false;
     bool forceProbeExecution;
     bool waitLockBuildGraph;
     bool fallbackProviderEnabled = true;
@@ -510,6 +511,25 @@ void SetupProjectParameters::setLogElapsedTime(bool logElapsedTime)
     d->logElapsedTime = logElapsedTime;
 }
 
+/*!
+ * \brief Returns true iff hierarchical profiling data will be collected while setting up
+ * the project.
+ * \sa AbstractJob::profilingData()
+ */
+bool SetupProjectParameters::collectProfilingData() const
+{
+    return d->collectProfilingData;
+}
+
+/*!
+ * Controls whether to collect hierarchical profiling data while setting up the project.
+ * The default is false.
+ */
+void SetupProjectParameters::setCollectProfilingData(bool collect)
+{
+    d->collectProfilingData = collect;
+}
+
 
 /*!
  * \brief Returns true iff probes should be re-run.
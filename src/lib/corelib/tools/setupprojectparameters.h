@@ -121,6 +121,9 @@ public:
     bool logElapsedTime() const;
     void setLogElapsedTime(bool logElapsedTime);
 
+    bool collectProfilingData() const;
+    void setCollectProfilingData(bool collect);
+
     bool forceProbeExecution() const;
     void setForceProbeExecution(bool force);
 
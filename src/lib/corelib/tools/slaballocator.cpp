@@ -0,0 +1,425 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "slaballocator.h"
+
+#include <QtCore/qglobal.h>
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+#ifdef Q_OS_WIN
+#include <malloc.h>
+#endif
+
+namespace qbs {
+namespace Internal {
+
+static const std::size_t slotGranularity = alignof(std::max_align_t);
+static const std::size_t maxSlotSize = 1024;
+static const std::size_t chunkSize = 64 * 1024;
+static const std::size_t sizeClassCount = maxSlotSize / slotGranularity;
+
+namespace {
+
+class SizeClass;
+
+struct FreeSlot { FreeSlot *next; };
+
+// Chunks are aligned to their size, so the chunk of an object can be found from its address.
+// Each chunk is either owned by one thread, which allocates from it without locking, or
+// it is detached. Any thread can free objects in any chunk. A detached chunk is handed back
+// to the system as soon as its last object is gone.
+class Chunk
+{
+public:
+    // The live object count and two flags, combined so that exactly one party observes
+    // the chunk becoming empty and unowned.
+    static const std::size_t ownedFlag = 1;
+    static const std::size_t availableFlag = 2; // In the size class's list of available chunks.
+    static const std::size_t countUnit = 4;
+
+    static Chunk *create(SizeClass *sizeClass, std::size_t slotSize);
+    static Chunk *fromObject(void *p)
+    {
+        return reinterpret_cast<Chunk *>(reinterpret_cast<quintptr>(p) & ~quintptr(chunkSize - 1));
+    }
+    void destroy();
+
+    static std::size_t liveCount(std::size_t state) { return state / countUnit; }
+    std::size_t liveCount() const { return liveCount(state.load()); }
+
+    // Owner only.
+    void *allocate()
+    {
+        if (!localFreeList)
+            localFreeList = remoteFreeList.exchange(nullptr);
+        void *slot = nullptr;
+        if (localFreeList) {
+            slot = localFreeList;
+            localFreeList = localFreeList->next;
+        } else if (remainder + slotSize <= end) {
+            // Fresh chunks are carved up lazily, so they do not need to get touched
+            // as a whole up front.
+            slot = remainder;
+            remainder += slotSize;
+        } else {
+            return nullptr;
+        }
+        state.fetch_add(countUnit);
+        return slot;
+    }
+
+    bool hasFreeSlots() const
+    {
+        return localFreeList || remoteFreeList.load() || remainder + slotSize <= end;
+    }
+
+    SizeClass *sizeClass = nullptr;
+    std::atomic_size_t state{0};
+    std::atomic<FreeSlot *> remoteFreeList{nullptr};
+
+    // Only accessed by the owner, or with the size class mutex locked while there is none.
+    FreeSlot *localFreeList = nullptr;
+    char *remainder = nullptr;
+    char *end = nullptr;
+    std::size_t slotSize = 0;
+
+    // Protected by the size class mutex.
+    Chunk *previous = nullptr;
+    Chunk *next = nullptr;
+    Chunk *previousAvailable = nullptr;
+    Chunk *nextAvailable = nullptr;
+};
+
+static const std::size_t chunkHeaderSize
+        = (sizeof(Chunk) + slotGranularity - 1) / slotGranularity * slotGranularity;
+
+class SizeClass
+{
+public:
+    void setSlotSize(std::size_t slotSize) { m_slotSize = slotSize; }
+
+    // Returns a chunk with free slots that is owned by the calling thread.
+    Chunk *acquireChunk()
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        for (Chunk *chunk = m_firstAvailable; chunk; chunk = chunk->nextAvailable) {
+            // A chunk without objects is about to be destroyed by whoever freed the last one.
+            std::size_t state = chunk->state.load();
+            while (Chunk::liveCount(state) > 0) {
+                if (chunk->state.compare_exchange_weak(
+                            state, (state | Chunk::ownedFlag) & ~Chunk::availableFlag)) {
+                    unlinkAvailable(chunk);
+                    return chunk;
+                }
+            }
+        }
+        Chunk * const chunk = Chunk::create(this, m_slotSize);
+        chunk->state = Chunk::ownedFlag;
+        chunk->next = m_firstChunk;
+        if (m_firstChunk)
+            m_firstChunk->previous = chunk;
+        m_firstChunk = chunk;
+        return chunk;
+    }
+
+    // Called by the owner when it has no more use for the chunk.
+    void releaseChunk(Chunk *chunk)
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        const bool hasFreeSlots = chunk->hasFreeSlots();
+        if (Chunk::liveCount(chunk->state.fetch_and(~Chunk::ownedFlag)) == 0) {
+            destroyChunk(chunk);
+        } else if (hasFreeSlots) {
+            // If the last object goes away in the meantime, the chunk gets destroyed
+            // once we release the lock.
+            chunk->state.fetch_or(Chunk::availableFlag);
+            linkAvailable(chunk);
+        }
+    }
+
+    // Called by a thread that freed an object in a detached chunk that was full before.
+    // The object has not been subtracted from the live count yet, so the chunk stays alive.
+    void makeAvailable(Chunk *chunk)
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        std::size_t state = chunk->state.load();
+        while (!(state & (Chunk::ownedFlag | Chunk::availableFlag))) {
+            if (chunk->state.compare_exchange_weak(state, state | Chunk::availableFlag)) {
+                linkAvailable(chunk);
+                return;
+            }
+        }
+    }
+
+    // Called by the thread that freed the last object in a detached chunk.
+    void destroyEmptyChunk(Chunk *chunk)
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        destroyChunk(chunk);
+    }
+
+    void addStatistics(SlabAllocatorStatistics &stats)
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        for (const Chunk *chunk = m_firstChunk; chunk; chunk = chunk->next) {
+            stats.liveObjectCount += chunk->liveCount();
+            ++stats.chunkCount;
+        }
+    }
+
+private:
+    void linkAvailable(Chunk *chunk)
+    {
+        chunk->previousAvailable = nullptr;
+        chunk->nextAvailable = m_firstAvailable;
+        if (m_firstAvailable)
+            m_firstAvailable->previousAvailable = chunk;
+        m_firstAvailable = chunk;
+    }
+
+    void unlinkAvailable(Chunk *chunk)
+    {
+        if (chunk->previousAvailable)
+            chunk->previousAvailable->nextAvailable = chunk->nextAvailable;
+        else
+            m_firstAvailable = chunk->nextAvailable;
+        if (chunk->nextAvailable)
+            chunk->nextAvailable->previousAvailable = chunk->previousAvailable;
+        chunk->previousAvailable = chunk->nextAvailable = nullptr;
+    }
+
+    void destroyChunk(Chunk *chunk)
+    {
+        if (chunk->state.load() & Chunk::availableFlag)
+            unlinkAvailable(chunk);
+        if (chunk->previous)
+            chunk->previous->next = chunk->next;
+        else
+            m_firstChunk = chunk->next;
+        if (chunk->next)
+            chunk->next->previous = chunk->previous;
+        chunk->destroy();
+    }
+
+    std::mutex m_mutex;
+    Chunk *m_firstChunk = nullptr;
+    Chunk *m_firstAvailable = nullptr;
+    std::size_t m_slotSize = 0;
+};
+
+Chunk *Chunk::create(SizeClass *sizeClass, std::size_t slotSize)
+{
+#ifdef Q_OS_WIN
+    void * const memory = _aligned_malloc(chunkSize, chunkSize);
+#else
+    void *memory = nullptr;
+    if (posix_memalign(&memory, chunkSize, chunkSize) != 0)
+        memory = nullptr;
+#endif
+    if (!memory)
+        throw std::bad_alloc();
+    const auto chunk = new (memory) Chunk;
+    chunk->sizeClass = sizeClass;
+    chunk->slotSize = slotSize;
+    chunk->remainder = static_cast<char *>(memory) + chunkHeaderSize;
+    chunk->end = static_cast<char *>(memory) + chunkSize;
+    return chunk;
+}
+
+void Chunk::destroy()
+{
+    this->~Chunk();
+#ifdef Q_OS_WIN
+    _aligned_free(this);
+#else
+    std::free(this);
+#endif
+}
+
+// The chunks a thread currently allocates from, one per size class.
+class ThreadCache
+{
+public:
+    ~ThreadCache()
+    {
+        for (Chunk * const chunk : m_chunks) {
+            if (chunk)
+                chunk->sizeClass->releaseChunk(chunk);
+        }
+    }
+
+    void *allocate(SizeClass &sizeClass, std::size_t index)
+    {
+        Chunk *&chunk = m_chunks.at(index);
+        if (chunk) {
+            if (void * const slot = chunk->allocate())
+                return slot;
+            sizeClass.releaseChunk(chunk);
+        }
+        chunk = sizeClass.acquireChunk();
+        return chunk->allocate();
+    }
+
+private:
+    std::array<Chunk *, sizeClassCount> m_chunks{};
+};
+
+class SlabAllocator
+{
+public:
+    static SlabAllocator &instance()
+    {
+        // Deliberately leaked, as objects might get destroyed during static destruction.
+        static SlabAllocator * const allocator = new SlabAllocator;
+        return *allocator;
+    }
+
+    bool isEnabled() const { return m_enabled; }
+
+    void *allocate(std::size_t size);
+    static void deallocate(void *p);
+
+    std::array<SizeClass, sizeClassCount> &sizeClasses() { return m_sizeClasses; }
+
+    static bool isSlabSize(std::size_t size) { return size > 0 && size <= maxSlotSize; }
+
+private:
+    SlabAllocator() : m_enabled(!qEnvironmentVariableIsSet("QBS_NO_SLAB_ALLOCATION"))
+    {
+        for (std::size_t i = 0; i < m_sizeClasses.size(); ++i)
+            m_sizeClasses[i].setSlotSize((i + 1) * slotGranularity);
+    }
+
+    static std::size_t sizeClassIndex(std::size_t size)
+    {
+        return (size + slotGranularity - 1) / slotGranularity - 1;
+    }
+
+    const bool m_enabled;
+    std::array<SizeClass, sizeClassCount> m_sizeClasses;
+
+    // For allocations of threads whose cache has already been destroyed.
+    ThreadCache m_fallbackCache;
+    std::mutex m_fallbackMutex;
+};
+
+static thread_local bool threadCacheDestroyed = false;
+
+class ThreadCacheHolder
+{
+public:
+    ~ThreadCacheHolder() { threadCacheDestroyed = true; }
+    ThreadCache cache;
+};
+
+void *SlabAllocator::allocate(std::size_t size)
+{
+    const std::size_t index = sizeClassIndex(size);
+    SizeClass &sizeClass = m_sizeClasses.at(index);
+    if (Q_UNLIKELY(threadCacheDestroyed)) {
+        std::lock_guard<std::mutex> locker(m_fallbackMutex);
+        return m_fallbackCache.allocate(sizeClass, index);
+    }
+    static thread_local ThreadCacheHolder holder;
+    return holder.cache.allocate(sizeClass, index);
+}
+
+void SlabAllocator::deallocate(void *p)
+{
+    Chunk * const chunk = Chunk::fromObject(p);
+    const auto slot = static_cast<FreeSlot *>(p);
+    slot->next = chunk->remoteFreeList.load();
+    while (!chunk->remoteFreeList.compare_exchange_weak(slot->next, slot))
+        ;
+
+    // A full chunk that nobody allocates from anymore becomes available again.
+    const std::size_t state = chunk->state.load();
+    if (!(state & (Chunk::ownedFlag | Chunk::availableFlag)) && Chunk::liveCount(state) > 1)
+        chunk->sizeClass->makeAvailable(chunk);
+
+    const std::size_t oldState = chunk->state.fetch_sub(Chunk::countUnit);
+    if (Chunk::liveCount(oldState) == 1 && !(oldState & Chunk::ownedFlag))
+        chunk->sizeClass->destroyEmptyChunk(chunk);
+}
+
+} // namespace
+
+static thread_local std::size_t bytesAllocatedInThread = 0;
+
+void *slabAllocate(std::size_t size)
+{
+    bytesAllocatedInThread += size;
+    SlabAllocator &allocator = SlabAllocator::instance();
+    if (!allocator.isEnabled() || !SlabAllocator::isSlabSize(size))
+        return ::operator new(size);
+    return allocator.allocate(size);
+}
+
+void slabDeallocate(void *p, std::size_t size)
+{
+    if (!p)
+        return;
+    SlabAllocator &allocator = SlabAllocator::instance();
+    if (!allocator.isEnabled() || !SlabAllocator::isSlabSize(size)) {
+        ::operator delete(p);
+        return;
+    }
+    SlabAllocator::deallocate(p);
+}
+
+std::size_t slabBytesAllocatedInCurrentThread()
+{
+    return bytesAllocatedInThread;
+}
+
+SlabAllocatorStatistics SlabAllocatorStatistics::current()
+{
+    SlabAllocatorStatistics stats;
+    for (SizeClass &sizeClass : SlabAllocator::instance().sizeClasses())
+        sizeClass.addStatistics(stats);
+    return stats;
+}
+
+} // namespace Internal
+} // namespace qbs
@@ -0,0 +1,106 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_SLABALLOCATOR_H
+#define QBS_SLABALLOCATOR_H
+
+#include "qbs_export.h"
+
+#include <cstddef>
+#include <memory>
+
+namespace qbs {
+namespace Internal {
+
+// Allocation of small, frequently created objects such as build graph nodes from large
+// per-size chunks. Every thread allocates from chunks of its own without locking, and
+// objects can be freed from any thread. A chunk is handed back to the system as soon as
+// it is empty and no thread allocates from it, so tearing down a build graph results in
+// a handful of deallocations only.
+// Set QBS_NO_SLAB_ALLOCATION in the environment to fall back to the global allocator,
+// e.g. when hunting memory errors with valgrind or ASan.
+QBS_AUTOTEST_EXPORT void *slabAllocate(std::size_t size);
+QBS_AUTOTEST_EXPORT void slabDeallocate(void *p, std::size_t size);
+
+// The total size of the objects allocated via slabAllocate() in the calling thread so far.
+// Cheap enough to be queried around arbitrary code regions.
+QBS_AUTOTEST_EXPORT std::size_t slabBytesAllocatedInCurrentThread();
+
+class QBS_AUTOTEST_EXPORT SlabAllocatorStatistics
+{
+public:
+    static SlabAllocatorStatistics current();
+
+    std::size_t liveObjectCount = 0;
+    std::size_t chunkCount = 0;
+};
+
+// Derive from this class to have the objects of the derived type allocated via slabAllocate().
+class QBS_AUTOTEST_EXPORT SlabAllocated
+{
+public:
+    static void *operator new(std::size_t size) { return slabAllocate(size); }
+    static void operator delete(void *p, std::size_t size) { slabDeallocate(p, size); }
+};
+
+// For putting shared pointer control blocks into the slabs as well.
+template<typename T> class SlabStdAllocator
+{
+public:
+    using value_type = T;
+
+    SlabStdAllocator() = default;
+    template<typename U> SlabStdAllocator(const SlabStdAllocator<U> &) {}
+
+    T *allocate(std::size_t n) { return static_cast<T *>(slabAllocate(n * sizeof(T))); }
+    void deallocate(T *p, std::size_t n) { slabDeallocate(p, n * sizeof(T)); }
+
+    template<typename U> bool operator==(const SlabStdAllocator<U> &) const { return true; }
+    template<typename U> bool operator!=(const SlabStdAllocator<U> &) const { return false; }
+};
+
+template<typename T> std::shared_ptr<T> makeSlabShared(T *object)
+{
+    return std::shared_ptr<T>(object, std::default_delete<T>(), SlabStdAllocator<T>());
+}
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_SLABALLOCATOR_H
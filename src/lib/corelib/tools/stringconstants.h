@@ -68,6 +68,7 @@ public:
     QBS_STRING_CONSTANT(auxiliaryInputsProperty, "auxiliaryInputs")
     QBS_STRING_CONSTANT(baseNameProperty, "baseName")
     QBS_STRING_CONSTANT(baseProfileProperty, "baseProfile")
+    QBS_STRING_CONSTANT(batchPrepareProperty, "batchPrepare")
     QBS_STRING_CONSTANT(buildDirectoryProperty, "buildDirectory")
     QBS_STRING_CONSTANT(buildDirectoryKey, "build-directory")
     QBS_STRING_CONSTANT(builtByDefaultProperty, "builtByDefault")
@@ -177,6 +178,7 @@ public:
     QBS_STRING_CONSTANT(productsOverridePrefix, "products.")
 
     QBS_STRING_CONSTANT(baseVar, "base")
+    QBS_STRING_CONSTANT(batchVar, "batch")
     static const QString &explicitlyDependsOnVar() { return explicitlyDependsOn(); }
     QBS_STRING_CONSTANT(inputVar, "input")
     static const QString &inputsVar() { return inputs(); }
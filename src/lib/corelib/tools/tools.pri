@@ -36,6 +36,7 @@ HEADERS += \
     $$PWD/settings.h \
     $$PWD/settingsmodel.h \
     $$PWD/settingsrepresentation.h \
+    $$PWD/pathatom.h \
     $$PWD/pathutils.h \
     $$PWD/preferences.h \
     $$PWD/profile.h \
@@ -47,7 +48,9 @@ HEADERS += \
     $$PWD/projectgeneratormanager.h \
     $$PWD/qbspluginmanager.h \
     $$PWD/qbsprocess.h \
+    $$PWD/remoteexecutionclient.h \
     $$PWD/shellutils.h \
+    $$PWD/slaballocator.h \
     $$PWD/stlutils.h \
     $$PWD/stringutils.h \
     $$PWD/toolchains.h \
@@ -85,6 +88,7 @@ SOURCES += \
     $$PWD/launcherpackets.cpp \
     $$PWD/launchersocket.cpp \
     $$PWD/msvcinfo.cpp \
+    $$PWD/pathatom.cpp \
     $$PWD/persistence.cpp \
     $$PWD/scannerpluginmanager.cpp \
     $$PWD/scripttools.cpp \
@@ -100,7 +104,9 @@ SOURCES += \
     $$PWD/projectgeneratormanager.cpp \
     $$PWD/qbspluginmanager.cpp \
     $$PWD/qbsprocess.cpp \
+    $$PWD/remoteexecutionclient.cpp \
     $$PWD/shellutils.cpp \
+    $$PWD/slaballocator.cpp \
     $$PWD/buildoptions.cpp \
     $$PWD/installoptions.cpp \
     $$PWD/cleanoptions.cpp \
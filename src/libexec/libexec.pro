@@ -1,3 +1,3 @@
 TEMPLATE = subdirs
 
-SUBDIRS += qbs_processlauncher
+SUBDIRS += qbs_processlauncher qbs_remoteworker
@@ -42,13 +42,79 @@
 #include "launcherlogging.h"
 
 #include <QtCore/qcoreapplication.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
 #include <QtCore/qprocess.h>
 #include <QtCore/qtimer.h>
 #include <QtNetwork/qlocalsocket.h>
 
+#include <algorithm>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
 namespace qbs {
 namespace Internal {
 
+#ifdef Q_OS_LINUX
+// Sums up the peak resident set sizes of a process and all of its descendants, because
+// the memory hungry part of a compiler or linker invocation often is a sub-process.
+static qint64 peakResidentSetSizeOfProcessTree(qint64 pid)
+{
+    qint64 size = 0;
+    QFile status(QStringLiteral("/proc/%1/status").arg(pid));
+    if (!status.open(QIODevice::ReadOnly))
+        return size;
+    const QList<QByteArray> lines = status.readAll().split('\n');
+    for (const QByteArray &line : lines) {
+        if (line.startsWith("VmHWM:")) {
+            size = line.mid(6).trimmed().split(' ').constFirst().toLongLong() * 1024;
+            break;
+        }
+    }
+    const QDir taskDir(QStringLiteral("/proc/%1/task").arg(pid));
+    const QStringList threadIds = taskDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString &threadId : threadIds) {
+        QFile children(taskDir.filePath(threadId + QLatin1String("/children")));
+        if (!children.open(QIODevice::ReadOnly))
+            continue;
+        const QList<QByteArray> childIds = children.readAll().split(' ');
+        for (const QByteArray &childId : childIds) {
+            bool ok;
+            const qint64 childPid = childId.trimmed().toLongLong(&ok);
+            if (ok)
+                size += peakResidentSetSizeOfProcessTree(childPid);
+        }
+    }
+    return size;
+}
+#endif
+
+// The system only tells us the peak resident set size of the largest child process that has
+// been reaped so far, including its descendants. If that value grew with the process that
+// just finished, it is the peak of that process. Otherwise, we know nothing new.
+static qint64 peakResidentSetSizeOfLastReapedChild()
+{
+#ifdef Q_OS_UNIX
+    static qint64 largestPeak = 0;
+    struct rusage usage;
+    if (getrusage(RUSAGE_CHILDREN, &usage) != 0)
+        return 0;
+#ifdef Q_OS_MACOS
+    const qint64 peak = usage.ru_maxrss;
+#else
+    const qint64 peak = qint64(usage.ru_maxrss) * 1024;
+#endif
+    if (peak <= largestPeak)
+        return 0;
+    largestPeak = peak;
+    return peak;
+#else
+    return 0;
+#endif
+}
+
 class Process : public QProcess
 {
     Q_OBJECT
@@ -58,6 +124,22 @@ public:
     {
         m_stopTimer->setSingleShot(true);
         connect(m_stopTimer, &QTimer::timeout, this, &Process::cancel);
+        connect(this, &QProcess::started, this, [this] { m_peakMemoryUsage = 0; });
+#ifdef Q_OS_LINUX
+        // Sample often at first, so that short-lived processes are seen as well.
+        // The peak is recorded by the kernel, so every sample covers the time before it.
+        m_memorySampleTimer = new QTimer(this);
+        m_memorySampleTimer->setSingleShot(true);
+        connect(m_memorySampleTimer, &QTimer::timeout, this, [this] {
+            addMemorySample(peakResidentSetSizeOfProcessTree(processId()));
+            m_memorySampleTimer->start(std::min(m_memorySampleTimer->interval() * 2, 200));
+        });
+        connect(this, &QProcess::started, this, [this] { m_memorySampleTimer->start(10); });
+        connect(this, &QProcess::stateChanged, this, [this](QProcess::ProcessState state) {
+            if (state == QProcess::NotRunning)
+                m_memorySampleTimer->stop();
+        });
+#endif
     }
 
     void cancel()
@@ -88,12 +170,19 @@ public:
 
     quintptr token() const { return m_token; }
 
+    // The highest memory usage seen while the process was running, including the final
+    // sample taken when it finished.
+    qint64 peakMemoryUsage() const { return m_peakMemoryUsage; }
+    void addMemorySample(qint64 usage) { m_peakMemoryUsage = std::max(m_peakMemoryUsage, usage); }
+
 signals:
     void failedToStop();
 
 private:
     const quintptr m_token;
     QTimer * const m_stopTimer;
+    QTimer *m_memorySampleTimer = nullptr;
+    qint64 m_peakMemoryUsage = 0;
     enum class StopState { Inactive, Terminating, Killing } m_stopState = StopState::Inactive;
 };
 
@@ -196,11 +285,13 @@ void LauncherSocketHandler::handleProcessFinished()
 {
     Process * proc = senderProcess();
     proc->stopStopProcedure();
+    proc->addMemorySample(peakResidentSetSizeOfLastReapedChild());
     ProcessFinishedPacket packet(proc->token());
     packet.error = proc->error();
     packet.errorString = proc->errorString();
     packet.exitCode = proc->exitCode();
     packet.exitStatus = proc->exitStatus();
+    packet.peakMemoryUsage = proc->peakMemoryUsage();
     packet.stdErr = proc->readAllStandardError();
     packet.stdOut = proc->readAllStandardOutput();
     sendPacket(packet);
@@ -0,0 +1,19 @@
+include(../libexec.pri)
+
+TARGET = qbs_remoteworker
+CONFIG += console c++17
+CONFIG -= app_bundle
+QT = core network
+
+TOOLS_DIR = $$PWD/../../lib/corelib/tools
+
+INCLUDEPATH += $$TOOLS_DIR
+
+HEADERS += \
+    remoteworker.h \
+    $$TOOLS_DIR/launcherpackets.h
+
+SOURCES += \
+    remoteworker-main.cpp \
+    remoteworker.cpp \
+    $$TOOLS_DIR/launcherpackets.cpp
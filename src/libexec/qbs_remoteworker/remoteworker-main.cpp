@@ -0,0 +1,98 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "remoteworker.h"
+
+#include <QtCore/qcommandlineparser.h>
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qrandom.h>
+
+#include <cstdio>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral(
+            "Runs commands on behalf of qbs builds started with --remote-worker.\n"
+            "This is a reference implementation that listens on localhost only.\n"
+            "Clients must present the access token given in the QBS_REMOTE_WORKER_TOKEN\n"
+            "environment variable. If that variable is not set, a random token is generated."));
+    parser.addHelpOption();
+    const QCommandLineOption portOption(QStringLiteral("port"),
+            QStringLiteral("The port to listen on. By default, a free port is chosen."),
+            QStringLiteral("port"), QStringLiteral("0"));
+    const QCommandLineOption cacheDirOption(QStringLiteral("cache-dir"),
+            QStringLiteral("The directory in which received files are stored."),
+            QStringLiteral("directory"),
+            QDir::tempPath() + QStringLiteral("/qbs-remoteworker-cache"));
+    parser.addOption(portOption);
+    parser.addOption(cacheDirOption);
+    parser.process(app);
+
+    bool portOk;
+    const quint16 port = parser.value(portOption).toUShort(&portOk);
+    if (!portOk) {
+        std::fprintf(stderr, "Invalid port '%s'.\n", qPrintable(parser.value(portOption)));
+        return 1;
+    }
+
+    QByteArray accessToken = qgetenv("QBS_REMOTE_WORKER_TOKEN");
+    const bool printAccessToken = accessToken.isEmpty();
+    if (printAccessToken) {
+        QByteArray randomBytes(16, Qt::Uninitialized);
+        QRandomGenerator::system()->fillRange(reinterpret_cast<quint32 *>(randomBytes.data()),
+                                              randomBytes.size() / int(sizeof(quint32)));
+        accessToken = randomBytes.toHex();
+    }
+
+    qbs::Internal::RemoteWorker worker(parser.value(cacheDirOption), accessToken);
+    if (!worker.listen(port)) {
+        std::fprintf(stderr, "Cannot listen on port %u: %s\n", unsigned(port),
+                     qPrintable(worker.errorString()));
+        return 1;
+    }
+    std::printf("qbs_remoteworker listening on port %u\n", unsigned(worker.port()));
+    if (printAccessToken)
+        std::printf("access token: %s\n", accessToken.constData());
+    std::fflush(stdout);
+    return app.exec();
+}
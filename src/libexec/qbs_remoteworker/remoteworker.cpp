@@ -0,0 +1,413 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "remoteworker.h"
+
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qloggingcategory.h>
+#include <QtCore/qprocess.h>
+#include <QtNetwork/qtcpserver.h>
+#include <QtNetwork/qtcpsocket.h>
+
+namespace qbs {
+namespace Internal {
+
+Q_LOGGING_CATEGORY(remoteWorkerLog, "qbs.remoteworker", QtWarningMsg)
+
+static QByteArray computeDigest(const QByteArray &content)
+{
+    return QCryptographicHash::hash(content, QCryptographicHash::Sha256).toHex();
+}
+
+BlobStore::BlobStore(QString directory) : m_directory(std::move(directory))
+{
+    QDir().mkpath(m_directory);
+}
+
+bool BlobStore::contains(const QByteArray &digest) const
+{
+    return QFileInfo::exists(blobFilePath(digest));
+}
+
+bool BlobStore::insert(const QByteArray &digest, const QByteArray &content,
+                       QString *errorString)
+{
+    if (computeDigest(content) != digest) {
+        *errorString = QStringLiteral("Content of uploaded file does not match digest %1.")
+                .arg(QString::fromLatin1(digest));
+        return false;
+    }
+    if (contains(digest))
+        return true;
+
+    // Write to a temporary file first, so a concurrent reader never sees a partial blob.
+    const QString filePath = blobFilePath(digest);
+    QFile file(filePath + QStringLiteral(".tmp"));
+    if (!file.open(QIODevice::WriteOnly) || file.write(content) != content.size()) {
+        *errorString = QStringLiteral("Cannot write '%1': %2")
+                .arg(file.fileName(), file.errorString());
+        return false;
+    }
+    file.close();
+    if (!file.rename(filePath) && !contains(digest)) {
+        *errorString = QStringLiteral("Cannot rename '%1': %2")
+                .arg(file.fileName(), file.errorString());
+        return false;
+    }
+    return true;
+}
+
+QString BlobStore::blobFilePath(const QByteArray &digest) const
+{
+    return m_directory + QLatin1Char('/') + QString::fromLatin1(digest);
+}
+
+QByteArray BlobStore::digestOfFile(const QString &filePath)
+{
+    const QFileInfo fileInfo(filePath);
+    if (!fileInfo.isFile())
+        return {};
+    CachedDigest &entry = m_fileDigests[filePath];
+    const qint64 lastModified = fileInfo.lastModified().toMSecsSinceEpoch();
+    if (entry.lastModified == lastModified && entry.size == fileInfo.size())
+        return entry.digest;
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(&file);
+    entry.lastModified = lastModified;
+    entry.size = fileInfo.size();
+    entry.digest = hash.result().toHex();
+    return entry.digest;
+}
+
+
+RemoteWorkerConnection::RemoteWorkerConnection(QTcpSocket *socket, BlobStore &blobStore,
+                                               const QByteArray &accessToken, QObject *parent)
+    : QObject(parent), m_socket(socket), m_blobStore(blobStore), m_accessToken(accessToken)
+{
+    m_socket->setParent(this);
+    m_packetParser.setDevice(m_socket);
+    connect(m_socket, &QTcpSocket::readyRead, this, &RemoteWorkerConnection::handleSocketData);
+    connect(m_socket, &QTcpSocket::disconnected,
+            this, &RemoteWorkerConnection::handleSocketClosed);
+}
+
+RemoteWorkerConnection::~RemoteWorkerConnection()
+{
+    m_socket->disconnect();
+    for (const auto &job : m_jobs) {
+        if (job.second->process) {
+            job.second->process->disconnect();
+            job.second->process->kill();
+            job.second->process->waitForFinished(1000);
+        }
+    }
+}
+
+void RemoteWorkerConnection::handleSocketData()
+{
+    try {
+        if (!m_packetParser.parse())
+            return;
+    } catch (const PacketParser::InvalidPacketSizeException &e) {
+        qCWarning(remoteWorkerLog) << "Internal protocol error: invalid packet size" << e.size;
+        m_socket->abort();
+        return;
+    }
+
+    // Nothing the client sends is acted upon before it has proven that it knows the token.
+    // Otherwise, anyone who can connect could make us write files anywhere we have access to.
+    if (!m_authenticated) {
+        handleHandshakePacket();
+        if (!m_authenticated)
+            return;
+        handleSocketData();
+        return;
+    }
+
+    switch (m_packetParser.type()) {
+    case LauncherPacketType::RemoteExecute:
+        handleExecutePacket();
+        break;
+    case LauncherPacketType::RemoteUploadBlobs:
+        handleUploadPacket();
+        break;
+    case LauncherPacketType::StopProcess:
+        handleStopPacket();
+        break;
+    default:
+        qCWarning(remoteWorkerLog) << "Internal protocol error: invalid packet type"
+                                   << static_cast<int>(m_packetParser.type());
+        m_socket->abort();
+        return;
+    }
+    handleSocketData();
+}
+
+void RemoteWorkerConnection::handleSocketClosed()
+{
+    qCDebug(remoteWorkerLog) << "client disconnected";
+    deleteLater();
+}
+
+void RemoteWorkerConnection::handleHandshakePacket()
+{
+    if (m_packetParser.type() == LauncherPacketType::RemoteHandshake) {
+        const auto packet = LauncherPacket::extractPacket<RemoteHandshakePacket>(
+                    m_packetParser.token(), m_packetParser.packetData());
+        m_authenticated = packet.accessToken == m_accessToken;
+    }
+    if (!m_authenticated) {
+        qCWarning(remoteWorkerLog) << "Rejecting client that did not present the access token.";
+        m_socket->abort();
+    }
+}
+
+void RemoteWorkerConnection::handleExecutePacket()
+{
+    const quintptr token = m_packetParser.token();
+    auto job = std::make_unique<Job>(LauncherPacket::extractPacket<RemoteExecutePacket>(
+                                         token, m_packetParser.packetData()));
+    const QList<QByteArray> missing = missingBlobs(job->request);
+    m_jobs[token] = std::move(job);
+    if (missing.empty()) {
+        runJob(token);
+        return;
+    }
+    qCDebug(remoteWorkerLog) << "requesting" << missing.size() << "files for job" << token;
+    RemoteMissingBlobsPacket packet(token);
+    packet.digests = missing;
+    sendPacket(packet);
+}
+
+void RemoteWorkerConnection::handleUploadPacket()
+{
+    const quintptr token = m_packetParser.token();
+    const auto packet = LauncherPacket::extractPacket<RemoteUploadBlobsPacket>(
+                token, m_packetParser.packetData());
+    if (m_jobs.find(token) == m_jobs.end())
+        return;
+    for (auto it = packet.blobs.cbegin(); it != packet.blobs.cend(); ++it) {
+        QString errorString;
+        if (!m_blobStore.insert(it.key(), it.value(), &errorString)) {
+            failJob(token, errorString);
+            return;
+        }
+    }
+    if (!missingBlobs(m_jobs.at(token)->request).empty()) {
+        failJob(token, QStringLiteral("Client did not provide all input files."));
+        return;
+    }
+    runJob(token);
+}
+
+void RemoteWorkerConnection::handleStopPacket()
+{
+    const auto it = m_jobs.find(m_packetParser.token());
+    if (it == m_jobs.end())
+        return;
+    if (QProcess * const process = it->second->process) {
+        process->disconnect();
+        process->kill();
+        process->deleteLater();
+    }
+    m_jobs.erase(it);
+}
+
+void RemoteWorkerConnection::handleProcessFinished(quintptr token)
+{
+    const auto it = m_jobs.find(token);
+    if (it == m_jobs.end())
+        return;
+    QProcess * const process = it->second->process;
+    RemoteExecutionFinishedPacket packet(token);
+    packet.error = process->error();
+    packet.errorString = process->errorString();
+    packet.exitCode = process->exitCode();
+    packet.exitStatus = process->exitStatus();
+    packet.stdOut = process->readAllStandardOutput();
+    packet.stdErr = process->readAllStandardError();
+    if (packet.exitStatus == QProcess::NormalExit) {
+        // A "process error" that happened before the process finished (e.g. a failed write
+        // to stdin) is of no interest here.
+        packet.error = QProcess::UnknownError;
+    }
+    for (const QString &outputFilePath : it->second->request.outputs) {
+        QFile file(outputFilePath);
+        if (!file.open(QIODevice::ReadOnly))
+            continue;
+        RemoteOutputFile output;
+        output.content = file.readAll();
+        output.executable = QFileInfo(outputFilePath).isExecutable();
+        packet.outputs.insert(outputFilePath, output);
+    }
+    finishJob(packet);
+}
+
+void RemoteWorkerConnection::handleProcessError(quintptr token)
+{
+    const auto it = m_jobs.find(token);
+    if (it == m_jobs.end() || it->second->process->error() != QProcess::FailedToStart)
+        return;
+    RemoteExecutionFinishedPacket packet(token);
+    packet.error = QProcess::FailedToStart;
+    packet.errorString = it->second->process->errorString();
+    packet.exitCode = -1;
+    finishJob(packet);
+}
+
+QList<QByteArray> RemoteWorkerConnection::missingBlobs(const RemoteExecutePacket &request)
+{
+    QList<QByteArray> missing;
+    for (const RemoteInputFile &input : request.inputs) {
+        if (m_blobStore.digestOfFile(input.filePath) != input.digest
+                && !m_blobStore.contains(input.digest)) {
+            missing << input.digest;
+        }
+    }
+    return missing;
+}
+
+void RemoteWorkerConnection::runJob(quintptr token)
+{
+    Job &job = *m_jobs.at(token);
+
+    // Materialize the inputs at the same locations they have on the client.
+    for (const RemoteInputFile &input : job.request.inputs) {
+        if (m_blobStore.digestOfFile(input.filePath) == input.digest)
+            continue;
+        QDir().mkpath(QFileInfo(input.filePath).absolutePath());
+        QFile::remove(input.filePath);
+        if (!QFile::copy(m_blobStore.blobFilePath(input.digest), input.filePath)) {
+            failJob(token, QStringLiteral("Cannot create input file '%1'.")
+                    .arg(input.filePath));
+            return;
+        }
+        QFile::Permissions permissions = QFile::ReadOwner | QFile::WriteOwner
+                | QFile::ReadGroup | QFile::ReadOther;
+        if (input.executable)
+            permissions |= QFile::ExeOwner | QFile::ExeGroup | QFile::ExeOther;
+        QFile::setPermissions(input.filePath, permissions);
+    }
+    if (!job.request.workingDir.isEmpty())
+        QDir().mkpath(job.request.workingDir);
+    for (const QString &outputFilePath : job.request.outputs)
+        QDir().mkpath(QFileInfo(outputFilePath).absolutePath());
+
+    qCDebug(remoteWorkerLog) << "running" << job.request.command << job.request.arguments;
+    job.process = new QProcess(this);
+    job.process->setEnvironment(job.request.env);
+    job.process->setWorkingDirectory(job.request.workingDir);
+    connect(job.process, &QProcess::errorOccurred, this, [this, token] {
+        handleProcessError(token);
+    });
+    connect(job.process,
+            static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+            this, [this, token] { handleProcessFinished(token); });
+    job.process->start(job.request.command, job.request.arguments);
+}
+
+void RemoteWorkerConnection::finishJob(RemoteExecutionFinishedPacket &packet)
+{
+    const auto it = m_jobs.find(packet.token);
+    if (it == m_jobs.end())
+        return;
+    if (QProcess * const process = it->second->process) {
+        process->disconnect();
+        process->deleteLater();
+    }
+    m_jobs.erase(it);
+    sendPacket(packet);
+}
+
+void RemoteWorkerConnection::failJob(quintptr token, const QString &errorString)
+{
+    qCWarning(remoteWorkerLog) << "job" << token << "failed:" << errorString;
+    RemoteExecutionFinishedPacket packet(token);
+    packet.error = QProcess::FailedToStart;
+    packet.errorString = errorString;
+    packet.exitCode = -1;
+    finishJob(packet);
+}
+
+void RemoteWorkerConnection::sendPacket(const LauncherPacket &packet)
+{
+    m_socket->write(packet.serialize());
+}
+
+
+RemoteWorker::RemoteWorker(QString cacheDir, QByteArray accessToken, QObject *parent)
+    : QObject(parent)
+    , m_server(new QTcpServer(this))
+    , m_blobStore(std::move(cacheDir))
+    , m_accessToken(std::move(accessToken))
+{
+    connect(m_server, &QTcpServer::newConnection, this, &RemoteWorker::handleNewConnection);
+}
+
+bool RemoteWorker::listen(quint16 port)
+{
+    return m_server->listen(QHostAddress::LocalHost, port);
+}
+
+quint16 RemoteWorker::port() const
+{
+    return m_server->serverPort();
+}
+
+QString RemoteWorker::errorString() const
+{
+    return m_server->errorString();
+}
+
+void RemoteWorker::handleNewConnection()
+{
+    while (QTcpSocket * const socket = m_server->nextPendingConnection()) {
+        qCDebug(remoteWorkerLog) << "new client connection";
+        new RemoteWorkerConnection(socket, m_blobStore, m_accessToken, this);
+    }
+}
+
+} // namespace Internal
+} // namespace qbs
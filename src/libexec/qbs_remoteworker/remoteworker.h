@@ -0,0 +1,149 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_REMOTEWORKER_H
+#define QBS_REMOTEWORKER_H
+
+#include <launcherpackets.h>
+
+#include <QtCore/qhash.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qstring.h>
+
+#include <memory>
+#include <unordered_map>
+
+QT_BEGIN_NAMESPACE
+class QProcess;
+class QTcpServer;
+class QTcpSocket;
+QT_END_NAMESPACE
+
+namespace qbs {
+namespace Internal {
+
+// Content-addressed storage for the input files received from clients.
+class BlobStore
+{
+public:
+    explicit BlobStore(QString directory);
+
+    bool contains(const QByteArray &digest) const;
+    bool insert(const QByteArray &digest, const QByteArray &content, QString *errorString);
+    QString blobFilePath(const QByteArray &digest) const;
+
+    // Returns an empty digest if the file does not exist.
+    QByteArray digestOfFile(const QString &filePath);
+
+private:
+    class CachedDigest
+    {
+    public:
+        qint64 lastModified = 0;
+        qint64 size = -1;
+        QByteArray digest;
+    };
+
+    const QString m_directory;
+    QHash<QString, CachedDigest> m_fileDigests;
+};
+
+class RemoteWorkerConnection : public QObject
+{
+    Q_OBJECT
+public:
+    RemoteWorkerConnection(QTcpSocket *socket, BlobStore &blobStore,
+                           const QByteArray &accessToken, QObject *parent = nullptr);
+    ~RemoteWorkerConnection() override;
+
+private:
+    class Job
+    {
+    public:
+        Job(RemoteExecutePacket request) : request(std::move(request)) { }
+
+        const RemoteExecutePacket request;
+        QProcess *process = nullptr;
+    };
+
+    void handleSocketData();
+    void handleSocketClosed();
+    void handleHandshakePacket();
+    void handleExecutePacket();
+    void handleUploadPacket();
+    void handleStopPacket();
+    void handleProcessFinished(quintptr token);
+    void handleProcessError(quintptr token);
+
+    QList<QByteArray> missingBlobs(const RemoteExecutePacket &request);
+    void runJob(quintptr token);
+    void finishJob(RemoteExecutionFinishedPacket &packet);
+    void failJob(quintptr token, const QString &errorString);
+    void sendPacket(const LauncherPacket &packet);
+
+    QTcpSocket * const m_socket;
+    BlobStore &m_blobStore;
+    const QByteArray m_accessToken;
+    bool m_authenticated = false;
+    PacketParser m_packetParser;
+    std::unordered_map<quintptr, std::unique_ptr<Job>> m_jobs;
+};
+
+class RemoteWorker : public QObject
+{
+    Q_OBJECT
+public:
+    RemoteWorker(QString cacheDir, QByteArray accessToken, QObject *parent = nullptr);
+
+    bool listen(quint16 port);
+    quint16 port() const;
+    QString errorString() const;
+
+private:
+    void handleNewConnection();
+
+    QTcpServer * const m_server;
+    BlobStore m_blobStore;
+    const QByteArray m_accessToken;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // Include guard
@@ -5,6 +5,7 @@ DEFINES += CPLUSPLUS_NO_PARSER
 QT = core
 
 HEADERS += CPlusPlusForwardDeclarations.h Lexer.h Token.h ../scanner.h \
-           cpp_global.h
+           cpp_global.h cppscanengines.h moduledeclarationparser.h preprocessorconditions.h
 SOURCES += Lexer.cpp Token.cpp \
-    cppscanner.cpp
+    cppscanner.cpp directivescanengine.cpp lexerscanengine.cpp moduledeclarationparser.cpp \
+    preprocessorconditions.cpp
@@ -0,0 +1,93 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_CPPSCANENGINES_H
+#define QBS_CPPSCANENGINES_H
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qlist.h>
+
+class PreprocessorConditions;
+
+struct ScanResult
+{
+    char *fileName = nullptr;
+    int size = 0;
+    int flags = 0;
+};
+
+struct CppScanResults
+{
+    QList<ScanResult> includedFiles;
+
+    // C++20 modules. Partitions are named "module:partition".
+    QList<QByteArray> importedModules;
+    QByteArray moduleName; // From the module declaration, if there is one.
+
+    bool hasQObjectMacro = false;
+    bool hasPluginMetaDataMacro = false;
+};
+
+struct CppScanParameters
+{
+    bool scanForFileTags = false;
+    bool scanForDependencies = false;
+
+    // If only file tags are requested, scanning stops at the first Q_OBJECT-like macro.
+    // Unless this is set, it goes on until a Q_PLUGIN_METADATA has been seen as well.
+    bool stopAtQObjectMacro = false;
+
+    // Also look for C++20 module and import declarations. Only used along with
+    // scanForDependencies.
+    bool scanForModules = false;
+
+    // If set, only includes that are reachable according to these conditions are reported.
+    PreprocessorConditions *conditions = nullptr;
+};
+
+// Both engines find the same #include/#import directives, module declarations and moc macros
+// in [begin, end).
+// The lexer based one tokenizes the whole file; the directive scanner jumps from one
+// potentially relevant character to the next and only tokenizes around those.
+void scanCppFileWithLexer(char *begin, char *end, const CppScanParameters &parameters,
+                          CppScanResults &results);
+void scanCppFileDirectives(char *begin, char *end, const CppScanParameters &parameters,
+                           CppScanResults &results);
+
+#endif // QBS_CPPSCANENGINES_H
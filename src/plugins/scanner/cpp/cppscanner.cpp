@@ -39,9 +39,8 @@
 
 #include "../scanner.h"
 #include "cpp_global.h"
-#include "Lexer.h"
-
-using namespace CPlusPlus;
+#include "cppscanengines.h"
+#include "preprocessorconditions.h"
 
 #include <tools/qbspluginmanager.h>
 #include <tools/scannerpluginmanager.h>
@@ -62,13 +61,7 @@ using namespace CPlusPlus;
 
 #include <cstring>
 #include <memory>
-
-struct ScanResult
-{
-    char *fileName = nullptr;
-    int size = 0;
-    int flags = 0;
-};
+#include <vector>
 
 struct Opaq
 {
@@ -85,8 +78,6 @@ struct Opaq
 #endif
           fileContent(nullptr),
           fileType(FT_UNKNOWN),
-          hasQObjectMacro(false),
-          hasPluginMetaDataMacro(false),
           currentResultIndex(0)
     {}
 
@@ -111,97 +102,14 @@ struct Opaq
     QString fileName;
     char *fileContent;
     FileType fileType;
-    QList<ScanResult> includedFiles;
-    bool hasQObjectMacro;
-    bool hasPluginMetaDataMacro;
+    CppScanResults results;
     int currentResultIndex;
+    std::unique_ptr<PreprocessorConditions> conditions;
+    std::vector<const char *> conditionMacros;
 };
 
-class TokenComparator
-{
-    const char * const m_fileContent;
-public:
-    TokenComparator(const char *fileContent)
-        : m_fileContent(fileContent)
-    {
-    }
-
-    bool equals(const Token &tk, const QLatin1String &literal) const
-    {
-        return static_cast<int>(tk.length()) == literal.size()
-                && memcmp(m_fileContent + tk.begin(), literal.data(), literal.size()) == 0;
-    }
-};
-
-static void scanCppFile(void *opaq, CPlusPlus::Lexer &yylex, bool scanForFileTags,
-                        bool scanForDependencies)
-{
-    const QLatin1String includeLiteral("include");
-    const QLatin1String importLiteral("import");
-    const QLatin1String defineLiteral("define");
-    const QLatin1String qobjectLiteral("Q_OBJECT");
-    const QLatin1String qgadgetLiteral("Q_GADGET");
-    const QLatin1String qnamespaceLiteral("Q_NAMESPACE");
-    const QLatin1String pluginMetaDataLiteral("Q_PLUGIN_METADATA");
-    const auto opaque = static_cast<Opaq *>(opaq);
-    const TokenComparator tc(opaque->fileContent);
-    Token tk;
-    Token oldTk;
-    ScanResult scanResult;
-
-    yylex(&tk);
-
-    while (tk.isNot(T_EOF_SYMBOL)) {
-        if (tk.newline() && tk.is(T_POUND)) {
-            yylex(&tk);
-
-            if (scanForDependencies && !tk.newline() && tk.is(T_IDENTIFIER)) {
-                if (tc.equals(tk, includeLiteral) || tc.equals(tk, importLiteral))
-                {
-                    yylex.setScanAngleStringLiteralTokens(true);
-                    yylex(&tk);
-                    yylex.setScanAngleStringLiteralTokens(false);
-
-                    if (!tk.newline() && (tk.is(T_STRING_LITERAL) || tk.is(T_ANGLE_STRING_LITERAL))) {
-                        scanResult.size = int(tk.length() - 2);
-                        if (tk.is(T_STRING_LITERAL))
-                            scanResult.flags = SC_LOCAL_INCLUDE_FLAG;
-                        else
-                            scanResult.flags = SC_GLOBAL_INCLUDE_FLAG;
-                        scanResult.fileName = opaque->fileContent + tk.begin() + 1;
-                        opaque->includedFiles.push_back(scanResult);
-                    }
-                }
-            }
-        } else if (tk.is(T_IDENTIFIER)) {
-            if (scanForFileTags) {
-                if (oldTk.is(T_IDENTIFIER) && tc.equals(oldTk, defineLiteral)) {
-                    // Someone was clever and redefined Q_OBJECT or Q_PLUGIN_METADATA.
-                    // Example: iplugin.h in Qt Creator.
-                } else {
-                    if (tc.equals(tk, qobjectLiteral) || tc.equals(tk, qgadgetLiteral)  ||
-                        tc.equals(tk, qnamespaceLiteral))
-                    {
-                        opaque->hasQObjectMacro = true;
-                    } else if (tc.equals(tk, pluginMetaDataLiteral))
-                    {
-                        opaque->hasPluginMetaDataMacro = true;
-                    }
-                    if (!scanForDependencies && opaque->hasQObjectMacro
-                        && (opaque->hasPluginMetaDataMacro
-                            || opaque->fileType == Opaq::FT_CPP
-                            || opaque->fileType == Opaq::FT_OBJCPP))
-                        break;
-                }
-            }
-
-        }
-        oldTk = tk;
-        yylex(&tk);
-    }
-}
-
-static void *openScanner(const unsigned short *filePath, const char *fileTags, int flags)
+static void *openScannerHelper(const unsigned short *filePath, const char *fileTags, int flags,
+                               const char *macros)
 {
     std::unique_ptr<Opaq> opaque(new Opaq);
     opaque->fileName = QString::fromUtf16(filePath);
@@ -258,11 +166,33 @@ static void *openScanner(const unsigned short *filePath, const char *fileTags, i
         mapl -= 3;
     }
 
-    CPlusPlus::Lexer lex(opaque->fileContent, opaque->fileContent + mapl);
-    scanCppFile(opaque.get(), lex, flags & ScanForFileTagsFlag, flags & ScanForDependenciesFlag);
+    CppScanParameters parameters;
+    parameters.scanForFileTags = flags & ScanForFileTagsFlag;
+    parameters.scanForDependencies = flags & ScanForDependenciesFlag;
+    parameters.scanForModules = flags & ScanForModulesFlag;
+    parameters.stopAtQObjectMacro = opaque->fileType == Opaq::FT_CPP
+            || opaque->fileType == Opaq::FT_OBJCPP;
+    if (macros && parameters.scanForDependencies) {
+        opaque->conditions = std::make_unique<PreprocessorConditions>(macros);
+        parameters.conditions = opaque->conditions.get();
+    }
+    static const bool useLexer = qEnvironmentVariableIsSet("QBS_CPP_SCANNER_USE_LEXER");
+    const auto scan = useLexer ? &scanCppFileWithLexer : &scanCppFileDirectives;
+    scan(opaque->fileContent, opaque->fileContent + mapl, parameters, opaque->results);
     return opaque.release();
 }
 
+static void *openScanner(const unsigned short *filePath, const char *fileTags, int flags)
+{
+    return openScannerHelper(filePath, fileTags, flags, nullptr);
+}
+
+static void *openScannerConditional(const unsigned short *filePath, const char *fileTags,
+                                    int flags, const char *macros)
+{
+    return openScannerHelper(filePath, fileTags, flags, macros);
+}
+
 static void closeScanner(void *ptr)
 {
     const auto opaque = static_cast<Opaq *>(ptr);
@@ -272,13 +202,22 @@ static void closeScanner(void *ptr)
 static const char *next(void *opaq, int *size, int *flags)
 {
     const auto opaque = static_cast<Opaq*>(opaq);
-    if (opaque->currentResultIndex < opaque->includedFiles.size()) {
-        const ScanResult &result = opaque->includedFiles.at(opaque->currentResultIndex);
+    const int includeCount = opaque->results.includedFiles.size();
+    if (opaque->currentResultIndex < includeCount) {
+        const ScanResult &result = opaque->results.includedFiles.at(opaque->currentResultIndex);
         ++opaque->currentResultIndex;
         *size = result.size;
         *flags = result.flags;
         return result.fileName;
     }
+    const int moduleIndex = opaque->currentResultIndex - includeCount;
+    if (moduleIndex < opaque->results.importedModules.size()) {
+        const QByteArray &moduleName = opaque->results.importedModules.at(moduleIndex);
+        ++opaque->currentResultIndex;
+        *size = moduleName.size();
+        *flags = SC_MODULE_IMPORT_FLAG;
+        return moduleName.constData();
+    }
     *size = 0;
     *flags = 0;
     return nullptr;
@@ -292,14 +231,14 @@ static const char **additionalFileTags(void *opaq, int *size)
     static const char *thMocPluginCpp[] = { "moc_cpp_plugin" };
 
     const auto opaque = static_cast<const Opaq*>(opaq);
-    if (opaque->hasQObjectMacro) {
+    if (opaque->results.hasQObjectMacro) {
         *size = 1;
         switch (opaque->fileType) {
         case Opaq::FT_CPP:
         case Opaq::FT_OBJCPP:
-            return opaque->hasPluginMetaDataMacro ? thMocPluginCpp : thMocCpp;
+            return opaque->results.hasPluginMetaDataMacro ? thMocPluginCpp : thMocCpp;
         case Opaq::FT_HPP:
-            return opaque->hasPluginMetaDataMacro ? thMocPluginHpp : thMocHpp;
+            return opaque->results.hasPluginMetaDataMacro ? thMocPluginHpp : thMocHpp;
         default:
             break;
         }
@@ -308,6 +247,18 @@ static const char **additionalFileTags(void *opaq, int *size)
     return nullptr;
 }
 
+static const char **conditionMacros(void *opaq, int *size)
+{
+    const auto opaque = static_cast<Opaq *>(opaq);
+    opaque->conditionMacros.clear();
+    if (opaque->conditions) {
+        for (const QByteArray &macro : opaque->conditions->queriedMacros())
+            opaque->conditionMacros.push_back(macro.constData());
+    }
+    *size = int(opaque->conditionMacros.size());
+    return opaque->conditionMacros.data();
+}
+
 ScannerPlugin includeScanner =
 {
     "include_scanner",
@@ -316,7 +267,9 @@ ScannerPlugin includeScanner =
     closeScanner,
     next,
     additionalFileTags,
-    ScannerUsesCppIncludePaths | ScannerRecursiveDependencies
+    ScannerUsesCppIncludePaths | ScannerRecursiveDependencies,
+    openScannerConditional,
+    conditionMacros
 };
 
 ScannerPlugin *cppScanners[] = { &includeScanner, nullptr };
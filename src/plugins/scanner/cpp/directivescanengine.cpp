@@ -0,0 +1,546 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "cppscanengines.h"
+#include "moduledeclarationparser.h"
+#include "preprocessorconditions.h"
+
+#include "../scanner.h"
+
+#include <QtCore/qalgorithms.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define QBS_CPPSCANNER_USE_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+#define QBS_CPPSCANNER_USE_NEON
+#include <arm_neon.h>
+#endif
+
+#include <cstring>
+
+// This engine must report exactly what scanCppFileWithLexer() reports, including the quirks
+// of CPlusPlus::Lexer, e.g. that L"..." literals do not end at a line break, that a NUL byte
+// ends the file and that numbers swallow a sign following an exponent character.
+//
+// Only few characters can change the lexer's state or start a token we are interested in:
+// quotes, slashes, backslashes and '#', plus 'Q' if we look for moc macros and line breaks
+// if we look for module declarations, which start at the beginning of a line. The stretches
+// in between consist of whitespace, identifiers, numbers and operators only, so they are
+// skipped with a vectorized search. Tokenization happens only at the interesting characters,
+// with a lexer that mimics CPlusPlus::Lexer::scan_helper().
+
+namespace {
+
+enum class TokenKind { EndOfFile, Pound, Identifier, StringLiteral, AngleStringLiteral, Other };
+
+struct DirectiveToken
+{
+    TokenKind kind = TokenKind::Other;
+    const char *begin = nullptr;
+    const char *end = nullptr;
+    bool newline = false;
+
+    bool equals(const char *literal, int length) const
+    {
+        return end - begin == length && std::memcmp(begin, literal, length) == 0;
+    }
+};
+
+template<int N> bool tokenEquals(const DirectiveToken &tk, const char (&literal)[N])
+{
+    return tk.equals(literal, N - 1);
+}
+
+// Like the lexer's use of <cctype> in the C locale.
+inline bool isSpace(char c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+inline bool isAlpha(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+inline bool isAlnum(char c)
+{
+    return isAlpha(c) || isDigit(c);
+}
+
+inline bool isIdentifierChar(char c)
+{
+    return isAlnum(c) || c == '_' || c == '$';
+}
+
+// Characters that can be part of a number without being able to start one, which means
+// that an identifier character following them might belong to a number token.
+inline bool mayContinueNumber(char c)
+{
+    return c == '.' || c == '+' || c == '-';
+}
+
+template<bool WithQ, bool WithNewline> inline bool isCandidate(char c)
+{
+    return c == '"' || c == '\'' || c == '/' || c == '\\' || c == '#' || (WithQ && c == 'Q')
+            || (WithNewline && c == '\n');
+}
+
+template<bool WithQ, bool WithNewline> const char *findCandidate(const char *p, const char *end)
+{
+#if defined(QBS_CPPSCANNER_USE_SSE2)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i apostrophe = _mm_set1_epi8('\'');
+    const __m128i slash = _mm_set1_epi8('/');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i pound = _mm_set1_epi8('#');
+    const __m128i q = _mm_set1_epi8('Q');
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; end - p >= 16; p += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        __m128i hits = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, apostrophe)),
+                    _mm_or_si128(_mm_cmpeq_epi8(chunk, slash), _mm_cmpeq_epi8(chunk, backslash)));
+        hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, pound));
+        if (WithQ)
+            hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, q));
+        if (WithNewline)
+            hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, newline));
+        if (const int mask = _mm_movemask_epi8(hits))
+            return p + qCountTrailingZeroBits(uint(mask));
+    }
+#elif defined(QBS_CPPSCANNER_USE_NEON)
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t apostrophe = vdupq_n_u8('\'');
+    const uint8x16_t slash = vdupq_n_u8('/');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    const uint8x16_t pound = vdupq_n_u8('#');
+    const uint8x16_t q = vdupq_n_u8('Q');
+    const uint8x16_t newline = vdupq_n_u8('\n');
+    for (; end - p >= 16; p += 16) {
+        const uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t *>(p));
+        uint8x16_t hits = vorrq_u8(
+                    vorrq_u8(vceqq_u8(chunk, quote), vceqq_u8(chunk, apostrophe)),
+                    vorrq_u8(vceqq_u8(chunk, slash), vceqq_u8(chunk, backslash)));
+        hits = vorrq_u8(hits, vceqq_u8(chunk, pound));
+        if (WithQ)
+            hits = vorrq_u8(hits, vceqq_u8(chunk, q));
+        if (WithNewline)
+            hits = vorrq_u8(hits, vceqq_u8(chunk, newline));
+        if (vmaxvq_u8(hits))
+            break; // The scalar loop below finds the exact position.
+    }
+#endif
+    while (p < end && !isCandidate<WithQ, WithNewline>(*p))
+        ++p;
+    return p;
+}
+
+const char *findChar(const char *p, const char *end, char c)
+{
+    const auto found = static_cast<const char *>(std::memchr(p, c, end - p));
+    return found ? found : end;
+}
+
+ModuleDeclarationParser::TokenKind moduleTokenKind(const DirectiveToken &tk)
+{
+    switch (tk.kind) {
+    case TokenKind::Identifier:
+        return ModuleDeclarationParser::TokenKind::Identifier;
+    case TokenKind::StringLiteral:
+        return ModuleDeclarationParser::TokenKind::StringLiteral;
+    case TokenKind::AngleStringLiteral:
+        return ModuleDeclarationParser::TokenKind::AngleStringLiteral;
+    case TokenKind::Other:
+        if (tk.end - tk.begin == 1) {
+            switch (*tk.begin) {
+            case '.':
+                return ModuleDeclarationParser::TokenKind::Period;
+            case ':':
+                return ModuleDeclarationParser::TokenKind::Colon;
+            case ';':
+                return ModuleDeclarationParser::TokenKind::Semicolon;
+            }
+        }
+        break;
+    default:
+        break;
+    }
+    return ModuleDeclarationParser::TokenKind::Other;
+}
+
+class DirectiveScanner
+{
+public:
+    DirectiveScanner(char *begin, char *end, const CppScanParameters &parameters,
+                     CppScanResults &results)
+        : m_begin(begin)
+        , m_end(end)
+        , m_pos(begin)
+        , m_parameters(parameters)
+        , m_results(results)
+    {
+        // The lexer treats a NUL byte like the end of the file.
+        m_end = findChar(m_begin, m_end, '\0');
+    }
+
+    void scan()
+    {
+        const bool withModules = m_parameters.scanForModules && m_parameters.scanForDependencies;
+        if (m_parameters.scanForFileTags)
+            withModules ? scan<true, true>() : scan<true, false>();
+        else
+            withModules ? scan<false, true>() : scan<false, false>();
+    }
+
+private:
+    template<bool WithQ, bool WithModules> void scan();
+    template<bool WithQ, bool WithModules> const char *skipUninterestingTokens();
+    bool settle(const char *segmentBegin, const char *segmentEnd, bool withDefine);
+    DirectiveToken lex(bool angleStringLiterals);
+    const char *skipQuoted(const char *p, char quote, bool stopAtNewline) const;
+    const char *skipBlockComment(const char *p) const;
+    const char *skipNumber(const char *p) const;
+
+    char * const m_begin;
+    const char *m_end;
+    const char *m_pos;
+    const CppScanParameters &m_parameters;
+    CppScanResults &m_results;
+
+    // The lexer starts with a virtual line break, so the first token is at a line start.
+    bool m_pendingNewline = true;
+    bool m_previousIsDefine = false;
+};
+
+template<bool WithQ, bool WithModules> void DirectiveScanner::scan()
+{
+    ModuleDeclarationParser moduleParser(m_begin, m_parameters, m_results);
+
+    // The first line does not start with a line break, so its first token must not be skipped.
+    if (!WithModules)
+        m_pos = skipUninterestingTokens<WithQ, WithModules>();
+    DirectiveToken tk = lex(false);
+    while (tk.kind != TokenKind::EndOfFile) {
+        if (WithModules && tk.newline && tk.kind == TokenKind::Identifier
+                && moduleParser.start(tk.begin, tk.end)) {
+            DirectiveToken previous;
+            do {
+                previous = tk;
+                tk = lex(moduleParser.expectsHeaderName());
+            } while (moduleParser.addToken(moduleTokenKind(tk), tk.begin, tk.end, tk.newline));
+            m_previousIsDefine = previous.kind == TokenKind::Identifier
+                    && tokenEquals(previous, "define");
+            continue; // The current token is either the final ';' or not part of the declaration.
+        }
+        if (tk.newline && tk.kind == TokenKind::Pound) {
+            tk = lex(false);
+            if (m_parameters.scanForDependencies && !tk.newline
+                    && tk.kind == TokenKind::Identifier
+                    && (tokenEquals(tk, "include") || tokenEquals(tk, "import"))) {
+                tk = lex(true);
+                if (!tk.newline && (tk.kind == TokenKind::StringLiteral
+                                    || tk.kind == TokenKind::AngleStringLiteral)
+                        && (!m_parameters.conditions || m_parameters.conditions->isReachable())) {
+                    ScanResult scanResult;
+                    scanResult.size = int(tk.end - tk.begin - 2);
+                    scanResult.flags = tk.kind == TokenKind::StringLiteral
+                            ? SC_LOCAL_INCLUDE_FLAG : SC_GLOBAL_INCLUDE_FLAG;
+                    scanResult.fileName = m_begin + (tk.begin - m_begin) + 1;
+                    m_results.includedFiles.push_back(scanResult);
+                }
+            } else if (m_parameters.conditions && m_parameters.scanForDependencies
+                       && !tk.newline && tk.kind == TokenKind::Identifier) {
+                m_parameters.conditions->handleDirective(tk.begin, tk.end, m_end);
+            }
+        } else if (WithQ && tk.kind == TokenKind::Identifier && !m_previousIsDefine) {
+            if (tokenEquals(tk, "Q_OBJECT") || tokenEquals(tk, "Q_GADGET")
+                    || tokenEquals(tk, "Q_NAMESPACE")) {
+                m_results.hasQObjectMacro = true;
+            } else if (tokenEquals(tk, "Q_PLUGIN_METADATA")) {
+                m_results.hasPluginMetaDataMacro = true;
+            }
+            if (!m_parameters.scanForDependencies && m_results.hasQObjectMacro
+                    && (m_results.hasPluginMetaDataMacro || m_parameters.stopAtQObjectMacro)) {
+                break;
+            }
+        }
+        m_previousIsDefine = tk.kind == TokenKind::Identifier && tokenEquals(tk, "define");
+        m_pos = skipUninterestingTokens<WithQ, WithModules>();
+        tk = lex(false);
+    }
+}
+
+// Returns the position at which lexing has to continue. m_pos must be at a token boundary.
+// Everything skipped consists of tokens the scan loop would ignore, but the state it keeps
+// about the previous token has to be updated accordingly.
+template<bool WithQ, bool WithModules> const char *DirectiveScanner::skipUninterestingTokens()
+{
+    const char * const segmentBegin = m_pos;
+    const char *p = m_pos;
+    while (true) {
+        const char * const candidate = findCandidate<WithQ, WithModules>(p, m_end);
+        if (candidate == m_end)
+            return settle(segmentBegin, m_end, WithQ) ? m_end : segmentBegin;
+        const char c = *candidate;
+        if (WithModules && c == '\n') {
+            // Only a line starting with "export", "import" or "module" is of interest.
+            const char *lineStart = candidate + 1;
+            while (lineStart < m_end && *lineStart != '\n' && isSpace(*lineStart))
+                ++lineStart;
+            if (lineStart == m_end || (*lineStart != 'e' && *lineStart != 'i'
+                                       && *lineStart != 'm')) {
+                p = lineStart;
+                continue;
+            }
+        }
+        if (WithQ && c == 'Q' && candidate > segmentBegin) {
+            const char previous = candidate[-1];
+            if (isIdentifierChar(previous)) {
+                p = candidate + 1; // Inside some identifier or number.
+                continue;
+            }
+            if (mayContinueNumber(previous))
+                return segmentBegin; // Let the lexer find out, one token at a time.
+        }
+        if ((c == '"' || c == '\'') && candidate > segmentBegin && candidate[-1] == 'L') {
+            const char * const prefix = candidate - 1;
+            if (prefix == segmentBegin)
+                return prefix;
+            const char previous = prefix[-1];
+            if (isIdentifierChar(previous))
+                return settle(segmentBegin, candidate, WithQ) ? candidate : segmentBegin;
+            if (mayContinueNumber(previous))
+                return segmentBegin;
+            return settle(segmentBegin, prefix, WithQ) ? prefix : segmentBegin;
+        }
+        return settle(segmentBegin, candidate, WithQ) ? candidate : segmentBegin;
+    }
+}
+
+// Accounts for the tokens in [segmentBegin, segmentEnd), which contains no comments,
+// literals, line continuations or '#'. Returns false if the last token cannot be determined
+// without lexing, in which case nothing is changed.
+bool DirectiveScanner::settle(const char *segmentBegin, const char *segmentEnd,
+                              bool withDefine)
+{
+    const char *tokenEnd = segmentEnd;
+    while (tokenEnd > segmentBegin && isSpace(tokenEnd[-1]))
+        --tokenEnd;
+    const bool sawLineBreak = findChar(tokenEnd, segmentEnd, '\n') != segmentEnd;
+    if (tokenEnd == segmentBegin) {
+        m_pendingNewline = m_pendingNewline || sawLineBreak;
+        return true;
+    }
+
+    bool previousIsDefine = false;
+    if (withDefine && isIdentifierChar(tokenEnd[-1])) {
+        const char *tokenBegin = tokenEnd - 1;
+        while (tokenBegin > segmentBegin && isIdentifierChar(tokenBegin[-1]))
+            --tokenBegin;
+        static const char defineLiteral[] = "define";
+        if (tokenEnd - tokenBegin == int(sizeof defineLiteral) - 1
+                && std::memcmp(tokenBegin, defineLiteral, sizeof defineLiteral - 1) == 0) {
+            if (tokenBegin > segmentBegin && mayContinueNumber(tokenBegin[-1]))
+                return false;
+            previousIsDefine = true;
+        }
+    }
+    m_previousIsDefine = previousIsDefine;
+    m_pendingNewline = sawLineBreak;
+    return true;
+}
+
+DirectiveToken DirectiveScanner::lex(bool angleStringLiterals)
+{
+    bool newline = m_pendingNewline;
+    m_pendingNewline = false;
+    const char *p = m_pos;
+    DirectiveToken tk;
+
+again:
+    while (p < m_end && isSpace(*p)) {
+        if (*p == '\n')
+            newline = true;
+        ++p;
+    }
+    tk.begin = p;
+    if (p == m_end) {
+        tk.kind = TokenKind::EndOfFile;
+        tk.end = p;
+        tk.newline = newline;
+        m_pos = p;
+        return tk;
+    }
+
+    const char ch = *p++;
+    switch (ch) {
+    case '\\':
+        while (p < m_end && *p != '\n' && isSpace(*p))
+            ++p;
+        if (p < m_end && *p == '\n') {
+            newline = false;
+            ++p;
+        }
+        goto again;
+    case '"':
+    case '\'':
+        p = skipQuoted(p, ch, true);
+        if (ch == '"')
+            tk.kind = TokenKind::StringLiteral;
+        break;
+    case '#':
+        if (p < m_end && *p == '#')
+            ++p;
+        else
+            tk.kind = TokenKind::Pound;
+        break;
+    case '.':
+        if (p < m_end) {
+            if (*p == '*') {
+                ++p;
+            } else if (*p == '.') {
+                ++p;
+                if (p < m_end && *p == '.')
+                    ++p;
+            } else if (isDigit(*p)) {
+                p = skipNumber(p);
+            }
+        }
+        break;
+    case '/':
+        if (p < m_end && *p == '/') {
+            p = findChar(p, m_end, '\n');
+            goto again;
+        }
+        if (p < m_end && *p == '*') {
+            p = skipBlockComment(p + 1);
+            goto again;
+        }
+        break;
+    case '<':
+        if (angleStringLiterals) {
+            p = findChar(p, m_end, '>');
+            if (p < m_end)
+                ++p;
+            tk.kind = TokenKind::AngleStringLiteral;
+        }
+        break;
+    default:
+        if (ch == 'L' && p < m_end && (*p == '"' || *p == '\'')) {
+            const char quote = *p;
+            p = skipQuoted(p + 1, quote, false);
+        } else if (isAlpha(ch) || ch == '_' || ch == '$') {
+            while (p < m_end && isIdentifierChar(*p))
+                ++p;
+            tk.kind = TokenKind::Identifier;
+        } else if (isDigit(ch)) {
+            p = skipNumber(p);
+        }
+        break;
+    }
+
+    tk.end = p;
+    tk.newline = newline;
+    m_pos = p;
+    return tk;
+}
+
+const char *DirectiveScanner::skipQuoted(const char *p, char quote, bool stopAtNewline) const
+{
+    while (p < m_end && *p != quote) {
+        if (*p == '\n' && stopAtNewline)
+            return p;
+        if (*p == '\\' && ++p == m_end)
+            break;
+        ++p;
+    }
+    if (p < m_end)
+        ++p;
+    return p;
+}
+
+// p points behind the opening "/*".
+const char *DirectiveScanner::skipBlockComment(const char *p) const
+{
+    if (p < m_end && (*p == '*' || *p == '!')) {
+        const char c = *p++;
+        if (c == '*' && p < m_end && *p == '/')
+            return p + 1;
+        if (p < m_end && *p == '<')
+            ++p;
+    }
+    while (true) {
+        p = findChar(p, m_end, '*');
+        if (p == m_end)
+            return p;
+        if (++p < m_end && *p == '/')
+            return p + 1;
+    }
+}
+
+// p points behind the first character of the number.
+const char *DirectiveScanner::skipNumber(const char *p) const
+{
+    while (p < m_end) {
+        if (*p == 'e' || *p == 'E') {
+            ++p;
+            if (p < m_end && (*p == '-' || *p == '+'))
+                ++p;
+        } else if (isAlnum(*p) || *p == '.') {
+            ++p;
+        } else {
+            break;
+        }
+    }
+    return p;
+}
+
+} // namespace
+
+void scanCppFileDirectives(char *begin, char *end, const CppScanParameters &parameters,
+                           CppScanResults &results)
+{
+    DirectiveScanner(begin, end, parameters, results).scan();
+}
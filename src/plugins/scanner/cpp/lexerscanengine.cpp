@@ -0,0 +1,172 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "cppscanengines.h"
+
+#include "../scanner.h"
+#include "Lexer.h"
+#include "moduledeclarationparser.h"
+#include "preprocessorconditions.h"
+
+#include <QtCore/qstring.h>
+
+#include <cstring>
+
+using namespace CPlusPlus;
+
+namespace {
+class TokenComparator
+{
+    const char * const m_fileContent;
+public:
+    TokenComparator(const char *fileContent)
+        : m_fileContent(fileContent)
+    {
+    }
+
+    bool equals(const Token &tk, const QLatin1String &literal) const
+    {
+        return static_cast<int>(tk.length()) == literal.size()
+                && memcmp(m_fileContent + tk.begin(), literal.data(), literal.size()) == 0;
+    }
+};
+
+ModuleDeclarationParser::TokenKind moduleTokenKind(const Token &tk)
+{
+    switch (tk.kind()) {
+    case T_IDENTIFIER:
+        return ModuleDeclarationParser::TokenKind::Identifier;
+    case T_DOT:
+        return ModuleDeclarationParser::TokenKind::Period;
+    case T_COLON:
+        return ModuleDeclarationParser::TokenKind::Colon;
+    case T_SEMICOLON:
+        return ModuleDeclarationParser::TokenKind::Semicolon;
+    case T_STRING_LITERAL:
+        return ModuleDeclarationParser::TokenKind::StringLiteral;
+    case T_ANGLE_STRING_LITERAL:
+        return ModuleDeclarationParser::TokenKind::AngleStringLiteral;
+    default:
+        return ModuleDeclarationParser::TokenKind::Other;
+    }
+}
+} // namespace
+
+void scanCppFileWithLexer(char *begin, char *end, const CppScanParameters &parameters,
+                          CppScanResults &results)
+{
+    const QLatin1String includeLiteral("include");
+    const QLatin1String importLiteral("import");
+    const QLatin1String defineLiteral("define");
+    const QLatin1String qobjectLiteral("Q_OBJECT");
+    const QLatin1String qgadgetLiteral("Q_GADGET");
+    const QLatin1String qnamespaceLiteral("Q_NAMESPACE");
+    const QLatin1String pluginMetaDataLiteral("Q_PLUGIN_METADATA");
+    const TokenComparator tc(begin);
+    CPlusPlus::Lexer yylex(begin, end);
+    Token tk;
+    Token oldTk;
+    ScanResult scanResult;
+    const bool scanForModules = parameters.scanForModules && parameters.scanForDependencies;
+    ModuleDeclarationParser moduleParser(begin, parameters, results);
+
+    yylex(&tk);
+
+    while (tk.isNot(T_EOF_SYMBOL)) {
+        if (scanForModules && tk.newline() && tk.is(T_IDENTIFIER)
+                && moduleParser.start(begin + tk.begin(), begin + tk.end())) {
+            do {
+                oldTk = tk;
+                yylex.setScanAngleStringLiteralTokens(moduleParser.expectsHeaderName());
+                yylex(&tk);
+                yylex.setScanAngleStringLiteralTokens(false);
+            } while (moduleParser.addToken(moduleTokenKind(tk), begin + tk.begin(),
+                                           begin + tk.end(), tk.newline()));
+            continue; // The current token is either the final ';' or not part of the declaration.
+        }
+        if (tk.newline() && tk.is(T_POUND)) {
+            yylex(&tk);
+
+            if (parameters.scanForDependencies && !tk.newline() && tk.is(T_IDENTIFIER)) {
+                if (tc.equals(tk, includeLiteral) || tc.equals(tk, importLiteral))
+                {
+                    yylex.setScanAngleStringLiteralTokens(true);
+                    yylex(&tk);
+                    yylex.setScanAngleStringLiteralTokens(false);
+
+                    if (!tk.newline() && (tk.is(T_STRING_LITERAL) || tk.is(T_ANGLE_STRING_LITERAL))
+                            && (!parameters.conditions || parameters.conditions->isReachable())) {
+                        scanResult.size = int(tk.length() - 2);
+                        if (tk.is(T_STRING_LITERAL))
+                            scanResult.flags = SC_LOCAL_INCLUDE_FLAG;
+                        else
+                            scanResult.flags = SC_GLOBAL_INCLUDE_FLAG;
+                        scanResult.fileName = begin + tk.begin() + 1;
+                        results.includedFiles.push_back(scanResult);
+                    }
+                } else if (parameters.conditions) {
+                    const char * const name = begin + tk.begin();
+                    parameters.conditions->handleDirective(name, name + tk.length(), end);
+                }
+            }
+        } else if (tk.is(T_IDENTIFIER)) {
+            if (parameters.scanForFileTags) {
+                if (oldTk.is(T_IDENTIFIER) && tc.equals(oldTk, defineLiteral)) {
+                    // Someone was clever and redefined Q_OBJECT or Q_PLUGIN_METADATA.
+                    // Example: iplugin.h in Qt Creator.
+                } else {
+                    if (tc.equals(tk, qobjectLiteral) || tc.equals(tk, qgadgetLiteral)  ||
+                        tc.equals(tk, qnamespaceLiteral))
+                    {
+                        results.hasQObjectMacro = true;
+                    } else if (tc.equals(tk, pluginMetaDataLiteral))
+                    {
+                        results.hasPluginMetaDataMacro = true;
+                    }
+                    if (!parameters.scanForDependencies && results.hasQObjectMacro
+                        && (results.hasPluginMetaDataMacro || parameters.stopAtQObjectMacro))
+                        break;
+                }
+            }
+
+        }
+        oldTk = tk;
+        yylex(&tk);
+    }
+}
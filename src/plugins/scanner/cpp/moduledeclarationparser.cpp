@@ -0,0 +1,206 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "moduledeclarationparser.h"
+
+#include "cppscanengines.h"
+#include "preprocessorconditions.h"
+
+#include "../scanner.h"
+
+#include <cstring>
+
+template<int N> static bool textEquals(const char *begin, const char *end,
+                                       const char (&literal)[N])
+{
+    return end - begin == N - 1 && std::memcmp(begin, literal, N - 1) == 0;
+}
+
+ModuleDeclarationParser::ModuleDeclarationParser(char *fileContent,
+                                                 const CppScanParameters &parameters,
+                                                 CppScanResults &results)
+    : m_fileContent(fileContent), m_parameters(parameters), m_results(results)
+{
+}
+
+bool ModuleDeclarationParser::start(const char *begin, const char *end)
+{
+    m_isExported = false;
+    m_name.clear();
+    m_partition.clear();
+    m_headerName = nullptr;
+    if (textEquals(begin, end, "export")) {
+        m_isExported = true;
+        m_state = State::AfterExport;
+    } else if (textEquals(begin, end, "import")) {
+        m_isImport = true;
+        m_state = State::ImportStart;
+    } else if (textEquals(begin, end, "module")) {
+        m_isImport = false;
+        m_state = State::ModuleStart;
+    } else {
+        m_state = State::Idle;
+    }
+    return m_state != State::Idle;
+}
+
+bool ModuleDeclarationParser::addToken(TokenKind kind, const char *begin, const char *end,
+                                       bool newline)
+{
+    const State state = m_state;
+    m_state = State::Idle;
+    if (newline)
+        return false;
+
+    switch (state) {
+    case State::Idle:
+        break;
+    case State::AfterExport:
+        if (kind == TokenKind::Identifier && textEquals(begin, end, "import")) {
+            m_isImport = true;
+            m_state = State::ImportStart;
+        } else if (kind == TokenKind::Identifier && textEquals(begin, end, "module")) {
+            m_isImport = false;
+            m_state = State::ModuleStart;
+        }
+        break;
+    case State::ImportStart:
+        if (kind == TokenKind::StringLiteral || kind == TokenKind::AngleStringLiteral) {
+            m_headerNameKind = kind;
+            m_headerName = begin;
+            m_headerNameSize = int(end - begin);
+            m_state = State::AfterHeaderName;
+        } else if (kind == TokenKind::Colon) {
+            m_state = State::PartitionStart;
+        } else if (kind == TokenKind::Identifier) {
+            m_name = QByteArray(begin, int(end - begin));
+            m_state = State::AfterNamePart;
+        }
+        break;
+    case State::ModuleStart:
+        if (kind == TokenKind::Semicolon) {
+            // The start of the global module fragment.
+        } else if (kind == TokenKind::Colon) {
+            m_state = State::PrivateFragmentStart;
+        } else if (kind == TokenKind::Identifier) {
+            m_name = QByteArray(begin, int(end - begin));
+            m_state = State::AfterNamePart;
+        }
+        break;
+    case State::PrivateFragmentStart:
+        if (kind == TokenKind::Identifier && textEquals(begin, end, "private"))
+            m_state = State::AfterPrivate;
+        break;
+    case State::AfterPrivate:
+        break; // Nothing to record, with or without the semicolon.
+    case State::NameStart:
+        if (kind == TokenKind::Identifier) {
+            m_name.append(begin, int(end - begin));
+            m_state = State::AfterNamePart;
+        }
+        break;
+    case State::AfterNamePart:
+        if (kind == TokenKind::Period) {
+            m_name += '.';
+            m_state = State::NameStart;
+        } else if (kind == TokenKind::Colon && !m_isImport) {
+            m_state = State::PartitionStart;
+        } else if (kind == TokenKind::Semicolon) {
+            finish();
+        }
+        break;
+    case State::PartitionStart:
+        if (kind == TokenKind::Identifier) {
+            m_partition.append(begin, int(end - begin));
+            m_state = State::AfterPartitionPart;
+        }
+        break;
+    case State::AfterPartitionPart:
+        if (kind == TokenKind::Period) {
+            m_partition += '.';
+            m_state = State::PartitionStart;
+        } else if (kind == TokenKind::Semicolon) {
+            finish();
+        }
+        break;
+    case State::AfterHeaderName:
+        if (kind == TokenKind::Semicolon)
+            finish();
+        break;
+    }
+    return m_state != State::Idle;
+}
+
+void ModuleDeclarationParser::finish()
+{
+    const bool isReachable = !m_parameters.conditions || m_parameters.conditions->isReachable();
+    if (!m_isImport) {
+        m_results.moduleName = m_partition.isEmpty() ? m_name : m_name + ':' + m_partition;
+
+        // A module implementation unit implicitly imports the primary module interface.
+        if (!m_isExported && m_partition.isEmpty() && isReachable)
+            m_results.importedModules.push_back(m_name);
+        return;
+    }
+    if (!isReachable)
+        return;
+
+    if (m_headerName) {
+        // Header units are tracked like includes.
+        ScanResult scanResult;
+        scanResult.size = m_headerNameSize - 2;
+        scanResult.flags = m_headerNameKind == TokenKind::StringLiteral
+                ? SC_LOCAL_INCLUDE_FLAG : SC_GLOBAL_INCLUDE_FLAG;
+        scanResult.fileName = m_fileContent + (m_headerName - m_fileContent) + 1;
+        m_results.includedFiles.push_back(scanResult);
+        return;
+    }
+
+    if (!m_name.isEmpty()) {
+        m_results.importedModules.push_back(m_name);
+        return;
+    }
+
+    // A partition of the module this unit belongs to.
+    const int colonPos = m_results.moduleName.indexOf(':');
+    const QByteArray primaryModuleName = colonPos == -1
+            ? m_results.moduleName : m_results.moduleName.left(colonPos);
+    if (!primaryModuleName.isEmpty())
+        m_results.importedModules.push_back(primaryModuleName + ':' + m_partition);
+}
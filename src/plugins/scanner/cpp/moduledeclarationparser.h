@@ -0,0 +1,94 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#ifndef QBS_MODULEDECLARATIONPARSER_H
+#define QBS_MODULEDECLARATIONPARSER_H
+
+#include <QtCore/qbytearray.h>
+
+struct CppScanParameters;
+struct CppScanResults;
+
+// Recognizes C++20 module and import declarations. Like preprocessing directives, they start
+// at the beginning of a line with "module", "import" or "export", and the tokens up to the
+// terminating semicolon must be on the same line. Both scan engines feed the tokens of such
+// a declaration one by one, so they agree on the results.
+class ModuleDeclarationParser
+{
+public:
+    enum class TokenKind {
+        Identifier, Period, Colon, Semicolon, StringLiteral, AngleStringLiteral, Other
+    };
+
+    ModuleDeclarationParser(char *fileContent, const CppScanParameters &parameters,
+                            CppScanResults &results);
+
+    // To be called for an identifier at the start of a line. Returns true if it might
+    // begin a declaration, in which case the following tokens have to be passed to
+    // addToken() until it returns false.
+    bool start(const char *begin, const char *end);
+
+    // Returns false if the declaration is complete with this token or if the token does not
+    // fit, in which case it is not part of the declaration.
+    bool addToken(TokenKind kind, const char *begin, const char *end, bool newline);
+
+    // Whether the next token may be a header name, i.e. an angle string literal.
+    bool expectsHeaderName() const { return m_state == State::ImportStart; }
+
+private:
+    enum class State {
+        Idle, AfterExport, ImportStart, ModuleStart, PrivateFragmentStart, AfterPrivate,
+        NameStart, AfterNamePart, PartitionStart, AfterPartitionPart, AfterHeaderName
+    };
+
+    void finish();
+
+    char * const m_fileContent;
+    const CppScanParameters &m_parameters;
+    CppScanResults &m_results;
+    State m_state = State::Idle;
+    bool m_isImport = false;
+    bool m_isExported = false;
+    QByteArray m_name;
+    QByteArray m_partition;
+    TokenKind m_headerNameKind = TokenKind::Other;
+    const char *m_headerName = nullptr;
+    int m_headerNameSize = 0;
+};
+
+#endif // QBS_MODULEDECLARATIONPARSER_H
@@ -0,0 +1,642 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "preprocessorconditions.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+inline bool isIdentifierStart(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == '$';
+}
+inline bool isIdentifierChar(char c) { return isIdentifierStart(c) || isDigit(c); }
+inline bool isHorizontalSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+}
+
+// Returns the position behind a backslash-newline sequence at p, or p if there is none.
+const char *skipLineContinuation(const char *p, const char *end)
+{
+    if (p == end || *p != '\\')
+        return p;
+    const char *q = p + 1;
+    if (q < end && *q == '\r')
+        ++q;
+    return q < end && *q == '\n' ? q + 1 : p;
+}
+
+int digitValue(char c)
+{
+    if (isDigit(c))
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return 16;
+}
+
+} // namespace
+
+// Evaluates a fully macro-expanded #if expression. Operands that are not known make the
+// result unknown, unless the operator does not depend on them, as in "0 && x".
+class PreprocessorConditions::Evaluator
+{
+public:
+    explicit Evaluator(const Tokens &tokens) : m_tokens(tokens) {}
+
+    Tristate evaluate()
+    {
+        const Value value = parseExpression();
+        if (m_error || m_pos != m_tokens.size() || !value.known)
+            return Tristate::Unknown;
+        return value.value != 0 ? Tristate::True : Tristate::False;
+    }
+
+private:
+    struct Value
+    {
+        bool known = false;
+        bool isUnsigned = false;
+        qint64 value = 0;
+    };
+
+    static Value unknown() { return {}; }
+    static Value known(qint64 value, bool isUnsigned = false) { return {true, isUnsigned, value}; }
+    static Value known(bool value) { return known(qint64(value)); }
+
+    bool accept(const char *punctuator)
+    {
+        if (m_pos < m_tokens.size() && m_tokens[m_pos].kind == Token::Punctuator
+                && m_tokens[m_pos].text == punctuator) {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    Value parseExpression()
+    {
+        Value value = parseConditional();
+        while (accept(","))
+            value = parseConditional();
+        return value;
+    }
+
+    Value parseConditional()
+    {
+        const Value condition = parseBinary(1);
+        if (!accept("?"))
+            return condition;
+        Value first = parseExpression();
+        if (!accept(":")) {
+            m_error = true;
+            return unknown();
+        }
+        Value second = parseConditional();
+        const bool isUnsigned = first.isUnsigned || second.isUnsigned;
+        first.isUnsigned = second.isUnsigned = isUnsigned;
+        if (condition.known)
+            return condition.value != 0 ? first : second;
+        if (first.known && second.known && first.value == second.value)
+            return first;
+        return unknown();
+    }
+
+    static int binaryPrecedence(const Token &token)
+    {
+        if (token.kind != Token::Punctuator)
+            return 0;
+        static const QHash<QByteArray, int> precedences{
+            {"||", 1}, {"&&", 2}, {"|", 3}, {"^", 4}, {"&", 5}, {"==", 6}, {"!=", 6},
+            {"<", 7}, {">", 7}, {"<=", 7}, {">=", 7}, {"<<", 8}, {">>", 8}, {"+", 9}, {"-", 9},
+            {"*", 10}, {"/", 10}, {"%", 10}};
+        return precedences.value(token.text);
+    }
+
+    Value parseBinary(int minPrecedence)
+    {
+        Value left = parseUnary();
+        while (m_pos < m_tokens.size()) {
+            const int precedence = binaryPrecedence(m_tokens[m_pos]);
+            if (precedence == 0 || precedence < minPrecedence)
+                break;
+            const QByteArray op = m_tokens[m_pos++].text;
+            const Value right = parseBinary(precedence + 1);
+            left = applyBinary(op, left, right);
+        }
+        return left;
+    }
+
+    Value parseUnary()
+    {
+        if (accept("!")) {
+            const Value value = parseUnary();
+            return value.known ? known(value.value == 0) : unknown();
+        }
+        if (accept("~")) {
+            const Value value = parseUnary();
+            return value.known ? known(~value.value, value.isUnsigned) : unknown();
+        }
+        if (accept("-")) {
+            const Value value = parseUnary();
+            return value.known ? known(qint64(0 - quint64(value.value)), value.isUnsigned)
+                               : unknown();
+        }
+        if (accept("+"))
+            return parseUnary();
+        return parsePrimary();
+    }
+
+    Value parsePrimary()
+    {
+        if (m_pos == m_tokens.size()) {
+            m_error = true;
+            return unknown();
+        }
+        const Token &token = m_tokens[m_pos++];
+        switch (token.kind) {
+        case Token::Number:
+            return parseNumber(token.text);
+        case Token::Punctuator:
+            if (token.text == "(") {
+                const Value value = parseExpression();
+                if (!accept(")"))
+                    m_error = true;
+                return value;
+            }
+            m_error = true;
+            return unknown();
+        case Token::Identifier:
+        case Token::Literal:
+        case Token::UnknownValue:
+            break;
+        }
+        return unknown();
+    }
+
+    static Value parseNumber(QByteArray text)
+    {
+        text.replace('\'', QByteArray());
+        int base = 10;
+        int i = 0;
+        if (text.size() > 1 && text.at(0) == '0') {
+            const char prefix = text.at(1);
+            if (prefix == 'x' || prefix == 'X') {
+                base = 16;
+                i = 2;
+            } else if (prefix == 'b' || prefix == 'B') {
+                base = 2;
+                i = 2;
+            } else {
+                base = 8;
+            }
+        }
+        const int digitsBegin = i;
+        quint64 value = 0;
+        for (; i < text.size(); ++i) {
+            const int digit = digitValue(text.at(i));
+            if (digit >= base)
+                break;
+            if (value > (std::numeric_limits<quint64>::max() - digit) / base)
+                return unknown();
+            value = value * base + digit;
+        }
+        if (i == digitsBegin && base != 8)
+            return unknown();
+        bool hasUnsignedSuffix = false;
+        for (; i < text.size(); ++i) {
+            switch (text.at(i)) {
+            case 'u': case 'U':
+                if (hasUnsignedSuffix)
+                    return unknown();
+                hasUnsignedSuffix = true;
+                break;
+            case 'l': case 'L': case 'z': case 'Z':
+                break;
+            default:
+                return unknown(); // Floating point literal or garbage.
+            }
+        }
+        return known(qint64(value),
+                     hasUnsignedSuffix || value > quint64(std::numeric_limits<qint64>::max()));
+    }
+
+    static Value applyBinary(const QByteArray &op, const Value &left, const Value &right)
+    {
+        if (op == "&&") {
+            if ((left.known && left.value == 0) || (right.known && right.value == 0))
+                return known(false);
+            return left.known && right.known ? known(true) : unknown();
+        }
+        if (op == "||") {
+            if ((left.known && left.value != 0) || (right.known && right.value != 0))
+                return known(true);
+            return left.known && right.known ? known(false) : unknown();
+        }
+        if (!left.known || !right.known)
+            return unknown();
+
+        const bool isUnsigned = left.isUnsigned || right.isUnsigned;
+        const quint64 a = left.value;
+        const quint64 b = right.value;
+        const auto compare = [&](auto signedComparison, auto unsignedComparison) {
+            return known(isUnsigned ? unsignedComparison(a, b)
+                                    : signedComparison(left.value, right.value));
+        };
+        if (op == "*")
+            return known(qint64(a * b), isUnsigned);
+        if (op == "/" || op == "%") {
+            if (b == 0 || (!isUnsigned && left.value == std::numeric_limits<qint64>::min()
+                           && right.value == -1)) {
+                return unknown();
+            }
+            if (isUnsigned)
+                return known(qint64(op == "/" ? a / b : a % b), true);
+            return known(op == "/" ? left.value / right.value : left.value % right.value);
+        }
+        if (op == "+")
+            return known(qint64(a + b), isUnsigned);
+        if (op == "-")
+            return known(qint64(a - b), isUnsigned);
+        if (op == "<<" || op == ">>") {
+            if (right.value < 0 || right.value >= 64)
+                return unknown();
+            if (op == "<<")
+                return known(qint64(a << right.value), left.isUnsigned);
+            return left.isUnsigned ? known(qint64(a >> right.value), true)
+                                   : known(left.value >> right.value);
+        }
+        if (op == "<")
+            return compare(std::less<qint64>(), std::less<quint64>());
+        if (op == ">")
+            return compare(std::greater<qint64>(), std::greater<quint64>());
+        if (op == "<=")
+            return compare(std::less_equal<qint64>(), std::less_equal<quint64>());
+        if (op == ">=")
+            return compare(std::greater_equal<qint64>(), std::greater_equal<quint64>());
+        if (op == "==")
+            return known(a == b);
+        if (op == "!=")
+            return known(a != b);
+        if (op == "&")
+            return known(qint64(a & b), isUnsigned);
+        if (op == "^")
+            return known(qint64(a ^ b), isUnsigned);
+        if (op == "|")
+            return known(qint64(a | b), isUnsigned);
+        return unknown();
+    }
+
+    const Tokens &m_tokens;
+    size_t m_pos = 0;
+    bool m_error = false;
+};
+
+PreprocessorConditions::PreprocessorConditions(const char *macros)
+{
+    const char *p = macros;
+    const char * const end = macros + std::strlen(macros);
+    while (p < end) {
+        const char * const lineEnd = std::find(p, end, '\n');
+        Tokens line;
+        tokenize(p, lineEnd, line);
+        if (line.size() >= 2 && line.at(0).text == "#") {
+            const QByteArray directive = line.at(1).text;
+            line.erase(line.begin(), line.begin() + 2);
+            QByteArray name;
+            Macro macro;
+            if (directive == "define" && parseDefinition(line, name, macro)) {
+                macro.state = Macro::Defined;
+                m_knownMacros.insert(name, macro);
+            } else if (directive == "undef" && !line.empty()
+                       && line.front().kind == Token::Identifier) {
+                macro.state = Macro::Undefined;
+                m_knownMacros.insert(line.front().text, macro);
+            }
+        }
+        if (lineEnd == end)
+            break;
+        p = lineEnd + 1;
+    }
+}
+
+void PreprocessorConditions::handleDirective(const char *nameBegin, const char *nameEnd,
+                                             const char *end)
+{
+    const QByteArray name = QByteArray::fromRawData(nameBegin, int(nameEnd - nameBegin));
+    const auto parseLine = [nameEnd, end] {
+        Tokens line;
+        tokenize(nameEnd, end, line);
+        return line;
+    };
+
+    if (name == "if" || name == "ifdef" || name == "ifndef") {
+        Group group;
+        group.enclosing = reachability();
+        if (group.enclosing == Tristate::False) {
+            group.taken = Tristate::True;
+            group.current = Tristate::False;
+        } else {
+            enterBranch(group, evaluateCondition(name, parseLine()));
+        }
+        m_groups.push_back(group);
+    } else if (name == "elif" || name == "elifdef" || name == "elifndef") {
+        if (m_groups.empty())
+            return;
+        Group &group = m_groups.back();
+        if (group.enclosing == Tristate::False || group.taken == Tristate::True)
+            group.current = Tristate::False;
+        else
+            enterBranch(group, evaluateCondition(name, parseLine()));
+    } else if (name == "else") {
+        if (m_groups.empty())
+            return;
+        Group &group = m_groups.back();
+        group.current = std::min(group.enclosing, negated(group.taken));
+        group.taken = Tristate::True;
+    } else if (name == "endif") {
+        if (!m_groups.empty())
+            m_groups.pop_back();
+    } else if (name == "define" || name == "undef") {
+        const Tristate reachable = reachability();
+        if (reachable == Tristate::False)
+            return;
+        const Tokens line = parseLine();
+        QByteArray macroName;
+        Macro macro;
+        if (name == "define") {
+            if (!parseDefinition(line, macroName, macro))
+                return;
+            macro.state = Macro::Defined;
+        } else {
+            if (line.empty() || line.front().kind != Token::Identifier)
+                return;
+            macroName = line.front().text;
+            macro.state = Macro::Undefined;
+        }
+        // If we do not know whether the directive is seen by the compiler, we also do not
+        // know anything about the macro afterwards.
+        if (reachable == Tristate::Unknown)
+            macro = Macro();
+        m_fileMacros.insert(macroName, macro);
+    }
+}
+
+void PreprocessorConditions::enterBranch(Group &group, Tristate condition)
+{
+    group.current = std::min(group.enclosing, std::min(negated(group.taken), condition));
+    group.taken = std::max(group.taken, condition);
+}
+
+PreprocessorConditions::Tristate PreprocessorConditions::evaluateCondition(
+        const QByteArray &directive, const Tokens &line)
+{
+    if (directive.endsWith("def")) {
+        if (line.empty() || line.front().kind != Token::Identifier)
+            return Tristate::Unknown;
+        const Tristate defined = definedState(line.front().text);
+        return directive.endsWith("ndef") ? negated(defined) : defined;
+    }
+    Tokens expanded;
+    QSet<QByteArray> activeMacros;
+    expand(line, expanded, activeMacros, 0);
+    return Evaluator(expanded).evaluate();
+}
+
+PreprocessorConditions::Tristate PreprocessorConditions::definedState(const QByteArray &name)
+{
+    switch (lookup(name).state) {
+    case Macro::Defined:
+        return Tristate::True;
+    case Macro::Undefined:
+        return Tristate::False;
+    case Macro::Unknown:
+        break;
+    }
+    return Tristate::Unknown;
+}
+
+// Replaces all identifiers by numbers or, if their value cannot be determined, by
+// placeholders for unknown values. Function-like macros are never expanded.
+void PreprocessorConditions::expand(const Tokens &tokens, Tokens &expanded,
+                                    QSet<QByteArray> &activeMacros, int depth)
+{
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        const Token &token = tokens.at(i);
+        if (token.kind != Token::Identifier) {
+            expanded.push_back(token);
+            continue;
+        }
+
+        Token result;
+        result.kind = Token::UnknownValue;
+        const auto isPunctuator = [&tokens](size_t index, const char *text) {
+            return index < tokens.size() && tokens.at(index).kind == Token::Punctuator
+                    && tokens.at(index).text == text;
+        };
+        if (token.text == "defined") {
+            size_t j = i + 1;
+            const bool parenthesized = isPunctuator(j, "(");
+            if (parenthesized)
+                ++j;
+            if (j < tokens.size() && tokens.at(j).kind == Token::Identifier) {
+                const Tristate defined = definedState(tokens.at(j).text);
+                ++j;
+                if (defined != Tristate::Unknown && (!parenthesized || isPunctuator(j, ")"))) {
+                    result.kind = Token::Number;
+                    result.text = defined == Tristate::True ? "1" : "0";
+                }
+                if (parenthesized && isPunctuator(j, ")"))
+                    ++j;
+            }
+            i = j - 1;
+            expanded.push_back(result);
+            continue;
+        }
+
+        const Macro &macro = lookup(token.text);
+        if (macro.state == Macro::Defined && !macro.isFunctionLike
+                && !activeMacros.contains(token.text) && depth < 32) {
+            Tokens body;
+            tokenize(macro.body.constData(), macro.body.constData() + macro.body.size(), body);
+            activeMacros.insert(token.text);
+            expand(body, expanded, activeMacros, depth + 1);
+            activeMacros.remove(token.text);
+            continue;
+        }
+        if (isPunctuator(i + 1, "(")) {
+            // A function-like macro or something like __has_include(<header>).
+            int level = 0;
+            for (++i; i < tokens.size(); ++i) {
+                if (isPunctuator(i, "("))
+                    ++level;
+                else if (isPunctuator(i, ")") && --level == 0)
+                    break;
+            }
+        } else if (macro.state == Macro::Undefined) {
+            result.kind = Token::Number;
+            result.text = "0";
+        }
+        expanded.push_back(result);
+    }
+}
+
+const PreprocessorConditions::Macro &PreprocessorConditions::lookup(const QByteArray &name)
+{
+    const auto fileMacro = m_fileMacros.constFind(name);
+    if (fileMacro != m_fileMacros.constEnd())
+        return fileMacro.value();
+    if (!m_queriedMacroSet.contains(name)) {
+        m_queriedMacroSet.insert(name);
+        m_queriedMacros.push_back(name);
+    }
+    static const Macro unknownMacro;
+    const auto knownMacro = m_knownMacros.constFind(name);
+    return knownMacro != m_knownMacros.constEnd() ? knownMacro.value() : unknownMacro;
+}
+
+bool PreprocessorConditions::parseDefinition(const Tokens &line, QByteArray &name, Macro &macro)
+{
+    if (line.empty() || line.front().kind != Token::Identifier)
+        return false;
+    name = line.front().text;
+    size_t i = 1;
+    if (i < line.size() && line.at(i).text == "(" && !line.at(i).followsSpace) {
+        macro.isFunctionLike = true;
+        while (i < line.size() && line.at(i).text != ")")
+            ++i;
+        ++i;
+    }
+    for (; i < line.size(); ++i) {
+        if (!macro.body.isEmpty())
+            macro.body += ' ';
+        macro.body += line.at(i).text;
+    }
+    return true;
+}
+
+// Splits the logical line starting at p into preprocessing tokens. Comments and line
+// continuations are skipped. A NUL byte ends the line, as it ends the file for the scanners.
+void PreprocessorConditions::tokenize(const char *p, const char *end, Tokens &tokens)
+{
+    bool followsSpace = false;
+    while (p < end) {
+        const char c = *p;
+        if (c == '\n' || c == '\0')
+            break;
+        if (isHorizontalSpace(c)) {
+            ++p;
+            followsSpace = true;
+            continue;
+        }
+        if (c == '\\') {
+            const char * const next = skipLineContinuation(p, end);
+            if (next != p) {
+                p = next;
+                followsSpace = true;
+                continue;
+            }
+        }
+        if (c == '/' && p + 1 < end && p[1] == '/')
+            break;
+        if (c == '/' && p + 1 < end && p[1] == '*') {
+            for (p += 2; p < end && *p != '\0'; ++p) {
+                if (*p == '*' && p + 1 < end && p[1] == '/') {
+                    p += 2;
+                    break;
+                }
+            }
+            followsSpace = true;
+            continue;
+        }
+
+        const char * const tokenBegin = p;
+        Token token;
+        token.followsSpace = followsSpace;
+        followsSpace = false;
+        if (isIdentifierStart(c)) {
+            while (p < end && isIdentifierChar(*p))
+                ++p;
+            token.kind = Token::Identifier;
+        } else if (isDigit(c) || (c == '.' && p + 1 < end && isDigit(p[1]))) {
+            for (++p; p < end; ++p) {
+                if ((*p == '+' || *p == '-') && (p[-1] == 'e' || p[-1] == 'E'
+                                                 || p[-1] == 'p' || p[-1] == 'P')) {
+                    continue;
+                }
+                if (*p == '\'' && p + 1 < end && isIdentifierChar(p[1]))
+                    continue;
+                if (!isIdentifierChar(*p) && *p != '.')
+                    break;
+            }
+            token.kind = Token::Number;
+        } else if (c == '"' || c == '\'') {
+            for (++p; p < end && *p != c && *p != '\n' && *p != '\0'; ++p) {
+                if (*p == '\\' && p + 1 < end)
+                    ++p;
+            }
+            if (p < end && *p == c)
+                ++p;
+            token.kind = Token::Literal;
+        } else {
+            static const char * const twoCharPunctuators[] = {
+                "<<", ">>", "<=", ">=", "==", "!=", "&&", "||", "##"
+            };
+            ++p;
+            if (p < end) {
+                for (const char *punctuator : twoCharPunctuators) {
+                    if (c == punctuator[0] && *p == punctuator[1]) {
+                        ++p;
+                        break;
+                    }
+                }
+            }
+            token.kind = Token::Punctuator;
+        }
+        token.text = QByteArray(tokenBegin, int(p - tokenBegin));
+        tokens.push_back(token);
+    }
+}
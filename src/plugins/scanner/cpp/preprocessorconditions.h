@@ -0,0 +1,121 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_PREPROCESSORCONDITIONS_H
+#define QBS_PREPROCESSORCONDITIONS_H
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qset.h>
+
+#include <vector>
+
+// Keeps track of which parts of a file are reachable when compiling it with a given set of
+// macros. Only the macros passed in and the ones defined in the file itself are known.
+// Everything else is unknown, and a condition that depends on an unknown macro is considered
+// to be possibly true. Consequently, an include is only considered unreachable if the
+// compiler is certain not to see it either.
+class PreprocessorConditions
+{
+public:
+    // The macros are given as a sequence of "#define" lines for the macros that are known
+    // to be defined and "#undef" lines for the ones that are known not to be defined.
+    explicit PreprocessorConditions(const char *macros);
+
+    // To be called for every preprocessing directive other than #include and #import,
+    // with the directive name in [nameBegin, nameEnd). The end of the file is at end.
+    void handleDirective(const char *nameBegin, const char *nameEnd, const char *end);
+
+    bool isReachable() const { return reachability() != Tristate::False; }
+
+    // The names of all macros that were looked up in the set passed to the constructor,
+    // including those that were not in there. The scan result depends on exactly these.
+    const std::vector<QByteArray> &queriedMacros() const { return m_queriedMacros; }
+
+private:
+    enum class Tristate { False, Unknown, True };
+
+    struct Macro
+    {
+        enum State { Unknown, Defined, Undefined };
+        State state = Unknown;
+        bool isFunctionLike = false;
+        QByteArray body;
+    };
+
+    struct Token
+    {
+        enum Kind { Identifier, Number, Literal, Punctuator, UnknownValue };
+        Kind kind = Punctuator;
+        QByteArray text;
+        bool followsSpace = false;
+    };
+    using Tokens = std::vector<Token>;
+
+    struct Group
+    {
+        Tristate enclosing = Tristate::True; // Reachability of the code around the group.
+        Tristate taken = Tristate::False;    // Whether one of the previous branches was taken.
+        Tristate current = Tristate::True;   // Reachability of the current branch.
+    };
+
+    class Evaluator;
+
+    static Tristate negated(Tristate value) { return Tristate(2 - int(value)); }
+    Tristate reachability() const
+    {
+        return m_groups.empty() ? Tristate::True : m_groups.back().current;
+    }
+    void enterBranch(Group &group, Tristate condition);
+    Tristate evaluateCondition(const QByteArray &directive, const Tokens &line);
+    Tristate definedState(const QByteArray &name);
+    void expand(const Tokens &tokens, Tokens &expanded, QSet<QByteArray> &activeMacros,
+                int depth);
+    const Macro &lookup(const QByteArray &name);
+    static bool parseDefinition(const Tokens &line, QByteArray &name, Macro &macro);
+    static void tokenize(const char *p, const char *end, Tokens &tokens);
+
+    QHash<QByteArray, Macro> m_knownMacros;
+    QHash<QByteArray, Macro> m_fileMacros;
+    QSet<QByteArray> m_queriedMacroSet;
+    std::vector<QByteArray> m_queriedMacros;
+    std::vector<Group> m_groups;
+};
+
+#endif // QBS_PREPROCESSORCONDITIONS_H
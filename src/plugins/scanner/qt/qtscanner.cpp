@@ -177,7 +177,9 @@ ScannerPlugin qrcScanner =
     closeScannerQrc,
     nextQrc,
     additionalFileTagsQrc,
-    NoScannerFlags
+    NoScannerFlags,
+    nullptr,
+    nullptr
 };
 
 ScannerPlugin *qtScanners[] = {&qrcScanner, nullptr};
@@ -46,11 +46,13 @@ extern "C" {
 
 #define SC_LOCAL_INCLUDE_FLAG   0x1
 #define SC_GLOBAL_INCLUDE_FLAG  0x2
+#define SC_MODULE_IMPORT_FLAG   0x4 // The result is the name of an imported C++ module.
 
 enum OpenScannerFlags
 {
     ScanForDependenciesFlag = 0x01,
-    ScanForFileTagsFlag = 0x02
+    ScanForFileTagsFlag = 0x02,
+    ScanForModulesFlag = 0x04 // Along with ScanForDependenciesFlag, report C++ module imports.
 };
 
 /**
@@ -81,6 +83,23 @@ typedef const char *(*scanNext_f)           (void *opaq, int *size, int *flags);
   */
 typedef const char** (*scanAdditionalFileTags_f) (void *opaq, int *size);
 
+/**
+  * Like scanOpen_f, but dependencies are only reported if they are reachable
+  * with respect to preprocessor conditions.
+  * The macros that are known to be defined are given as "#define" lines,
+  * the ones known not to be defined as "#undef" lines.
+  * Conditions depending on any other macro are assumed to be possibly true.
+  */
+typedef void *(*scanOpenConditional_f) (const unsigned short *filePath, const char *fileTags,
+                                        int flags, const char *macros);
+
+/**
+  * Returns the names of the macros from the set passed to scanOpenConditional_f
+  * that were looked up during the scan, including the ones that were not in the set.
+  * The result of the scan only depends on the definitions of these macros.
+  */
+typedef const char** (*scanConditionMacros_f) (void *opaq, int *size);
+
 enum ScannerFlags
 {
     NoScannerFlags = 0x00,
@@ -98,6 +117,8 @@ public:
     scanNext_f  next;
     scanAdditionalFileTags_f additionalFileTags;
     int flags;
+    scanOpenConditional_f openConditional; // May be null.
+    scanConditionMacros_f conditionMacros; // May be null.
 };
 
 #ifdef __cplusplus
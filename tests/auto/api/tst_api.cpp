@@ -44,6 +44,7 @@
 #include <QtCore/qeventloop.h>
 #include <QtCore/qfile.h>
 #include <QtCore/qfileinfo.h>
+#include <QtCore/qprocess.h>
 #include <QtCore/qstringlist.h>
 #include <QtCore/qthread.h>
 #include <QtCore/qtimer.h>
@@ -54,6 +55,7 @@
 #include <functional>
 #include <memory>
 #include <regex>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -257,7 +259,7 @@ void TestApi::buildGraphInfo()
     QVERIFY2(QFileInfo::exists(bgFilePath), qPrintable(bgFilePath));
     qbs::Project::BuildGraphInfo bgInfo
             = qbs::Project::getBuildGraphInfo(bgFilePath, QStringList());
-    QVERIFY(bgInfo.error.hasError()); // Build graph is still locked.
+    QVERIFY2(!bgInfo.error.hasError(), qPrintable(bgInfo.error.toString())); // Read-only.
     setupJob.reset(nullptr);
     const QStringList requestedProperties({"qbs.architecture", "qbs.shellPath",
                                            "qbs.targetPlatform"});
@@ -301,12 +303,17 @@ void TestApi::buildGraphLocking()
     const qbs::Project project = setupJob->project();
     Q_UNUSED(project);
 
-    // Case 1: Setting up a competing project from scratch.
+    // Case 1: Setting up a competing project from scratch. This only reads the build graph,
+    //         so it succeeds, but building the competing project does not.
     setupJob.reset(qbs::Project().setupProject(setupParams, m_logSink, nullptr));
     waitForFinished(setupJob.get());
-    QVERIFY(setupJob->error().hasError());
-    QVERIFY2(setupJob->error().toString().contains("lock"),
-             qPrintable(setupJob->error().toString()));
+    QVERIFY2(!setupJob->error().hasError(), qPrintable(setupJob->error().toString()));
+    std::unique_ptr<qbs::BuildJob> buildJob(setupJob->project()
+                                            .buildAllProducts(qbs::BuildOptions()));
+    waitForFinished(buildJob.get());
+    QVERIFY(buildJob->error().hasError());
+    QVERIFY2(buildJob->error().toString().contains("lock"),
+             qPrintable(buildJob->error().toString()));
 
     // Case 2: Setting up a non-competing project and then making it competing.
     qbs::SetupProjectParameters setupParams2 = setupParams;
@@ -322,9 +329,13 @@ void TestApi::buildGraphLocking()
     QVERIFY(project2.isValid());
     setupJob.reset(project2.setupProject(setupParams, m_logSink, nullptr));
     waitForFinished(setupJob.get());
-    QVERIFY(setupJob->error().hasError());
-    QVERIFY2(setupJob->error().toString().contains("lock"),
-             qPrintable(setupJob->error().toString()));
+    QVERIFY2(!setupJob->error().hasError(), qPrintable(setupJob->error().toString()));
+    buildJob.reset(setupJob->project().buildAllProducts(qbs::BuildOptions()));
+    waitForFinished(buildJob.get());
+    QVERIFY(buildJob->error().hasError());
+    QVERIFY2(buildJob->error().toString().contains("lock"),
+             qPrintable(buildJob->error().toString()));
+    buildJob.reset();
     QVERIFY2(QFileInfo(lockFile).isFile(), qPrintable(lockFile));
 
     // Case 3: Changing the build directory of an existing project to something non-competing.
@@ -354,6 +365,34 @@ void TestApi::buildGraphLocking()
     QVERIFY2(!QFileInfo(newLockFile).exists(), qPrintable(newLockFile));
 }
 
+void TestApi::buildGraphLockingWithProductRemoval()
+{
+    qbs::SetupProjectParameters setupParams
+            = defaultSetupParameters("buildgraph-locking-product-removal");
+    std::unique_ptr<qbs::SetupProjectJob> setupJob(qbs::Project().setupProject(setupParams,
+                                                                        m_logSink, nullptr));
+    waitForFinished(setupJob.get());
+    QVERIFY2(!setupJob->error().hasError(), qPrintable(setupJob->error().toString()));
+    const qbs::Project project = setupJob->project();
+    std::unique_ptr<qbs::BuildJob> buildJob(project.buildAllProducts(qbs::BuildOptions()));
+    waitForFinished(buildJob.get());
+    QVERIFY2(!buildJob->error().hasError(), qPrintable(buildJob->error().toString()));
+    buildJob.reset();
+    const QString removedArtifact = relativeProductBuildDir("p2") + "/p2.txt";
+    QVERIFY2(regularFileExists(removedArtifact), qPrintable(removedArtifact));
+
+    // The first project now holds the lock. Setting up a competing project in which
+    // a product has disappeared must fail before the product's artifacts are removed.
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE(setupParams.projectFilePath(), "references: \"p2.qbs\"", "references: []");
+    setupJob.reset(qbs::Project().setupProject(setupParams, m_logSink, nullptr));
+    waitForFinished(setupJob.get());
+    QVERIFY(setupJob->error().hasError());
+    QVERIFY2(setupJob->error().toString().contains("lock"),
+             qPrintable(setupJob->error().toString()));
+    QVERIFY2(regularFileExists(removedArtifact), qPrintable(removedArtifact));
+}
+
 void TestApi::buildProject()
 {
     QFETCH(QString, projectSubDir);
@@ -2291,6 +2330,55 @@ void TestApi::projectDataAfterProductInvalidation()
             != productAfterBulding.generatedArtifacts());
 }
 
+void TestApi::projectDataSnapshot()
+{
+    qbs::SetupProjectParameters setupParams = defaultSetupParameters("project-data-snapshot");
+    std::unique_ptr<qbs::SetupProjectJob> setupJob(qbs::Project().setupProject(setupParams,
+                                                                              m_logSink, nullptr));
+    waitForFinished(setupJob.get());
+    QVERIFY2(!setupJob->error().hasError(), qPrintable(setupJob->error().toString()));
+    qbs::Project project = setupJob->project();
+    const qbs::ProjectData dataBeforeBuild = project.projectData();
+    QVERIFY(project.projectData() == dataBeforeBuild);
+    QCOMPARE(dataBeforeBuild.products().size(), 1);
+
+    std::unique_ptr<qbs::BuildJob> buildJob(project.buildAllProducts(qbs::BuildOptions()));
+    waitForFinished(buildJob.get());
+    QVERIFY2(!buildJob->error().hasError(), qPrintable(buildJob->error().toString()));
+    const qbs::ProjectData dataAfterBuild = project.projectData();
+    QVERIFY(dataAfterBuild != dataBeforeBuild);
+    QVERIFY(project.projectData() == dataAfterBuild);
+
+    // The first access can happen from several threads at once.
+    const qbs::ProductData sharedProduct = dataAfterBuild.products().front();
+    std::vector<std::thread> threads;
+    std::vector<int> itemCounts(4);
+    for (int &itemCount : itemCounts) {
+        threads.emplace_back([&sharedProduct, &itemCount] {
+            itemCount = sharedProduct.generatedArtifacts().size()
+                    + sharedProduct.groups().size();
+        });
+    }
+    for (std::thread &thread : threads)
+        thread.join();
+    const int expectedItemCount = sharedProduct.generatedArtifacts().size()
+            + sharedProduct.groups().size();
+    for (const int itemCount : itemCounts)
+        QCOMPARE(itemCount, expectedItemCount);
+
+    // Product data is filled in on first access, but still reflects the time of its retrieval.
+    const qbs::ProductData productBeforeBuild = dataBeforeBuild.products().front();
+    const qbs::ProductData productAfterBuild = dataAfterBuild.products().front();
+    QVERIFY(productBeforeBuild.generatedArtifacts().empty());
+    QVERIFY(!productAfterBuild.generatedArtifacts().empty());
+    QVERIFY(productBeforeBuild.groups() == productAfterBuild.groups());
+
+    // The data outlives the project.
+    project = qbs::Project();
+    setupJob.reset();
+    QVERIFY(!productAfterBuild.targetExecutable().isEmpty());
+}
+
 void TestApi::processResult()
 {
     waitForFileUnlock();
@@ -2641,6 +2729,59 @@ void TestApi::renameTargetArtifact()
     QCOMPARE(receiver.descriptions.count("linking"), 2);
 }
 
+void TestApi::remoteExecution()
+{
+    const QString workerFilePath = HostOsInfo::appendExecutableSuffix(
+                QDir::cleanPath(QCoreApplication::applicationDirPath()
+                                + QLatin1String("/" QBS_RELATIVE_LIBEXEC_PATH)
+                                + QLatin1String("/qbs_remoteworker")));
+    QProcess worker;
+    QProcessEnvironment workerEnv = QProcessEnvironment::systemEnvironment();
+    workerEnv.insert("QT_LOGGING_RULES", "qbs.remoteworker.debug=true");
+    workerEnv.insert("QBS_REMOTE_WORKER_TOKEN", "the-token");
+    worker.setProcessEnvironment(workerEnv);
+    worker.start(workerFilePath, {"--cache-dir", m_workingDataDir + "/remote-execution-cache"});
+    QVERIFY2(worker.waitForStarted(), qPrintable(worker.errorString()));
+    QVERIFY(worker.waitForReadyRead(10000));
+    const QByteArray greeting = worker.readLine().trimmed();
+    QVERIFY2(greeting.startsWith("qbs_remoteworker listening on port "), greeting.constData());
+    const QString port = QString::fromLatin1(greeting.mid(greeting.lastIndexOf(' ') + 1));
+
+    // The worker does not run anything for clients that do not know its access token.
+    qbs::BuildOptions options;
+    options.setRemoteWorker("127.0.0.1:" + port);
+    options.setRemoteWorkerToken("some-other-token");
+    qbs::ErrorInfo errorInfo = doBuildProject("remote-execution/remote-execution.qbs",
+                                              nullptr, nullptr, nullptr, options);
+    if (m_logSink->output.contains("targetPlatform differs from hostPlatform")) {
+        worker.kill();
+        worker.waitForFinished();
+        QSKIP("Cannot run binaries in cross-compiled build");
+    }
+    QVERIFY(errorInfo.hasError());
+
+    options.setRemoteWorkerToken("the-token");
+    BuildDescriptionReceiver receiver;
+    errorInfo = doBuildProject("remote-execution/remote-execution.qbs",
+                               &receiver, nullptr, nullptr, options);
+    worker.kill();
+    worker.waitForFinished();
+    if (m_logSink->output.contains("targetPlatform differs from hostPlatform"))
+        QSKIP("Cannot run binaries in cross-compiled build");
+    VERIFY_NO_ERROR(errorInfo);
+    QCOMPARE(receiver.descriptions.count("copying"), 2);
+    for (const QString &name : {QStringLiteral("a"), QStringLiteral("b")}) {
+        QFile output(relativeProductBuildDir("p") + '/' + name + ".out");
+        QVERIFY2(output.open(QIODevice::ReadOnly), qPrintable(output.fileName()));
+        QCOMPARE(output.readAll().trimmed(), "contents of " + name.toLatin1());
+    }
+
+    // Only the copy commands opted in to remote execution.
+    const QByteArray workerLog = worker.readAllStandardError();
+    QCOMPARE(workerLog.count("running"), 2);
+    QVERIFY2(workerLog.contains("Rejecting client"), workerLog.constData());
+}
+
 void TestApi::removeFileDependency()
 {
     qbs::ErrorInfo errorInfo = doBuildProject("remove-file-dependency/removeFileDependency.qbs");
@@ -2744,6 +2885,40 @@ void TestApi::restoredWarnings()
     m_logSink->warnings.clear();
 }
 
+void TestApi::reusedProductsAfterFailedResolving()
+{
+    const qbs::SetupProjectParameters setupParams
+            = defaultSetupParameters("reused-products-after-failed-resolving");
+    std::unique_ptr<qbs::SetupProjectJob> setupJob(qbs::Project().setupProject(setupParams,
+                                                                        m_logSink, nullptr));
+    waitForFinished(setupJob.get());
+    QVERIFY2(!setupJob->error().hasError(), qPrintable(setupJob->error().toString()));
+    qbs::Project project = setupJob->project();
+    std::unique_ptr<qbs::BuildJob> buildJob(project.buildAllProducts(qbs::BuildOptions()));
+    waitForFinished(buildJob.get());
+    QVERIFY2(!buildJob->error().hasError(), qPrintable(buildJob->error().toString()));
+
+    // "lib" and "user" are taken over from the existing project, then resolving "other" fails.
+    // The existing project must not have been affected.
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("other.qbs", "\"ok\"", "{ throw \"boom\"; }");
+    setupJob.reset(project.setupProject(setupParams, m_logSink, nullptr));
+    waitForFinished(setupJob.get());
+    QVERIFY(setupJob->error().hasError());
+    QVERIFY2(setupJob->error().toString().contains("boom"),
+             qPrintable(setupJob->error().toString()));
+    setupJob.reset();
+
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("lib.in", "1", "2");
+    buildJob.reset(project.buildAllProducts(qbs::BuildOptions()));
+    waitForFinished(buildJob.get());
+    QVERIFY2(!buildJob->error().hasError(), qPrintable(buildJob->error().toString()));
+    QFile userFile(relativeProductBuildDir("user") + "/user.txt");
+    QVERIFY2(userFile.open(QIODevice::ReadOnly), qPrintable(userFile.errorString()));
+    QCOMPARE(userFile.readAll().trimmed(), QByteArray("2"));
+}
+
 void TestApi::ruleConflict()
 {
     const qbs::ErrorInfo errorInfo = doBuildProject("rule-conflict");
@@ -63,6 +63,7 @@ private slots:
     void buildErrorCodeLocation();
     void buildGraphInfo();
     void buildGraphLocking();
+    void buildGraphLockingWithProductRemoval();
     void buildProject();
     void buildProject_data();
     void buildProjectDryRun();
@@ -117,6 +118,7 @@ private slots:
     void nonexistingProjectPropertyFromProduct();
     void objC();
     void projectDataAfterProductInvalidation();
+    void projectDataSnapshot();
     void processResult();
     void processResult_data();
     void projectInvalidation();
@@ -130,6 +132,7 @@ private slots:
     void referencedFileErrors_data();
     void references();
     void relaxedModeRecovery();
+    void remoteExecution();
     void removeFileDependency();
     void renameProduct();
     void renameTargetArtifact();
@@ -139,6 +142,7 @@ private slots:
     void resolveProjectDryRun();
     void resolveProjectDryRun_data();
     void restoredWarnings();
+    void reusedProductsAfterFailedResolving();
     void ruleConflict();
     void runEnvForDisabledProduct();
     void softDependency();
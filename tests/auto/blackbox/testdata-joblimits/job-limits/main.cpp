@@ -29,10 +29,12 @@
 #include <cerrno>
 #include <chrono>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <string>
 #include <thread>
+#include <vector>
 
 #if defined(_WIN32) || defined(WIN32)
 #include <io.h>
@@ -55,12 +57,19 @@ static bool tryLock(FILE *f)
 
 int main(int argc, char *argv[])
 {
-    if (argc != 2) {
-        std::cerr << "tool needs exactly one argument" << std::endl;
+    if (argc != 2 && argc != 3) {
+        std::cerr << "tool needs one or two arguments" << std::endl;
         return 1;
     }
 
-    const std::string lockFilePath = std::string(argv[0]) + ".lock";
+    // Lets the tool use a given amount of memory while it runs.
+    std::vector<char> memory;
+    if (const char * const memoryMiB = std::getenv("QBS_TEST_TOOL_MEMORY_MIB"))
+        memory.assign(std::size_t(std::atoi(memoryMiB)) * 1024 * 1024, 1);
+
+    // Instances that are to be mutually exclusive must use the same lock file.
+    const std::string lockFilePath = argc == 3 ? std::string(argv[2])
+                                               : std::string(argv[0]) + ".lock";
     std::FILE * const lockFile = std::fopen(lockFilePath.c_str(), "w");
     if (!lockFile) {
         std::cerr << "cannot open lock file: " << std::strerror(errno) << std::endl;
@@ -0,0 +1,13 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && std::strcmp(argv[1], "fail") == 0) {
+        std::cerr << "FAIL" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "PASS" << std::endl;
+    return EXIT_SUCCESS;
+}
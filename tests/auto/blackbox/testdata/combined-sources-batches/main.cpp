@@ -0,0 +1,12 @@
+#ifdef SPECIAL
+#error "SPECIAL defined"
+#endif
+
+int f1();
+int f2();
+int f3();
+int f4();
+int f5();
+int special();
+
+int main() { return f1() + f2() + f3() + f4() + f5() + special() == 21 ? 0 : 1; }
@@ -0,0 +1,5 @@
+#ifndef SPECIAL
+#error "SPECIAL not defined"
+#endif
+
+int special() { return 6; }
@@ -0,0 +1,6 @@
+import lib.math;
+
+int main()
+{
+    return add(1, twice(1)) == 3 ? 0 : 1;
+}
@@ -0,0 +1,3 @@
+export module lib.math:detail;
+
+export int twice(int a) { return 2 * a; }
@@ -0,0 +1,3 @@
+module lib.math;
+
+int add(int a, int b) { return a + b; }
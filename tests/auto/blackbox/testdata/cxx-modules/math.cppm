@@ -0,0 +1,4 @@
+export module lib.math;
+export import :detail;
+
+export int add(int a, int b);
@@ -0,0 +1 @@
+// feature
@@ -0,0 +1,14 @@
+#include "always.h"
+
+#if ENABLE_FEATURE
+#include "feature.h"
+#endif
+
+#ifdef SOME_MACRO_FROM_ELSEWHERE
+#include "maybe.h"
+#endif
+
+int main()
+{
+    return 0;
+}
@@ -0,0 +1 @@
+// maybe
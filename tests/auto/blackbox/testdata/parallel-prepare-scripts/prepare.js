@@ -0,0 +1,4 @@
+function content(fileName, suffix)
+{
+    return fileName + suffix;
+}
@@ -0,0 +1,6 @@
+#include "header.h"
+
+int main()
+{
+    return f();
+}
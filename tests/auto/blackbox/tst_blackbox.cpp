@@ -43,6 +43,7 @@
 #include <tools/version.h>
 
 #include <QtCore/qdebug.h>
+#include <QtCore/qdiriterator.h>
 #include <QtCore/qelapsedtimer.h>
 #include <QtCore/qjsonarray.h>
 #include <QtCore/qjsondocument.h>
@@ -894,6 +895,30 @@ void TestBlackbox::changedRuleInputs()
     QVERIFY2(!m_qbsStdout.contains("generating p2-dummy"), m_qbsStdout.constData());
 }
 
+void TestBlackbox::cachedPropertyMapValues()
+{
+    QDir::setCurrent(testDataDir + "/cached-property-map-values");
+    QCOMPARE(runQbs(), 0);
+    QCOMPARE(m_qbsStdout.count("computing prefix"), 1);
+    QVERIFY2(m_qbsStdout.contains("generating a.out"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("generating b.out"), m_qbsStdout.constData());
+    const auto readOutput = [](const QString &fileName) {
+        QFile outFile(relativeProductBuildDir("p") + '/' + fileName);
+        return outFile.open(QIODevice::ReadOnly) ? outFile.readAll() : QByteArray();
+    };
+    QCOMPARE(readOutput("a.out"), QByteArray("first: a.in"));
+    QCOMPARE(readOutput("b.out"), QByteArray("first: b.in"));
+
+    // Both transformers depend on the property, even though the value was computed only once.
+    QCOMPARE(runQbs(QbsRunParameters("resolve", QStringList("modules.m.prefix:second"))), 0);
+    QCOMPARE(runQbs(), 0);
+    QCOMPARE(m_qbsStdout.count("computing prefix"), 1);
+    QVERIFY2(m_qbsStdout.contains("generating a.out"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("generating b.out"), m_qbsStdout.constData());
+    QCOMPARE(readOutput("a.out"), QByteArray("second: a.in"));
+    QCOMPARE(readOutput("b.out"), QByteArray("second: b.in"));
+}
+
 void TestBlackbox::changeInDisabledProduct()
 {
     QDir::setCurrent(testDataDir + "/change-in-disabled-product");
@@ -933,6 +958,41 @@ void TestBlackbox::changeTrackingAndMultiplexing()
     QCOMPARE(m_qbsStdout.count("creating prefix2l"), 2);
 }
 
+void TestBlackbox::changeTrackingForBuildSystemFiles()
+{
+    QDir::setCurrent(testDataDir + "/change-tracking-for-build-system-files");
+    QCOMPARE(runQbs(QbsRunParameters("resolve")), 0);
+    QVERIFY2(m_qbsStdout.contains("evaluating independent"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("evaluating user with old value"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("evaluating indirect-user"), m_qbsStdout.constData());
+
+    // Only the products depending on the module, directly or indirectly, get re-evaluated.
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("modules/helper/helper.qbs", "old value", "new value");
+    QCOMPARE(runQbs(QbsRunParameters("resolve")), 0);
+    QVERIFY2(!m_qbsStdout.contains("evaluating independent"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("evaluating user with new value"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("evaluating indirect-user"), m_qbsStdout.constData());
+
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("indirect-user.qbs");
+    QCOMPARE(runQbs(QbsRunParameters("resolve")), 0);
+    QVERIFY2(!m_qbsStdout.contains("evaluating independent"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("evaluating user"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("evaluating indirect-user"), m_qbsStdout.constData());
+
+    // The project file affects all products.
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("change-tracking-for-build-system-files.qbs");
+    QCOMPARE(runQbs(QbsRunParameters("resolve")), 0);
+    QVERIFY2(m_qbsStdout.contains("evaluating independent"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("evaluating user with new value"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("evaluating indirect-user"), m_qbsStdout.constData());
+
+    // The stored build data of re-used products must still be intact.
+    QCOMPARE(runQbs(), 0);
+}
+
 static QJsonObject findByName(const QJsonArray &objects, const QString &name)
 {
     for (const QJsonValue &v : objects) {
@@ -1725,6 +1785,33 @@ void TestBlackbox::clean()
     QVERIFY(regularFileExists(depLibFilePath));
     for (const QString &symLink : qAsConst(symlinks))
         QVERIFY2(symlinkExists(symLink), qPrintable(symLink));
+
+    // Whole product directories, multi-threaded.
+    QCOMPARE(runQbs(), 0);
+    QVERIFY(regularFileExists(appObjectFilePath));
+    QVERIFY(regularFileExists(depLibFilePath));
+    QCOMPARE(runQbs(QbsRunParameters(QStringLiteral("clean"),
+                                     QStringList({"--remove-product-directories", "-j", "4"}))),
+             0);
+    QVERIFY(!QFile(appObjectFilePath).exists());
+    QVERIFY(!QFile(appExeFilePath).exists());
+    QVERIFY(!QFile(depObjectFilePath).exists());
+    QVERIFY(!QFile(depLibFilePath).exists());
+    for (const QString &symLink : qAsConst(symlinks))
+        QVERIFY2(!symlinkExists(symLink), qPrintable(symLink));
+    QVERIFY(!directoryExists(relativeProductBuildDir("app")));
+    QVERIFY(!directoryExists(relativeProductBuildDir("dep")));
+
+    // Foreign files in a product directory must survive.
+    QCOMPARE(runQbs(), 0);
+    const QString foreignFilePath = relativeProductBuildDir("app") + "/foreign.txt";
+    touch(foreignFilePath);
+    QCOMPARE(runQbs(QbsRunParameters(QStringLiteral("clean"),
+                                     QStringList("--remove-product-directories"))), 0);
+    QVERIFY(!QFile(appObjectFilePath).exists());
+    QVERIFY(!QFile(appExeFilePath).exists());
+    QVERIFY(!QFile(depLibFilePath).exists());
+    QVERIFY(regularFileExists(foreignFilePath));
 }
 
 void TestBlackbox::concurrentExecutor()
@@ -1866,6 +1953,46 @@ void TestBlackbox::cxxLanguageVersion_data()
                             std::make_pair(QString("msvc-new"), QString("/std:"))});
 }
 
+void TestBlackbox::cxxModules()
+{
+    QDir::setCurrent(testDataDir + "/cxx-modules");
+    QCOMPARE(runQbs(QbsRunParameters("resolve")), 0);
+    if (m_qbsStdout.contains("C++ modules not supported"))
+        QSKIP("The toolchain does not support C++ modules");
+    QCOMPARE(runQbs(), 0);
+
+    // A module is compiled before its importers, also across products.
+    const int partitionIndex = m_qbsStdout.indexOf("compiling math-detail.cppm");
+    const int interfaceIndex = m_qbsStdout.indexOf("compiling math.cppm");
+    const int implementationIndex = m_qbsStdout.indexOf("compiling math.cpp\n");
+    const int importerIndex = m_qbsStdout.indexOf("compiling main.cpp");
+    QVERIFY2(partitionIndex != -1 && partitionIndex < interfaceIndex, m_qbsStdout.constData());
+    QVERIFY2(interfaceIndex < implementationIndex, m_qbsStdout.constData());
+    QVERIFY2(interfaceIndex < importerIndex, m_qbsStdout.constData());
+
+    // The compiled interfaces are stored in the build directory of the product that has them.
+    const QDir libModulesDir(relativeProductBuildDir("lib") + "/cxx-modules");
+    QCOMPARE(libModulesDir.entryList(QStringList("math.*"), QDir::Files).size(), 1);
+    QCOMPARE(libModulesDir.entryList(QStringList("math-detail.*"), QDir::Files).size(), 1);
+    QVERIFY(!QFileInfo::exists(relativeProductBuildDir("app") + "/cxx-modules"));
+
+    // Changing the implementation does not affect importers.
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("math.cpp");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("compiling math.cpp\n"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("compiling math.cppm"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("compiling main.cpp"), m_qbsStdout.constData());
+
+    // Changing the interface does.
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("math.cppm", "int add(int a, int b);", "int add(int a, int b) noexcept;");
+    REPLACE_IN_FILE("math.cpp", "int add(int a, int b)", "int add(int a, int b) noexcept");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("compiling math.cppm"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("compiling main.cpp"), m_qbsStdout.constData());
+}
+
 void TestBlackbox::conanfileProbe()
 {
     QString executable = findExecutable({"conan"});
@@ -3001,6 +3128,37 @@ void TestBlackbox::overrideProjectProperties()
     QCOMPARE(runQbs(params), 0);
 }
 
+void TestBlackbox::parallelPrepareScripts()
+{
+    QDir::setCurrent(testDataDir + "/parallel-prepare-scripts");
+    const QStringList fileNames({"a", "b", "c", "d", "e", "f"});
+    const auto verifyOutputs = [this, &fileNames](const QByteArray &suffix) {
+        for (const QString &fileName : fileNames) {
+            QFile outputFile(relativeProductBuildDir("p") + '/' + fileName + ".out");
+            QVERIFY2(outputFile.open(QIODevice::ReadOnly), qPrintable(outputFile.fileName()));
+            QCOMPARE(outputFile.readAll(), fileName.toUtf8() + ".in" + suffix);
+        }
+    };
+    QbsRunParameters params(QStringList({"--parallel-prepare-scripts", "-j", "4"}));
+    QCOMPARE(runQbs(params), 0);
+    QCOMPARE(m_qbsStdout.count("generating"), fileNames.size());
+    verifyOutputs("-v1");
+
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(!m_qbsStdout.contains("generating"), m_qbsStdout.constData());
+
+    // The property request from the prepare scripts must have been recorded.
+    params.arguments << "products.p.suffix:-v2";
+    QCOMPARE(runQbs(params), 0);
+    QCOMPARE(m_qbsStdout.count("generating"), fileNames.size());
+    verifyOutputs("-v2");
+
+    params.arguments << "products.p.failFor:c.in";
+    params.expectFailure = true;
+    QVERIFY(runQbs(params) != 0);
+    QVERIFY2(m_qbsStderr.contains("failing for c.in"), m_qbsStderr.constData());
+}
+
 void TestBlackbox::pathProbe_data()
 {
     QTest::addColumn<QString>("projectFile");
@@ -4494,6 +4652,26 @@ void TestBlackbox::combinedSources()
     QVERIFY(m_qbsStdout.contains("compiling amalgamated_theapp.cpp"));
 }
 
+void TestBlackbox::combinedSourcesBatches()
+{
+    QDir::setCurrent(testDataDir + "/combined-sources-batches");
+    QCOMPARE(runQbs(QbsRunParameters("run")), 0);
+    const int batchCount = m_qbsStdout.count("compiling amalgamated_theapp_");
+    QVERIFY2(batchCount >= 2 && batchCount <= 4, m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("compiling file"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("compiling special.cpp"), m_qbsStdout.constData());
+
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("file3.cpp");
+    QCOMPARE(runQbs(), 0);
+    QCOMPARE(m_qbsStdout.count("compiling amalgamated_theapp_"), 1);
+
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("special.cpp");
+    QCOMPARE(runQbs(), 0);
+    QCOMPARE(m_qbsStdout.count("compiling amalgamated_theapp_"), 1);
+}
+
 void TestBlackbox::commandFile()
 {
     QDir::setCurrent(testDataDir + "/command-file");
@@ -4510,6 +4688,22 @@ void TestBlackbox::compilerDefinesByLanguage()
     QCOMPARE(runQbs(params), 0);
 }
 
+void TestBlackbox::jobserver()
+{
+    if (HostOsInfo::isWindowsHost())
+        QSKIP("Providing a jobserver is only supported on Unix");
+    QDir::setCurrent(testDataDir + "/jobserver");
+    QbsRunParameters params(QStringList{"--jobserver", "-j", "3"});
+    params.environment.remove("MAKEFLAGS");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("makeflags:  -j3 --jobserver-auth=fifo:"),
+             m_qbsStdout.constData());
+
+    params.arguments = QStringList{"-j", "3"};
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("makeflags: \n"), m_qbsStdout.constData());
+}
+
 void TestBlackbox::jsExtensionsFile()
 {
     QDir::setCurrent(testDataDir + "/jsextensions-file");
@@ -4813,6 +5007,27 @@ void TestBlackbox::linkerVariant()
         QVERIFY2(!m_qbsStdout.contains("-fuse-ld"), m_qbsStdout.constData());
 }
 
+void TestBlackbox::splitDwarf()
+{
+    QDir::setCurrent(testDataDir + "/split-dwarf");
+    QCOMPARE(runQbs(QbsRunParameters("resolve")), 0);
+    if (m_qbsStdout.contains("is ELF GCC: false"))
+        QSKIP("split DWARF requires GCC or Clang with an ELF target");
+    QVERIFY2(m_qbsStdout.contains("is ELF GCC: true"), m_qbsStdout.constData());
+    QCOMPARE(runQbs(QbsRunParameters("build",
+                                      QStringList{"--command-echo-mode", "command-line"})), 0);
+    QVERIFY2(m_qbsStdout.contains("-gsplit-dwarf"), m_qbsStdout.constData());
+    QStringList dwoFiles;
+    QDirIterator it(relativeProductBuildDir("p"), {"*.dwo"}, QDir::Files,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext())
+        dwoFiles << it.next();
+    QCOMPARE(dwoFiles.size(), 1);
+
+    QCOMPARE(runQbs(QbsRunParameters("clean")), 0);
+    QVERIFY2(!QFile::exists(dwoFiles.first()), qPrintable(dwoFiles.first()));
+}
+
 void TestBlackbox::lexyacc()
 {
     if (!lexYaccExist())
@@ -5856,6 +6071,57 @@ void TestBlackbox::pseudoMultiplexing()
     QCOMPARE(runQbs(), 0);
 }
 
+void TestBlackbox::queryBuildGraph()
+{
+    QDir::setCurrent(testDataDir + "/query-build-graph");
+    QCOMPARE(runQbs(), 0);
+    const QString appFilePath = QFileInfo(relativeExecutableFilePath("the-app"))
+            .absoluteFilePath();
+
+    QCOMPARE(runQbs(QbsRunParameters("query", QStringList{"dependents", "header.h"})), 0);
+    QVERIFY2(m_qbsStdout.contains("main.cpp"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("other.cpp"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains(appFilePath.toLocal8Bit()), m_qbsStdout.constData());
+
+    QCOMPARE(runQbs(QbsRunParameters("query", QStringList{"all-dependents", "header.h"})), 0);
+    QVERIFY2(m_qbsStdout.contains("main.cpp"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("other.cpp"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains(appFilePath.toLocal8Bit()), m_qbsStdout.constData());
+
+    QCOMPARE(runQbs(QbsRunParameters("query", QStringList{"tagged", "cpp"})), 0);
+    QVERIFY2(m_qbsStdout.contains("main.cpp"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("other.cpp"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("header.h"), m_qbsStdout.constData());
+
+    QCOMPARE(runQbs(QbsRunParameters("query", QStringList{"producer", appFilePath})), 0);
+    QVERIFY2(m_qbsStdout.contains("Inputs:"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("main.cpp"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("other.cpp"), m_qbsStdout.constData());
+
+    QCOMPARE(runQbs(QbsRunParameters("query", QStringList("stale"))), 0);
+    QVERIFY2(!m_qbsStdout.contains("main.cpp"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains(appFilePath.toLocal8Bit()), m_qbsStdout.constData());
+
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("header.h");
+    QCOMPARE(runQbs(QbsRunParameters("query", QStringList("stale"))), 0);
+    QVERIFY2(m_qbsStdout.contains("main.cpp"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("other.cpp"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains(appFilePath.toLocal8Bit()), m_qbsStdout.constData());
+
+    QCOMPARE(runQbs(), 0);
+    QCOMPARE(runQbs(QbsRunParameters("query", QStringList("stale"))), 0);
+    QVERIFY2(!m_qbsStdout.contains("main.cpp"), m_qbsStdout.constData());
+
+    QbsRunParameters failParams("query", QStringList{"producer", "main.cpp"});
+    failParams.expectFailure = true;
+    QVERIFY(runQbs(failParams) != 0);
+    QVERIFY2(m_qbsStderr.contains("is not generated by any rule"), m_qbsStderr.constData());
+    failParams.arguments = QStringList("whatever");
+    QVERIFY(runQbs(failParams) != 0);
+    QVERIFY2(m_qbsStderr.contains("Unknown query 'whatever'"), m_qbsStderr.constData());
+}
+
 void TestBlackbox::qbsConfig()
 {
     QbsRunParameters params("config");
@@ -6837,6 +7103,15 @@ void TestBlackbox::topLevelSearchPath()
     QCOMPARE(runQbs(params), 0);
 }
 
+void TestBlackbox::cheapJavaScriptCommands()
+{
+    QDir::setCurrent(testDataDir + "/cheap-javascript-commands");
+    QCOMPARE(runQbs(), 0);
+    QFile counterFile(relativeProductBuildDir("p") + "/counter.txt");
+    QVERIFY2(counterFile.open(QIODevice::ReadOnly), qPrintable(counterFile.errorString()));
+    QCOMPARE(counterFile.readAll().count('x'), 10000);
+}
+
 void TestBlackbox::checkProjectFilePath()
 {
     QDir::setCurrent(testDataDir + "/project_filepath_check");
@@ -6964,6 +7239,97 @@ void TestBlackbox::assembly()
     QCOMPARE(m_qbsStdout.contains("creating testd.lib"), haveMSVC);
 }
 
+static int passedTestCount(const QByteArray &output)
+{
+    const QRegularExpression summaryRegExp("Tests: (\\d+) passed");
+    const QRegularExpressionMatch match = summaryRegExp.match(QString::fromLocal8Bit(output));
+    return match.hasMatch() ? match.captured(1).toInt() : -1;
+}
+
+void TestBlackbox::autotestCommand()
+{
+    QDir::setCurrent(testDataDir + "/autotest-command");
+    QCOMPARE(runQbs({"resolve"}), 0);
+    if (m_qbsStdout.contains("targetPlatform differs from hostPlatform"))
+        QSKIP("Cannot run binaries in cross-compiled build");
+
+    // All tests are run and reported.
+    QCOMPARE(runQbs(QbsRunParameters("test", {"--json-report", "report.json",
+                                              "--junit-report", "report.xml"})), 0);
+    QCOMPARE(m_qbsStdout.count("Running test"), 2);
+    QVERIFY2(m_qbsStdout.contains("Tests: 2 passed (0 cached), 0 failed, 0 not run."),
+             m_qbsStdout.constData());
+    QFile jsonReport("report.json");
+    QVERIFY2(jsonReport.open(QIODevice::ReadOnly), qPrintable(jsonReport.errorString()));
+    QJsonObject report = QJsonDocument::fromJson(jsonReport.readAll()).object();
+    jsonReport.close();
+    QCOMPARE(report.value("passed").toInt(), 2);
+    QJsonArray tests = report.value("tests").toArray();
+    QCOMPARE(tests.size(), 2);
+    QCOMPARE(tests.at(0).toObject().value("name").toString(), QString("test-a"));
+    QCOMPARE(tests.at(0).toObject().value("runner").toString(), QString("autotest-runner"));
+    QCOMPARE(tests.at(0).toObject().value("status").toString(), QString("passed"));
+    QCOMPARE(tests.at(1).toObject().value("name").toString(), QString("test-b"));
+    QFile junitReport("report.xml");
+    QVERIFY2(junitReport.open(QIODevice::ReadOnly), qPrintable(junitReport.errorString()));
+    const QByteArray junitContents = junitReport.readAll();
+    QVERIFY2(junitContents.contains("<testsuite name=\"autotest-runner\" tests=\"2\" "
+                                    "failures=\"0\""), junitContents.constData());
+    QVERIFY2(junitContents.contains("<testcase name=\"test-b\""), junitContents.constData());
+
+    // Nothing has changed, so the results are taken from the previous run.
+    QCOMPARE(runQbs(QbsRunParameters("test")), 0);
+    QVERIFY2(!m_qbsStdout.contains("Running test"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("Tests: 2 passed (2 cached), 0 failed, 0 not run."),
+             m_qbsStdout.constData());
+
+    // Every test is run in exactly one shard. Selecting a shard does not change the
+    // build configuration.
+    QCOMPARE(runQbs(QbsRunParameters("test", {"--shard", "0/2"})), 0);
+    QVERIFY2(!m_qbsStdout.contains("Resolving"), m_qbsStdout.constData());
+    const int shard0Count = passedTestCount(m_qbsStdout);
+    QCOMPARE(runQbs(QbsRunParameters("test", {"--shard", "1/2"})), 0);
+    const int shard1Count = passedTestCount(m_qbsStdout);
+    QVERIFY(shard0Count >= 0 && shard1Count >= 0);
+    QCOMPARE(shard0Count + shard1Count, 2);
+    QbsRunParameters invalidShardParams("test", {"--shard", "2/2"});
+    invalidShardParams.expectFailure = true;
+    QVERIFY(runQbs(invalidShardParams) != 0);
+    QVERIFY2(m_qbsStderr.contains("Illegal shard specification"), m_qbsStderr.constData());
+
+    // A failing test is reported as such, and the result of the other test is still valid.
+    QCOMPARE(runQbs(QbsRunParameters("test")), 0);
+    QCOMPARE(passedTestCount(m_qbsStdout), 2);
+    QCOMPARE(runQbs(QbsRunParameters("resolve", {"products.test-b.fail:true"})), 0);
+    QbsRunParameters failParams("test", {"-k", "--json-report", "report.json"});
+    failParams.expectFailure = true;
+    QVERIFY(runQbs(failParams) != 0);
+    QVERIFY2(m_qbsStdout.contains("Running test test-b"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStderr.contains("FAIL"), m_qbsStderr.constData());
+    QVERIFY2(m_qbsStdout.contains("Tests: 1 passed (1 cached), 1 failed, 0 not run."),
+             m_qbsStdout.constData());
+    QVERIFY2(jsonReport.open(QIODevice::ReadOnly), qPrintable(jsonReport.errorString()));
+    report = QJsonDocument::fromJson(jsonReport.readAll()).object();
+    tests = report.value("tests").toArray();
+    QCOMPARE(tests.size(), 2);
+    QCOMPARE(tests.at(1).toObject().value("status").toString(), QString("failed"));
+    QCOMPARE(tests.at(1).toObject().value("exit-code").toInt(), 1);
+
+    // Failed tests are always run again.
+    failParams.arguments.clear();
+    QVERIFY(runQbs(failParams) != 0);
+    QVERIFY2(m_qbsStdout.contains("Running test test-b"), m_qbsStdout.constData());
+
+    // Without result caching, all tests are run every time.
+    QCOMPARE(runQbs(QbsRunParameters("resolve",
+                                     {"products.autotest-runner.cacheResults:false"})), 0);
+    QCOMPARE(runQbs(QbsRunParameters("test")), 0);
+    QCOMPARE(runQbs(QbsRunParameters("test")), 0);
+    QCOMPARE(m_qbsStdout.count("Running test"), 2);
+    QVERIFY2(m_qbsStdout.contains("Tests: 2 passed (0 cached), 0 failed, 0 not run."),
+             m_qbsStdout.constData());
+}
+
 void TestBlackbox::autotestWithDependencies()
 {
     QDir::setCurrent(testDataDir + "/autotest-with-dependencies");
@@ -7557,6 +7923,52 @@ void TestBlackbox::importsConflict()
     QCOMPARE(runQbs(), 0);
 }
 
+void TestBlackbox::includeConditions()
+{
+    QDir::setCurrent(testDataDir + "/include-conditions");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("compiling main.cpp"), m_qbsStdout.constData());
+
+    // A header that is only included if the feature is enabled is not a dependency.
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("feature.h");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(!m_qbsStdout.contains("compiling main.cpp"), m_qbsStdout.constData());
+
+    // A header whose inclusion depends on a macro unknown to the scanner is a dependency.
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("maybe.h");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("compiling main.cpp"), m_qbsStdout.constData());
+
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("always.h");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("compiling main.cpp"), m_qbsStdout.constData());
+
+    // Enabling the feature turns the header into a dependency.
+    QCOMPARE(runQbs(QbsRunParameters("resolve", QStringList("products.app.enableFeature:true"))),
+             0);
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("compiling main.cpp"), m_qbsStdout.constData());
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("feature.h");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("compiling main.cpp"), m_qbsStdout.constData());
+
+    // Without evaluation of conditions, every included header is a dependency.
+    QCOMPARE(runQbs(QbsRunParameters("resolve",
+                                     QStringList{"products.app.enableFeature:false",
+                                                 "products.app.evaluateConditions:false"})),
+             0);
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("compiling main.cpp"), m_qbsStdout.constData());
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("feature.h");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("compiling main.cpp"), m_qbsStdout.constData());
+}
+
 void TestBlackbox::includeLookup()
 {
     QDir::setCurrent(testDataDir + "/includeLookup");
@@ -7659,6 +8071,60 @@ void TestBlackbox::outputArtifactAutoTagging()
     QVERIFY(regularFileExists(relativeExecutableFilePath("output-artifact-auto-tagging")));
 }
 
+void TestBlackbox::outputArtifactsScriptCache()
+{
+    QDir::setCurrent(testDataDir + "/output-artifacts-script-cache");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("running outputArtifacts for a.in"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("running outputArtifacts for b.txt"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("generating a.out"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("generating b-output.out"), m_qbsStdout.constData());
+    QVERIFY2(regularFileExists(relativeProductBuildDir("p") + "/one.out"),
+             m_qbsStdout.constData());
+
+    // The rules get re-applied, but the outputArtifacts script of the first one does not
+    // run again. The second script reads its input, so its result is never re-used.
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("a.in");
+    touch("b.txt");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(!m_qbsStdout.contains("running outputArtifacts for a.in"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("running outputArtifacts for b.txt"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("generating a.out"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("generating b-output.out"), m_qbsStdout.constData());
+
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("b.txt", "b-output", "b-changed");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(!m_qbsStdout.contains("running outputArtifacts for a.in"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("running outputArtifacts for b.txt"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("generating b-changed.out"), m_qbsStdout.constData());
+
+    // The first script reads a product property.
+    QCOMPARE(runQbs(QbsRunParameters("resolve", QStringList("products.p.suffix:.o2"))), 0);
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("running outputArtifacts for a.in"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("generating a.o2"), m_qbsStdout.constData());
+
+    // The third script lists a directory, so it must see a file that was added there.
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("dir/two");
+    touch("list.lst");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("running outputArtifacts for list.lst"),
+             m_qbsStdout.constData());
+    QVERIFY2(regularFileExists(relativeProductBuildDir("p") + "/two.out"),
+             m_qbsStdout.constData());
+
+    // The accesses of a script whose result is never re-used are still tracked.
+    QCOMPARE(runQbs(QbsRunParameters("resolve", {"products.p.suffix:.o2",
+                                                 "products.p.prefix:new-"})), 0);
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(!m_qbsStdout.contains("running outputArtifacts for a.in"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("running outputArtifacts for b.txt"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("generating new-b-changed.out"), m_qbsStdout.constData());
+}
+
 void TestBlackbox::outputRedirection()
 {
     QDir::setCurrent(testDataDir + "/output-redirection");
@@ -8170,6 +8636,49 @@ void TestBlackbox::bomSources()
     QVERIFY2(m_qbsStdout.contains("compiling main.cpp"), m_qbsStdout.constData());
 }
 
+void TestBlackbox::batchPrepare()
+{
+    QDir::setCurrent(testDataDir + "/batch-prepare");
+    QCOMPARE(runQbs(), 0);
+    QCOMPARE(m_qbsStdout.count("batchPrepare called"), 1);
+    QVERIFY2(m_qbsStdout.contains("batchPrepare called with 3 entries"),
+             m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("generating a.out"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("generating b.out"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("generating c.out"), m_qbsStdout.constData());
+    QFile outFile(relativeProductBuildDir("p") + "/b.out");
+    QVERIFY2(outFile.open(QIODevice::ReadOnly), qPrintable(outFile.errorString()));
+    QCOMPARE(outFile.readAll().trimmed(), QByteArray("first: b"));
+    outFile.close();
+
+    // Only the changed input is part of the batch.
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("a.in");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("batchPrepare called with 1 entries"),
+             m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("generating a.out"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("generating b.out"), m_qbsStdout.constData());
+
+    // All entries depend on the properties accessed by the script.
+    QCOMPARE(runQbs(QbsRunParameters("resolve", QStringList("products.p.prefix:second"))), 0);
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("batchPrepare called with 3 entries"),
+             m_qbsStdout.constData());
+    QVERIFY2(outFile.open(QIODevice::ReadOnly), qPrintable(outFile.errorString()));
+    QCOMPARE(outFile.readAll().trimmed(), QByteArray("second: b"));
+    outFile.close();
+
+    // Changing the batchPrepare script re-runs it for all entries.
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("batch-prepare.qbs", "product.prefix + \": \"", "product.prefix + \"= \"");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("batchPrepare called with 3 entries"),
+             m_qbsStdout.constData());
+    QVERIFY2(outFile.open(QIODevice::ReadOnly), qPrintable(outFile.errorString()));
+    QCOMPARE(outFile.readAll().trimmed(), QByteArray("second= b"));
+}
+
 void TestBlackbox::buildDataOfDisabledProduct()
 {
     QDir::setCurrent(testDataDir + QLatin1String("/build-data-of-disabled-product"));
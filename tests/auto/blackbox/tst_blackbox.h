@@ -50,6 +50,7 @@ private slots:
     void artifactsMapRaceCondition();
     void artifactScanning();
     void assembly();
+    void autotestCommand();
     void autotestWithDependencies();
     void autotestTimeout();
     void autotestTimeout_data();
@@ -57,6 +58,7 @@ private slots:
     void autotests();
     void auxiliaryInputsFromDependencies();
     void badInterpreter();
+    void batchPrepare();
     void bomSources();
     void buildDataOfDisabledProduct();
     void buildDirectories();
@@ -64,6 +66,7 @@ private slots:
     void buildGraphVersions();
     void buildVariantDefaults_data();
     void buildVariantDefaults();
+    void cachedPropertyMapValues();
     void capnproto();
     void capnproto_data();
     void changedFiles_data();
@@ -73,6 +76,8 @@ private slots:
     void changeInDisabledProduct();
     void changeInImportedFile();
     void changeTrackingAndMultiplexing();
+    void changeTrackingForBuildSystemFiles();
+    void cheapJavaScriptCommands();
     void checkProjectFilePath();
     void checkTimestamps();
     void chooseModuleInstanceByPriority();
@@ -80,6 +85,7 @@ private slots:
     void clean();
     void cli();
     void combinedSources();
+    void combinedSourcesBatches();
     void commandFile();
     void compilerDefinesByLanguage();
     void concurrentExecutor();
@@ -89,6 +95,7 @@ private slots:
     void conflictingArtifacts();
     void cxxLanguageVersion();
     void cxxLanguageVersion_data();
+    void cxxModules();
     void conanfileProbe();
     void cpuFeatures();
     void dependenciesProperty();
@@ -142,6 +149,7 @@ private slots:
     void importSearchPath();
     void importingProduct();
     void importsConflict();
+    void includeConditions();
     void includeLookup();
     void innoSetup();
     void innoSetupDependencies();
@@ -167,6 +175,7 @@ private slots:
     void invalidInstallDir();
     void invalidLibraryNames();
     void invalidLibraryNames_data();
+    void jobserver();
     void jsExtensionsFile();
     void jsExtensionsFileInfo();
     void jsExtensionsProcess();
@@ -224,8 +233,10 @@ private slots:
     void nsisDependencies();
     void outOfDateMarking();
     void outputArtifactAutoTagging();
+    void outputArtifactsScriptCache();
     void outputRedirection();
     void overrideProjectProperties();
+    void parallelPrepareScripts();
     void pathProbe_data();
     void pathProbe();
     void pchChangeTracking();
@@ -261,6 +272,7 @@ private slots:
     void qbsSession();
     void qbsVersion();
     void qtBug51237();
+    void queryBuildGraph();
     void radAfterIncompleteBuild();
     void radAfterIncompleteBuild_data();
     void recursiveRenaming();
@@ -300,6 +312,7 @@ private slots:
     void separateDebugInfo();
     void sevenZip();
     void sourceArtifactInInputsFromDependencies();
+    void splitDwarf();
     void staticLibWithoutSources();
     void suspiciousCalls();
     void suspiciousCalls_data();
@@ -42,6 +42,10 @@ private slots:
     void initTestCase();
     void jobLimits_data();
     void jobLimits();
+    void memoryBudget_data();
+    void memoryBudget();
+    void measuredMemoryUsage();
+    void sharedJobBudget();
 };
 
 TestBlackboxJobLimits::TestBlackboxJobLimits()
@@ -181,6 +185,71 @@ void TestBlackboxJobLimits::jobLimits()
         QCOMPARE(m_qbsStdout.count("Running tool"), 5);
 }
 
+void TestBlackboxJobLimits::memoryBudget_data()
+{
+    QTest::addColumn<int>("expectedMemoryUsage");
+    QTest::addColumn<bool>("expectSuccess");
+    QTest::newRow("commands fit into budget together") << 100 << false;
+    QTest::newRow("commands exceed budget together") << 600 << true;
+    QTest::newRow("command exceeds budget on its own") << 2000 << true;
+}
+
+void TestBlackboxJobLimits::memoryBudget()
+{
+    QDir::setCurrent(testDataDir + "/memory-budget");
+    QFETCH(int, expectedMemoryUsage);
+    QFETCH(bool, expectSuccess);
+    QbsRunParameters params(QStringList{"--memory-budget", "1000",
+            "project.expectedMemoryUsage:" + QString::number(expectedMemoryUsage)});
+    params.expectFailure = !expectSuccess;
+    rmDirR(relativeBuildDir());
+    const int exitCode = runQbs(params);
+    if (expectSuccess)
+        QCOMPARE(exitCode, 0);
+    else if (exitCode == 0)
+        QSKIP("no failure with budget not exhausted, result inconclusive");
+    else
+        QVERIFY2(m_qbsStderr.contains("exclusive"), m_qbsStderr.constData());
+    if (exitCode == 0)
+        QCOMPARE(m_qbsStdout.count("Running tool"), 5);
+}
+
+void TestBlackboxJobLimits::measuredMemoryUsage()
+{
+    if (!qbs::Internal::HostOsInfo::isLinuxHost())
+        QSKIP("The memory usage of processes is only measured on Linux");
+
+    // Nothing is declared, so all the tool's memory usage must come from the measurements
+    // taken during the first, serialized build.
+    QDir::setCurrent(testDataDir + "/memory-budget");
+    rmDirR(relativeBuildDir());
+    QCOMPARE(runQbs(QbsRunParameters(QStringList{"-j", "1", "project.toolMemoryUsage:300"})), 0);
+    QCOMPARE(m_qbsStdout.count("Running tool"), 5);
+
+    // Two tool instances do not fit into the budget, so they must not run at the same time.
+    waitForNewTimestamp(testDataDir);
+    touch("../job-limits/main.cpp");
+    QCOMPARE(runQbs(QbsRunParameters(QStringList{"--memory-budget", "500"})), 0);
+    QVERIFY2(!m_qbsStderr.contains("exclusive"), m_qbsStderr.constData());
+    QCOMPARE(m_qbsStdout.count("Running tool"), 5);
+}
+
+void TestBlackboxJobLimits::sharedJobBudget()
+{
+    // Both configurations draw from the same job budget, so with only one job allowed,
+    // no two instances of the tool can run at the same time.
+    QDir::setCurrent(testDataDir + "/shared-job-budget");
+    QbsRunParameters params(QStringList{"-j", "1",
+                                        "config:one", "profile:" + profileName(),
+                                        "config:two", "profile:" + profileName()});
+    params.profile.clear();
+    rmDirR(relativeBuildDir("one"));
+    rmDirR(relativeBuildDir("two"));
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(!m_qbsStderr.contains("exclusive"), m_qbsStderr.constData());
+    QCOMPARE(m_qbsStdout.count("Running tool"), 10);
+}
+
 QTEST_MAIN(TestBlackboxJobLimits)
 
 #include <tst_blackboxjoblimits.moc>
@@ -0,0 +1,21 @@
+TARGET = tst_cppscanner
+
+CPP_SCANNER_DIR = ../../../src/plugins/scanner/cpp
+DEFINES += CPLUSPLUS_NO_PARSER
+INCLUDEPATH += $$CPP_SCANNER_DIR
+
+SOURCES = tst_cppscanner.cpp \
+    $$CPP_SCANNER_DIR/Lexer.cpp \
+    $$CPP_SCANNER_DIR/Token.cpp \
+    $$CPP_SCANNER_DIR/directivescanengine.cpp \
+    $$CPP_SCANNER_DIR/lexerscanengine.cpp \
+    $$CPP_SCANNER_DIR/moduledeclarationparser.cpp \
+    $$CPP_SCANNER_DIR/preprocessorconditions.cpp
+HEADERS = tst_cppscanner.h \
+    $$CPP_SCANNER_DIR/Lexer.h \
+    $$CPP_SCANNER_DIR/Token.h \
+    $$CPP_SCANNER_DIR/cppscanengines.h \
+    $$CPP_SCANNER_DIR/moduledeclarationparser.h \
+    $$CPP_SCANNER_DIR/preprocessorconditions.h
+
+include(../auto.pri)
@@ -0,0 +1,380 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "tst_cppscanner.h"
+
+#include <plugins/scanner/cpp/cppscanengines.h>
+#include <plugins/scanner/cpp/preprocessorconditions.h>
+
+#include <QtCore/qbytearraylist.h>
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qdiriterator.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+
+#include <QtTest/qtest.h>
+
+#include <memory>
+
+using ScanFunction = void (*)(char *, char *, const CppScanParameters &, CppScanResults &);
+
+static CppScanResults scan(ScanFunction scanFunction, QByteArray &content,
+                           CppScanParameters parameters, const char *conditionMacros = nullptr)
+{
+    CppScanResults results;
+    std::unique_ptr<PreprocessorConditions> conditions;
+    if (conditionMacros) {
+        conditions = std::make_unique<PreprocessorConditions>(conditionMacros);
+        parameters.conditions = conditions.get();
+    }
+    scanFunction(content.data(), content.data() + content.size(), parameters, results);
+    return results;
+}
+
+static QByteArray describe(const CppScanResults &results, const QByteArray &content)
+{
+    QByteArray description = "qobject: " + QByteArray::number(results.hasQObjectMacro)
+            + ", plugin: " + QByteArray::number(results.hasPluginMetaDataMacro);
+    for (const ScanResult &result : results.includedFiles) {
+        description += "\n" + QByteArray::number(result.flags) + ' '
+                + QByteArray::number(int(result.fileName - content.constData())) + ' '
+                + QByteArray(result.fileName, result.size);
+    }
+    description += "\nmodule: " + results.moduleName + ", imports: "
+            + results.importedModules.join(' ');
+    return description;
+}
+
+// Returns a description of the first difference between the two engines, if there is one.
+static QString compareEngines(QByteArray &content)
+{
+    static const char conditionMacros[] = "#define __linux__ 1\n#define LEVEL 2\n#undef _WIN32\n";
+    for (int combination = 0; combination < 32; ++combination) {
+        CppScanParameters parameters;
+        parameters.scanForDependencies = combination & 1;
+        parameters.scanForFileTags = combination & 2;
+        parameters.stopAtQObjectMacro = combination & 4;
+        parameters.scanForModules = combination & 16;
+        const char * const macros = combination & 8 ? conditionMacros : nullptr;
+        const QByteArray expected
+                = describe(scan(&scanCppFileWithLexer, content, parameters, macros), content);
+        const QByteArray actual
+                = describe(scan(&scanCppFileDirectives, content, parameters, macros), content);
+        if (actual != expected) {
+            return QStringLiteral("parameter combination %1:\nexpected:\n%2\nactual:\n%3")
+                    .arg(combination)
+                    .arg(QString::fromLatin1(expected), QString::fromLatin1(actual));
+        }
+    }
+    return {};
+}
+
+void TestCppScanner::enginesAgree_data()
+{
+    QTest::addColumn<QByteArray>("content");
+    QTest::addColumn<QByteArrayList>("includes");
+    QTest::addColumn<bool>("hasQObjectMacro");
+
+    QTest::newRow("plain") << QByteArray("#include <a.h>\n#include \"b.h\"\n#import <c.h>\n")
+                           << QByteArrayList{"a.h", "b.h", "c.h"} << false;
+    QTest::newRow("whitespace") << QByteArray("  #  include\t<a.h>\n\t# import \"b.h\"")
+                                << QByteArrayList{"a.h", "b.h"} << false;
+    QTest::newRow("not at line start") << QByteArray("int i; #include <a.h>\n")
+                                       << QByteArrayList() << false;
+    QTest::newRow("line comments") << QByteArray("// #include <a.h>\n#include <b.h> // Q_OBJECT\n")
+                                   << QByteArrayList{"b.h"} << false;
+    QTest::newRow("block comments")
+            << QByteArray("/* #include <a.h>\nQ_OBJECT */ #include <b.h>\n"
+                          "/**/#include <c.h>\n/***/ Q_GADGET /*! x */")
+            << QByteArrayList{"b.h", "c.h"} << true;
+    QTest::newRow("string literals")
+            << QByteArray("const char *s = \"\\\"\\n#include <a.h> Q_OBJECT\";\n"
+                          "char c = '\"';\n#include <b.h>\n")
+            << QByteArrayList{"b.h"} << false;
+    QTest::newRow("wide literals span lines")
+            << QByteArray("auto s = L\"abc\n#include <a.h>\n\";\n#include <b.h>\n"
+                          "auto t = xL\"abc\n#include <c.h>\n")
+            << QByteArrayList{"b.h", "c.h"} << false;
+    QTest::newRow("line continuation")
+            << QByteArray("int i; \\\n#include <a.h>\n#define X \\\n  Q_OBJECT\n#include <b.h>\n")
+            << QByteArrayList{"b.h"} << true;
+    QTest::newRow("macro definitions")
+            << QByteArray("#define Q_OBJECT\n# define Q_PLUGIN_METADATA(x)\n"
+                          "#undef Q_OBJECT\n#ifdef Q_GADGET\n")
+            << QByteArrayList() << true;
+    QTest::newRow("macro usage") << QByteArray("class C {\n    Q_OBJECT\n};\n")
+                                 << QByteArrayList() << true;
+    QTest::newRow("macro inside identifiers and numbers")
+            << QByteArray("MY_Q_OBJECT x; Q_OBJECTS y; 1.Q_OBJECT; 1e+Q_GADGET; 0xQ_OBJECT;")
+            << QByteArrayList() << false;
+    QTest::newRow("macro after operators")
+            << QByteArray("a-Q_OBJECT; b.Q_GADGET;") << QByteArrayList() << true;
+    QTest::newRow("digit separators") << QByteArray("int i = 1'000;\n#include <a.h>\n'\n")
+                                      << QByteArrayList{"a.h"} << false;
+    QTest::newRow("unterminated") << QByteArray("#include \"a.h\n#include <b.h")
+                                  << QByteArrayList{"a.", "b."} << false;
+    QTest::newRow("nul byte") << QByteArray("#include <a.h>\n\0#include <b.h>\n", 30)
+                              << QByteArrayList{"a.h"} << false;
+    QTest::newRow("empty") << QByteArray() << QByteArrayList() << false;
+}
+
+void TestCppScanner::enginesAgree()
+{
+    QFETCH(QByteArray, content);
+    QFETCH(QByteArrayList, includes);
+    QFETCH(bool, hasQObjectMacro);
+
+    const QString difference = compareEngines(content);
+    QVERIFY2(difference.isEmpty(), qPrintable(difference));
+
+    CppScanParameters parameters;
+    parameters.scanForDependencies = true;
+    parameters.scanForFileTags = true;
+    const CppScanResults results = scan(&scanCppFileDirectives, content, parameters);
+    QByteArrayList actualIncludes;
+    for (const ScanResult &result : results.includedFiles)
+        actualIncludes << QByteArray(result.fileName, result.size);
+    QCOMPARE(actualIncludes, includes);
+    QCOMPARE(results.hasQObjectMacro, hasQObjectMacro);
+}
+
+// All C-family files that come with qbs, which includes the test data of all autotests.
+void TestCppScanner::enginesAgreeOnSourceTree()
+{
+    static const QStringList nameFilters{"*.c", "*.cpp", "*.cxx", "*.h", "*.hpp", "*.m", "*.mm"};
+    int fileCount = 0;
+    QDirIterator it(QStringLiteral(SRCDIR "/../../.."), nameFilters, QDir::Files,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        QFile file(it.next());
+        QVERIFY2(file.open(QIODevice::ReadOnly), qPrintable(file.errorString()));
+        QByteArray content = file.readAll();
+        const QString difference = compareEngines(content);
+        QVERIFY2(difference.isEmpty(),
+                 qPrintable(file.fileName() + QLatin1String(": ") + difference));
+        ++fileCount;
+    }
+    QVERIFY(fileCount > 0);
+}
+
+void TestCppScanner::preprocessorConditions_data()
+{
+    QTest::addColumn<QByteArray>("macros");
+    QTest::addColumn<QByteArray>("content");
+    QTest::addColumn<QByteArrayList>("includes");
+    QTest::addColumn<QByteArrayList>("queriedMacros");
+
+    const QByteArray linuxMacros = "#define __linux__ 1\n#undef _WIN32\n#undef __APPLE__\n";
+    QTest::newRow("platform")
+            << linuxMacros
+            << QByteArray("#ifdef _WIN32\n#include <windows.h>\n#elif defined(__APPLE__)\n"
+                          "#include <mac.h>\n#elif __linux__\n#include <linux.h>\n#else\n"
+                          "#include <other.h>\n#endif\n")
+            << QByteArrayList{"linux.h"} << QByteArrayList{"_WIN32", "__APPLE__", "__linux__"};
+    QTest::newRow("unknown macros")
+            << linuxMacros
+            << QByteArray("#ifndef HEADER_H\n#define HEADER_H\n#if FEATURE\n#include <a.h>\n"
+                          "#else\n#include <b.h>\n#endif\n#ifdef _WIN32\n#include <c.h>\n"
+                          "#endif\n#endif\n")
+            << QByteArrayList{"a.h", "b.h"} << QByteArrayList{"HEADER_H", "FEATURE", "_WIN32"};
+    QTest::newRow("macros defined in the file")
+            << QByteArray()
+            << QByteArray("#define ON 1\n#define OFF 0\n#define ALIAS OFF\n#if ON\n#include <a.h>\n"
+                          "#endif\n#if ALIAS\n#include <b.h>\n#endif\n#undef ON\n"
+                          "#ifdef ON\n#include <c.h>\n#endif\n")
+            << QByteArrayList{"a.h"} << QByteArrayList();
+    QTest::newRow("definitions in possibly unreachable code")
+            << QByteArray()
+            << QByteArray("#define X 0\n#if UNKNOWN\n#undef X\n#define X 1\n#endif\n"
+                          "#if X\n#include <a.h>\n#endif\n")
+            << QByteArrayList{"a.h"} << QByteArrayList{"UNKNOWN"};
+    QTest::newRow("nested groups")
+            << QByteArray("#define A 1\n#define B 0\n")
+            << QByteArray("#if B\n#  if A\n#    include <a.h>\n#  endif\n#elif A\n"
+                          "#  include <b.h>\n#  if !A\n#    include <c.h>\n#  endif\n#else\n"
+                          "#  include <d.h>\n#endif\n")
+            << QByteArrayList{"b.h"} << QByteArrayList{"B", "A"};
+    QTest::newRow("arithmetic")
+            << QByteArray("#define VERSION 0x050F02\n")
+            << QByteArray("#if VERSION >= 0x060000\n#include <a.h>\n#endif\n"
+                          "#if (VERSION >> 16) == 5 && VERSION % 256 == 2 ? 1 : 0\n"
+                          "#include <b.h>\n#endif\n#if -1 > 0u\n#include <c.h>\n#endif\n"
+                          "#if 1 / 0\n#include <d.h>\n#endif\n")
+            << QByteArrayList{"b.h", "c.h", "d.h"} << QByteArrayList{"VERSION"};
+    QTest::newRow("short circuit")
+            << QByteArray("#define ZERO 0\n")
+            << QByteArray("#if ZERO && UNKNOWN\n#include <a.h>\n#endif\n"
+                          "#if !ZERO || UNKNOWN\n#include <b.h>\n#endif\n")
+            << QByteArrayList{"b.h"} << QByteArrayList{"ZERO", "UNKNOWN"};
+    QTest::newRow("function-like macros")
+            << QByteArray("#define CHECK(x) x\n")
+            << QByteArray("#if CHECK(0)\n#include <a.h>\n#endif\n"
+                          "#if __has_include(<b.h>)\n#include <b.h>\n#endif\n")
+            << QByteArrayList{"a.h", "b.h"} << QByteArrayList{"CHECK", "__has_include"};
+    QTest::newRow("comments and continuations")
+            << QByteArray("#define ZERO 0\n")
+            << QByteArray("#if /* ONE */ ZERO \\\n  || ZERO // || 1\n#include <a.h>\n#endif\n")
+            << QByteArrayList() << QByteArrayList{"ZERO"};
+}
+
+void TestCppScanner::preprocessorConditions()
+{
+    QFETCH(QByteArray, macros);
+    QFETCH(QByteArray, content);
+    QFETCH(QByteArrayList, includes);
+    QFETCH(QByteArrayList, queriedMacros);
+
+    PreprocessorConditions conditions(macros.constData());
+    CppScanParameters parameters;
+    parameters.scanForDependencies = true;
+    parameters.conditions = &conditions;
+    CppScanResults results;
+    scanCppFileDirectives(content.data(), content.data() + content.size(), parameters, results);
+    QByteArrayList actualIncludes;
+    for (const ScanResult &result : results.includedFiles)
+        actualIncludes << QByteArray(result.fileName, result.size);
+    QCOMPARE(actualIncludes, includes);
+    const QByteArrayList actualQueriedMacros(conditions.queriedMacros().cbegin(),
+                                             conditions.queriedMacros().cend());
+    QCOMPARE(actualQueriedMacros, queriedMacros);
+}
+
+void TestCppScanner::moduleDeclarations_data()
+{
+    QTest::addColumn<QByteArray>("content");
+    QTest::addColumn<QByteArray>("moduleName");
+    QTest::addColumn<QByteArrayList>("importedModules");
+    QTest::addColumn<QByteArrayList>("includes");
+
+    QTest::newRow("interface unit")
+            << QByteArray("module;\n#include <a.h>\nexport module lib.core;\nimport std;\n"
+                          "export import lib.util;\nimport :detail;\n")
+            << QByteArray("lib.core") << QByteArrayList{"std", "lib.util", "lib.core:detail"}
+            << QByteArrayList{"a.h"};
+    QTest::newRow("implementation unit")
+            << QByteArray("module lib.core;\nimport lib.extra;\nmodule :private;\n")
+            << QByteArray("lib.core") << QByteArrayList{"lib.core", "lib.extra"}
+            << QByteArrayList();
+    QTest::newRow("partitions")
+            << QByteArray("export module m:part;\nimport :other;\n")
+            << QByteArray("m:part") << QByteArrayList{"m:other"} << QByteArrayList();
+    QTest::newRow("header units")
+            << QByteArray("import <vector>;\nexport import \"local.h\";\n")
+            << QByteArray() << QByteArrayList() << QByteArrayList{"vector", "local.h"};
+    QTest::newRow("whitespace and comments")
+            << QByteArray("  import /* x */ a . b ; // y\nexport\nimport c;\n")
+            << QByteArray() << QByteArrayList{"a.b", "c"} << QByteArrayList();
+    QTest::newRow("not a declaration")
+            << QByteArray("int import = 1;\nimport = 2;\nimport(x);\nimport a\n;\n"
+                          "import a::b;\nimport a:b;\nimport :p;\nmodule.f();\n"
+                          "// import c;\n/*\nimport d;\n*/\n")
+            << QByteArray() << QByteArrayList() << QByteArrayList();
+}
+
+void TestCppScanner::moduleDeclarations()
+{
+    QFETCH(QByteArray, content);
+    QFETCH(QByteArray, moduleName);
+    QFETCH(QByteArrayList, importedModules);
+    QFETCH(QByteArrayList, includes);
+
+    CppScanParameters parameters;
+    parameters.scanForDependencies = true;
+    parameters.scanForModules = true;
+    const CppScanResults results = scan(&scanCppFileDirectives, content, parameters);
+    QCOMPARE(results.moduleName, moduleName);
+    QCOMPARE(results.importedModules, importedModules);
+    QByteArrayList actualIncludes;
+    for (const ScanResult &result : results.includedFiles)
+        actualIncludes << QByteArray(result.fileName, result.size);
+    QCOMPARE(actualIncludes, includes);
+}
+
+void TestCppScanner::scanPerformance_data()
+{
+    QTest::addColumn<bool>("useLexer");
+    QTest::addColumn<bool>("scanForFileTags");
+
+    QTest::newRow("lexer, dependencies") << true << false;
+    QTest::newRow("directives, dependencies") << false << false;
+    QTest::newRow("lexer, dependencies and file tags") << true << true;
+    QTest::newRow("directives, dependencies and file tags") << false << true;
+}
+
+// Mimics a big header as generated by protoc.
+void TestCppScanner::scanPerformance()
+{
+    QFETCH(bool, useLexer);
+    QFETCH(bool, scanForFileTags);
+
+    static const QByteArray block =
+            "// Generated by the protocol buffer compiler.  DO NOT EDIT!\n"
+            "#include <google/protobuf/message.h>\n"
+            "#include \"foo/bar.pb.h\"\n"
+            "namespace pkg {\n"
+            "class Message final : public ::google::protobuf::Message "
+            "/* @@protoc_insertion_point(class_definition:pkg.Message) */ {\n"
+            " public:\n"
+            "  inline Message() : Message(nullptr) {}\n"
+            "  static constexpr char kName[] = \"pkg.Message\";\n"
+            "  // optional int64 value = 1;\n"
+            "  void clear_value();\n"
+            "  ::PROTOBUF_NAMESPACE_ID::int64 value() const;\n"
+            "  void set_value(::PROTOBUF_NAMESPACE_ID::int64 value);\n"
+            "  double ratio_ = 1.5e+3;\n"
+            "};\n"
+            "}  // namespace pkg\n";
+    QByteArray content = block.repeated(2 * 1024 * 1024 / block.size());
+
+    CppScanParameters parameters;
+    parameters.scanForDependencies = true;
+    parameters.scanForFileTags = scanForFileTags;
+    const ScanFunction scanFunction = useLexer ? &scanCppFileWithLexer : &scanCppFileDirectives;
+    QBENCHMARK {
+        const CppScanResults results = scan(scanFunction, content, parameters);
+        QVERIFY(!results.includedFiles.empty());
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    TestCppScanner tc;
+    return QTest::qExec(&tc, argc, argv);
+}
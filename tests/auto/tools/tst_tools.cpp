@@ -48,23 +48,31 @@
 #include <tools/fileinfo.h>
 #include <tools/filesaver.h>
 #include <tools/hostosinfo.h>
+#include <tools/pathatom.h>
 #include <tools/processutils.h>
 #include <tools/profile.h>
+#include <tools/profiling.h>
 #include <tools/set.h>
 #include <tools/settings.h>
 #include <tools/setupprojectparameters.h>
+#include <tools/slaballocator.h>
 #include <tools/stringutils.h>
 #include <tools/version.h>
 
 #include <QtCore/qdir.h>
 #include <QtCore/qfile.h>
 #include <QtCore/qfileinfo.h>
+#include <QtCore/qjsonarray.h>
 #include <QtCore/qsettings.h>
 #include <QtCore/qtemporarydir.h>
 #include <QtCore/qtemporaryfile.h>
 
 #include <QtTest/qtest.h>
 
+#include <memory>
+#include <thread>
+#include <vector>
+
 using namespace qbs;
 using namespace qbs::Internal;
 
@@ -249,6 +257,48 @@ void TestTools::fileCaseCheck()
         QVERIFY(!FileInfo::isFileCaseCorrect(upperFilePath));
 }
 
+void TestTools::testProfiler()
+{
+    {
+        // No active profiler, must be a no-op.
+        ProfilingScope scope("nothing");
+    }
+
+    Profiler profiler;
+    profiler.setAttribute(QStringLiteral("activity"), QStringLiteral("test"));
+    {
+        const Profiler::Activation activation(&profiler);
+        ProfilingScope outerScope("outer");
+        slabDeallocate(slabAllocate(64), 64);
+        for (int i = 0; i < 3; ++i) {
+            ProfilingScope innerScope("inner", QStringLiteral("a"));
+        }
+        ProfilingScope lazyScope("inner", [] { return QStringLiteral("b"); });
+        lazyScope.stop();
+        lazyScope.stop();
+    }
+    {
+        ProfilingScope scope("not recorded");
+    }
+
+    const QJsonObject data = profiler.toJson();
+    QCOMPARE(data.value("activity").toString(), QStringLiteral("test"));
+    const QJsonArray scopes = data.value("scopes").toArray();
+    QCOMPARE(scopes.size(), 1);
+    const QJsonObject outer = scopes.first().toObject();
+    QCOMPARE(outer.value("name").toString(), QStringLiteral("outer"));
+    QCOMPARE(outer.value("count").toInt(), 1);
+    QVERIFY(outer.value("wall-time-ms").toDouble() >= 0);
+    QVERIFY(outer.value("allocated-bytes").toInt() >= 64);
+    const QJsonArray children = outer.value("children").toArray();
+    QCOMPARE(children.size(), 2);
+    QCOMPARE(children.at(0).toObject().value("name").toString(), QStringLiteral("inner:a"));
+    QCOMPARE(children.at(0).toObject().value("count").toInt(), 3);
+    QCOMPARE(children.at(1).toObject().value("name").toString(), QStringLiteral("inner:b"));
+    QCOMPARE(children.at(1).toObject().value("count").toInt(), 1);
+    QVERIFY(!children.at(0).toObject().contains("children"));
+}
+
 void TestTools::testProfiles()
 {
     TemporaryProfile tpp("parent", m_settings);
@@ -292,6 +342,72 @@ void TestTools::testProfiles()
     QVERIFY(errorInfo.hasError());
 }
 
+namespace {
+class SlabObject : public SlabAllocated
+{
+public:
+    virtual ~SlabObject() = default;
+    QString name;
+};
+
+class LargerSlabObject : public SlabObject
+{
+public:
+    qint64 values[10] = {};
+};
+} // namespace
+
+void TestTools::testSlabAllocator()
+{
+    if (qEnvironmentVariableIsSet("QBS_NO_SLAB_ALLOCATION"))
+        QSKIP("Slab allocation disabled");
+
+    const auto liveObjectCount = [] { return SlabAllocatorStatistics::current().liveObjectCount; };
+    const auto chunkCount = [] { return SlabAllocatorStatistics::current().chunkCount; };
+    const std::size_t initialCount = liveObjectCount();
+    std::vector<SlabObject *> objects;
+    Set<const void *> addresses;
+    for (int i = 0; i < 10000; ++i) {
+        SlabObject * const object = i % 2 == 0 ? new SlabObject : new LargerSlabObject;
+        object->name = QString::number(i);
+        QCOMPARE(reinterpret_cast<quintptr>(object) % alignof(std::max_align_t), quintptr(0));
+        QVERIFY(addresses.insert(object).second);
+        objects.push_back(object);
+    }
+    QCOMPARE(liveObjectCount(), initialCount + 10000);
+    for (int i = 0; i < 10000; ++i)
+        QCOMPARE(objects.at(i)->name, QString::number(i));
+
+    // Deleting through the base class must hand the memory back to the right slab.
+    SlabObject * const larger = objects.back();
+    delete larger;
+    SlabObject * const reused = new LargerSlabObject;
+    QCOMPARE(reused, larger);
+    objects.back() = reused;
+
+    for (SlabObject * const object : objects)
+        delete object;
+    QCOMPARE(liveObjectCount(), initialCount);
+
+    // Objects can be freed from other threads, and the chunks of a finished thread
+    // go away with their last object.
+    const std::size_t chunkCountBeforeThread = chunkCount();
+    objects.clear();
+    std::thread([&objects] {
+        for (int i = 0; i < 10000; ++i)
+            objects.push_back(new SlabObject);
+    }).join();
+    QVERIFY(chunkCount() > chunkCountBeforeThread);
+    QCOMPARE(liveObjectCount(), initialCount + 10000);
+    for (SlabObject * const object : objects)
+        delete object;
+    QCOMPARE(liveObjectCount(), initialCount);
+    QCOMPARE(chunkCount(), chunkCountBeforeThread);
+
+    const std::shared_ptr<SlabObject> shared = makeSlabShared(new SlabObject);
+    QVERIFY(liveObjectCount() >= initialCount + 1);
+}
+
 void TestTools::testSettingsMigration()
 {
     QFETCH(QString, baseDir);
@@ -420,6 +536,48 @@ void TestTools::testBuildConfigMerging()
     QCOMPARE(finalCppMap.value(QStringLiteral("treatWarningsAsErrors")).toBool(), true);
 }
 
+void TestTools::testPathAtoms()
+{
+    QVERIFY(PathAtom::intern(QString()).isNull());
+    QCOMPARE(PathAtom::intern(QString()), PathAtom());
+    QCOMPARE(PathAtom().toString(), QString());
+    QVERIFY(PathAtom::find(QString()));
+
+    const QString dirPath = QStringLiteral("/some/dir/only/used/by/testPathAtoms");
+    QVERIFY(!PathAtom::find(dirPath));
+    const PathAtom atom = PathAtom::intern(dirPath);
+    QVERIFY(!atom.isNull());
+    QCOMPARE(atom.toString(), dirPath);
+
+    // Equal strings yield the same atom, no matter where they come from.
+    QString copy = QStringLiteral("/some/dir/only/used/by/");
+    copy += QStringLiteral("testPathAtoms");
+    QCOMPARE(PathAtom::intern(copy), atom);
+    QCOMPARE(*PathAtom::find(copy), atom);
+    QCOMPARE(PathAtom::intern(copy).hash(), atom.hash());
+    QVERIFY(PathAtom::intern(dirPath + QLatin1Char('2')) != atom);
+
+    // An entry goes away with the last atom referring to it.
+    const QString otherDirPath = QStringLiteral("/some/other/dir/only/used/by/testPathAtoms");
+    {
+        PathAtom otherAtom = PathAtom::intern(otherDirPath);
+        {
+            const PathAtom copy = otherAtom;
+            otherAtom = PathAtom();
+            QVERIFY(PathAtom::find(otherDirPath));
+        }
+        QVERIFY(!PathAtom::find(otherDirPath));
+        otherAtom = PathAtom::intern(otherDirPath);
+        PathAtom movedAtom = std::move(otherAtom);
+        QVERIFY(otherAtom.isNull());
+        QCOMPARE(movedAtom.toString(), otherDirPath);
+    }
+    QVERIFY(!PathAtom::find(otherDirPath));
+    QVERIFY(PathAtom::find(dirPath));
+    QVERIFY(!PathAtom::find(dirPath + QLatin1Char('2')));
+    QVERIFY(PathAtom::find(QString()));
+}
+
 void TestTools::testProcessNameByPid()
 {
     QCOMPARE(qAppName(), processNameByPid(QCoreApplication::applicationPid()));
@@ -65,8 +65,11 @@ private slots:
     void fileCaseCheck();
     void testBuildConfigMerging();
     void testFileInfo();
+    void testPathAtoms();
     void testProcessNameByPid();
+    void testProfiler();
     void testProfiles();
+    void testSlabAllocator();
     void testSettingsMigration();
     void testSettingsMigration_data();
 
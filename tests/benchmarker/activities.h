@@ -29,13 +29,34 @@
 #define QBS_BENCHMARKER_ACTIVITY_H
 
 #include <QtCore/qflags.h>
+#include <QtCore/qstring.h>
+
+#include <vector>
 
 namespace qbsBenchmarker {
 
-enum Activity { ActivityResolving = 1, ActivityRuleExecution = 2, ActivityNullBuild = 4 };
+enum Activity {
+    ActivityResolving = 1,
+    ActivityRuleExecution = 2,
+    ActivityNullBuild = 4,
+    ActivityIncrementalBuild = 8,
+    ActivityBuildGraphLoadStore = 16,
+    ActivityDependencyScanning = 32,
+    ActivityInstall = 64,
+    ActivityClean = 128,
+    ActivityProjectData = 256
+};
 Q_DECLARE_FLAGS(Activities, Activity)
 Q_DECLARE_OPERATORS_FOR_FLAGS(Activities)
 
+// In the order in which results get reported.
+const std::vector<Activity> &allActivities();
+
+// The identifier used on the command line, in file names and in JSON output.
+QString activityId(Activity activity);
+
+QString activityDisplayName(Activity activity);
+
 } // namespace qbsBenchmarker
 
 #endif // Include guard.
@@ -0,0 +1,158 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#include "activityrunner.h"
+
+#include "exception.h"
+#include "runsupport.h"
+
+#include <QtCore/qdir.h>
+#include <QtCore/qjsondocument.h>
+#include <QtCore/qjsonobject.h>
+
+namespace qbsBenchmarker {
+
+static QByteArray sessionPacket(const QJsonObject &message)
+{
+    const QByteArray payload = QJsonDocument(message).toJson(QJsonDocument::Compact).toBase64();
+    return "qbsmsg:" + QByteArray::number(payload.size()) + '\n' + payload;
+}
+
+ActivityRunner::ActivityRunner(Activities activities, TestProject testProject,
+                               const QString &qbsBuildDir, QString baseOutputDir)
+    : m_activities(activities)
+    , m_testProject(std::move(testProject))
+    , m_qbsBinary(qbsBuildDir + "/bin/qbs")
+    , m_baseOutputDir(std::move(baseOutputDir))
+{
+    if (!QDir::root().mkpath(m_baseOutputDir))
+        throw Exception(QStringLiteral("Failed to create directory '%1'.").arg(m_baseOutputDir));
+    if ((m_activities & ActivityIncrementalBuild) && m_testProject.changedFile.isEmpty()) {
+        throw Exception(QStringLiteral("The activity '%1' requires a file to change.")
+                        .arg(activityId(ActivityIncrementalBuild)));
+    }
+}
+
+void ActivityRunner::setUpActivity(Activity activity, const QString &buildDir) const
+{
+    switch (activity) {
+    case ActivityResolving:
+    case ActivityClean:
+        break;
+    case ActivityRuleExecution:
+    case ActivityBuildGraphLoadStore:
+    case ActivityProjectData:
+        runProcess(qbsCommandLine("resolve", buildDir));
+        break;
+    case ActivityNullBuild:
+    case ActivityIncrementalBuild:
+    case ActivityDependencyScanning:
+        runProcess(qbsCommandLine("build", buildDir));
+        break;
+    case ActivityInstall:
+        runProcess(qbsCommandLine("build", buildDir, QStringList("--no-install")));
+        break;
+    }
+}
+
+void ActivityRunner::prepareMeasurement(Activity activity, const QString &buildDir) const
+{
+    switch (activity) {
+    case ActivityResolving:
+        if (!QDir(buildDir).removeRecursively())
+            throw Exception(QStringLiteral("Failed to remove directory '%1'.").arg(buildDir));
+        break;
+    case ActivityClean:
+        runProcess(qbsCommandLine("build", buildDir));
+        break;
+    case ActivityRuleExecution:
+    case ActivityNullBuild:
+    case ActivityIncrementalBuild:
+    case ActivityDependencyScanning:
+    case ActivityBuildGraphLoadStore:
+    case ActivityInstall:
+    case ActivityProjectData:
+        break;
+    }
+}
+
+QStringList ActivityRunner::measuredCommandLine(Activity activity, const QString &buildDir) const
+{
+    switch (activity) {
+    case ActivityResolving:
+    case ActivityBuildGraphLoadStore:
+        return qbsCommandLine("resolve", buildDir);
+    case ActivityRuleExecution:
+        return qbsCommandLine("build", buildDir, QStringList("--dry-run"));
+    case ActivityNullBuild:
+        return qbsCommandLine("build", buildDir);
+    case ActivityIncrementalBuild:
+        // Using --changed-files rather than touching the file keeps the source tree untouched,
+        // so the activities can run concurrently on the same test project.
+        return qbsCommandLine("build", buildDir,
+                              QStringList{"--changed-files", m_testProject.changedFile});
+    case ActivityDependencyScanning:
+        // Makes the executor scan the inputs of all transformers of the up-to-date project.
+        return qbsCommandLine("build", buildDir, QStringList("--check-timestamps"));
+    case ActivityInstall:
+        return qbsCommandLine("install", buildDir, QStringList("--no-build"));
+    case ActivityClean:
+        return qbsCommandLine("clean", buildDir);
+    case ActivityProjectData:
+        return QStringList{m_qbsBinary, "session"};
+    }
+    return {};
+}
+
+QByteArray ActivityRunner::measuredCommandInput(Activity activity, const QString &buildDir) const
+{
+    if (activity != ActivityProjectData)
+        return {};
+    const QJsonObject resolveRequest{
+        {"type", "resolve-project"},
+        {"project-file-path", m_testProject.filePath},
+        {"build-root", buildDir},
+        {"configuration-name", "default"},
+        {"restore-behavior", "restore-only"},
+        {"data-mode", "always"}
+    };
+    return sessionPacket(resolveRequest) + sessionPacket(QJsonObject{{"type", "quit"}});
+}
+
+QString ActivityRunner::buildDirectory(Activity activity, const QString &variant) const
+{
+    return m_baseOutputDir + "/build-dir." + activityId(activity) + '.' + variant;
+}
+
+QStringList ActivityRunner::qbsCommandLine(const QString &command, const QString &buildDir,
+                                           const QStringList &extraArgs) const
+{
+    return QStringList() << m_qbsBinary << command << "-qq" << "-d" << buildDir
+                         << "-f" << m_testProject.filePath << extraArgs;
+}
+
+} // namespace qbsBenchmarker
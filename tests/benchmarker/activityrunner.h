@@ -0,0 +1,84 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#ifndef QBS_BENCHMARKER_ACTIVITYRUNNER_H
+#define QBS_BENCHMARKER_ACTIVITYRUNNER_H
+
+#include "activities.h"
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
+
+namespace qbsBenchmarker {
+
+class TestProject
+{
+public:
+    QString filePath;
+
+    // The source file that the incremental build activity considers as changed.
+    QString changedFile;
+};
+
+// Knows how to bring a build directory into the state required by an activity and
+// which qbs invocation is to be measured for it. Subclasses implement the actual measuring.
+class ActivityRunner
+{
+public:
+    virtual ~ActivityRunner() = default;
+
+    virtual void run() = 0;
+
+protected:
+    ActivityRunner(Activities activities, TestProject testProject, const QString &qbsBuildDir,
+                   QString baseOutputDir);
+
+    // Called once per build directory.
+    void setUpActivity(Activity activity, const QString &buildDir) const;
+
+    // Called before every measured qbs invocation.
+    void prepareMeasurement(Activity activity, const QString &buildDir) const;
+
+    QStringList measuredCommandLine(Activity activity, const QString &buildDir) const;
+    QByteArray measuredCommandInput(Activity activity, const QString &buildDir) const;
+
+    QString buildDirectory(Activity activity, const QString &variant) const;
+
+    const Activities m_activities;
+    const TestProject m_testProject;
+    const QString m_qbsBinary;
+    const QString m_baseOutputDir;
+
+private:
+    QStringList qbsCommandLine(const QString &command, const QString &buildDir,
+                               const QStringList &extraArgs = QStringList()) const;
+};
+
+} // namespace qbsBenchmarker
+
+#endif // Include guard.
@@ -31,6 +31,10 @@
 #include "exception.h"
 
 #include <QtCore/qcoreapplication.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qjsonarray.h>
+#include <QtCore/qjsondocument.h>
+#include <QtCore/qjsonobject.h>
 
 #include <cstdlib>
 #include <iostream>
@@ -41,7 +45,7 @@ static bool hasRegression = false;
 
 static int relativeChange(qint64 oldVal, qint64 newVal)
 {
-    return newVal == 0 ? 0 : newVal * 100 / oldVal - 100;
+    return oldVal == 0 || newVal == 0 ? 0 : newVal * 100 / oldVal - 100;
 }
 
 static QByteArray relativeChangeString(int change)
@@ -53,37 +57,13 @@ static QByteArray relativeChangeString(int change)
     return changeString;
 }
 
-static void printResults(Activity activity, const BenchmarkResults &results,
-                         int regressionThreshold)
+static void printValue(const char *description, qint64 oldVal, qint64 newVal, const char *unit,
+                       int regressionThreshold)
 {
-    std::cout << "========== Performance data for ";
-    switch (activity) {
-    case ActivityResolving:
-        std::cout << "Resolving";
-        break;
-    case ActivityRuleExecution:
-        std::cout << "Rule Execution";
-        break;
-    case ActivityNullBuild:
-        std::cout << "Null Build";
-        break;
-    }
-    std::cout << " ==========" << std::endl;
-    const BenchmarkResult result = results.value(activity);
     const char * const indent = "    ";
-    std::cout << indent << "Old instruction count: " << result.oldInstructionCount << std::endl;
-    std::cout << indent << "New instruction count: " << result.newInstructionCount << std::endl;
-    int change = relativeChange(result.oldInstructionCount, result.newInstructionCount);
-    if (change > regressionThreshold)
-        hasRegression = true;
-    std::cout << indent << "Relative change: "
-              << relativeChangeString(change).constData()
-              << std::endl;
-    std::cout << indent << "Old peak memory usage: " << result.oldPeakMemoryUsage << " Bytes"
-              << std::endl;
-    std::cout << indent
-              << "New peak memory usage: " << result.newPeakMemoryUsage << " Bytes" << std::endl;
-    change = relativeChange(result.oldPeakMemoryUsage, result.newPeakMemoryUsage);
+    std::cout << indent << "Old " << description << ": " << oldVal << unit << std::endl;
+    std::cout << indent << "New " << description << ": " << newVal << unit << std::endl;
+    const int change = relativeChange(oldVal, newVal);
     if (change > regressionThreshold)
         hasRegression = true;
     std::cout << indent << "Relative change: "
@@ -91,15 +71,85 @@ static void printResults(Activity activity, const BenchmarkResults &results,
               << std::endl;
 }
 
+static void printResults(Activity activity, const BenchmarkResults &results,
+                         bool wallClockMode, int regressionThreshold)
+{
+    std::cout << "========== Performance data for " << qPrintable(activityDisplayName(activity))
+              << " ==========" << std::endl;
+    const BenchmarkResult result = results.value(activity);
+    if (wallClockMode) {
+        printValue("wall-clock time", result.oldWallClockTime, result.newWallClockTime, " ms",
+                   regressionThreshold);
+        return;
+    }
+    printValue("instruction count", result.oldInstructionCount, result.newInstructionCount, "",
+               regressionThreshold);
+    printValue("peak memory usage", result.oldPeakMemoryUsage, result.newPeakMemoryUsage,
+               " Bytes", regressionThreshold);
+}
+
 static void printResults(Activities activities, const BenchmarkResults &results,
-                         int regressionThreshold)
+                         bool wallClockMode, int regressionThreshold)
+{
+    for (const Activity activity : allActivities()) {
+        if (activities & activity)
+            printResults(activity, results, wallClockMode, regressionThreshold);
+    }
+}
+
+static QJsonObject jsonValue(qint64 oldVal, qint64 newVal)
+{
+    return QJsonObject{
+        {"old", oldVal},
+        {"new", newVal},
+        {"relative-change", relativeChange(oldVal, newVal)}
+    };
+}
+
+static void writeJsonResults(const CommandLineParser &clParser, const Benchmarker &benchmarker)
 {
-    if (activities & ActivityResolving)
-        printResults(ActivityResolving, results, regressionThreshold);
-    if (activities & ActivityRuleExecution)
-        printResults(ActivityRuleExecution, results, regressionThreshold);
-    if (activities & ActivityNullBuild)
-        printResults(ActivityNullBuild, results, regressionThreshold);
+    QJsonArray activityResults;
+    for (const Activity activity : allActivities()) {
+        if (!(clParser.activies() & activity))
+            continue;
+        const BenchmarkResult result = benchmarker.results().value(activity);
+        QJsonObject activityResult{{"activity", activityId(activity)}};
+        if (clParser.wallClockMode()) {
+            activityResult.insert("wall-clock-time-ms",
+                                  jsonValue(result.oldWallClockTime, result.newWallClockTime));
+        } else {
+            activityResult.insert("instruction-count", jsonValue(result.oldInstructionCount,
+                                                                 result.newInstructionCount));
+            activityResult.insert("peak-memory-usage", jsonValue(result.oldPeakMemoryUsage,
+                                                                 result.newPeakMemoryUsage));
+        }
+        activityResults.append(activityResult);
+    }
+    QJsonObject testProject{{"file-path", benchmarker.testProject().filePath}};
+    if (clParser.generatedProductCount() > 0) {
+        testProject.insert("generated-products", clParser.generatedProductCount());
+        testProject.insert("generated-files-per-product", clParser.generatedFilesPerProduct());
+        testProject.insert("generated-js-commands-per-product",
+                           clParser.generatedJsCommandsPerProduct());
+    }
+    QJsonObject data{
+        {"mode", clParser.wallClockMode() ? "wall-clock" : "valgrind"},
+        {"old-commit", clParser.oldCommit()},
+        {"new-commit", clParser.newCommit()},
+        {"test-project", testProject},
+        {"regression-threshold", clParser.regressionThreshold()},
+        {"regression", hasRegression},
+        {"results", activityResults}
+    };
+    if (clParser.wallClockMode())
+        data.insert("repetitions", clParser.repetitions());
+
+    QFile f(clParser.jsonOutputFilePath());
+    const QByteArray content = QJsonDocument(data).toJson();
+    if (!f.open(QIODevice::WriteOnly) || f.write(content) != content.size()) {
+        throw Exception(QStringLiteral("Failed to write file '%1': %2")
+                        .arg(f.fileName(), f.errorString()));
+    }
 }
 
 int main(int argc, char *argv[])
@@ -114,11 +164,24 @@ int main(int argc, char *argv[])
         return EXIT_FAILURE;
     }
 
+    TestProject testProject;
+    testProject.filePath = clParser.testProjectFilePath();
+    testProject.changedFile = clParser.changedFilePath();
     Benchmarker benchmarker(clParser.activies(), clParser.oldCommit(), clParser.newCommit(),
-                            clParser.testProjectFilePath(), clParser.qbsRepoDirPath());
+                            testProject, clParser.qbsRepoDirPath());
+    if (clParser.wallClockMode())
+        benchmarker.setWallClockMode(clParser.repetitions());
+    if (clParser.generatedProductCount() > 0) {
+        benchmarker.setGeneratedProjectSize(clParser.generatedProductCount(),
+                                            clParser.generatedFilesPerProduct(),
+                                            clParser.generatedJsCommandsPerProduct());
+    }
     try {
         benchmarker.benchmark();
-        printResults(clParser.activies(), benchmarker.results(), clParser.regressionThreshold());
+        printResults(clParser.activies(), benchmarker.results(), clParser.wallClockMode(),
+                     clParser.regressionThreshold());
+        if (!clParser.jsonOutputFilePath().isEmpty())
+            writeJsonResults(clParser, benchmarker);
         if (hasRegression) {
             benchmarker.keepRawData();
             std::cout << "Performance regression detected. Raw benchmarking data available "
@@ -28,8 +28,10 @@
 #include "benchmarker.h"
 
 #include "exception.h"
+#include "projectgenerator.h"
 #include "runsupport.h"
 #include "valgrindrunner.h"
+#include "wallclockrunner.h"
 
 #include <QtConcurrent/qtconcurrentrun.h>
 
@@ -39,7 +41,7 @@
 namespace qbsBenchmarker {
 
 Benchmarker::Benchmarker(Activities activities, QString oldCommit, QString newCommit,
-                         QString testProject, QString qbsRepo)
+                         TestProject testProject, QString qbsRepo)
     : m_activities(activities)
     , m_oldCommit(std::move(oldCommit))
     , m_newCommit(std::move(newCommit))
@@ -60,8 +62,28 @@ Benchmarker::~Benchmarker()
     }
 }
 
+void Benchmarker::setWallClockMode(int repetitions)
+{
+    m_mode = BenchmarkMode::WallClock;
+    m_repetitions = repetitions;
+}
+
+void Benchmarker::setGeneratedProjectSize(int productCount, int filesPerProduct,
+                                          int jsCommandsPerProduct)
+{
+    m_generatedProductCount = productCount;
+    m_generatedFilesPerProduct = filesPerProduct;
+    m_generatedJsCommandsPerProduct = jsCommandsPerProduct;
+}
+
 void Benchmarker::benchmark()
 {
+    if (m_generatedProductCount > 0) {
+        std::cout << "Generating test project..." << std::endl;
+        m_testProject = ProjectGenerator(m_generatedProductCount, m_generatedFilesPerProduct,
+                                         m_generatedJsCommandsPerProduct)
+                .generate(m_baseOutputDir.path());
+    }
     rememberCurrentRepoState();
     runProcess(QStringList() << "git" << "checkout" << m_oldCommit, m_qbsRepo);
     const QString oldQbsBuildDir = m_baseOutputDir.path() + "/qbs-build." + m_oldCommit;
@@ -71,6 +93,15 @@ void Benchmarker::benchmark()
     const QString newQbsBuildDir = m_baseOutputDir.path() + "/qbs-build." + m_newCommit;
     std::cout << "Building from new repo state..." << std::endl;
     buildQbs(newQbsBuildDir);
+    if (m_mode == BenchmarkMode::Valgrind)
+        runValgrind(oldQbsBuildDir, newQbsBuildDir);
+    else
+        runWallClock(oldQbsBuildDir, newQbsBuildDir);
+    std::cout << "Done!" << std::endl;
+}
+
+void Benchmarker::runValgrind(const QString &oldQbsBuildDir, const QString &newQbsBuildDir)
+{
     std::cout << "Now running valgrind. This can take a while." << std::endl;
 
     ValgrindRunner oldDataRetriever(m_activities, m_testProject, oldQbsBuildDir,
@@ -93,7 +124,28 @@ void Benchmarker::benchmark()
         benchmarkResult.newInstructionCount = valgrindResult.instructionCount;
         benchmarkResult.newPeakMemoryUsage = valgrindResult.peakMemoryUsage;
     }
-    std::cout << "Done!" << std::endl;
+}
+
+void Benchmarker::runWallClock(const QString &oldQbsBuildDir, const QString &newQbsBuildDir)
+{
+    std::cout << "Now measuring wall-clock times." << std::endl;
+
+    // Old and new state are measured one after the other, as running them concurrently
+    // would distort the timings.
+    WallClockRunner oldDataRetriever(m_activities, m_testProject, oldQbsBuildDir,
+                                     m_baseOutputDir.path() + "/benchmark-data." + m_oldCommit,
+                                     m_repetitions);
+    oldDataRetriever.run();
+    const auto oldWallClockResults = oldDataRetriever.results();
+    for (const WallClockResult &wallClockResult : oldWallClockResults)
+        m_results[wallClockResult.activity].oldWallClockTime = wallClockResult.medianTime;
+    WallClockRunner newDataRetriever(m_activities, m_testProject, newQbsBuildDir,
+                                     m_baseOutputDir.path() + "/benchmark-data." + m_newCommit,
+                                     m_repetitions);
+    newDataRetriever.run();
+    const auto newWallClockResults = newDataRetriever.results();
+    for (const WallClockResult &wallClockResult : newWallClockResults)
+        m_results[wallClockResult.activity].newWallClockTime = wallClockResult.medianTime;
 }
 
 void Benchmarker::rememberCurrentRepoState()
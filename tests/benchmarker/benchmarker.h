@@ -28,7 +28,7 @@
 #ifndef QBS_BENCHMARKER_BENCHMARKER_H
 #define QBS_BENCHMARKER_BENCHMARKER_H
 
-#include "activities.h"
+#include "activityrunner.h"
 
 #include <QtCore/qhash.h>
 #include <QtCore/qstring.h>
@@ -40,13 +40,17 @@ QT_END_NAMESPACE
 
 namespace qbsBenchmarker {
 
+enum class BenchmarkMode { Valgrind, WallClock };
+
 class BenchmarkResult
 {
 public:
-    qint64 oldInstructionCount;
-    qint64 newInstructionCount;
-    qint64 oldPeakMemoryUsage;
-    qint64 newPeakMemoryUsage;
+    qint64 oldInstructionCount = 0;
+    qint64 newInstructionCount = 0;
+    qint64 oldPeakMemoryUsage = 0;
+    qint64 newPeakMemoryUsage = 0;
+    qint64 oldWallClockTime = 0; // Median, in milliseconds.
+    qint64 newWallClockTime = 0;
 };
 using BenchmarkResults = QHash<Activity, BenchmarkResult>;
 
@@ -54,24 +58,36 @@ class Benchmarker
 {
 public:
     Benchmarker(Activities activities, QString oldCommit, QString newCommit,
-                QString testProject, QString qbsRepo);
+                TestProject testProject, QString qbsRepo);
     ~Benchmarker();
 
+    void setWallClockMode(int repetitions);
+    void setGeneratedProjectSize(int productCount, int filesPerProduct,
+                                 int jsCommandsPerProduct);
+
     void benchmark();
     void keepRawData() { m_baseOutputDir.setAutoRemove(false ); }
 
     BenchmarkResults results() const { return m_results; }
     QString rawDataBaseDir() const { return m_baseOutputDir.path(); }
+    TestProject testProject() const { return m_testProject; }
 
 private:
     void rememberCurrentRepoState();
     void buildQbs(const QString &buildDir) const;
+    void runValgrind(const QString &oldQbsBuildDir, const QString &newQbsBuildDir);
+    void runWallClock(const QString &oldQbsBuildDir, const QString &newQbsBuildDir);
 
     const Activities m_activities;
     const QString m_oldCommit;
     const QString m_newCommit;
-    const QString m_testProject;
+    TestProject m_testProject;
     const QString m_qbsRepo;
+    BenchmarkMode m_mode = BenchmarkMode::Valgrind;
+    int m_repetitions = 1;
+    int m_generatedProductCount = 0;
+    int m_generatedFilesPerProduct = 0;
+    int m_generatedJsCommandsPerProduct = 0;
     QString m_commitToRestore;
     QTemporaryDir m_baseOutputDir;
     BenchmarkResults m_results;
@@ -5,16 +5,23 @@ CONFIG -= app_bundle
 CONFIG += c++17
 QT += concurrent
 SOURCES = \
+    activities.cpp \
+    activityrunner.cpp \
     benchmarker-main.cpp \
     benchmarker.cpp \
     commandlineparser.cpp \
+    projectgenerator.cpp \
     runsupport.cpp \
-    valgrindrunner.cpp
+    valgrindrunner.cpp \
+    wallclockrunner.cpp
 
 HEADERS = \
     activities.h \
+    activityrunner.h \
     benchmarker.h \
     commandlineparser.h \
     exception.h \
+    projectgenerator.h \
     runsupport.h \
-    valgrindrunner.h
+    valgrindrunner.h \
+    wallclockrunner.h
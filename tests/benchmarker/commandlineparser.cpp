@@ -34,12 +34,14 @@
 #include <QtCore/qcoreapplication.h>
 #include <QtCore/qfileinfo.h>
 
+#include <algorithm>
+#include <iostream>
+
 namespace qbsBenchmarker {
 
-static QString resolveActivity() { return "resolving"; }
-static QString ruleExecutionActivity() { return "rule-execution"; }
-static QString nullBuildActivity() { return "null-build"; }
-static QString allActivities() { return "all"; }
+static QString allActivitiesId() { return "all"; }
+static QString valgrindMode() { return "valgrind"; }
+static QString wallClockMode() { return "wall-clock"; }
 
 CommandLineParser::CommandLineParser() = default;
 
@@ -47,7 +49,7 @@ void CommandLineParser::parse()
 {
     QCommandLineParser parser;
     parser.setApplicationDescription("This tool aims to detect qbs performance regressions "
-                                     "using valgrind.");
+                                     "using valgrind or wall-clock time measurements.");
     parser.addHelpOption();
     QCommandLineOption oldCommitOption(QStringList{"old-commit", "o"}, "The old qbs commit.",
                                        "old commit");
@@ -58,23 +60,57 @@ void CommandLineParser::parse()
     QCommandLineOption testProjectOption(QStringList{"test-project", "p"},
             "The example project to use for the benchmark.", "project file path");
     parser.addOption(testProjectOption);
+    QCommandLineOption changedFileOption("changed-file",
+            "The source file of the test project that is considered as changed "
+            "for the incremental build activity. Required for that activity, unless "
+            "the test project is generated.", "file path");
+    parser.addOption(changedFileOption);
+    QCommandLineOption generatedProductsOption("generated-products",
+            "Instead of using an existing test project, generate one with this many products.",
+            "count");
+    parser.addOption(generatedProductsOption);
+    QCommandLineOption generatedFilesOption("generated-files-per-product",
+            "The number of source files (plus one header each) per generated product.",
+            "count", "10");
+    parser.addOption(generatedFilesOption);
+    QCommandLineOption generatedJsCommandsOption("generated-js-commands-per-product",
+            "The number of trivial JavaScript commands (copying a small file) per generated "
+            "product. Use this to benchmark command execution overhead.", "count", "0");
+    parser.addOption(generatedJsCommandsOption);
     QCommandLineOption qbsRepoOption(QStringList{"qbs-repo", "r"}, "The qbs repository.",
                                      "repo path");
     parser.addOption(qbsRepoOption);
+    QStringList activityIds;
+    for (const Activity activity : allActivities())
+        activityIds << activityId(activity);
+    activityIds << allActivitiesId();
     QCommandLineOption activitiesOption(QStringList{"activities", "a"},
-            QStringLiteral("The activities to benchmark. Possible values (CSV): %1,%2,%3,%4")
-                    .arg(resolveActivity(), ruleExecutionActivity(), nullBuildActivity(),
-                         allActivities()), "activities", allActivities());
+            QStringLiteral("The activities to benchmark. Possible values (CSV): %1")
+                    .arg(activityIds.join(',')), "activities", allActivitiesId());
     parser.addOption(activitiesOption);
+    QCommandLineOption modeOption(QStringList{"mode", "m"},
+            QStringLiteral("How to measure. Possible values: %1 (instruction count and peak "
+                           "memory usage), %2 (elapsed time).")
+                    .arg(valgrindMode(), wallClockMode()), "mode", valgrindMode());
+    parser.addOption(modeOption);
+    QCommandLineOption repetitionsOption("repetitions",
+            "How often to repeat each measurement in wall-clock mode. "
+            "The median is reported.", "count", "5");
+    parser.addOption(repetitionsOption);
     QCommandLineOption thresholdOption(QStringList{"regression-threshold", "t"},
             "A relative increase higher than this is considered a performance regression. "
             "All temporary data from running the benchmarks will be kept if that happens.",
             "value in per cent");
     parser.addOption(thresholdOption);
+    QCommandLineOption jsonOutputOption("json-output",
+            "Also write the results to this file in JSON format.", "file path");
+    parser.addOption(jsonOutputOption);
     parser.process(*QCoreApplication::instance());
-    const QList<QCommandLineOption> mandatoryOptions = QList<QCommandLineOption>()
-            << oldCommitOption << newCommitOption << testProjectOption << qbsRepoOption;
-    for (const QCommandLineOption &o : mandatoryOptions) {
+    QList<QCommandLineOption> mandatoryOptions = QList<QCommandLineOption>()
+            << oldCommitOption << newCommitOption << qbsRepoOption;
+    if (!parser.isSet(generatedProductsOption))
+        mandatoryOptions << testProjectOption;
+    for (const QCommandLineOption &o : qAsConst(mandatoryOptions)) {
         if (!parser.isSet(o))
             throwException(o.names().constFirst(), parser.helpText());
         if (parser.value(o).isEmpty())
@@ -86,26 +122,63 @@ void CommandLineParser::parse()
         throw Exception(QStringLiteral("Error parsing command line: "
                 "'new commit' and 'old commit' must be different commits.\n%1").arg(parser.helpText()));
     }
-    m_testProjectFilePath = parser.value(testProjectOption);
+    if (parser.isSet(generatedProductsOption)) {
+        if (parser.isSet(testProjectOption)) {
+            throw Exception(QStringLiteral("Error parsing command line: "
+                    "'--%1' and '--%2' are mutually exclusive.\n%3")
+                    .arg(testProjectOption.names().constFirst(),
+                         generatedProductsOption.names().constFirst(), parser.helpText()));
+        }
+        m_generatedProductCount = positiveIntValue(generatedProductsOption.names().constFirst(),
+                parser.value(generatedProductsOption), parser.helpText());
+        m_generatedFilesPerProduct = positiveIntValue(generatedFilesOption.names().constFirst(),
+                parser.value(generatedFilesOption), parser.helpText());
+        if (parser.value(generatedJsCommandsOption) != QLatin1String("0")) {
+            m_generatedJsCommandsPerProduct = positiveIntValue(
+                        generatedJsCommandsOption.names().constFirst(),
+                        parser.value(generatedJsCommandsOption), parser.helpText());
+        }
+    } else {
+        m_testProjectFilePath = QFileInfo(parser.value(testProjectOption)).absoluteFilePath();
+    }
+    if (parser.isSet(changedFileOption))
+        m_changedFilePath = QFileInfo(parser.value(changedFileOption)).absoluteFilePath();
     m_qbsRepoDirPath = parser.value(qbsRepoOption);
     const QStringList activitiesList = parser.value(activitiesOption).split(',');
     m_activities = Activities();
     for (const QString &activityString : activitiesList) {
-        if (activityString == allActivities()) {
-            m_activities = ActivityResolving | ActivityRuleExecution | ActivityNullBuild;
+        if (activityString == allActivitiesId()) {
+            for (const Activity activity : allActivities()) {
+                // Generated projects come with a file to change; existing ones do not.
+                if (activity == ActivityIncrementalBuild && m_changedFilePath.isEmpty()
+                        && m_generatedProductCount == 0) {
+                    std::cout << "Skipping activity '" << qPrintable(activityId(activity))
+                              << "', as no changed file was given." << std::endl;
+                    continue;
+                }
+                m_activities |= activity;
+            }
             break;
-        } else if (activityString == resolveActivity()) {
-            m_activities = ActivityResolving;
-        } else if (activityString == ruleExecutionActivity()) {
-            m_activities |= ActivityRuleExecution;
-        } else if (activityString == nullBuildActivity()) {
-            m_activities |= ActivityNullBuild;
-        } else {
+        }
+        const auto &activities = allActivities();
+        const auto it = std::find_if(activities.cbegin(), activities.cend(),
+                                     [&activityString](Activity activity) {
+            return activityId(activity) == activityString;
+        });
+        if (it == activities.cend()) {
             throwException(activitiesOption.names().constFirst(),
                            activityString,
                            parser.helpText());
         }
+        m_activities |= *it;
     }
+    const QString mode = parser.value(modeOption);
+    if (mode == wallClockMode())
+        m_wallClockMode = true;
+    else if (mode != valgrindMode())
+        throwException(modeOption.names().constFirst(), mode, parser.helpText());
+    m_repetitions = positiveIntValue(repetitionsOption.names().constFirst(),
+                                     parser.value(repetitionsOption), parser.helpText());
     m_regressionThreshold = 5;
     if (parser.isSet(thresholdOption)) {
         bool ok = true;
@@ -116,6 +189,18 @@ void CommandLineParser::parse()
                            rawThresholdValue,
                            parser.helpText());
     }
+    if (parser.isSet(jsonOutputOption))
+        m_jsonOutputFilePath = QFileInfo(parser.value(jsonOutputOption)).absoluteFilePath();
+}
+
+int CommandLineParser::positiveIntValue(const QString &optionName, const QString &rawValue,
+                                        const QString &helpText)
+{
+    bool ok = true;
+    const int value = rawValue.toInt(&ok);
+    if (!ok || value < 1)
+        throwException(optionName, rawValue, helpText);
+    return value;
 }
 
 void CommandLineParser::throwException(const QString &optionName, const QString &illegalValue,
@@ -45,20 +45,36 @@ public:
     QString oldCommit() const { return m_oldCommit; }
     QString newCommit() const { return m_newCommit; }
     QString testProjectFilePath() const { return m_testProjectFilePath; }
+    QString changedFilePath() const { return m_changedFilePath; }
+    int generatedProductCount() const { return m_generatedProductCount; }
+    int generatedFilesPerProduct() const { return m_generatedFilesPerProduct; }
+    int generatedJsCommandsPerProduct() const { return m_generatedJsCommandsPerProduct; }
     QString qbsRepoDirPath() const { return m_qbsRepoDirPath; }
     int regressionThreshold() const { return m_regressionThreshold; }
+    bool wallClockMode() const { return m_wallClockMode; }
+    int repetitions() const { return m_repetitions; }
+    QString jsonOutputFilePath() const { return m_jsonOutputFilePath; }
 
 private:
     [[noreturn]] void throwException(const QString &optionName, const QString &illegalValue,
                                    const QString &helpText);
     [[noreturn]] void throwException(const QString &missingOption, const QString &helpText);
+    int positiveIntValue(const QString &optionName, const QString &rawValue,
+                         const QString &helpText);
 
     Activities m_activities;
     QString m_oldCommit;
     QString m_newCommit;
     QString m_testProjectFilePath;
+    QString m_changedFilePath;
+    int m_generatedProductCount = 0;
+    int m_generatedFilesPerProduct = 0;
+    int m_generatedJsCommandsPerProduct = 0;
     QString m_qbsRepoDirPath;
     int m_regressionThreshold = 0;
+    bool m_wallClockMode = false;
+    int m_repetitions = 0;
+    QString m_jsonOutputFilePath;
 };
 
 } // namespace qbsBenchmarker
@@ -0,0 +1,181 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#include "projectgenerator.h"
+
+#include "exception.h"
+
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+
+namespace qbsBenchmarker {
+
+// Products form chains of this length, so the dependency depth stays bounded
+// independently of the project size.
+static const int chainLength = 10;
+
+ProjectGenerator::ProjectGenerator(int productCount, int filesPerProduct,
+                                   int jsCommandsPerProduct)
+    : m_productCount(productCount)
+    , m_filesPerProduct(filesPerProduct)
+    , m_jsCommandsPerProduct(jsCommandsPerProduct)
+{
+    if (m_productCount < 1 || m_filesPerProduct < 1 || m_jsCommandsPerProduct < 0) {
+        throw Exception(QStringLiteral("Invalid project size: %1 products with %2 files each.")
+                        .arg(m_productCount).arg(m_filesPerProduct));
+    }
+}
+
+TestProject ProjectGenerator::generate(const QString &baseDir) const
+{
+    const QString projectDir = baseDir + "/generated-project";
+    if (!QDir::root().mkpath(projectDir + "/common"))
+        throw Exception(QStringLiteral("Failed to create directory '%1'.").arg(projectDir));
+    writeFile(projectDir + "/common/common.h",
+              "#pragma once\n\n#define COMMON_VALUE 1\n");
+
+    QByteArray projectFileContent = "import qbs\n\nProject {\n    references: [\n";
+    for (int i = 0; i < m_productCount; ++i) {
+        const QString productDir = projectDir + '/' + productName(i);
+        if (!QDir::root().mkpath(productDir))
+            throw Exception(QStringLiteral("Failed to create directory '%1'.").arg(productDir));
+        generateProduct(productDir, i);
+        projectFileContent += "        \"" + productName(i).toUtf8() + '/'
+                + productName(i).toUtf8() + ".qbs\",\n";
+    }
+    projectFileContent += "    ]\n}\n";
+
+    TestProject project;
+    project.filePath = projectDir + "/project.qbs";
+    writeFile(project.filePath, projectFileContent);
+
+    // A file in the last product, which no other product depends on.
+    project.changedFile = projectDir + '/' + productName(m_productCount - 1) + '/'
+            + fileBaseName(m_productCount - 1, m_filesPerProduct - 1) + ".cpp";
+    return project;
+}
+
+QString ProjectGenerator::productName(int productIndex) const
+{
+    return QStringLiteral("product%1").arg(productIndex);
+}
+
+QString ProjectGenerator::fileBaseName(int productIndex, int fileIndex) const
+{
+    return QStringLiteral("p%1_f%2").arg(productIndex).arg(fileIndex);
+}
+
+void ProjectGenerator::generateProduct(const QString &productDir, int productIndex) const
+{
+    // Every product depends on its predecessor in the chain, the first product of a chain
+    // depends on the very first product.
+    const int dependencyIndex = productIndex % chainLength != 0 ? productIndex - 1
+                                                                : productIndex > 0 ? 0 : -1;
+
+    QByteArray productFileContent = "import qbs\n";
+    if (m_jsCommandsPerProduct > 0)
+        productFileContent += "import qbs.File\n";
+    productFileContent += "\nStaticLibrary {\n    name: \""
+            + productName(productIndex).toUtf8() + "\"\n"
+            "    Depends { name: \"cpp\" }\n";
+    if (dependencyIndex != -1) {
+        productFileContent += "    Depends { name: \"" + productName(dependencyIndex).toUtf8()
+                + "\" }\n";
+    }
+    productFileContent += "    cpp.includePaths: [\"../common\"]\n"
+                          "    Export {\n"
+                          "        Depends { name: \"cpp\" }\n"
+                          "        cpp.includePaths: [exportingProduct.sourceDirectory]\n"
+                          "    }\n"
+                          "    files: [\n";
+    for (int i = 0; i < m_filesPerProduct; ++i) {
+        const QByteArray baseName = fileBaseName(productIndex, i).toUtf8();
+        productFileContent += "        \"" + baseName + ".cpp\",\n"
+                "        \"" + baseName + ".h\",\n";
+
+        writeFile(productDir + '/' + baseName + ".h",
+                  "#pragma once\n\nint " + baseName + "();\n");
+        QByteArray sourceContent = "#include \"" + baseName + ".h\"\n"
+                "#include <common.h>\n";
+        QByteArray expression = "COMMON_VALUE";
+        if (i > 0) {
+            const QByteArray predecessor = fileBaseName(productIndex, i - 1).toUtf8();
+            sourceContent += "#include \"" + predecessor + ".h\"\n";
+            expression += " + " + predecessor + "()";
+        }
+        if (dependencyIndex != -1) {
+            const QByteArray dependencyFunction = fileBaseName(dependencyIndex, 0).toUtf8();
+            sourceContent += "#include <" + dependencyFunction + ".h>\n";
+            expression += " + " + dependencyFunction + "()";
+        }
+        sourceContent += "\nint " + baseName + "() { return " + expression + "; }\n";
+        writeFile(productDir + '/' + baseName + ".cpp", sourceContent);
+    }
+    productFileContent += "    ]\n";
+
+    // Lots of tiny JavaScript commands, as e.g. resource handling or file copying rules
+    // produce them.
+    if (m_jsCommandsPerProduct > 0) {
+        productFileContent += "    type: base.concat([\"copied-text\"])\n"
+                              "    Group {\n"
+                              "        fileTags: [\"text\"]\n"
+                              "        files: [\n";
+        for (int i = 0; i < m_jsCommandsPerProduct; ++i) {
+            const QByteArray fileName = "t" + QByteArray::number(i) + ".txt";
+            productFileContent += "            \"" + fileName + "\",\n";
+            writeFile(productDir + '/' + QString::fromLatin1(fileName), fileName + '\n');
+        }
+        productFileContent += "        ]\n"
+                "    }\n"
+                "    Rule {\n"
+                "        inputs: [\"text\"]\n"
+                "        Artifact {\n"
+                "            filePath: input.fileName + \".copy\"\n"
+                "            fileTags: [\"copied-text\"]\n"
+                "        }\n"
+                "        prepare: {\n"
+                "            var cmd = new JavaScriptCommand();\n"
+                "            cmd.silent = true;\n"
+                "            cmd.sourceCode = function() { File.copy(input.filePath, output.filePath); };\n"
+                "            return [cmd];\n"
+                "        }\n"
+                "    }\n";
+    }
+    productFileContent += "}\n";
+    writeFile(productDir + '/' + productName(productIndex) + ".qbs", productFileContent);
+}
+
+void ProjectGenerator::writeFile(const QString &filePath, const QByteArray &content) const
+{
+    QFile f(filePath);
+    if (!f.open(QIODevice::WriteOnly) || f.write(content) != content.size()) {
+        throw Exception(QStringLiteral("Failed to write file '%1': %2")
+                        .arg(filePath, f.errorString()));
+    }
+}
+
+} // namespace qbsBenchmarker
@@ -0,0 +1,59 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#ifndef QBS_BENCHMARKER_PROJECTGENERATOR_H
+#define QBS_BENCHMARKER_PROJECTGENERATOR_H
+
+#include "activityrunner.h"
+
+#include <QtCore/qstring.h>
+
+namespace qbsBenchmarker {
+
+// Creates a C++ project of the requested size. The output only depends on the parameters,
+// so results obtained with generated projects of the same size are comparable.
+class ProjectGenerator
+{
+public:
+    ProjectGenerator(int productCount, int filesPerProduct, int jsCommandsPerProduct = 0);
+
+    TestProject generate(const QString &baseDir) const;
+
+private:
+    QString productName(int productIndex) const;
+    QString fileBaseName(int productIndex, int fileIndex) const;
+    void generateProduct(const QString &productDir, int productIndex) const;
+    void writeFile(const QString &filePath, const QByteArray &content) const;
+
+    const int m_productCount;
+    const int m_filesPerProduct;
+    const int m_jsCommandsPerProduct;
+};
+
+} // namespace qbsBenchmarker
+
+#endif // Include guard.
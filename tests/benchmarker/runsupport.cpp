@@ -37,7 +37,7 @@
 namespace qbsBenchmarker {
 
 void runProcess(const QStringList &commandLine, const QString &workingDir, QByteArray *output,
-                int *exitCode)
+                int *exitCode, const QByteArray &input)
 {
     QStringList args = commandLine;
     const QString command = args.takeFirst();
@@ -47,6 +47,10 @@ void runProcess(const QStringList &commandLine, const QString &workingDir, QByte
     p.start(command, args);
     if (!p.waitForStarted())
         throw Exception(QStringLiteral("Process '%1' failed to start.").arg(command));
+    if (!input.isEmpty()) {
+        p.write(input);
+        p.closeWriteChannel();
+    }
     p.waitForFinished(-1);
     if (p.exitStatus() != QProcess::NormalExit) {
         throw Exception(QStringLiteral("Error running '%1': %2")
@@ -28,18 +28,19 @@
 #ifndef QBS_BENCHMARKER_RUNSUPPORT_H
 #define QBS_BENCHMARKER_RUNSUPPORT_H
 
+#include <QtCore/qbytearray.h>
 #include <QtCore/qglobal.h>
 #include <QtCore/qstring.h>
 
 QT_BEGIN_NAMESPACE
-class QByteArray;
 class QStringList;
 QT_END_NAMESPACE
 
 namespace qbsBenchmarker {
 
 void runProcess(const QStringList &commandLine, const QString& workingDir = QString(),
-                QByteArray *output = nullptr, int *exitCode = nullptr);
+                QByteArray *output = nullptr, int *exitCode = nullptr,
+                const QByteArray &input = QByteArray());
 
 } // namespace qbsBenchmarker
 
@@ -44,102 +44,48 @@
 
 namespace qbsBenchmarker {
 
-ValgrindRunner::ValgrindRunner(Activities activities, QString testProject,
+ValgrindRunner::ValgrindRunner(Activities activities, TestProject testProject,
                                const QString &qbsBuildDir, const QString &baseOutputDir)
-    : m_activities(activities)
-    , m_testProject(std::move(testProject))
-    , m_qbsBinary(qbsBuildDir + "/bin/qbs")
-    , m_baseOutputDir(baseOutputDir)
+    : ActivityRunner(activities, std::move(testProject), qbsBuildDir, baseOutputDir)
 {
-    if (!QDir::root().mkpath(m_baseOutputDir))
-        throw Exception(QStringLiteral("Failed to create directory '%1'.").arg(baseOutputDir));
 }
 
 void ValgrindRunner::run()
 {
     std::deque<QFuture<void>> futures;
-    if (m_activities & ActivityResolving)
-        futures.push_back(QtConcurrent::run(this, &ValgrindRunner::traceResolving));
-    if (m_activities & ActivityRuleExecution)
-        futures.push_back(QtConcurrent::run(this, &ValgrindRunner::traceRuleExecution));
-    if (m_activities & ActivityNullBuild)
-        futures.push_back(QtConcurrent::run(this, &ValgrindRunner::traceNullBuild));
+    for (const Activity activity : allActivities()) {
+        if (m_activities & activity)
+            futures.push_back(QtConcurrent::run(this, &ValgrindRunner::traceActivity, activity));
+    }
     while (!futures.empty()) {
         futures.front().waitForFinished();
         futures.pop_front();
     }
 }
 
-void ValgrindRunner::traceResolving()
-{
-    const QString buildDirCallgrind = m_baseOutputDir + "/build-dir.resolving.callgrind";
-    const QString buildDirMassif = m_baseOutputDir + "/build-dir.resolving.massif";
-    traceActivity(ActivityResolving, buildDirCallgrind, buildDirMassif);
-}
-
-void ValgrindRunner::traceRuleExecution()
-{
-    const QString buildDirCallgrind = m_baseOutputDir + "/build-dir.rule-execution.callgrind";
-    const QString buildDirMassif = m_baseOutputDir + "/build-dir.rule-execution.massif";
-    runProcess(qbsCommandLine("resolve", buildDirCallgrind, false));
-    runProcess(qbsCommandLine("resolve", buildDirMassif, false));
-    traceActivity(ActivityRuleExecution, buildDirCallgrind, buildDirMassif);
-}
-
-void ValgrindRunner::traceNullBuild()
-{
-    const QString buildDirCallgrind = m_baseOutputDir + "/build-dir.null-build.callgrind";
-    const QString buildDirMassif = m_baseOutputDir + "/build-dir.null-build.massif";
-    runProcess(qbsCommandLine("build", buildDirCallgrind, false));
-    runProcess(qbsCommandLine("build", buildDirMassif, false));
-    traceActivity(ActivityNullBuild, buildDirCallgrind, buildDirMassif);
-}
-
-void ValgrindRunner::traceActivity(Activity activity, const QString &buildDirCallgrind,
-                                   const QString &buildDirMassif)
+void ValgrindRunner::traceActivity(Activity activity)
 {
-    QString activityString;
-    QString qbsCommand;
-    bool dryRun;
-    switch (activity) {
-    case ActivityResolving:
-        activityString = "resolving";
-        qbsCommand = "resolve";
-        dryRun = false;
-        break;
-    case ActivityRuleExecution:
-        activityString = "rule-execution";
-        qbsCommand = "build";
-        dryRun = true;
-        break;
-    case ActivityNullBuild:
-        activityString = "null-build";
-        qbsCommand = "build";
-        dryRun = false;
-        break;
+    const QString buildDirCallgrind = buildDirectory(activity, "callgrind");
+    const QString buildDirMassif = buildDirectory(activity, "massif");
+    for (const QString &buildDir : {buildDirCallgrind, buildDirMassif}) {
+        setUpActivity(activity, buildDir);
+        prepareMeasurement(activity, buildDir);
     }
 
+    const QString activityString = activityId(activity);
     const QString outFileCallgrind = m_baseOutputDir + "/outfile." + activityString + ".callgrind";
     const QString outFileMassif = m_baseOutputDir + "/outfile." + activityString + ".massif";
     QFuture<qint64> callGrindFuture = QtConcurrent::run(this, &ValgrindRunner::runCallgrind,
-            qbsCommand, buildDirCallgrind, dryRun, outFileCallgrind);
-    QFuture<qint64> massifFuture = QtConcurrent::run(this, &ValgrindRunner::runMassif, qbsCommand,
-            buildDirMassif, dryRun, outFileMassif);
+            measuredCommandLine(activity, buildDirCallgrind),
+            measuredCommandInput(activity, buildDirCallgrind), outFileCallgrind);
+    QFuture<qint64> massifFuture = QtConcurrent::run(this, &ValgrindRunner::runMassif,
+            measuredCommandLine(activity, buildDirMassif),
+            measuredCommandInput(activity, buildDirMassif), outFileMassif);
     callGrindFuture.waitForFinished();
     massifFuture.waitForFinished();
     addToResults(ValgrindResult(activity, callGrindFuture.result(), massifFuture.result()));
 }
 
-QStringList ValgrindRunner::qbsCommandLine(const QString &command, const QString &buildDir,
-                                           bool dryRun) const
-{
-    QStringList commandLine = QStringList() << m_qbsBinary << command << "-qq" << "-d" << buildDir
-                                            << "-f" << m_testProject;
-    if (dryRun)
-        commandLine << "--dry-run";
-    return commandLine;
-}
-
 QStringList ValgrindRunner::wrapForValgrind(const QStringList &commandLine, const QString &tool,
                                             const QString &outFile) const
 {
@@ -148,22 +94,17 @@ QStringList ValgrindRunner::wrapForValgrind(const QStringList &commandLine, cons
                          << commandLine;
 }
 
-QStringList ValgrindRunner::valgrindCommandLine(const QString &qbsCommand, const QString &buildDir,
-        bool dryRun, const QString &tool, const QString &outFile) const
-{
-    return wrapForValgrind(qbsCommandLine(qbsCommand, buildDir, dryRun), tool, outFile);
-}
-
 void ValgrindRunner::addToResults(const ValgrindResult &result)
 {
     std::lock_guard<std::mutex> locker(m_resultsMutex);
     m_results.push_back(result);
 }
 
-qint64 ValgrindRunner::runCallgrind(const QString &qbsCommand, const QString &buildDir,
-                                     bool dryRun, const QString &outFile)
+qint64 ValgrindRunner::runCallgrind(const QStringList &commandLine, const QByteArray &input,
+                                    const QString &outFile)
 {
-    runProcess(valgrindCommandLine(qbsCommand, buildDir, dryRun, "callgrind", outFile));
+    runProcess(wrapForValgrind(commandLine, "callgrind", outFile), QString(), nullptr, nullptr,
+               input);
     QFile f(outFile);
     if (!f.open(QIODevice::ReadOnly)) {
         throw Exception(QStringLiteral("Failed to open file '%1': %2")
@@ -189,10 +130,11 @@ qint64 ValgrindRunner::runCallgrind(const QString &qbsCommand, const QString &bu
                                         "output file '%1'.").arg(outFile));
 }
 
-qint64 ValgrindRunner::runMassif(const QString &qbsCommand, const QString &buildDir, bool dryRun,
-                                  const QString &outFile)
+qint64 ValgrindRunner::runMassif(const QStringList &commandLine, const QByteArray &input,
+                                 const QString &outFile)
 {
-    runProcess(valgrindCommandLine(qbsCommand, buildDir, dryRun, "massif", outFile));
+    runProcess(wrapForValgrind(commandLine, "massif", outFile), QString(), nullptr, nullptr,
+               input);
     QByteArray ms_printOutput;
     runProcess(QStringList() << "ms_print" << outFile, QString(), &ms_printOutput);
     QBuffer buffer(&ms_printOutput);
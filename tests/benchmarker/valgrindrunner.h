@@ -28,7 +28,7 @@
 #ifndef QBS_BENCHMARKER_BENCHMARKRUNNER_H
 #define QBS_BENCHMARKER_BENCHMARKRUNNER_H
 
-#include "activities.h"
+#include "activityrunner.h"
 
 #include <QtCore/qlist.h>
 #include <QtCore/qstring.h>
@@ -52,36 +52,25 @@ public:
     qint64 peakMemoryUsage;
 };
 
-class ValgrindRunner
+class ValgrindRunner : public ActivityRunner
 {
 public:
-    ValgrindRunner(Activities activities, QString testProject, const QString &qbsBuildDir,
+    ValgrindRunner(Activities activities, TestProject testProject, const QString &qbsBuildDir,
                     const QString &baseOutputDir);
 
-    void run();
+    void run() override;
     QList<ValgrindResult> results() const { return m_results; }
 
 private:
-    void traceResolving();
-    void traceRuleExecution();
-    void traceNullBuild();
-    void traceActivity(Activity activity, const QString &buildDirCallgrind,
-                       const QString &buildDirMassif);
-    QStringList qbsCommandLine(const QString &command, const QString &buildDir, bool dryRun) const;
+    void traceActivity(Activity activity);
     QStringList wrapForValgrind(const QStringList &commandLine, const QString &tool,
                                 const QString &outFile) const;
-    QStringList valgrindCommandLine(const QString &qbsCommand, const QString &buildDir, bool dryRun,
-            const QString &tool, const QString &outFile) const;
     void addToResults(const ValgrindResult &results);
-    qint64 runCallgrind(const QString &qbsCommand, const QString &buildDir, bool dryRun,
-                         const QString &outFile);
-    qint64 runMassif(const QString &qbsCommand, const QString &buildDir, bool dryRun,
-                      const QString &outFile);
+    qint64 runCallgrind(const QStringList &commandLine, const QByteArray &input,
+                        const QString &outFile);
+    qint64 runMassif(const QStringList &commandLine, const QByteArray &input,
+                     const QString &outFile);
 
-    const Activities m_activities;
-    const QString m_testProject;
-    const QString m_qbsBinary;
-    const QString m_baseOutputDir;
     QList<ValgrindResult> m_results;
     std::mutex m_resultsMutex;
 };
@@ -0,0 +1,75 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#include "wallclockrunner.h"
+
+#include "runsupport.h"
+
+#include <QtCore/qelapsedtimer.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace qbsBenchmarker {
+
+WallClockRunner::WallClockRunner(Activities activities, TestProject testProject,
+                                 const QString &qbsBuildDir, const QString &baseOutputDir,
+                                 int repetitions)
+    : ActivityRunner(activities, std::move(testProject), qbsBuildDir, baseOutputDir)
+    , m_repetitions(std::max(repetitions, 1))
+{
+}
+
+void WallClockRunner::run()
+{
+    for (const Activity activity : allActivities()) {
+        if (m_activities & activity)
+            timeActivity(activity);
+    }
+}
+
+void WallClockRunner::timeActivity(Activity activity)
+{
+    const QString buildDir = buildDirectory(activity, "wall-clock");
+    setUpActivity(activity, buildDir);
+    const QStringList commandLine = measuredCommandLine(activity, buildDir);
+    const QByteArray input = measuredCommandInput(activity, buildDir);
+    std::vector<qint64> times;
+    times.reserve(m_repetitions);
+    for (int i = 0; i < m_repetitions; ++i) {
+        prepareMeasurement(activity, buildDir);
+        QElapsedTimer timer;
+        timer.start();
+        runProcess(commandLine, QString(), nullptr, nullptr, input);
+        times.push_back(timer.elapsed());
+    }
+    std::sort(times.begin(), times.end());
+    m_results.push_back(WallClockResult(activity, times.at(times.size() / 2), times.front(),
+                                        times.back()));
+}
+
+} // namespace qbsBenchmarker
@@ -0,0 +1,70 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#ifndef QBS_BENCHMARKER_WALLCLOCKRUNNER_H
+#define QBS_BENCHMARKER_WALLCLOCKRUNNER_H
+
+#include "activityrunner.h"
+
+#include <QtCore/qlist.h>
+
+namespace qbsBenchmarker {
+
+class WallClockResult
+{
+public:
+    WallClockResult(Activity a, qint64 median, qint64 min, qint64 max)
+        : activity(a), medianTime(median), minTime(min), maxTime(max) {}
+
+    Activity activity;
+    qint64 medianTime; // In milliseconds, as are the other values.
+    qint64 minTime;
+    qint64 maxTime;
+};
+
+// Measures the elapsed time of the qbs invocations directly, which is much faster than
+// running them under valgrind, but also more susceptible to noise. Activities are therefore
+// run one after the other, and each measurement is repeated.
+class WallClockRunner : public ActivityRunner
+{
+public:
+    WallClockRunner(Activities activities, TestProject testProject, const QString &qbsBuildDir,
+                    const QString &baseOutputDir, int repetitions);
+
+    void run() override;
+    QList<WallClockResult> results() const { return m_results; }
+
+private:
+    void timeActivity(Activity activity);
+
+    const int m_repetitions;
+    QList<WallClockResult> m_results;
+};
+
+} // namespace qbsBenchmarker
+
+#endif // Include guard.